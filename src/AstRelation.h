@@ -66,6 +66,18 @@
 /* Relation warnings are suppressed */
 #define SUPPRESSED_RELATION (0x800)
 
+/* Relation uses a disk-backed data structure */
+#define DISK_RELATION (0x1000)
+
+/* Relation uses a btree data structure with indirect indexes */
+#define INDIRECT_RELATION (0x2000)
+
+/* Relation keeps the least value of its last attribute per key */
+#define MIN_LATTICE_RELATION (0x4000)
+
+/* Relation keeps the greatest value of its last attribute per key */
+#define MAX_LATTICE_RELATION (0x8000)
+
 namespace souffle {
 
 /*!
@@ -138,12 +150,20 @@ public:
     /** Set qualifier associated with this relation */
     void setQualifier(int q) {
         qualifier = q;
-        if ((q & EQREL_RELATION) != 0) {
+        if ((q & MIN_LATTICE_RELATION) != 0) {
+            representation = RelationRepresentation::MIN_LATTICE;
+        } else if ((q & MAX_LATTICE_RELATION) != 0) {
+            representation = RelationRepresentation::MAX_LATTICE;
+        } else if ((q & EQREL_RELATION) != 0) {
             representation = RelationRepresentation::EQREL;
         } else if ((q & BRIE_RELATION) != 0) {
             representation = RelationRepresentation::BRIE;
         } else if ((q & BTREE_RELATION) != 0) {
             representation = RelationRepresentation::BTREE;
+        } else if ((q & DISK_RELATION) != 0) {
+            representation = RelationRepresentation::DISK;
+        } else if ((q & INDIRECT_RELATION) != 0) {
+            representation = RelationRepresentation::INDIRECT;
         } else if ((q & INFO_RELATION) != 0) {
             representation = RelationRepresentation::INFO;
         }
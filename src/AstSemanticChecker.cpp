@@ -763,6 +763,41 @@ void AstSemanticChecker::checkRelation(ErrorReport& report, const TypeEnvironmen
         }
     }
 
+    if (isLattice(relation.getRepresentation())) {
+        // the last attribute holds the values ordered by the lattice, the others form the key
+        std::string name = toString(relation.getName());
+        if (relation.getArity() == 0) {
+            report.addError("Lattice relation " + name + " has no attributes", relation.getSrcLoc());
+        } else {
+            const AstTypeIdentifier& typeName = relation.getAttribute(relation.getArity() - 1)->getTypeName();
+            if (!typeEnv.isType(typeName) || !isNumberType(typeEnv.getType(typeName))) {
+                report.addError("Last attribute of lattice relation " + name + " is not a number",
+                        relation.getAttribute(relation.getArity() - 1)->getSrcLoc());
+            }
+        }
+        if ((relation.getQualifier() &
+                    (BRIE_RELATION | EQREL_RELATION | DISK_RELATION | INDIRECT_RELATION)) != 0) {
+            report.addError("Lattice relation " + name + " must use a btree data structure",
+                    relation.getSrcLoc());
+        }
+        if (relation.isInline()) {
+            report.addError("Lattice relation " + name + " cannot be inlined", relation.getSrcLoc());
+        }
+        if (Global::config().has("provenance")) {
+            report.addError("Lattice relation " + name + " is not supported with provenance",
+                    relation.getSrcLoc());
+        }
+    }
+
+    // disk-backed relations are only supported by the interpreter
+    if (relation.getRepresentation() == RelationRepresentation::DISK &&
+            (Global::config().has("compile") || Global::config().has("dl-program") ||
+                    Global::config().has("generate") || Global::config().has("swig"))) {
+        report.addWarning("Disk relation " + toString(relation.getName()) +
+                                  " is kept in memory by synthesised programs",
+                relation.getSrcLoc());
+    }
+
     // start with declaration
     checkRelationDeclaration(report, typeEnv, program, relation, ioTypes);
 
@@ -33,6 +33,7 @@
 #include "GraphUtils.h"
 #include "PrecedenceGraph.h"
 #include "RamTypes.h"
+#include "RelationRepresentation.h"
 #include "TypeSystem.h"
 #include <cstddef>
 #include <functional>
@@ -92,8 +93,9 @@ bool RemoveRelationCopiesTransformer::removeRelationCopies(AstTranslationUnit& t
     AstProgram& program = *translationUnit.getProgram();
 
     // search for relations only defined by a single rule ..
+    // (lattices drop the tuples of their rule which are not the best ones, hence they are no copies)
     for (AstRelation* rel : program.getRelations()) {
-        if (!ioType->isIO(rel) && rel->getClauses().size() == 1u) {
+        if (!ioType->isIO(rel) && !isLattice(rel->getRepresentation()) && rel->getClauses().size() == 1u) {
             // .. of shape r(x,y,..) :- s(x,y,..)
             AstClause* cl = rel->getClause(0);
             if (!isFact(*cl) && cl->getBodySize() == 1u && cl->getAtoms().size() == 1u) {
@@ -887,8 +889,9 @@ bool ReduceExistentialsTransformer::transform(AstTranslationUnit& translationUni
         newRelation->setName(newRelationName.str());
         newRelation->setSrcLoc(originalRelation->getSrcLoc());
 
-        // EqRel relations require two arguments, so remove it from the qualifier
-        newRelation->setQualifier(originalRelation->getQualifier() & ~(EQREL_RELATION));
+        // EqRel relations require two arguments and lattices at least one, so remove them from the qualifier
+        newRelation->setQualifier(originalRelation->getQualifier() &
+                                  ~(EQREL_RELATION | MIN_LATTICE_RELATION | MAX_LATTICE_RELATION));
 
         // Keep all non-recursive clauses
         for (AstClause* clause : originalRelation->getClauses()) {
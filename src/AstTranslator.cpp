@@ -22,6 +22,7 @@
 #include "AstIO.h"
 #include "AstLiteral.h"
 #include "AstNode.h"
+#include "AstProfileUse.h"
 #include "AstProgram.h"
 #include "AstRelation.h"
 #include "AstTranslationUnit.h"
@@ -44,6 +45,7 @@
 #include "RamStatement.h"
 #include "RamTranslationUnit.h"
 #include "RecordTable.h"
+#include "RelationRepresentation.h"
 #include "SrcLocation.h"
 #include "TypeSystem.h"
 #include "Util.h"
@@ -592,6 +594,202 @@ std::unique_ptr<RamCondition> AstTranslator::ProvenanceClauseTranslator::createC
     return nullptr;
 }
 
+/** check whether a rule body is cyclic and can be evaluated by leapfrog triejoins */
+bool AstTranslator::ClauseTranslator::isCyclicJoin(const AstClause& clause) const {
+    // provenance requires the nested-loop translation of rules
+    if (Global::config().has("provenance") || clause.getHead()->getArity() == 0) {
+        return false;
+    }
+
+    // a plan given by the user fixes the order of the nested loops
+    if (clause.hasFixedExecutionPlan()) {
+        return false;
+    }
+
+    // a cycle requires at least three atoms
+    const auto atoms = clause.getAtoms();
+    if (atoms.size() < 3) {
+        return false;
+    }
+
+    // aggregates and records are bound by dedicated operations
+    bool isComplex = false;
+    visitDepthFirst(clause, [&](const AstAggregator&) { isComplex = true; });
+    visitDepthFirst(clause, [&](const AstRecordInit&) { isComplex = true; });
+    if (isComplex) {
+        return false;
+    }
+
+    // atoms must be indexed by b-trees, and their arguments distinct variables or constants
+    std::vector<std::set<std::string>> edges;
+    for (const AstAtom* atom : atoms) {
+        auto representation = translator.translateRelation(atom)->get()->getRepresentation();
+        if (representation != RelationRepresentation::DEFAULT &&
+                representation != RelationRepresentation::BTREE &&
+                representation != RelationRepresentation::INDIRECT) {
+            return false;
+        }
+        std::set<std::string> vars;
+        for (const AstArgument* arg : atom->getArguments()) {
+            if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                if (!vars.insert(var->getName()).second) {
+                    return false;
+                }
+            } else if (dynamic_cast<const AstConstant*>(arg) == nullptr &&
+                       dynamic_cast<const AstUnnamedVariable*>(arg) == nullptr) {
+                return false;
+            }
+        }
+        if (vars.empty()) {
+            return false;
+        }
+        edges.push_back(vars);
+    }
+
+    // all variables must be bound by atoms
+    bool isGrounded = true;
+    visitDepthFirst(clause, [&](const AstVariable& var) {
+        if (!any_of(edges, [&](const std::set<std::string>& edge) { return contains(edge, var.getName()); })) {
+            isGrounded = false;
+        }
+    });
+    if (!isGrounded) {
+        return false;
+    }
+
+    // GYO reduction: the body is acyclic iff the reduction eliminates all but one atom
+    bool changed = true;
+    while (changed && edges.size() > 1) {
+        changed = false;
+
+        // remove variables occurring in a single atom
+        for (auto& edge : edges) {
+            for (auto it = edge.begin(); it != edge.end();) {
+                const std::string& var = *it;
+                if (std::count_if(edges.begin(), edges.end(), [&](const std::set<std::string>& other) {
+                        return contains(other, var);
+                    }) == 1) {
+                    it = edge.erase(it);
+                    changed = true;
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        // remove an atom whose variables are covered by another atom
+        for (size_t i = 0; i < edges.size() && !changed; i++) {
+            for (size_t j = 0; j < edges.size(); j++) {
+                if (i != j && std::includes(edges[j].begin(), edges[j].end(), edges[i].begin(),
+                                      edges[i].end())) {
+                    edges.erase(edges.begin() + i);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    return edges.size() > 1;
+}
+
+/** check whether a leapfrog triejoin is expected to be cheaper than nested loops */
+bool AstTranslator::ClauseTranslator::isLeapfrogProfitable(const AstClause& clause) const {
+    // without a profile, the worst-case optimal join is chosen for every cyclic body
+    AstProfileUse* profileUse = translator.profileUse;
+    if (profileUse == nullptr) {
+        return true;
+    }
+
+    // the seeks of a leapfrog join cost more than the nested loops over small relations
+    for (const AstAtom* atom : clause.getAtoms()) {
+        if (!profileUse->hasRelationSize(atom->getName()) ||
+                profileUse->getRelationSize(atom->getName()) >= LEAPFROG_MIN_TUPLES) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** generate RAM code for a rule with a cyclic body */
+std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateLeapfrogClause(
+        const AstClause& clause, const AstClause& originalClause) {
+    const auto atoms = clause.getAtoms();
+
+    // each variable is bound by its own join, in the order of first appearance
+    std::map<std::string, int> varLevel;
+    for (const AstAtom* atom : atoms) {
+        for (const AstArgument* arg : atom->getArguments()) {
+            if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                if (varLevel.find(var->getName()) == varLevel.end()) {
+                    int varLoc = varLevel.size();
+                    varLevel[var->getName()] = varLoc;
+                    valueIndex.addVarReference(*var, varLoc, 0);
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<RamOperation> op = createOperation(clause);
+
+    /* add conditions caused by negations and binary relations */
+    for (const auto& lit : clause.getBodyLiterals()) {
+        if (auto condition = translator.translateConstraint(lit, valueIndex)) {
+            op = std::make_unique<RamFilter>(std::move(condition), std::move(op));
+        }
+    }
+
+    // build the joins bottom-up
+    for (int level = varLevel.size() - 1; level >= 0; level--) {
+        std::vector<std::unique_ptr<RamRelationReference>> relRefs;
+        std::vector<std::vector<std::unique_ptr<RamExpression>>> queryPatterns;
+        std::vector<size_t> columns;
+
+        // intersect the atoms containing the variable, bound by constants and outer variables
+        for (const AstAtom* atom : atoms) {
+            int column = -1;
+            std::vector<std::unique_ptr<RamExpression>> queryPattern;
+            for (size_t pos = 0; pos < atom->argSize(); ++pos) {
+                const AstArgument* arg = atom->getArgument(pos);
+                const auto* var = dynamic_cast<const AstVariable*>(arg);
+                if (var != nullptr && varLevel[var->getName()] == level) {
+                    column = pos;
+                    queryPattern.push_back(std::make_unique<RamUndefValue>());
+                } else if (var != nullptr && varLevel[var->getName()] < level) {
+                    queryPattern.push_back(std::make_unique<RamTupleElement>(varLevel[var->getName()], 0));
+                } else if (const auto* c = dynamic_cast<const AstConstant*>(arg)) {
+                    queryPattern.push_back(std::make_unique<RamSignedConstant>(c->getRamRepresentation()));
+                } else {
+                    queryPattern.push_back(std::make_unique<RamUndefValue>());
+                }
+            }
+            if (column >= 0) {
+                relRefs.push_back(translator.translateRelation(atom));
+                queryPatterns.push_back(std::move(queryPattern));
+                columns.push_back(column);
+            }
+        }
+
+        op = std::make_unique<RamLeapfrogJoin>(
+                std::move(relRefs), std::move(queryPatterns), std::move(columns), level, std::move(op));
+    }
+
+    // add check for emptiness of the atoms
+    for (const AstAtom* atom : atoms) {
+        op = std::make_unique<RamFilter>(
+                std::make_unique<RamNegation>(
+                        std::make_unique<RamEmptinessCheck>(translator.translateRelation(atom))),
+                std::move(op));
+    }
+
+    /* generate the final RAM Insert statement */
+    std::unique_ptr<RamCondition> cond = createCondition(originalClause);
+    if (cond != nullptr) {
+        return std::make_unique<RamQuery>(std::make_unique<RamFilter>(std::move(cond), std::move(op)));
+    } else {
+        return std::make_unique<RamQuery>(std::move(op));
+    }
+}
+
 /** generate RAM code for a clause */
 std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
         const AstClause& clause, const AstClause& originalClause, const int version) {
@@ -619,6 +817,12 @@ std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
     // the rest should be rules
     assert(isRule(clause));
 
+    // evaluate cyclic bodies variable-at-a-time, unless disabled or not worth it
+    if (!Global::config().has("no-leapfrog") && isCyclicJoin(clause) &&
+            isLeapfrogProfitable(originalClause)) {
+        return translateLeapfrogClause(clause, originalClause);
+    }
+
     createValueIndex(clause);
 
     // -- create RAM statement --
@@ -885,10 +1089,38 @@ std::unique_ptr<RamStatement> AstTranslator::translateNonRecursiveRelation(
     // the ram table reference
     std::unique_ptr<RamRelationReference> rrel = translateRelation(&rel);
 
+    /* insert facts of constants as a single table, unless each rule is profiled */
+    std::vector<RamDomain> facts;
+    std::set<const AstClause*> tabulated;
+    if (!Global::config().has("profile") && rel.getArity() > 0) {
+        for (AstClause* clause : rel.getClauses()) {
+            if (!isFact(*clause)) {
+                continue;
+            }
+            const auto& args = clause->getHead()->getArguments();
+            if (!all_of(args, [](const AstArgument* arg) {
+                    return dynamic_cast<const AstConstant*>(arg) != nullptr;
+                })) {
+                continue;
+            }
+            for (const AstArgument* arg : args) {
+                facts.push_back(static_cast<const AstConstant*>(arg)->getRamRepresentation());
+            }
+            tabulated.insert(clause);
+        }
+    }
+    if (!tabulated.empty()) {
+        std::ostringstream ds;
+        ds << rel.getName() << ": " << tabulated.size() << " facts\nin file " << rel.getSrcLoc();
+        auto table = std::make_unique<RamFacts>(
+                std::unique_ptr<RamRelationReference>(rrel->clone()), std::move(facts));
+        appendStmt(res, std::make_unique<RamDebugInfo>(std::move(table), ds.str()));
+    }
+
     /* iterate over all clauses that belong to the relation */
     for (AstClause* clause : rel.getClauses()) {
-        // skip recursive rules
-        if (recursiveClauses->recursive(clause)) {
+        // skip recursive rules and tabulated facts
+        if (recursiveClauses->recursive(clause) || tabulated.count(clause) > 0) {
             continue;
         }
 
@@ -974,6 +1206,53 @@ void AstTranslator::nameUnnamedVariables(AstClause* clause) {
     }
 }
 
+/** generate RAM code keeping the tuples of a lattice relation with the best value of their key */
+std::unique_ptr<RamStatement> AstTranslator::translateLatticeCompaction(const AstRelation& rel) {
+    size_t valueColumn = rel.getArity() - 1;
+    AggregateFunction fun =
+            (rel.getRepresentation() == RelationRepresentation::MIN_LATTICE) ? souffle::MIN : souffle::MAX;
+
+    // project each tuple whose value is the best value of its key into the compaction relation
+    std::vector<std::unique_ptr<RamExpression>> values;
+    for (size_t i = 0; i < rel.getArity(); i++) {
+        values.push_back(std::make_unique<RamTupleElement>(0, i));
+    }
+    std::unique_ptr<RamOperation> op =
+            std::make_unique<RamProject>(translateRelation(&rel, "@compact_"), std::move(values));
+    op = std::make_unique<RamFilter>(std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+                                             std::make_unique<RamTupleElement>(0, valueColumn),
+                                             std::make_unique<RamTupleElement>(1, 0)),
+            std::move(op));
+
+    // aggregate the values of the tuples with the same key
+    std::unique_ptr<RamCondition> keyCondition;
+    for (size_t i = 0; i < valueColumn; i++) {
+        std::unique_ptr<RamCondition> equal = std::make_unique<RamConstraint>(BinaryConstraintOp::EQ,
+                std::make_unique<RamTupleElement>(1, i), std::make_unique<RamTupleElement>(0, i));
+        keyCondition = (keyCondition == nullptr)
+                               ? std::move(equal)
+                               : std::make_unique<RamConjunction>(std::move(keyCondition), std::move(equal));
+    }
+    if (keyCondition == nullptr) {
+        keyCondition = std::make_unique<RamTrue>();
+    }
+    op = std::make_unique<RamAggregate>(std::move(op), fun, translateRelation(&rel),
+            std::make_unique<RamTupleElement>(1, valueColumn), std::move(keyCondition), 1);
+    op = std::make_unique<RamScan>(translateRelation(&rel), 0, std::move(op));
+
+    // replace the relation by the compacted tuples; the relation is purged even if a clear
+    // would keep its tuples for the interface
+    std::vector<std::unique_ptr<RamExpression>> copied;
+    for (size_t i = 0; i < rel.getArity(); i++) {
+        copied.push_back(std::make_unique<RamTupleElement>(0, i));
+    }
+    return std::make_unique<RamSequence>(std::make_unique<RamQuery>(std::move(op)),
+            std::make_unique<RamPurge>(translateRelation(&rel)),
+            std::make_unique<RamQuery>(std::make_unique<RamScan>(translateRelation(&rel, "@compact_"), 0,
+                    std::make_unique<RamProject>(translateRelation(&rel), std::move(copied)))),
+            std::make_unique<RamClear>(translateRelation(&rel, "@compact_")));
+}
+
 /** generate RAM code for recursive relations in a strongly-connected component */
 std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
         const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses) {
@@ -1439,6 +1718,11 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     // get auxiliary arity analysis
     auxArityAnalysis = translationUnit.getAnalysis<AuxiliaryArity>();
 
+    // the sizes of the relations in a profile decide whether leapfrog joins pay off
+    if (Global::config().has("profile-use")) {
+        profileUse = translationUnit.getAnalysis<AstProfileUse>();
+    }
+
     // start with an empty sequence of ram statements
     std::unique_ptr<RamStatement> res = std::make_unique<RamSequence>();
 
@@ -1446,7 +1730,7 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     if (sccGraph.getNumberOfSCCs() == 0) return;
 
     // a function to load relations
-    const auto& makeRamLoad = [&](std::unique_ptr<RamStatement>& current, const AstRelation* relation,
+    const auto& makeRamLoad = [&](RamParallel& current, const AstRelation* relation,
                                       const std::string& inputDirectory, const std::string& fileExtension) {
         std::unique_ptr<RamStatement> statement =
                 std::make_unique<RamLoad>(std::unique_ptr<RamRelationReference>(translateRelation(relation)),
@@ -1457,7 +1741,7 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
             statement = std::make_unique<RamLogRelationTimer>(std::move(statement), logTimerStatement,
                     std::unique_ptr<RamRelationReference>(translateRelation(relation)));
         }
-        appendStmt(current, std::move(statement));
+        current.add(std::move(statement));
     };
 
     // a function to store relations
@@ -1483,6 +1767,18 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     // maintain the index of the SCC within the topological order
     size_t indexOfScc = 0;
 
+    // loads of consecutive SCCs are performed concurrently, right before the first of
+    // them computing anything; the relations are loaded no earlier than in their stratum
+    auto loads = std::make_unique<RamParallel>();
+    const auto& flushLoads = [&]() {
+        if (loads->getStatements().size() == 1) {
+            appendStmt(res, std::unique_ptr<RamStatement>(loads->getStatements()[0]->clone()));
+        } else if (!loads->getStatements().empty()) {
+            appendStmt(res, std::move(loads));
+        }
+        loads = std::make_unique<RamParallel>();
+    };
+
     // create all Ram relations in ramRels
     for (const auto& scc : sccOrder.order()) {
         const auto& isRecursive = sccGraph.isRecursive(scc);
@@ -1511,6 +1807,12 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
                 ramRels[newName] = std::make_unique<RamRelation>(newName, arity, auxiliaryArity,
                         attributeNames, attributeTypeQualifiers, representation);
             }
+            // lattices are compacted through a plain relation, even if they are not recursive
+            if (isLattice(representation)) {
+                std::string compactName = "@compact_" + name;
+                ramRels[compactName] = std::make_unique<RamRelation>(compactName, arity, auxiliaryArity,
+                        attributeNames, attributeTypeQualifiers, RelationRepresentation::BTREE);
+            }
         }
     }
     // iterate over each SCC according to the topological order
@@ -1532,7 +1834,7 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
 
         // load all internal input relations from the facts dir with a .facts extension
         for (const auto& relation : internIns) {
-            makeRamLoad(current, relation, "fact-dir", ".facts");
+            makeRamLoad(*loads, relation, "fact-dir", ".facts");
         }
 
         // compute the relations themselves
@@ -1542,6 +1844,13 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
                                : translateRecursiveRelation(allInterns, recursiveClauses);
         appendStmt(current, std::move(bodyStatement));
 
+        // keep the best tuples of the lattices, including loaded ones
+        for (const auto& relation : allInterns) {
+            if (isLattice(relation->getRepresentation())) {
+                appendStmt(current, translateLatticeCompaction(*relation));
+            }
+        }
+
         // store all internal output relations to the output dir with a .csv extension
         for (const auto& relation : internOuts) {
             makeRamStore(current, relation, "output-dir", ".csv");
@@ -1555,9 +1864,13 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
             }
         }
 
-        appendStmt(res, std::move(current));
+        if (current) {
+            flushLoads();
+            appendStmt(res, std::move(current));
+        }
         indexOfScc++;
     }
+    flushLoads();
 
     // add main timer if profiling
     if (res && Global::config().has("profile")) {
@@ -36,6 +36,7 @@ namespace souffle {
 class AstAtom;
 class AstClause;
 class AstLiteral;
+class AstProfileUse;
 class AstProgram;
 class AstRelation;
 class AstTranslationUnit;
@@ -79,6 +80,12 @@ private:
     /** Auxiliary Arity Analysis */
     const AuxiliaryArity* auxArityAnalysis;
 
+    /** Relation sizes of a profile, if given */
+    AstProfileUse* profileUse = nullptr;
+
+    /** Number of tuples of the largest relation of a body below which leapfrog joins do not pay off */
+    static constexpr size_t LEAPFROG_MIN_TUPLES = 10000;
+
     /**
      * Concrete attribute
      */
@@ -347,6 +354,16 @@ private:
 
         void createValueIndex(const AstClause& clause);
 
+        // check whether the body of a clause is cyclic and amenable to a leapfrog triejoin
+        bool isCyclicJoin(const AstClause& clause) const;
+
+        // check whether a leapfrog triejoin is expected to be cheaper than nested loops
+        bool isLeapfrogProfitable(const AstClause& clause) const;
+
+        // translate a clause with a cyclic body into a nest of leapfrog joins, one per variable
+        std::unique_ptr<RamStatement> translateLeapfrogClause(
+                const AstClause& clause, const AstClause& originalClause);
+
     protected:
         AstTranslator& translator;
 
@@ -390,6 +407,12 @@ private:
     std::unique_ptr<RamStatement> translateRecursiveRelation(
             const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses);
 
+    /**
+     * translate RAM code reducing a lattice relation to the tuples with the best value of
+     * their key, dropping the tuples superseded during its computation
+     */
+    std::unique_ptr<RamStatement> translateLatticeCompaction(const AstRelation& rel);
+
     /** translate RAM code for subroutine to get subproofs */
     std::unique_ptr<RamStatement> makeSubproofSubroutine(const AstClause& clause);
 
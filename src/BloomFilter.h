@@ -0,0 +1,385 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file BloomFilter.h
+ *
+ * Approximate membership filters answering existence checks of absent
+ * tuples without an index lookup, shared by the interpreter and the
+ * synthesised code.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A split block Bloom filter over tuples of a fixed arity.
+ *
+ * Each tuple is hashed to a block of 256 bits, in which it sets one bit in
+ * each of the eight 32-bit words. A lookup hence touches a single cache
+ * line. Insertions are thread-safe and may run concurrently with lookups.
+ * The filter has no false negatives; the rate of false positives is about
+ * one percent as long as the number of tuples stays below the capacity.
+ */
+class BloomFilter {
+    /** Number of words of a block */
+    static constexpr std::size_t WORDS_PER_BLOCK = 8;
+
+    /** Number of bits per tuple at full capacity */
+    static constexpr std::size_t BITS_PER_TUPLE = 16;
+
+    /** A block of the filter, aligned to avoid straddling cache lines */
+    struct alignas(32) Block {
+        std::atomic<uint32_t> words[WORDS_PER_BLOCK];
+    };
+
+public:
+    /**
+     * Creates an empty filter for the given number of tuples
+     */
+    BloomFilter(std::size_t arity, std::size_t capacity)
+            : arity(arity), capacity(capacity),
+              numBlocks(std::max<std::size_t>(1, capacity * BITS_PER_TUPLE / (32 * WORDS_PER_BLOCK))),
+              blocks(new Block[numBlocks]) {
+        for (std::size_t i = 0; i < numBlocks; i++) {
+            for (auto& word : blocks[i].words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Adds a tuple to the filter
+     */
+    void insert(const RamDomain* tuple) {
+        uint64_t hash = hashTuple(tuple);
+        Block& block = getBlock(hash);
+        for (std::size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+            uint32_t mask = getMask(hash, i);
+            // avoid the write, and the invalidation of the cache line, if the bit is set already
+            if ((block.words[i].load(std::memory_order_relaxed) & mask) == 0) {
+                block.words[i].fetch_or(mask, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Tests whether the tuple may have been added; false is definite
+     */
+    bool mayContain(const RamDomain* tuple) const {
+        uint64_t hash = hashTuple(tuple);
+        const Block& block = getBlock(hash);
+        for (std::size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+            if ((block.words[i].load(std::memory_order_relaxed) & getMask(hash, i)) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Returns the number of tuples the filter has been sized for
+     */
+    std::size_t getCapacity() const {
+        return capacity;
+    }
+
+private:
+    uint64_t hashTuple(const RamDomain* tuple) const {
+        uint64_t hash = arity;
+        for (std::size_t i = 0; i < arity; i++) {
+            hash = (hash ^ static_cast<uint64_t>(tuple[i])) * 0x9e3779b97f4a7c15ULL;
+            hash ^= hash >> 29;
+        }
+        // finalise with the avalanche of MurmurHash3
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    Block& getBlock(uint64_t hash) const {
+        // map the upper half of the hash onto the blocks without a division
+        return blocks[((hash >> 32) * numBlocks) >> 32];
+    }
+
+    static uint32_t getMask(uint64_t hash, std::size_t word) {
+        static constexpr uint32_t salts[WORDS_PER_BLOCK] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return uint32_t(1) << ((static_cast<uint32_t>(hash) * salts[word]) >> 27);
+    }
+
+    const std::size_t arity;
+    const std::size_t capacity;
+    const std::size_t numBlocks;
+    std::unique_ptr<Block[]> blocks;
+};
+
+/**
+ * Guards the existence checks of a relation with a Bloom filter, which is
+ * enabled automatically for relations that are large and whose probes
+ * mostly miss, e.g. the relations of negated atoms and the full relations
+ * checked before tuples are added to the new knowledge of a recursion.
+ *
+ * The filter has to be informed of every tuple added to the relation
+ * before the tuple becomes visible in the indexes of the relation.
+ * Whether a filter is used, and its size, is adapted by update(), which
+ * must not run concurrently with insertions into the relation. Existence
+ * checks may run concurrently with update(), hence a replaced filter is
+ * only released once the relation is cleared.
+ *
+ * The checks are counted by each thread in a slot of its own, without
+ * atomic read-modify-write operations, and the slots are summed by
+ * update(). If more than NUM_SLOTS threads check a relation, threads share
+ * slots and may lose counts, which only makes the observed rates inexact.
+ */
+class TupleFilter {
+public:
+    /** Minimal size of a relation to be filtered */
+    static constexpr std::size_t MIN_SIZE = 4096;
+
+    /** Number of probes after which the observed miss rate is trusted */
+    static constexpr std::size_t MIN_PROBES = 1024;
+
+    /** Number of counter slots of the threads */
+    static constexpr std::size_t NUM_SLOTS = 32;
+
+    explicit TupleFilter(std::size_t arity) : arity(arity), slots(new Counters[NUM_SLOTS]) {}
+
+    TupleFilter(const TupleFilter&) = delete;
+    TupleFilter& operator=(const TupleFilter&) = delete;
+
+    /**
+     * Records a tuple added to the relation
+     */
+    void insert(const RamDomain* tuple) {
+        BloomFilter* filter = active.load(std::memory_order_acquire);
+        if (filter != nullptr) {
+            filter->insert(tuple);
+        }
+    }
+
+    /**
+     * Tests whether the relation contains a tuple, calling the given index
+     * lookup only if the filter cannot rule out the tuple
+     */
+    template <typename Lookup>
+    bool contains(const RamDomain* tuple, Lookup lookup) {
+        Counters& counters = slots[getSlot()];
+        increment(counters.probes);
+        BloomFilter* filter = active.load(std::memory_order_acquire);
+        if (filter != nullptr && !filter->mayContain(tuple)) {
+            increment(counters.misses);
+            increment(counters.saved);
+            return false;
+        }
+        bool found = lookup();
+        if (!found) {
+            increment(counters.misses);
+        }
+        return found;
+    }
+
+    /**
+     * Enables, resizes or disables the filter, depending on the size of the
+     * relation and the miss rate of the probes observed since the last
+     * change. A relation is filtered optimistically as soon as it is large
+     * enough, unless its filter has been disabled before for lack of misses.
+     * To fill a new filter, scan is called with a function adding a tuple
+     * and has to pass it all tuples of the relation.
+     */
+    template <typename Scan>
+    void update(std::size_t size, Scan scan) {
+        std::lock_guard<std::mutex> guard(lock);
+        std::size_t numProbes = sum(&Counters::probes);
+        std::size_t numMisses = sum(&Counters::misses);
+        bool observed = numProbes >= MIN_PROBES;
+
+        BloomFilter* filter = active.load(std::memory_order_relaxed);
+        if (filter == nullptr) {
+            if (size < MIN_SIZE || (observed ? 2 * numMisses < numProbes : rejected)) {
+                return;
+            }
+        } else if (observed && 4 * numMisses < numProbes) {
+            // most probes find their tuple, so the filter only adds to their cost
+            active.store(nullptr, std::memory_order_release);
+            rejected = true;
+            resetCounters();
+            return;
+        } else if (size <= filter->getCapacity()) {
+            return;
+        }
+
+        // leave room for the relation to double before the filter is rebuilt
+        auto next = std::make_unique<BloomFilter>(arity, 2 * size);
+        scan([&](const RamDomain* tuple) { next->insert(tuple); });
+        active.store(next.get(), std::memory_order_release);
+        filters.push_back(std::move(next));
+        if (filter == nullptr) {
+            resetCounters();
+        }
+    }
+
+    /**
+     * Drops the filter of a cleared relation; must not run concurrently
+     * with existence checks
+     */
+    void clear() {
+        std::lock_guard<std::mutex> guard(lock);
+        active.store(nullptr, std::memory_order_relaxed);
+        filters.clear();
+    }
+
+    /** Returns whether a filter is in use */
+    bool isActive() const {
+        return active.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    /** Returns the number of existence checks answered by the filter alone */
+    std::size_t getSaved() const {
+        return sum(&Counters::saved);
+    }
+
+private:
+    /** Counters of the existence checks of a thread, on a cache line of their own */
+    struct alignas(64) Counters {
+        /** Existence checks since the last change of the filter */
+        std::atomic<std::size_t> probes{0};
+
+        /** Existence checks not finding their tuple since the last change of the filter */
+        std::atomic<std::size_t> misses{0};
+
+        /** Existence checks answered by the filter alone */
+        std::atomic<std::size_t> saved{0};
+    };
+
+    /** Returns the counter slot of the calling thread */
+    static std::size_t getSlot() {
+        static std::atomic<std::size_t> nextSlot{0};
+        static thread_local std::size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % NUM_SLOTS;
+        return slot;
+    }
+
+    /** Increments a counter of the slot of the calling thread */
+    static void increment(std::atomic<std::size_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /** Sums a counter over all slots */
+    std::size_t sum(std::atomic<std::size_t> Counters::*counter) const {
+        std::size_t res = 0;
+        for (std::size_t i = 0; i < NUM_SLOTS; i++) {
+            res += (slots[i].*counter).load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+    void resetCounters() {
+        for (std::size_t i = 0; i < NUM_SLOTS; i++) {
+            slots[i].probes.store(0, std::memory_order_relaxed);
+            slots[i].misses.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    const std::size_t arity;
+
+    /** The filter in use, or null if the relation is not filtered */
+    std::atomic<BloomFilter*> active{nullptr};
+
+    /** The current and the replaced filters, which may still be read by existence checks */
+    std::vector<std::unique_ptr<BloomFilter>> filters;
+
+    /** Set once the filter has been disabled for a low miss rate */
+    bool rejected = false;
+
+    /** Guards updates of the filter */
+    std::mutex lock;
+
+    /** The counters of the existence checks, one slot per thread */
+    std::unique_ptr<Counters[]> slots;
+};
+
+/**
+ * A relation of the synthesised code whose existence checks are guarded by
+ * a filter. All insertions must go through this type.
+ */
+template <typename Relation, std::size_t Arity>
+class FilteredRelation : public Relation {
+public:
+    using t_tuple = typename Relation::t_tuple;
+    using context = typename Relation::context;
+
+    bool insert(const t_tuple& t) {
+        context h = this->createContext();
+        return insert(t, h);
+    }
+
+    bool insert(const t_tuple& t, context& h) {
+        filter.insert(&t[0]);
+        return Relation::insert(t, h);
+    }
+
+    bool insert(const RamDomain* ramDomain) {
+        RamDomain data[Arity];
+        std::copy(ramDomain, ramDomain + Arity, data);
+        return insert(reinterpret_cast<const t_tuple&>(data));
+    }
+
+    template <typename... Values,
+            typename = std::enable_if_t<sizeof...(Values) == Arity &&
+                                        std::conjunction<std::is_arithmetic<Values>...>::value>>
+    bool insert(Values... values) {
+        RamDomain data[Arity] = {static_cast<RamDomain>(values)...};
+        return insert(data);
+    }
+
+    bool contains(const t_tuple& t, context& h) const {
+        return filter.contains(&t[0], [&]() { return Relation::contains(t, h); });
+    }
+
+    bool contains(const t_tuple& t) const {
+        context h;
+        return contains(t, h);
+    }
+
+    void purge() {
+        Relation::purge();
+        filter.clear();
+    }
+
+    /** Adapts the filter before a query checking the existence of tuples in the relation */
+    void updateFilter() {
+        filter.update(this->size(), [&](const auto& add) {
+            for (const auto& t : *this) {
+                add(&t[0]);
+            }
+        });
+    }
+
+    const TupleFilter& getFilter() const {
+        return filter;
+    }
+
+private:
+    mutable TupleFilter filter{Arity};
+};
+
+}  // end of namespace souffle
@@ -27,6 +27,7 @@
 #pragma once
 
 #include "CompiledTuple.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "Util.h"
 
@@ -34,7 +35,9 @@
 #include <bitset>
 #include <cstring>
 #include <iterator>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #ifdef _WIN32
 /**
@@ -87,6 +90,57 @@ struct default_merge {
     }
 };
 
+/**
+ * A trait determining whether a merge operation can merge arrays of values
+ * at once, i.e., provides an operator()(T* trg, const T* src, std::size_t n).
+ */
+template <typename Op, typename T, typename = void>
+struct has_bulk_merge : std::false_type {};
+
+template <typename Op, typename T>
+struct has_bulk_merge<Op, T,
+        decltype(std::declval<const Op&>()(std::declval<T*>(), std::declval<const T*>(), std::size_t()),
+                void())> : std::true_type {};
+
+/**
+ * Word-level kernels on the bit-masks stored in the leaf nodes of sparse
+ * bit-maps. The loops carry no dependencies between iterations, such that
+ * compilers vectorise them.
+ */
+namespace bitmap {
+
+/** Sets the bits of the n words of src in the n words of trg */
+inline void unite(uint64_t* trg, const uint64_t* src, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        trg[i] |= src[i];
+    }
+}
+
+/** Counts the bits set in the n given words */
+inline std::size_t count(const uint64_t* words, std::size_t n) {
+    // a branch-free population count, which does not depend on a popcount instruction
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        uint64_t x = words[i];
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        res += (x * 0x0101010101010101ULL) >> 56;
+    }
+    return res;
+}
+
+/** Tests whether all bits set in the n words of b are set in the n words of a */
+inline bool includes(const uint64_t* a, const uint64_t* b, std::size_t n) {
+    uint64_t missing = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        missing |= b[i] & ~a[i];
+    }
+    return missing == 0;
+}
+
+}  // end namespace bitmap
+
 }  // end namespace detail
 
 /**
@@ -801,8 +855,12 @@ private:
         // the leaf-node step
         if (levels == 0) {
             merge_op merg;
-            for (int i = 0; i < NUM_CELLS; ++i) {
-                trg->cell[i].value = merg(trg->cell[i].value, src->cell[i].value);
+            if constexpr (detail::has_bulk_merge<merge_op, value_type>::value) {
+                merg(getValues(trg), getValues(src), NUM_CELLS);
+            } else {
+                for (int i = 0; i < NUM_CELLS; ++i) {
+                    trg->cell[i].value = merg(trg->cell[i].value, src->cell[i].value);
+                }
             }
             return;
         }
@@ -813,6 +871,83 @@ private:
         }
     }
 
+    /**
+     * Merges sub-trees like merge, but distributes the merges of disjoint sub-trees
+     * among the available threads. Unless the values are merged in bulk, the values
+     * of the cells of a leaf node, e.g. nested tries, are merged as separate tasks,
+     * such that a tree consisting of a single leaf is merged in parallel as well.
+     * Nested invocations, e.g. merging the nested tries stored in the leaves, are
+     * sequential.
+     */
+    static void mergeParallel(const Node* parent, Node*& trg, const Node* src, int levels) {
+#ifdef IS_PARALLEL
+        constexpr bool bulk = detail::has_bulk_merge<merge_op, value_type>::value;
+        if (trg == nullptr || src == nullptr || (levels == 0 && bulk) || omp_in_parallel() ||
+                MAX_THREADS == 1) {
+            merge(parent, trg, src, levels);
+            return;
+        }
+
+        // split the merge into merges of the sub-trees present on both sides, level by
+        // level, and finally into merges of the cells of leaf nodes, until there are
+        // enough of them to balance the load among the threads
+        struct Task {
+            const Node* parent;
+            Node** trg;
+            const Node* src;
+            int levels;
+            // the cell of the leaf node to be merged, or -1 for the entire sub-tree
+            int cell;
+        };
+        std::vector<Task> tasks = {Task{parent, &trg, src, levels, -1}};
+        auto minTasks = static_cast<std::size_t>(4 * MAX_THREADS);
+        bool split = true;
+        while (tasks.size() < minTasks && split) {
+            split = false;
+            std::vector<Task> next;
+            for (const Task& task : tasks) {
+                if (*task.trg == nullptr || task.cell != -1 || (task.levels == 0 && bulk)) {
+                    next.push_back(task);
+                    continue;
+                }
+                split = true;
+                for (int i = 0; i < NUM_CELLS; ++i) {
+                    if (task.levels == 0) {
+                        if (task.src->cell[i].value != souffle::detail::default_factory<value_type>()()) {
+                            next.push_back(Task{task.parent, task.trg, task.src, 0, i});
+                        }
+                    } else if (task.src->cell[i].ptr != nullptr) {
+                        next.push_back(Task{*task.trg, &(*task.trg)->cell[i].ptr, task.src->cell[i].ptr,
+                                task.levels - 1, -1});
+                    }
+                }
+            }
+            tasks.swap(next);
+        }
+
+        // a single task is not worth a parallel region
+        if (tasks.size() < 2) {
+            merge(parent, trg, src, levels);
+            return;
+        }
+
+        // the sub-trees and cells are disjoint, thus they can be merged concurrently
+        PARALLEL_START;
+        pfor(std::size_t i = 0; i < tasks.size(); i++) {
+            const Task& task = tasks[i];
+            if (task.cell == -1) {
+                merge(task.parent, *task.trg, task.src, task.levels);
+            } else {
+                auto& value = (*task.trg)->cell[task.cell].value;
+                value = merge_op()(value, task.src->cell[task.cell].value);
+            }
+        }
+        PARALLEL_END;
+#else
+        merge(parent, trg, src, levels);
+#endif
+    }
+
 public:
     /**
      * Adds all the values stored in the given array to this array.
@@ -858,7 +993,7 @@ public:
         }
 
         // merge sub-branches from here
-        merge((*node)->parent, *node, other.unsynced.root, level);
+        mergeParallel((*node)->parent, *node, other.unsynced.root, level);
 
         // update first
         if (unsynced.firstOffset > other.unsynced.firstOffset) {
@@ -867,6 +1002,59 @@ public:
         }
     }
 
+    /**
+     * Applies the given operation to each leaf node, i.e., to the index of its first
+     * element, a pointer to its values and the number of values. Only available for
+     * values stored in cells of their own size.
+     */
+    template <typename Op>
+    void forEachLeaf(const Op& op) const {
+        if (unsynced.root) {
+            forEachLeaf(unsynced.root, unsynced.levels, unsynced.offset, op);
+        }
+    }
+
+    /**
+     * Obtains a pointer to the values of the leaf node covering the element
+     * addressed by i, or null if there is no such leaf node.
+     */
+    const value_type* getLeaf(index_type i) const {
+        if (!unsynced.root || !inBoundaries(i)) return nullptr;
+
+        // navigate to the leaf
+        const Node* node = unsynced.root;
+        unsigned level = unsynced.levels;
+        while (level != 0) {
+            node = node->cell[getIndex(i, level)].ptr;
+            if (!node) return nullptr;
+            --level;
+        }
+        return getValues(node);
+    }
+
+    /** The number of values stored in each leaf node */
+    static constexpr int LEAF_SIZE = NUM_CELLS;
+
+private:
+    /**
+     * Applies the given operation to the leaf nodes of the sub-tree rooted by the
+     * given node of the given level covering the elements starting at offset.
+     */
+    template <typename Op>
+    static void forEachLeaf(const Node* node, int level, index_type offset, const Op& op) {
+        if (level == 0) {
+            op(offset, getValues(node), NUM_CELLS);
+            return;
+        }
+        for (int i = 0; i < NUM_CELLS; i++) {
+            if (node->cell[i].ptr) {
+                forEachLeaf(node->cell[i].ptr, level - 1,
+                        offset + (i * (index_type(1) << (level * BIT_PER_STEP))), op);
+            }
+        }
+    }
+
+public:
     // ---------------------------------------------------------------------
     //                           Iterator
     // ---------------------------------------------------------------------
@@ -1217,6 +1405,19 @@ private:
     //                                 Utilities
     // --------------------------------------------------------------------------
 
+    /**
+     * Obtains the values stored in the cells of a leaf node as an array.
+     */
+    static value_type* getValues(Node* node) {
+        static_assert(sizeof(Cell) == sizeof(value_type), "values must fill their cells");
+        return reinterpret_cast<value_type*>(node->cell);
+    }
+
+    static const value_type* getValues(const Node* node) {
+        static_assert(sizeof(Cell) == sizeof(value_type), "values must fill their cells");
+        return reinterpret_cast<const value_type*>(node->cell);
+    }
+
     /**
      * Creates new nodes and initializes them with 0.
      */
@@ -1419,6 +1620,10 @@ class SparseBitMap {
         value_t operator()(value_t a, value_t b) const {
             return a | b;  // merging bit masks => bitwise or operation
         }
+        // merging the bit masks of entire leaf nodes
+        void operator()(value_t* trg, const value_t* src, std::size_t n) const {
+            detail::bitmap::unite(trg, src, n);
+        }
     };
 
     // the type of the internal data store
@@ -1544,9 +1749,23 @@ public:
     std::size_t size() const {
         // this is computed on demand to keep the set operation simple.
         std::size_t res = 0;
-        for (const auto& cur : store) {
-            res += __builtin_popcountll(cur.second);
-        }
+        store.forEachLeaf([&](index_type, const value_t* words, std::size_t n) {
+            res += detail::bitmap::count(words, n);
+        });
+        return res;
+    }
+
+    /**
+     * Determines whether all bits set in other are set in this bit map.
+     */
+    bool containsAll(const SparseBitMap& other) const {
+        bool res = true;
+        other.store.forEachLeaf([&](index_type i, const value_t* words, std::size_t n) {
+            if (!res) return;
+            const value_t* own = store.getLeaf(i);
+            res = (own != nullptr) ? detail::bitmap::includes(own, words, n)
+                                   : detail::bitmap::count(words, n) == 0;
+        });
         return res;
     }
 
@@ -2405,6 +2624,23 @@ public:
         store.addAll(other.store);
     }
 
+    /**
+     * Determines whether all elements stored within the given trie are contained
+     * in this trie.
+     *
+     * @param other the elements to be tested
+     */
+    bool containsAll(const Trie& other) const {
+        op_context ctxt;
+        for (const auto& cur : other.store) {
+            const nested_trie_type* nested = store.lookup(cur.first, ctxt.local);
+            if (nested == nullptr || !nested->containsAll(*cur.second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     /**
      * Obtains an iterator referencing the first element stored within this trie.
      */
@@ -2757,6 +2993,13 @@ public:
         present = present || other.present;
     }
 
+    /**
+     * Determines whether all elements of the given trie are contained in this trie.
+     */
+    bool containsAll(const Trie& other) const {
+        return present || !other.present;
+    }
+
     /**
      * Determines whether the given 0-ary tuple is present within this trie.
      */
@@ -3010,6 +3253,14 @@ public:
         map.addAll(other.map);
     }
 
+    /**
+     * Determines whether all tuples stored within the given trie are contained
+     * in this trie, comparing entire leaf bit-masks at once.
+     */
+    bool containsAll(const Trie& other) const {
+        return map.containsAll(other.map);
+    }
+
     // ---------------------------------------------------------------------
     //                           Iterator
     // ---------------------------------------------------------------------
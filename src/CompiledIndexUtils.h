@@ -137,6 +137,46 @@ struct deref_compare {
     }
 };
 
+// ----- a reference to a tuple carrying a copy of a prefix of its columns ----------
+//         (the elements of keyed indirect indices)
+
+template <typename Tuple, unsigned... Columns>
+struct keyed_ref {
+    /* the values of the key columns of the referenced tuple */
+    RamDomain key[sizeof...(Columns)];
+
+    /* the referenced tuple */
+    const Tuple* ptr;
+
+    keyed_ref() = default;
+    keyed_ref(const Tuple* ptr) : key{(*ptr)[Columns]...}, ptr(ptr) {}
+
+    const Tuple& operator*() const {
+        return *ptr;
+    }
+};
+
+// ----- a comparator of keyed references ----------
+//    (compares the inlined keys first, and only dereferences on ties)
+
+template <typename KeyComp, typename TupleComp>
+struct keyed_compare {
+    template <typename T>
+    int operator()(const T& a, const T& b) const {
+        int res = KeyComp()(a.key, b.key);
+        return (res != 0) ? res : TupleComp()(*a, *b);
+    }
+    template <typename T>
+    bool less(const T& a, const T& b) const {
+        KeyComp comp;
+        return comp.less(a.key, b.key) || (comp.equal(a.key, b.key) && TupleComp().less(*a, *b));
+    }
+    template <typename T>
+    bool equal(const T& a, const T& b) const {
+        return KeyComp().equal(a.key, b.key) && TupleComp().equal(*a, *b);
+    }
+};
+
 // ----- a utility for printing lists of parameters -------
 //    (required for printing descriptions of relations)
 
@@ -68,11 +68,22 @@ protected:
      */
     size_t num_jobs;
 
+    /**
+     * socket of the query server, empty if no server is started
+     */
+    std::string server_socket;
+
+    /**
+     * filename of the sampled folded stacks, empty if no samples are taken
+     */
+    std::string sample_profile_name;
+
 public:
     // all argument constructor
     CmdOptions(const char* s, const char* id, const char* od, bool pe, const char* pfn, size_t nj,
-            size_t si = (size_t)-1)
-            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn), num_jobs(nj) {}
+            size_t si = (size_t)-1, const char* spfn = "")
+            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn), num_jobs(nj),
+              sample_profile_name(spfn) {}
 
     /**
      * get source code name
@@ -116,6 +127,27 @@ public:
         return num_jobs;
     }
 
+    /**
+     * is the query server switched on
+     */
+    bool isServing() const {
+        return !server_socket.empty();
+    }
+
+    /**
+     * get socket path of the query server
+     */
+    const std::string& getServerSocket() const {
+        return server_socket;
+    }
+
+    /**
+     * get filename of the sampled folded stacks
+     */
+    const std::string& getSampleProfileName() const {
+        return sample_profile_name;
+    }
+
     /**
      * Parses the given command line parameters, handles -h help requests or errors
      * and returns whether the parsing was successful or not.
@@ -137,6 +169,7 @@ public:
         // long options
         option longOptions[] = {{"facts", true, nullptr, 'F'}, {"output", true, nullptr, 'D'},
                 {"profile", true, nullptr, 'p'}, {"jobs", true, nullptr, 'j'}, {"index", true, nullptr, 'i'},
+                {"serve", true, nullptr, 'S'}, {"sample-profile", true, nullptr, 's'},
                 // the terminal option -- needs to be null
                 {nullptr, false, nullptr, 0}};
 #pragma GCC diagnostic pop
@@ -145,7 +178,7 @@ public:
         bool ok = true;
 
         int c; /* command-line arguments processing */
-        while ((c = getopt_long(argc, argv, "D:F:hp:j:i:", longOptions, nullptr)) != EOF) {
+        while ((c = getopt_long(argc, argv, "D:F:hp:j:i:S:s:", longOptions, nullptr)) != EOF) {
             switch (c) {
                 /* Fact directories */
                 case 'F':
@@ -188,6 +221,14 @@ public:
                     std::cerr << "\nWarning: OpenMP was not enabled in compilation\n\n";
 #endif
                     break;
+                /* Socket of the query server */
+                case 'S':
+                    server_socket = optarg;
+                    break;
+                /* Folded stacks of the sampling profiler */
+                case 's':
+                    sample_profile_name = optarg;
+                    break;
                 default:
                     printHelpPage(exec_name);
                     return false;
@@ -228,6 +269,9 @@ private:
             std::cerr << "                                    (default: auto)\n";
         }
 #endif
+        std::cerr << "    -S <FILE>, --serve=<FILE>    -- Answer queries on a Unix socket after evaluation\n";
+        std::cerr << "    -s <FILE>, --sample-profile=<FILE>\n";
+        std::cerr << "                                 -- Sample the CPU time of rules into folded stacks\n";
         std::cerr << "    -h                           -- prints this help page.\n";
         std::cerr << "--------------------------------------------------------------------\n";
         std::cout << " Copyright (c) 2016-20 The Souffle Developers." << std::endl;
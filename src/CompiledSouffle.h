@@ -16,19 +16,27 @@
 
 #pragma once
 
+#include "souffle/BloomFilter.h"
 #include "souffle/Brie.h"
 #include "souffle/CompiledIndexUtils.h"
 #include "souffle/CompiledTuple.h"
 #include "souffle/IODirectives.h"
+#include "souffle/HashJoin.h"
+#include "souffle/IOPool.h"
 #include "souffle/IOSystem.h"
+#include "souffle/InsertBuffer.h"
+#include "souffle/LeapfrogJoin.h"
 #include "souffle/ParallelUtils.h"
+#include "souffle/QueryServer.h"
 #include "souffle/RamTypes.h"
 #include "souffle/RecordTable.h"
+#include "souffle/SampleProfiler.h"
 #include "souffle/SignalHandler.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/Table.h"
 #include "souffle/Util.h"
+#include "souffle/WorkStealing.h"
 #include "souffle/WriteStream.h"
 #ifndef __EMBEDDED_SOUFFLE__
 #include "souffle/CompiledOptions.h"
@@ -73,13 +81,14 @@ private:
     std::array<const char*, Arity> tupleType;
     std::array<const char*, Arity> tupleName;
 
+    template <typename Iter = typename RelType::iterator>
     class iterator_wrapper : public iterator_base {
-        typename RelType::iterator it;
+        Iter it;
         const Relation* relation;
         tuple t;
 
     public:
-        iterator_wrapper(uint32_t arg_id, const Relation* rel, const typename RelType::iterator& arg_it)
+        iterator_wrapper(uint32_t arg_id, const Relation* rel, const Iter& arg_it)
                 : iterator_base(arg_id), it(arg_it), relation(rel), t(rel) {}
         void operator++() override {
             ++it;
@@ -107,10 +116,28 @@ public:
             const std::array<const char*, Arity>& n)
             : relation(r), symTable(s), name(std::move(name)), tupleType(t), tupleName(n) {}
     iterator begin() const override {
-        return iterator(new iterator_wrapper(id, this, relation.begin()));
+        return iterator(new iterator_wrapper<>(id, this, relation.begin()));
     }
     iterator end() const override {
-        return iterator(new iterator_wrapper(id, this, relation.end()));
+        return iterator(new iterator_wrapper<>(id, this, relation.end()));
+    }
+    std::pair<iterator, iterator> equalRange(const tuple& pattern, SearchSignature mask) const override {
+        TupleType t;
+        assert(pattern.size() == Arity && "wrong tuple arity");
+        for (size_t i = 0; i < Arity; i++) {
+            t[i] = pattern[i];
+        }
+        std::pair<iterator, iterator> res;
+        // the relation passes the range of its best index, if any index matches the mask
+        bool indexed = relation.equalRange(mask, t, [&](const auto& range) {
+            using Iter = std::decay_t<decltype(range.begin())>;
+            res.first = iterator(new iterator_wrapper<Iter>(id, this, range.begin()));
+            res.second = iterator(new iterator_wrapper<Iter>(id, this, range.end()));
+        });
+        if (!indexed) {
+            return Relation::equalRange(pattern, mask);
+        }
+        return res;
     }
     void insert(const tuple& arg) override {
         TupleType t;
@@ -121,6 +148,26 @@ public:
         }
         relation.insert(t);
     }
+    void insertMany(const RamDomain* rows, std::size_t n) override {
+        // insert directly from the rows, sharing the operation hints
+        auto ctxt = relation.createContext();
+        TupleType t;
+        for (std::size_t row = 0; row < n; row++) {
+            for (size_t i = 0; i < Arity; i++) {
+                t[i] = rows[row * Arity + i];
+            }
+            relation.insert(t, ctxt);
+        }
+    }
+    void exportColumns(RamDomain* const* columns) const override {
+        std::size_t row = 0;
+        for (auto it = relation.begin(); it != relation.end(); ++it) {
+            for (size_t i = 0; i < Arity; i++) {
+                columns[i][row] = (*it)[i];
+            }
+            row++;
+        }
+    }
     bool contains(const tuple& arg) const override {
         TupleType t;
         assert(arg.size() == Arity && "wrong tuple arity");
@@ -222,6 +269,11 @@ public:
     bool contains(const t_tuple& t, context& /* ctxt */) const {
         return data;
     }
+    template <typename Visitor>
+    bool equalRange(SearchSignature /* search */, const t_tuple& /* t */, Visitor visitor) const {
+        visitor(range<iterator>(begin(), end()));
+        return true;
+    }
     std::size_t size() const {
         return data ? 1 : 0;
     }
@@ -307,6 +359,11 @@ public:
     bool contains(const t_tuple& t, context& /* ctxt */) const {
         return contains(t);
     }
+    template <typename Visitor>
+    bool equalRange(SearchSignature /* search */, const t_tuple& /* t */, Visitor /* visitor */) const {
+        // info relations are not indexed
+        return false;
+    }
     std::size_t size() const {
         return data.size();
     }
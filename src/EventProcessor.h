@@ -22,6 +22,7 @@
 #include <cstdarg>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -405,6 +406,46 @@ public:
     }
 } recursiveRelationCopyTimingProcessor;
 
+/**
+ * Hardware Counter Profile Event Processor
+ *
+ * Stores the counters of a timing event next to its runtime; the counters
+ * of loading, saving and copying relations are not stored.
+ */
+const class HardwareCounterProcessor : public EventProcessor {
+public:
+    HardwareCounterProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@hw", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& counter = signature[1];
+        const std::string& timer = signature[2];
+        size_t number = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        if (timer == "@t-nonrecursive-rule") {
+            const std::string& relation = signature[3];
+            const std::string& rule = signature[5];
+            db.addSizeEntry({"program", "relation", relation, "non-recursive-rule", rule, "counters", counter},
+                    number);
+        } else if (timer == "@t-recursive-rule") {
+            const std::string& relation = signature[3];
+            const std::string& version = signature[4];
+            const std::string& rule = signature[6];
+            db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                    version, "counters", counter},
+                    number);
+        } else if (timer == "@t-nonrecursive-relation") {
+            const std::string& relation = signature[3];
+            db.addSizeEntry({"program", "relation", relation, "counters", counter}, number);
+        } else if (timer == "@t-recursive-relation") {
+            const std::string& relation = signature[3];
+            db.addSizeEntry(
+                    {"program", "relation", relation, "iteration", iteration, "counters", counter}, number);
+        }
+    }
+} hardwareCounterProcessor;
+
 /**
  * Recursive Relation Copy Timing Profile Event Processor
  */
@@ -536,6 +577,84 @@ public:
 
 } relationReadsProcessor;
 
+/**
+ * Filter Processor
+ */
+const class RelationFilterSavedProcessor : public EventProcessor {
+public:
+    RelationFilterSavedProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@relation-filter-saved", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        size_t saved = va_arg(args, size_t);
+        db.addSizeEntry({"program", "relation", relation, "filter-saved"}, saved);
+    }
+
+} relationFilterSavedProcessor;
+
+/**
+ * Samples Processor
+ */
+const class RelationSamplesProcessor : public EventProcessor {
+public:
+    RelationSamplesProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@relation-samples", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        size_t samples = va_arg(args, size_t);
+        db.addSizeEntry({"program", "relation", relation, "samples"}, samples);
+    }
+
+} relationSamplesProcessor;
+
+/**
+ * Parallel Load Balance Processor
+ *
+ * Accumulates the busy times of the threads and chunks of the executions of a parallel loop, such that
+ * the ratio of the maximal to the mean busy time gives the imbalance of the loop.
+ */
+const class ParallelBalanceProcessor : public EventProcessor {
+public:
+    ParallelBalanceProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@parallel-balance", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& rule = signature[2];
+        size_t threads = va_arg(args, size_t);
+        size_t busyMax = va_arg(args, size_t);
+        size_t busyTotal = va_arg(args, size_t);
+        size_t chunks = va_arg(args, size_t);
+        size_t chunkMax = va_arg(args, size_t);
+        std::vector<std::string> path = {"program", "relation", relation, "parallel", rule};
+        std::lock_guard<std::mutex> guard(mutex);
+        add(db, path, "executions", 1);
+        add(db, path, "busy-max", busyMax);
+        add(db, path, "busy-mean", busyTotal / threads);
+        add(db, path, "chunks", chunks);
+        add(db, path, "chunk-max", chunkMax);
+        add(db, path, "chunk-mean", busyTotal / chunks);
+    }
+
+private:
+    mutable std::mutex mutex;
+
+    /** add a value to a size entry of the loop */
+    static void add(
+            ProfileDatabase& db, std::vector<std::string> path, const std::string& key, size_t value) {
+        path.push_back(key);
+        if (const auto* entry = dynamic_cast<const SizeEntry*>(db.lookupEntry(path))) {
+            value += entry->getSize();
+        }
+        db.addSizeEntry(path, value);
+    }
+} parallelBalanceProcessor;
+
 /**
  * Config entry processor
  */
@@ -19,6 +19,7 @@
 #include "ExplainProvenanceImpl.h"
 
 #include <csignal>
+#include <fstream>
 #include <iostream>
 #include <regex>
 #include <string>
@@ -95,6 +96,45 @@ public:
             }
             query = parseTuple(command[1]);
             printTree(prov.explain(query.first, query.second, ExplainConfig::getExplainConfig().depthLimit));
+        } else if (command[0] == "explainfile") {
+            if (command.size() != 2) {
+                printError("Usage: explainfile <filename>\n");
+                return true;
+            }
+            // read one tuple per line, either from the file or, for -, from the input up to an empty line
+            std::vector<std::pair<std::string, std::vector<std::string>>> queries;
+            std::ifstream file;
+            if (command[1] != "-") {
+                file.open(command[1]);
+                if (!file.is_open()) {
+                    printError("Cannot open file " + command[1] + "\n");
+                    return true;
+                }
+            }
+            while (true) {
+                std::string line;
+                if (command[1] == "-") {
+                    printPrompt("Enter tuple > ");
+                    line = getInput();
+                    if (line.empty() || line == "q") {
+                        break;
+                    }
+                } else if (!getline(file, line)) {
+                    break;
+                } else if (line.empty()) {
+                    continue;
+                }
+                auto query = parseTuple(line);
+                if (query.first.empty()) {
+                    printError("Usage: explainfile <filename>, with one relation_name(\"<string element1>\", "
+                               "<number element2>, ...) per line\n");
+                    return true;
+                }
+                queries.push_back(query);
+            }
+            for (auto& tree : prov.explainBatch(queries, ExplainConfig::getExplainConfig().depthLimit)) {
+                printTree(std::move(tree));
+            }
         } else if (command[0] == "subproof") {
             std::pair<std::string, std::vector<std::string>> query;
             int label = -1;
@@ -248,6 +288,8 @@ public:
                     "----------\n"
                     "setdepth <depth>: Set a limit for printed derivation tree height\n"
                     "explain <relation>(<element1>, <element2>, ...): Prints derivation tree\n"
+                    "explainfile <filename>: Prints derivation trees for the tuples in a file, one per\n"
+                    "    line; for -, the tuples are read from the input up to an empty line\n"
                     "explainnegation <relation>(<element1>, <element2>, ...): Enters an interactive\n"
                     "    interface where the non-existence of a tuple can be explained\n"
                     "subproof <relation>(<label>): Prints derivation tree for a subproof, label is\n"
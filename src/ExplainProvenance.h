@@ -156,6 +156,15 @@ public:
     virtual std::unique_ptr<TreeNode> explain(
             std::string relName, std::vector<std::string> tuple, size_t depthLimit) = 0;
 
+    /**
+     * Explain a batch of tuples, sharing the evaluation of common subproofs between their proof trees
+     * @param tuples, vector of relation, argument pairs
+     * @param depthLimit, maximal height of each proof tree
+     * */
+    virtual std::vector<std::unique_ptr<TreeNode>> explainBatch(
+            const std::vector<std::pair<std::string, std::vector<std::string>>>& tuples,
+            size_t depthLimit) = 0;
+
     virtual std::unique_ptr<TreeNode> explainSubproof(
             std::string relName, RamDomain label, size_t depthLimit) = 0;
 
@@ -25,6 +25,7 @@
 #include <map>
 #include <memory>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -40,7 +41,7 @@ public:
     }
 
     void setup() override {
-        // for each clause, store a mapping from the head relation name to body relation names
+        // for each clause, store a mapping from the head relation name to the parsed literals of the clause
         for (auto& rel : prog.getAllRelations()) {
             std::string name = rel->getName();
 
@@ -51,22 +52,28 @@ public:
 
             // find all the info tuples
             for (auto& tuple : *rel) {
-                std::vector<std::string> bodyLiterals;
+                RuleInfo ruleInfo;
 
                 RamDomain ruleNum;
                 tuple >> ruleNum;
 
-                for (size_t i = 1; i < rel->getArity() - 1; i++) {
+                // the first literal holds the arguments of the head atom
+                std::string headLit;
+                tuple >> headLit;
+                ruleInfo.headVariables = splitString(headLit, ',');
+
+                for (size_t i = 2; i < rel->getArity() - 1; i++) {
                     std::string bodyLit;
                     tuple >> bodyLit;
-                    bodyLiterals.push_back(bodyLit);
+                    ruleInfo.body.push_back(parseBodyLiteral(bodyLit));
                 }
 
                 std::string rule;
                 tuple >> rule;
 
-                info.insert({std::make_pair(name.substr(0, name.find(".@info")), ruleNum), bodyLiterals});
-                rules.insert({std::make_pair(name.substr(0, name.find(".@info")), ruleNum), rule});
+                auto key = std::make_pair(name.substr(0, name.find(".@info")), ruleNum);
+                info.insert({key, std::move(ruleInfo)});
+                rules.insert({key, rule});
             }
         }
     }
@@ -82,7 +89,8 @@ public:
             return std::make_unique<LeafNode>(relName + "(" + joinedArgsStr + ")");
         }
 
-        assert(info.find(std::make_pair(relName, ruleNum)) != info.end() && "invalid rule for tuple");
+        auto ruleInfo = info.find(std::make_pair(relName, ruleNum));
+        assert(ruleInfo != info.end() && "invalid rule for tuple");
 
         // if depth limit exceeded
         if (depthLimit <= 1) {
@@ -109,102 +117,43 @@ public:
         auto internalNode = std::make_unique<InnerNode>(
                 relName + "(" + joinedArgsStr + ")", "(R" + std::to_string(ruleNum) + ")");
 
-        // make return vector pointer
-        std::vector<RamDomain> ret;
-
-        if (useSublevels) {
-            // add subtree level numbers to tuple
-            for (auto subtreeLevel : subtreeLevels) {
-                tuple.push_back(subtreeLevel);
-            }
-        } else {
-            tuple.push_back(levelNum);
-        }
-
-        // execute subroutine to get subproofs
-        prog.executeSubroutine(relName + "_" + std::to_string(ruleNum) + "_subproof", tuple, ret);
+        // execute subroutine to get subproofs, or reuse the result of an earlier execution
+        const auto& ret = getSubproof(relName, ruleNum, getSubroutineArgs(tuple, levelNum, subtreeLevels));
+        auto bodyTuples = getBodyTuples(ruleInfo->second, ret);
 
         // recursively get nodes for subproofs
-        size_t tupleCurInd = 0;
-        auto bodyRelations = info[std::make_pair(relName, ruleNum)];
-
-        // start from begin + 1 because the first element represents the head atom
-        for (auto it = bodyRelations.begin() + 1; it < bodyRelations.end(); it++) {
-            std::string bodyLiteral = *it;
-            // split bodyLiteral since it contains relation name plus arguments
-            std::string bodyRel = splitString(bodyLiteral, ',')[0];
-
-            // check whether the current atom is a constraint
-            assert(bodyRel.size() > 0 && "body of a relation should have positive length");
-            bool isConstraint = std::find(constraintList.begin(), constraintList.end(),
-                                        splitString(bodyRel, ',')[0]) != constraintList.end();
-
-            // handle negated atom names
-            auto bodyRelAtomName = bodyRel;
-            if (bodyRel[0] == '!') {
-                bodyRelAtomName = bodyRel.substr(1);
-            }
-
-            // traverse subroutine return
-            size_t arity;
-            size_t auxiliaryArity;
-            if (isConstraint) {
-                // we only handle binary constraints, and assume arity is 4 to account for hidden provenance
-                // annotations
-                arity = 4;
-                auxiliaryArity = 2;
-            } else {
-                arity = prog.getRelation(bodyRelAtomName)->getArity();
-                auxiliaryArity = prog.getRelation(bodyRelAtomName)->getAuxiliaryArity();
-            }
-            auto tupleEnd = tupleCurInd + arity;
-
-            // store current tuple
-            std::vector<RamDomain> subproofTuple;
-
-            for (; tupleCurInd < tupleEnd - auxiliaryArity; tupleCurInd++) {
-                subproofTuple.push_back(ret[tupleCurInd]);
-            }
-
-            int subproofRuleNum = ret[tupleCurInd];
-            int subproofLevelNum = ret[tupleCurInd + 1];
-
-            tupleCurInd += 2;
-
-            std::vector<RamDomain> subsubtreeLevels;
-            for (; tupleCurInd < tupleEnd; tupleCurInd++) {
-                subsubtreeLevels.push_back(ret[tupleCurInd]);
-            }
+        for (size_t i = 0; i < bodyTuples.size(); i++) {
+            const BodyLiteral& literal = ruleInfo->second.body[i];
+            const ProvenanceTuple& subproof = bodyTuples[i];
 
             // for a negation, display the corresponding tuple and do not recurse
-            if (bodyRel[0] == '!') {
+            if (literal.isNegation) {
                 std::stringstream joinedTuple;
-                joinedTuple << join(numsToArgs(bodyRelAtomName, subproofTuple), ", ");
+                joinedTuple << join(numsToArgs(literal.relName, subproof.tuple), ", ");
                 auto joinedTupleStr = joinedTuple.str();
-                internalNode->add_child(std::make_unique<LeafNode>(bodyRel + "(" + joinedTupleStr + ")"));
+                internalNode->add_child(
+                        std::make_unique<LeafNode>(literal.name + "(" + joinedTupleStr + ")"));
                 internalNode->setSize(internalNode->getSize() + 1);
                 // for a binary constraint, display the corresponding values and do not recurse
-            } else if (isConstraint) {
+            } else if (literal.isConstraint) {
                 std::stringstream joinedConstraint;
 
-                if (isNumericBinaryConstraintOp(toBinaryConstraintOp(bodyRel))) {
-                    joinedConstraint << subproofTuple[0] << " " << bodyRel << " " << subproofTuple[1];
+                if (isNumericBinaryConstraintOp(toBinaryConstraintOp(literal.name))) {
+                    joinedConstraint << subproof.tuple[0] << " " << literal.name << " " << subproof.tuple[1];
                 } else {
-                    joinedConstraint << bodyRel << "(\"" << symTable.resolve(subproofTuple[0]) << "\", \""
-                                     << symTable.resolve(subproofTuple[1]) << "\")";
+                    joinedConstraint << literal.name << "(\"" << symTable.resolve(subproof.tuple[0])
+                                     << "\", \"" << symTable.resolve(subproof.tuple[1]) << "\")";
                 }
 
                 internalNode->add_child(std::make_unique<LeafNode>(joinedConstraint.str()));
                 internalNode->setSize(internalNode->getSize() + 1);
                 // otherwise, for a normal tuple, recurse
             } else {
-                auto child = explain(bodyRel, subproofTuple, subproofRuleNum, subproofLevelNum,
-                        subsubtreeLevels, depthLimit - 1);
+                auto child = explain(literal.relName, subproof.tuple, subproof.ruleNum, subproof.levelNum,
+                        subproof.subtreeLevels, depthLimit - 1);
                 internalNode->setSize(internalNode->getSize() + child->getSize());
                 internalNode->add_child(std::move(child));
             }
-
-            tupleCurInd = tupleEnd;
         }
 
         return std::move(internalNode);
@@ -212,22 +161,47 @@ public:
 
     std::unique_ptr<TreeNode> explain(
             std::string relName, std::vector<std::string> args, size_t depthLimit) override {
-        auto tuple = argsToNums(relName, args);
-        if (tuple.empty()) {
-            return std::make_unique<LeafNode>("Relation not found");
-        }
-
-        std::tuple<int, int, std::vector<RamDomain>> tupleInfo = findTuple(relName, tuple);
-
-        int ruleNum = std::get<0>(tupleInfo);
-        int levelNum = std::get<1>(tupleInfo);
-        std::vector<RamDomain> subtreeLevels = std::get<2>(tupleInfo);
+        return std::move(explainBatch({std::make_pair(relName, args)}, depthLimit).front());
+    }
 
-        if (ruleNum < 0 || levelNum == -1) {
-            return std::make_unique<LeafNode>("Tuple not found");
+    std::vector<std::unique_ptr<TreeNode>> explainBatch(
+            const std::vector<std::pair<std::string, std::vector<std::string>>>& tuples,
+            size_t depthLimit) override {
+        // locate the queried tuples, scanning each relation once for all of its queries
+        std::vector<ProvenanceTuple> roots(tuples.size());
+        std::map<std::string, std::vector<ProvenanceTuple*>> queries;
+        for (size_t i = 0; i < tuples.size(); i++) {
+            roots[i].relName = tuples[i].first;
+            roots[i].tuple = argsToNums(tuples[i].first, tuples[i].second);
+            if (!roots[i].tuple.empty()) {
+                queries[roots[i].relName].push_back(&roots[i]);
+            }
+        }
+        for (auto& query : queries) {
+            findTuples(query.first, query.second);
         }
 
-        return explain(relName, tuple, ruleNum, levelNum, subtreeLevels, depthLimit);
+        std::vector<ProvenanceTuple> found;
+        for (const auto& root : roots) {
+            if (root.ruleNum >= 0 && root.levelNum != -1) {
+                found.push_back(root);
+            }
+        }
+        prefetchSubproofs(found, depthLimit);
+
+        // build the trees one after the other, so that subproofs are numbered as for single queries
+        std::vector<std::unique_ptr<TreeNode>> trees;
+        for (const auto& root : roots) {
+            if (root.tuple.empty()) {
+                trees.push_back(std::make_unique<LeafNode>("Relation not found"));
+            } else if (root.ruleNum < 0 || root.levelNum == -1) {
+                trees.push_back(std::make_unique<LeafNode>("Tuple not found"));
+            } else {
+                trees.push_back(explain(root.relName, root.tuple, root.ruleNum, root.levelNum,
+                        root.subtreeLevels, depthLimit));
+            }
+        }
+        return trees;
     }
 
     std::unique_ptr<TreeNode> explainSubproof(
@@ -254,6 +228,7 @@ public:
 
         tup.erase(tup.begin() + rel->getArity() - rel->getAuxiliaryArity(), tup.end());
 
+        prefetchSubproofs({ProvenanceTuple{relName, tup, ruleNum, levelNum, subtreeLevels}}, depthLimit);
         return explain(relName, tup, ruleNum, levelNum, subtreeLevels, depthLimit);
     }
 
@@ -270,23 +245,14 @@ public:
         }
 
         // atom meta information stored for the current rule
-        auto atoms = info[std::make_pair(relName, ruleNum)];
+        const RuleInfo& ruleInfo = info[std::make_pair(relName, ruleNum)];
 
-        // the info stores the set of atoms, if there is only 1 atom, then it must be the head, so it must be
-        // a fact
-        if (atoms.size() <= 1) {
+        // if there are no body literals, the rule must be a fact
+        if (ruleInfo.body.empty()) {
             return std::vector<std::string>({"@fact"});
         }
 
-        // atoms[0] represents variables in the head atom
-        auto headVariables = splitString(atoms[0], ',');
-
-        auto isVariable = [&](std::string arg) {
-            if (isNumber(arg.c_str()) || arg[0] == '\"' || arg == "_") {
-                return false;
-            }
-            return true;
-        };
+        const auto& headVariables = ruleInfo.headVariables;
 
         // check that head variable bindings make sense, i.e. for a head like a(x, x), make sure both x are
         // the same value
@@ -307,18 +273,14 @@ public:
 
         // get body variables
         std::vector<std::string> uniqueBodyVariables;
-        for (auto it = atoms.begin() + 1; it < atoms.end(); it++) {
-            auto atomRepresentation = splitString(*it, ',');
-
-            // atomRepresentation.begin() + 1 because the first element is the relation name of the atom
-            // which is not relevant for finding variables
-            for (auto atomIt = atomRepresentation.begin() + 1; atomIt < atomRepresentation.end(); atomIt++) {
-                if (!isVariable(*atomIt)) {
+        for (const auto& literal : ruleInfo.body) {
+            for (const auto& arg : literal.args) {
+                if (!isVariable(arg)) {
                     continue;
                 }
 
-                if (!contains(uniqueBodyVariables, *atomIt) && !contains(headVariables, *atomIt)) {
-                    uniqueBodyVariables.push_back(*atomIt);
+                if (!contains(uniqueBodyVariables, arg) && !contains(headVariables, arg)) {
+                    uniqueBodyVariables.push_back(arg);
                 }
             }
         }
@@ -336,44 +298,31 @@ public:
         std::map<std::string, char> variableTypes;
 
         // atom meta information stored for the current rule
-        auto atoms = info[std::make_pair(relName, ruleNum)];
-
-        // atoms[0] represents variables in the head atom
-        auto headVariables = splitString(atoms[0], ',');
+        const RuleInfo& ruleInfo = info[std::make_pair(relName, ruleNum)];
+        const auto& headVariables = ruleInfo.headVariables;
 
         uniqueVariables.insert(uniqueVariables.end(), headVariables.begin(), headVariables.end());
 
-        auto isVariable = [&](std::string arg) {
-            if (isNumber(arg.c_str()) || arg[0] == '\"' || arg == "_") {
-                return false;
-            }
-            return true;
-        };
-
         // get body variables
-        for (auto it = atoms.begin() + 1; it < atoms.end(); it++) {
-            auto atomRepresentation = splitString(*it, ',');
-
-            // atomRepresentation.begin() + 1 because the first element is the relation name of the atom
-            // which is not relevant for finding variables
-            for (auto atomIt = atomRepresentation.begin() + 1; atomIt < atomRepresentation.end(); atomIt++) {
-                if (!contains(uniqueVariables, *atomIt) && !contains(headVariables, *atomIt)) {
+        for (const auto& literal : ruleInfo.body) {
+            for (size_t i = 0; i < literal.args.size(); i++) {
+                const std::string& arg = literal.args[i];
+                if (!contains(uniqueVariables, arg) && !contains(headVariables, arg)) {
                     // ignore non-variables
-                    if (!isVariable(*atomIt)) {
+                    if (!isVariable(arg)) {
                         continue;
                     }
 
-                    uniqueVariables.push_back(*atomIt);
+                    uniqueVariables.push_back(arg);
 
-                    if (!contains(constraintList, atomRepresentation[0])) {
+                    if (!literal.isConstraint) {
                         // store type of variable
-                        auto currentRel = prog.getRelation(atomRepresentation[0]);
+                        auto currentRel = prog.getRelation(literal.relName);
                         assert(currentRel != nullptr &&
-                                ("relation " + atomRepresentation[0] + " doesn't exist").c_str());
-                        variableTypes[*atomIt] =
-                                *currentRel->getAttrType(atomIt - atomRepresentation.begin() - 1);
-                    } else if (atomIt->find("agg_") != std::string::npos) {
-                        variableTypes[*atomIt] = 'i';
+                                ("relation " + literal.relName + " doesn't exist").c_str());
+                        variableTypes[arg] = *currentRel->getAttrType(i);
+                    } else if (arg.find("agg_") != std::string::npos) {
+                        variableTypes[arg] = 'i';
                     }
                 }
             }
@@ -416,7 +365,7 @@ public:
         prog.executeSubroutine(relName + "_" + std::to_string(ruleNum) + "_negation_subproof", args, ret);
 
         // ensure the subroutine returns the correct number of results
-        assert(ret.size() == atoms.size() - 1);
+        assert(ret.size() == ruleInfo.body.size());
 
         // construct tree nodes
         std::stringstream joinedArgsStr;
@@ -431,7 +380,6 @@ public:
 
         // traverse return vector and construct child nodes
         // making sure we display existent and non-existent tuples correctly
-        int literalCounter = 1;
         for (size_t returnCounter = 0; returnCounter < ret.size(); returnCounter++) {
             // check what the next contained atom is
             bool atomExists = true;
@@ -439,37 +387,26 @@ public:
                 atomExists = false;
             }
 
-            // get the relation of the current atom
-            auto atomRepresentation = splitString(atoms[literalCounter], ',');
-            std::string bodyRel = atomRepresentation[0];
-
-            // check whether the current atom is a constraint
-            bool isConstraint =
-                    std::find(constraintList.begin(), constraintList.end(), bodyRel) != constraintList.end();
-
-            // handle negated atom names
-            auto bodyRelAtomName = bodyRel;
-            if (bodyRel[0] == '!') {
-                bodyRelAtomName = bodyRel.substr(1);
-            }
+            // get the current literal
+            const BodyLiteral& literal = ruleInfo.body[returnCounter];
 
             // construct a label for a node containing a literal (either constraint or atom)
             std::stringstream childLabel;
-            if (isConstraint) {
-                assert(atomRepresentation.size() == 3 && "not a binary constraint");
+            if (literal.isConstraint) {
+                assert(literal.args.size() == 2 && "not a binary constraint");
 
-                childLabel << bodyVariables[atomRepresentation[1]] << " " << bodyRel << " "
-                           << bodyVariables[atomRepresentation[2]];
+                childLabel << bodyVariables[literal.args[0]] << " " << literal.name << " "
+                           << bodyVariables[literal.args[1]];
             } else {
-                childLabel << bodyRel << "(";
-                for (size_t i = 1; i < atomRepresentation.size(); i++) {
+                childLabel << literal.name << "(";
+                for (size_t i = 0; i < literal.args.size(); i++) {
                     // if it's a non-variable, print either _ for unnamed, or constant value
-                    if (!isVariable(atomRepresentation[i])) {
-                        childLabel << atomRepresentation[i];
+                    if (!isVariable(literal.args[i])) {
+                        childLabel << literal.args[i];
                     } else {
-                        childLabel << bodyVariables[atomRepresentation[i]];
+                        childLabel << bodyVariables[literal.args[i]];
                     }
-                    if (i < atomRepresentation.size() - 1) {
+                    if (i < literal.args.size() - 1) {
                         childLabel << ", ";
                     }
                 }
@@ -485,8 +422,6 @@ public:
 
             internalNode->add_child(std::make_unique<LeafNode>(childLabel.str()));
             internalNode->setSize(internalNode->getSize() + 1);
-
-            literalCounter++;
         }
 
         return std::move(internalNode);
@@ -728,12 +663,250 @@ public:
     }
 
 private:
-    std::map<std::pair<std::string, size_t>, std::vector<std::string>> info;
+    /** A literal in the body of a rule, as stored in the info relation of the rule */
+    struct BodyLiteral {
+        /** name of the relation or constraint, prefixed by ! for a negation */
+        std::string name;
+        /** name of the relation or constraint without negation marker */
+        std::string relName;
+        /** arguments of the literal */
+        std::vector<std::string> args;
+        bool isConstraint = false;
+        bool isNegation = false;
+        /** number of values the literal occupies in the return values of a subproof subroutine */
+        size_t arity = 0;
+        size_t auxiliaryArity = 0;
+    };
+
+    /** The literals of a rule, as stored in the info relation of the rule */
+    struct RuleInfo {
+        /** arguments of the head atom */
+        std::vector<std::string> headVariables;
+        std::vector<BodyLiteral> body;
+    };
+
+    /** A tuple together with its provenance annotations */
+    struct ProvenanceTuple {
+        std::string relName;
+        std::vector<RamDomain> tuple;
+        RamDomain ruleNum = -1;
+        RamDomain levelNum = -1;
+        std::vector<RamDomain> subtreeLevels;
+    };
+
+    std::map<std::pair<std::string, size_t>, RuleInfo> info;
     std::map<std::pair<std::string, size_t>, std::string> rules;
     std::vector<std::vector<RamDomain>> subproofs;
     std::vector<std::string> constraintList = {
             "=", "!=", "<", "<=", ">=", ">", "match", "contains", "not_match", "not_contains"};
 
+    /** Return values of the subproof subroutines executed so far, by subroutine name and arguments */
+    std::map<std::pair<std::string, std::vector<RamDomain>>, std::vector<RamDomain>> subproofCache;
+
+    static bool isVariable(const std::string& arg) {
+        return !(isNumber(arg.c_str()) || arg[0] == '\"' || arg == "_");
+    }
+
+    /** Parse the description of a body literal, i.e., its name followed by its comma separated arguments */
+    BodyLiteral parseBodyLiteral(const std::string& description) const {
+        BodyLiteral literal;
+        auto representation = splitString(description, ',');
+        assert(representation[0].size() > 0 && "body literal should have a name");
+
+        literal.name = representation[0];
+        literal.args.assign(representation.begin() + 1, representation.end());
+        literal.isConstraint = contains(constraintList, literal.name);
+        literal.isNegation = !literal.isConstraint && literal.name[0] == '!';
+        literal.relName = literal.isNegation ? literal.name.substr(1) : literal.name;
+
+        if (literal.isConstraint) {
+            // we only handle binary constraints, and assume arity is 4 to account for hidden provenance
+            // annotations
+            literal.arity = 4;
+            literal.auxiliaryArity = 2;
+        } else if (auto rel = prog.getRelation(literal.relName)) {
+            literal.arity = rel->getArity();
+            literal.auxiliaryArity = rel->getAuxiliaryArity();
+        }
+        return literal;
+    }
+
+    /** Build the arguments of the subproof subroutine for a tuple */
+    std::vector<RamDomain> getSubroutineArgs(std::vector<RamDomain> tuple, RamDomain levelNum,
+            const std::vector<RamDomain>& subtreeLevels) const {
+        if (useSublevels) {
+            // add subtree level numbers to tuple
+            tuple.insert(tuple.end(), subtreeLevels.begin(), subtreeLevels.end());
+        } else {
+            tuple.push_back(levelNum);
+        }
+        return tuple;
+    }
+
+    /** Return the result of the subproof subroutine of a rule, executing it if it is not cached yet */
+    const std::vector<RamDomain>& getSubproof(
+            const std::string& relName, RamDomain ruleNum, std::vector<RamDomain> args) {
+        auto key = std::make_pair(relName + "_" + std::to_string(ruleNum) + "_subproof", std::move(args));
+        auto cached = subproofCache.find(key);
+        if (cached != subproofCache.end()) {
+            return cached->second;
+        }
+        std::vector<RamDomain> ret;
+        prog.executeSubroutine(key.first, key.second, ret);
+        return subproofCache.emplace(std::move(key), std::move(ret)).first->second;
+    }
+
+    /** Split the return values of a subproof subroutine into the annotated tuples of the body literals */
+    std::vector<ProvenanceTuple> getBodyTuples(const RuleInfo& ruleInfo, const std::vector<RamDomain>& ret) {
+        std::vector<ProvenanceTuple> bodyTuples;
+        size_t tupleCurInd = 0;
+        for (const auto& literal : ruleInfo.body) {
+            assert(literal.arity > 0 && "relation of body literal does not exist");
+            auto tupleEnd = tupleCurInd + literal.arity;
+            assert(tupleEnd <= ret.size() && "subroutine returned too few values");
+
+            ProvenanceTuple bodyTuple;
+            bodyTuple.relName = literal.relName;
+            for (; tupleCurInd < tupleEnd - literal.auxiliaryArity; tupleCurInd++) {
+                bodyTuple.tuple.push_back(ret[tupleCurInd]);
+            }
+
+            bodyTuple.ruleNum = ret[tupleCurInd];
+            bodyTuple.levelNum = ret[tupleCurInd + 1];
+            tupleCurInd += 2;
+
+            for (; tupleCurInd < tupleEnd; tupleCurInd++) {
+                bodyTuple.subtreeLevels.push_back(ret[tupleCurInd]);
+            }
+
+            bodyTuples.push_back(std::move(bodyTuple));
+        }
+        return bodyTuples;
+    }
+
+    /**
+     * Execute the subproof subroutines needed to explain the given tuples up to the depth limit.
+     * The proof trees are expanded level by level, executing each subroutine once per level for the
+     * arguments of all tuples in the frontier that have not been explained before.
+     */
+    void prefetchSubproofs(std::vector<ProvenanceTuple> frontier, size_t depthLimit) {
+        // facts have no subproofs
+        frontier.erase(std::remove_if(frontier.begin(), frontier.end(),
+                               [&](const ProvenanceTuple& cur) {
+                                   return cur.levelNum == 0 ||
+                                          info.find(std::make_pair(cur.relName, cur.ruleNum)) == info.end();
+                               }),
+                frontier.end());
+
+        for (size_t depth = depthLimit; depth > 1 && !frontier.empty(); depth--) {
+            // collect the arguments of the pending subroutine calls
+            std::map<std::string, std::set<std::vector<RamDomain>>> calls;
+            for (const auto& cur : frontier) {
+                auto args = getSubroutineArgs(cur.tuple, cur.levelNum, cur.subtreeLevels);
+                auto name = cur.relName + "_" + std::to_string(cur.ruleNum) + "_subproof";
+                if (subproofCache.find(std::make_pair(name, args)) == subproofCache.end()) {
+                    calls[name].insert(std::move(args));
+                }
+            }
+
+            // execute each subroutine for the whole frontier at once
+            for (auto& call : calls) {
+                std::vector<std::vector<RamDomain>> args(call.second.begin(), call.second.end());
+                std::vector<std::vector<RamDomain>> rets;
+                prog.executeSubroutineBatch(call.first, args, rets);
+                for (size_t i = 0; i < args.size(); i++) {
+                    subproofCache.emplace(std::make_pair(call.first, std::move(args[i])), std::move(rets[i]));
+                }
+            }
+
+            // the next frontier consists of the derived tuples in the bodies of the current one
+            std::vector<ProvenanceTuple> next;
+            std::set<std::pair<std::string, std::vector<RamDomain>>> visited;
+            for (const auto& cur : frontier) {
+                auto args = getSubroutineArgs(cur.tuple, cur.levelNum, cur.subtreeLevels);
+                const auto& ret = getSubproof(cur.relName, cur.ruleNum, std::move(args));
+                const RuleInfo& ruleInfo = info[std::make_pair(cur.relName, cur.ruleNum)];
+                auto bodyTuples = getBodyTuples(ruleInfo, ret);
+                for (size_t i = 0; i < bodyTuples.size(); i++) {
+                    const BodyLiteral& literal = ruleInfo.body[i];
+                    auto& bodyTuple = bodyTuples[i];
+                    if (literal.isConstraint || literal.isNegation || bodyTuple.levelNum == 0) {
+                        continue;
+                    }
+                    if (info.find(std::make_pair(bodyTuple.relName, bodyTuple.ruleNum)) == info.end()) {
+                        continue;
+                    }
+                    if (visited.insert(std::make_pair(bodyTuple.relName, bodyTuple.tuple)).second) {
+                        next.push_back(std::move(bodyTuple));
+                    }
+                }
+            }
+            frontier = std::move(next);
+        }
+    }
+
+    /**
+     * Find the annotations of the given tuples of a relation in a single scan of the relation.
+     * The annotations of tuples that do not exist are left unset.
+     */
+    void findTuples(const std::string& relName, const std::vector<ProvenanceTuple*>& queries) {
+        auto rel = prog.getRelation(relName);
+
+        if (rel == nullptr) {
+            return;
+        }
+
+        std::map<std::vector<RamDomain>, std::vector<ProvenanceTuple*>> pending;
+        for (auto query : queries) {
+            pending[query->tuple].push_back(query);
+        }
+
+        for (auto& tuple : *rel) {
+            if (pending.empty()) {
+                break;
+            }
+
+            std::vector<RamDomain> currentTuple;
+            for (size_t i = 0; i < rel->getArity() - rel->getAuxiliaryArity(); i++) {
+                RamDomain n;
+                if (*rel->getAttrType(i) == 's') {
+                    std::string s;
+                    tuple >> s;
+                    n = symTable.lookupExisting(s);
+                } else {
+                    tuple >> n;
+                }
+                currentTuple.push_back(n);
+            }
+
+            auto match = pending.find(currentTuple);
+            if (match == pending.end()) {
+                continue;
+            }
+
+            RamDomain ruleNum;
+            tuple >> ruleNum;
+
+            RamDomain levelNum;
+            tuple >> levelNum;
+
+            std::vector<RamDomain> subtreeLevels;
+
+            for (size_t i = rel->getArity() - rel->getAuxiliaryArity() + 2; i < rel->getArity(); i++) {
+                RamDomain subLevel;
+                tuple >> subLevel;
+                subtreeLevels.push_back(subLevel);
+            }
+
+            for (auto query : match->second) {
+                query->ruleNum = ruleNum;
+                query->levelNum = levelNum;
+                query->subtreeLevels = subtreeLevels;
+            }
+            pending.erase(match);
+        }
+    }
+
     std::tuple<int, int, std::vector<RamDomain>> findTuple(
             const std::string& relName, std::vector<RamDomain> tup) {
         auto rel = prog.getRelation(relName);
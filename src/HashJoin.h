@@ -0,0 +1,185 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashJoin.h
+ *
+ * The build side of hash joins, shared by the interpreter and the
+ * synthesised code.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include "Util.h"
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A hash table holding a copy of the tuples of a relation, keyed by a subset
+ * of its columns. The table is built once before a join is evaluated and
+ * dropped afterwards, so that a relation does not have to maintain an index
+ * for a join that is executed only once.
+ *
+ * The table is split into partitions by the hash of the key, each partition
+ * guarded by its own lock, such that tuples can be inserted concurrently.
+ * Once built, the table is read-only and can be probed concurrently.
+ */
+class HashJoinTable {
+    using bucket_iterator = std::unordered_multimap<std::size_t, std::size_t>::const_iterator;
+
+    /** A partition of the table */
+    struct Partition {
+        /** Lock guarding insertions */
+        SpinLock lock;
+
+        /** Tuples of the partition, stored consecutively */
+        std::vector<RamDomain> data;
+
+        /** Maps the hash of a key to the offset of its tuples in data */
+        std::unordered_multimap<std::size_t, std::size_t> buckets;
+    };
+
+public:
+    /**
+     * Iterates over the tuples matching the key of a probe
+     */
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = const RamDomain*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        iterator() = default;
+
+        iterator(const HashJoinTable* table, const Partition* partition, bucket_iterator cur,
+                bucket_iterator end, const RamDomain* key)
+                : table(table), partition(partition), cur(cur), end(end), key(key) {
+            skip();
+        }
+
+        bool operator==(const iterator& other) const {
+            return cur == other.cur;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const RamDomain* operator*() const {
+            return &partition->data[cur->second];
+        }
+
+        iterator& operator++() {
+            ++cur;
+            skip();
+            return *this;
+        }
+
+    private:
+        /** skip tuples whose key collides with the probe but does not match */
+        void skip() {
+            while (cur != end && !table->matches(&partition->data[cur->second], key)) {
+                ++cur;
+            }
+        }
+
+        const HashJoinTable* table = nullptr;
+        const Partition* partition = nullptr;
+        bucket_iterator cur;
+        bucket_iterator end;
+        const RamDomain* key = nullptr;
+    };
+
+    /**
+     * Creates an empty table
+     *
+     * @param arity the arity of the tuples
+     * @param keyColumns the columns forming the key of the join
+     * @param numPartitions the number of independently locked partitions
+     */
+    HashJoinTable(std::size_t arity, std::vector<std::size_t> keyColumns, std::size_t numPartitions = 64)
+            : arity(arity), keyColumns(std::move(keyColumns)), partitions(numPartitions) {}
+
+    /**
+     * Inserts a tuple; may be called concurrently
+     */
+    void insert(const RamDomain* tuple) {
+        std::size_t h = hash(tuple);
+        Partition& partition = partitions[h % partitions.size()];
+        partition.lock.lock();
+        partition.buckets.emplace(h, partition.data.size());
+        partition.data.insert(partition.data.end(), tuple, tuple + arity);
+        partition.lock.unlock();
+    }
+
+    /**
+     * Obtains the tuples agreeing with the given tuple on the key columns;
+     * the other columns of the given tuple are ignored.
+     */
+    range<iterator> probe(const RamDomain* key) const {
+        std::size_t h = hash(key);
+        const Partition& partition = partitions[h % partitions.size()];
+        auto bucket = partition.buckets.equal_range(h);
+        return make_range(iterator(this, &partition, bucket.first, bucket.second, key),
+                iterator(this, &partition, bucket.second, bucket.second, key));
+    }
+
+    /**
+     * Obtains the number of tuples in the table
+     */
+    std::size_t size() const {
+        std::size_t res = 0;
+        for (const auto& partition : partitions) {
+            res += partition.buckets.size();
+        }
+        return res;
+    }
+
+private:
+    /** hash of the key columns of a tuple */
+    std::size_t hash(const RamDomain* tuple) const {
+        std::size_t res = 0;
+        for (std::size_t column : keyColumns) {
+            res ^= std::hash<RamDomain>()(tuple[column]) + 0x9e3779b9 + (res << 6) + (res >> 2);
+        }
+        return res;
+    }
+
+    /** check whether two tuples agree on the key columns */
+    bool matches(const RamDomain* a, const RamDomain* b) const {
+        for (std::size_t column : keyColumns) {
+            if (a[column] != b[column]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Arity of the tuples */
+    const std::size_t arity;
+
+    /** Key columns of the join */
+    const std::vector<std::size_t> keyColumns;
+
+    /** Partitions of the table */
+    std::vector<Partition> partitions;
+};
+
+}  // end of namespace souffle
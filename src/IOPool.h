@@ -0,0 +1,268 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file IOPool.h
+ *
+ * A pool of background threads performing the input and output of
+ * relations, shared by the interpreter and the synthesised code.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace souffle {
+
+/**
+ * Executes IO tasks, i.e., the loading or storing of a relation, on
+ * background threads such that they overlap with each other and with
+ * the evaluation.
+ *
+ * Each task is associated with a key identifying the relation it reads
+ * or writes. Before a relation is modified again (e.g. cleared), the
+ * caller has to wait for the pending tasks of its key.
+ *
+ * Worker threads are started on demand, up to the given maximum; a pool
+ * without workers executes tasks immediately on the submitting thread.
+ *
+ * A task may contain ordered steps, which are executed only after the
+ * ordered steps of all tasks submitted before it, e.g. to add symbols to
+ * the symbol table in the same order as a sequential evaluation would.
+ *
+ * An exception thrown by a task is not raised on the worker thread but
+ * rethrown by the next call of wait() or join(), i.e., on the thread
+ * driving the evaluation.
+ */
+class IOPool {
+public:
+    explicit IOPool(std::size_t maxWorkers) : maxWorkers(maxWorkers) {}
+
+    IOPool(const IOPool&) = delete;
+    IOPool& operator=(const IOPool&) = delete;
+
+    ~IOPool() {
+        {
+            // an error not reported by now is dropped, destructors must not throw
+            std::unique_lock<std::mutex> lock(mutex);
+            taskDone.wait(lock, [&]() { return pending.empty(); });
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stopping = true;
+        }
+        taskAvailable.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * Submits a task operating on the relation identified by the given key
+     */
+    void submit(const void* key, std::function<void()> task) {
+        if (maxWorkers == 0) {
+            task();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            tasks.emplace_back(key, nextTicket++, std::move(task));
+            pending[key]++;
+            if (idle == 0 && workers.size() < maxWorkers) {
+                workers.emplace_back([this]() { work(); });
+            }
+        }
+        taskAvailable.notify_one();
+    }
+
+    /**
+     * Waits until all tasks of the given key have been completed, and
+     * rethrows the exception of a failed task, if any
+     */
+    void wait(const void* key) {
+        std::unique_lock<std::mutex> lock(mutex);
+        taskDone.wait(lock, [&]() { return pending.find(key) == pending.end(); });
+        rethrowError();
+    }
+
+    /**
+     * Waits until all submitted tasks have been completed, and rethrows
+     * the exception of a failed task, if any
+     */
+    void join() {
+        std::unique_lock<std::mutex> lock(mutex);
+        taskDone.wait(lock, [&]() { return pending.empty(); });
+        rethrowError();
+    }
+
+    /**
+     * Executes an ordered step of the task running on the calling thread,
+     * once the tasks submitted before it have executed their last ordered
+     * steps or have been completed. The last step of a task lets the
+     * following tasks proceed; outside of the tasks of a pool with workers,
+     * steps are executed immediately.
+     */
+    static void ordered(const std::function<void()>& step, bool last = true) {
+        RunningTask& running = runningTask();
+        if (running.pool == nullptr) {
+            step();
+            return;
+        }
+        assert(!running.released && "task has an ordered step after its last one");
+        IOPool& pool = *running.pool;
+        {
+            std::unique_lock<std::mutex> lock(pool.mutex);
+            pool.taskDone.wait(lock, [&]() { return pool.nextOrdered == running.ticket; });
+        }
+        step();
+        if (last) {
+            std::lock_guard<std::mutex> guard(pool.mutex);
+            pool.release(running);
+        }
+    }
+
+private:
+    /** The task running on a worker thread */
+    struct RunningTask {
+        IOPool* pool = nullptr;
+        std::size_t ticket = 0;
+        bool released = false;
+    };
+
+    static RunningTask& runningTask() {
+        static thread_local RunningTask running;
+        return running;
+    }
+
+    /** Rethrows and clears the exception of a failed task; the mutex must be held */
+    void rethrowError() {
+        if (error) {
+            std::exception_ptr res = error;
+            error = nullptr;
+            std::rethrow_exception(res);
+        }
+    }
+
+    /** Lets the following tasks execute their ordered steps; the mutex must be held */
+    void release(RunningTask& running) {
+        if (running.released) {
+            return;
+        }
+        running.released = true;
+        releasedTickets.insert(running.ticket);
+        while (!releasedTickets.empty() && *releasedTickets.begin() == nextOrdered) {
+            releasedTickets.erase(releasedTickets.begin());
+            nextOrdered++;
+        }
+        taskDone.notify_all();
+    }
+
+    /** main loop of a worker thread */
+    void work() {
+#ifdef _OPENMP
+        // the workers run alongside each other and the evaluation, which already
+        // occupies all threads; parallel regions in tasks thus use a single thread
+        omp_set_num_threads(1);
+#endif
+        RunningTask& running = runningTask();
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            idle++;
+            taskAvailable.wait(lock, [&]() { return stopping || !tasks.empty(); });
+            idle--;
+            if (tasks.empty()) {
+                return;
+            }
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            running.pool = this;
+            running.ticket = std::get<1>(task);
+            running.released = false;
+
+            lock.unlock();
+            std::exception_ptr failure;
+            try {
+                std::get<2>(task)();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            lock.lock();
+
+            if (failure && !error) {
+                error = failure;
+            }
+
+            release(running);
+            running.pool = nullptr;
+            if (--pending[std::get<0>(task)] == 0) {
+                pending.erase(std::get<0>(task));
+            }
+            taskDone.notify_all();
+        }
+    }
+
+    /** Maximal number of worker threads */
+    const std::size_t maxWorkers;
+
+    /** Guards the state of the pool */
+    std::mutex mutex;
+
+    /** Signalled when a task is submitted or the pool is shut down */
+    std::condition_variable taskAvailable;
+
+    /** Signalled when a task has been completed */
+    std::condition_variable taskDone;
+
+    /** Tasks waiting for a worker, with their keys and tickets in submission order */
+    std::deque<std::tuple<const void*, std::size_t, std::function<void()>>> tasks;
+
+    /** Ticket of the next submitted task */
+    std::size_t nextTicket = 0;
+
+    /** Ticket of the task whose ordered step is executed next */
+    std::size_t nextOrdered = 0;
+
+    /** Released tickets following a task that has not been released yet */
+    std::set<std::size_t> releasedTickets;
+
+    /** The first exception thrown by a task and not rethrown yet */
+    std::exception_ptr error;
+
+    /** Number of submitted but not completed tasks per key */
+    std::map<const void*, std::size_t> pending;
+
+    /** Worker threads */
+    std::vector<std::thread> workers;
+
+    /** Number of workers waiting for a task */
+    std::size_t idle = 0;
+
+    /** Set when the pool is destroyed */
+    bool stopping = false;
+};
+
+}  // end of namespace souffle
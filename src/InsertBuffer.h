@@ -0,0 +1,198 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file InsertBuffer.h
+ *
+ * Thread-local buffers collecting the tuples inserted by a parallel loop,
+ * shared by the interpreter and the synthesised code.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Collects the tuples inserted into a relation by the threads of a parallel
+ * loop, such that the threads do not compete for the locks of the relation.
+ * Each thread appends to its own unsorted buffer. Once the loop has been
+ * completed, the buffers are sorted and deduplicated in parallel, and merged
+ * into the relation by parallel tasks inserting disjoint ranges of tuples.
+ * A thread whose buffer is full inserts the tuples of its buffer into the
+ * relation itself, such that the buffers do not grow with the result.
+ *
+ * This is only sound if the relation is not read by the loop.
+ */
+class InsertBuffer {
+    /** The buffer of a thread, aligned to avoid false sharing */
+    struct alignas(64) Local {
+        /** Tuples of the buffer, stored consecutively */
+        std::vector<RamDomain> tuples;
+    };
+
+public:
+    /** Minimal number of tuples inserted by a merge task */
+    static constexpr std::size_t MIN_TASK_SIZE = 4096;
+
+    /** Number of merge tasks per thread, balancing ranges of different costs */
+    static constexpr std::size_t TASKS_PER_THREAD = 4;
+
+    /** Number of samples per merge task from which the ranges of the tasks are chosen */
+    static constexpr std::size_t SAMPLES_PER_TASK = 16;
+
+    /** Number of tuples of the buffer of a thread at which it is flushed */
+    static constexpr std::size_t MAX_LOCAL_SIZE = 1 << 16;
+
+    explicit InsertBuffer(std::size_t arity) : arity(arity), locals(MAX_THREADS) {
+        assert(arity > 0 && "nullary relations are not buffered");
+    }
+
+    /**
+     * Appends a tuple to the buffer of the calling thread, regardless of its size
+     */
+    void insert(const RamDomain* tuple) {
+        assert(static_cast<std::size_t>(THREAD_ID) < locals.size() && "more threads than buffers");
+        auto& tuples = locals[THREAD_ID].tuples;
+        tuples.insert(tuples.end(), tuple, tuple + arity);
+    }
+
+    /**
+     * Appends a tuple to the buffer of the calling thread; once the buffer
+     * holds MAX_LOCAL_SIZE tuples, they are inserted into the relation by the
+     * given function in order, without duplicates, and the buffer is emptied.
+     */
+    template <typename Insert>
+    void insert(const RamDomain* tuple, Insert flush) {
+        insert(tuple);
+        auto& tuples = locals[THREAD_ID].tuples;
+        if (tuples.size() < MAX_LOCAL_SIZE * arity) {
+            return;
+        }
+        std::vector<const RamDomain*> order;
+        order.reserve(MAX_LOCAL_SIZE);
+        for (std::size_t pos = 0; pos < tuples.size(); pos += arity) {
+            order.push_back(&tuples[pos]);
+        }
+        std::sort(order.begin(), order.end(), [&](const RamDomain* a, const RamDomain* b) {
+            return std::lexicographical_compare(a, a + arity, b, b + arity);
+        });
+        const RamDomain* last = nullptr;
+        for (const RamDomain* cur : order) {
+            if (last == nullptr || !std::equal(cur, cur + arity, last)) {
+                flush(cur);
+            }
+            last = cur;
+        }
+        tuples.clear();
+    }
+
+    /**
+     * Inserts the buffered tuples, without duplicates, into a relation and
+     * empties the buffers. Each merge task obtains a function inserting a
+     * tuple into the relation from createInsert, e.g., with its own operation
+     * hints, and inserts the tuples of a range in order. The ranges of the
+     * tasks are disjoint, such that they rarely touch the same nodes of the
+     * indexes. Unless parallel is set, a single task inserts all tuples, e.g.,
+     * for relations whose insertions read the relation.
+     */
+    template <typename CreateInsert>
+    void merge(CreateInsert createInsert, bool parallel = true) {
+        auto less = [&](const RamDomain* a, const RamDomain* b) {
+            return std::lexicographical_compare(a, a + arity, b, b + arity);
+        };
+        auto equal = [&](const RamDomain* a, const RamDomain* b) { return std::equal(a, a + arity, b); };
+
+        // sort the buffers of the threads in parallel
+        std::vector<std::vector<const RamDomain*>> sorted(locals.size());
+        PARALLEL_START
+            ;
+            pfor(std::size_t i = 0; i < locals.size(); i++) {
+                const auto& tuples = locals[i].tuples;
+                auto& order = sorted[i];
+                order.reserve(tuples.size() / arity);
+                for (std::size_t pos = 0; pos < tuples.size(); pos += arity) {
+                    order.push_back(&tuples[pos]);
+                }
+                std::sort(order.begin(), order.end(), less);
+                order.erase(std::unique(order.begin(), order.end(), equal), order.end());
+            }
+        PARALLEL_END;
+
+        // split the tuples at splitters sampled from the sorted buffers
+        std::size_t total = 0;
+        for (const auto& order : sorted) {
+            total += order.size();
+        }
+        std::size_t numTasks = 1;
+        if (parallel) {
+            numTasks = std::max<std::size_t>(
+                    1, std::min<std::size_t>(total / MIN_TASK_SIZE, TASKS_PER_THREAD * MAX_THREADS));
+        }
+        std::vector<const RamDomain*> splitters;
+        if (numTasks > 1) {
+            std::size_t step = std::max<std::size_t>(1, total / (numTasks * SAMPLES_PER_TASK));
+            std::vector<const RamDomain*> samples;
+            for (const auto& order : sorted) {
+                for (std::size_t pos = 0; pos < order.size(); pos += step) {
+                    samples.push_back(order[pos]);
+                }
+            }
+            std::sort(samples.begin(), samples.end(), less);
+            for (std::size_t task = 1; task < numTasks; task++) {
+                splitters.push_back(samples[task * samples.size() / numTasks]);
+            }
+            splitters.erase(std::unique(splitters.begin(), splitters.end(), equal), splitters.end());
+        }
+        numTasks = splitters.size() + 1;
+
+        // merge the ranges of the sorted buffers between consecutive splitters into the relation
+        PARALLEL_START
+            ;
+            pfor(std::size_t task = 0; task < numTasks; task++) {
+                auto insert = createInsert();
+                std::vector<const RamDomain*> range;
+                for (const auto& order : sorted) {
+                    auto begin = (task == 0) ? order.begin()
+                                             : std::lower_bound(order.begin(), order.end(),
+                                                       splitters[task - 1], less);
+                    auto end = (task + 1 == numTasks)
+                                       ? order.end()
+                                       : std::lower_bound(begin, order.end(), splitters[task], less);
+                    auto mid = range.insert(range.end(), begin, end);
+                    std::inplace_merge(range.begin(), mid, range.end(), less);
+                }
+                range.erase(std::unique(range.begin(), range.end(), equal), range.end());
+                for (const RamDomain* tuple : range) {
+                    insert(tuple);
+                }
+            }
+        PARALLEL_END;
+
+        for (auto& local : locals) {
+            local.tuples.clear();
+        }
+    }
+
+private:
+    /** Arity of the tuples */
+    const std::size_t arity;
+
+    /** Buffers of the threads */
+    std::vector<Local> locals;
+};
+
+}  // end of namespace souffle
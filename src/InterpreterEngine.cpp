@@ -14,16 +14,23 @@
  ***********************************************************************/
 
 #include "InterpreterEngine.h"
+#include "HashJoin.h"
 #include "IOSystem.h"
 #include "InterpreterGenerator.h"
+#include "LeapfrogJoin.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "RamTypes.h"
 #include "RecordTable.h"
+#include "SampleProfiler.h"
 #include "SignalHandler.h"
+#include <algorithm>
 #include <cassert>
 #include <csignal>
+#include <fstream>
 #include <regex>
 #include <ffi.h>
+#include <unistd.h>
 
 namespace souffle {
 
@@ -37,6 +44,20 @@ void InterpreterEngine::swapRelation(const size_t ramRel1, const size_t ramRel2)
     std::swap(rel1, rel2);
 }
 
+void InterpreterEngine::storeRelation(const RamStore& store, const InterpreterRelation& rel) {
+    std::vector<RamTypeAttribute> symbolMask;
+    for (auto& cur : store.getRelation().getAttributeTypes()) {
+        symbolMask.push_back(RamPrimitiveFromChar(cur[0]));
+    }
+    // errors are raised on the thread waiting for the pool rather than on the thread writing
+    for (IODirectives ioDirectives : store.getIODirectives()) {
+        IOSystem::getInstance()
+                .getWriter(
+                        symbolMask, getSymbolTable(), ioDirectives, store.getRelation().getAuxiliaryArity())
+                ->writeAll(rel);
+    }
+}
+
 int InterpreterEngine::incCounter() {
     return counter++;
 }
@@ -68,6 +89,52 @@ std::vector<std::unique_ptr<InterpreterEngine::RelationHandle>>& InterpreterEngi
     return generator.getRelations();
 }
 
+namespace {
+/** Return the size of the anonymous memory of this process, excluding mapped files, or 0 if unknown */
+size_t getAnonymousMemory() {
+    std::ifstream statm("/proc/self/statm");
+    size_t total = 0;
+    size_t resident = 0;
+    size_t shared = 0;
+    if (!(statm >> total >> resident >> shared)) {
+        return 0;
+    }
+    return (resident - shared) * sysconf(_SC_PAGESIZE);
+}
+}  // namespace
+
+void InterpreterEngine::enforceMemoryBudget() {
+    if (memoryBudget == 0) {
+        return;
+    }
+    size_t usage = getAnonymousMemory();
+    if (usage <= std::max(memoryBudget, spillThreshold)) {
+        return;
+    }
+    InterpreterRelation* largest = nullptr;
+    size_t largestSize = 0;
+    for (auto& handle : getRelationMap()) {
+        if (handle == nullptr || !(*handle)->canSpill()) {
+            continue;
+        }
+        size_t size = (*handle)->size() * (*handle)->getArity();
+        if (size > largestSize) {
+            largest = handle->get();
+            largestSize = size;
+        }
+    }
+    if (largest == nullptr) {
+        // nothing left to move, stop checking
+        memoryBudget = 0;
+        return;
+    }
+    ioPool.wait(largest);
+    largest->spill();
+    // freed memory is not necessarily returned to the system, so only move the next relation once
+    // the usage has grown noticeably
+    spillThreshold = usage + memoryBudget / 16;
+}
+
 const std::vector<void*>& InterpreterEngine::loadDLL() {
     if (!dll.empty()) {
         return dll;
@@ -127,6 +194,10 @@ void InterpreterEngine::executeMain() {
     if (Global::config().has("verbose")) {
         SignalHandler::instance()->enableLogging();
     }
+    if (Global::config().has("sample-profile")) {
+        SampleProfiler::instance().setOutputFile(Global::config().get("sample-profile"));
+    }
+    SampleProfiler::instance().start();
 
     RamStatement& program = tUnit.getProgram().getMain();
     auto entry = generator.generateTree(program);
@@ -135,8 +206,12 @@ void InterpreterEngine::executeMain() {
     if (!profileEnabled) {
         InterpreterContext ctxt;
         execute(entry.get(), ctxt);
+        ioPool.join();
     } else {
         ProfileEventSingleton::instance().setOutputFile(Global::config().get("profile"));
+        if (Global::config().has("profile-counters")) {
+            PerfCounters::instance().enable();
+        }
         // Prepare the frequency table for threaded use
         visitDepthFirst(program, [&](const RamTupleOperation& node) {
             if (!node.getProfileText().empty()) {
@@ -168,6 +243,7 @@ void InterpreterEngine::executeMain() {
 
         InterpreterContext ctxt;
         execute(entry.get(), ctxt);
+        ioPool.join();
         ProfileEventSingleton::instance().stopTimer();
         for (auto const& cur : frequencies) {
             for (size_t i = 0; i < cur.second.size(); ++i) {
@@ -178,17 +254,51 @@ void InterpreterEngine::executeMain() {
             ProfileEventSingleton::instance().makeQuantityEvent(
                     "@relation-reads;" + cur.first, cur.second, 0);
         }
+        for (auto& handle : getRelationMap()) {
+            const TupleFilter* filter = handle != nullptr ? (*handle)->getFilter() : nullptr;
+            if (filter != nullptr && filter->getSaved() > 0) {
+                ProfileEventSingleton::instance().makeQuantityEvent(
+                        "@relation-filter-saved;" + (*handle)->getName(), filter->getSaved(), 0);
+            }
+        }
+    }
+    for (const auto& cur : SampleProfiler::instance().stop()) {
+        ProfileEventSingleton::instance().makeQuantityEvent("@relation-samples;" + cur.first, cur.second, 0);
     }
     SignalHandler::instance()->reset();
 }
+const InterpreterNode* InterpreterEngine::getSubroutine(const std::string& name) {
+    auto& entry = subroutines[name];
+    if (entry == nullptr) {
+        entry = generator.generateTree(tUnit.getProgram().getSubroutine(name));
+    }
+    return entry.get();
+}
+
 void InterpreterEngine::executeSubroutine(
         const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) {
     InterpreterContext ctxt;
     ctxt.setReturnValues(ret);
     ctxt.setArguments(args);
 
-    auto entry = generator.generateTree(tUnit.getProgram().getSubroutine(name));
-    execute(entry.get(), ctxt);
+    execute(getSubroutine(name), ctxt);
+}
+
+void InterpreterEngine::executeSubroutine(const std::string& name,
+        const std::vector<std::vector<RamDomain>>& args, std::vector<std::vector<RamDomain>>& rets) {
+    const InterpreterNode* entry = getSubroutine(name);
+    rets.resize(args.size());
+
+    // the invocations are independent of each other, as each one writes its own return values
+    PARALLEL_START
+        ;
+        pfor(size_t i = 0; i < args.size(); i++) {
+            InterpreterContext ctxt;
+            ctxt.setReturnValues(rets[i]);
+            ctxt.setArguments(args[i]);
+            execute(entry, ctxt);
+        }
+    PARALLEL_END;
 }
 
 RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterContext& ctxt) {
@@ -614,6 +724,11 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 for (size_t i = 0; i < arity; i++) {
                     tuple[i] = execute(node->getChild(i), ctxt);
                 }
+                TupleFilter* filter = node->getData(1) != 0 ? node->getRelation()->getFilter() : nullptr;
+                if (filter != nullptr) {
+                    return filter->contains(
+                            tuple, [&]() { return ctxt.getView(viewPos)->contains(TupleRef(tuple, arity)); });
+                }
                 return ctxt.getView(viewPos)->contains(TupleRef(tuple, arity));
             }
 
@@ -784,6 +899,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
             auto pStream = rel.partitionScan(numOfThreads);
 
+            // too few tuples to occupy all threads, hence they split the range of the nested scan instead
+            if (pStream.size() < static_cast<size_t>(MAX_THREADS) && node->getData(0) != 0) {
+                executeSplitNested(node, node->getChild(0), pStream, 0, ctxt);
+                return true;
+            }
+
+            StealingStream stealing(pStream, rel.getArity(), profileEnabled);
             PARALLEL_START
                 ;
                 InterpreterContext newCtxt(ctxt);
@@ -791,8 +913,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                while (const auto* batch = stealing.next()) {
+                    for (const TupleRef& val : *batch) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (!execute(node->getChild(0), newCtxt)) {
                             break;
@@ -800,6 +922,10 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     }
                 }
             PARALLEL_END;
+            if (profileEnabled) {
+                ProfileEventSingleton::instance().makeBalanceEvent(SignalHandler::instance()->getMsg(),
+                        stealing.getThreadTimes(), stealing.getChunkTimes());
+            }
             return true;
         ESAC(ParallelScan)
 
@@ -852,6 +978,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             auto pStream =
                     rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads);
 
+            // too few tuples to occupy all threads, hence they split the range of the nested scan instead
+            if (pStream.size() < static_cast<size_t>(MAX_THREADS) && node->getData(1) != 0) {
+                executeSplitNested(node, node->getChild(arity), pStream, 1, ctxt);
+                return true;
+            }
+
+            StealingStream stealing(pStream, rel.getArity(), profileEnabled);
             PARALLEL_START
                 ;
                 InterpreterContext newCtxt(ctxt);
@@ -859,8 +992,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                while (const auto* batch = stealing.next()) {
+                    for (const TupleRef& val : *batch) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (!execute(node->getChild(arity), newCtxt)) {
                             break;
@@ -868,10 +1001,33 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     }
                 }
             PARALLEL_END;
+            if (profileEnabled) {
+                ProfileEventSingleton::instance().makeBalanceEvent(SignalHandler::instance()->getMsg(),
+                        stealing.getThreadTimes(), stealing.getChunkTimes());
+            }
 
             return true;
         ESAC(ParallelIndexScan)
 
+        CASE(HashJoin)
+            // create key tuple for the probe
+            size_t arity = cur.getRelation().getArity();
+            RamDomain key[arity];
+            for (size_t i = 0; i < arity; i++) {
+                key[i] = (node->getChild(i) != nullptr) ? execute(node->getChild(i), ctxt) : 0;
+            }
+
+            // probe the hash table built by the enclosing query
+            const HashJoinTable& table = node->getPreamble()->getHashTable(node->getData(0));
+            for (const RamDomain* tuple : table.probe(key)) {
+                ctxt[cur.getTupleId()] = tuple;
+                if (!execute(node->getChild(arity), ctxt)) {
+                    break;
+                }
+            }
+            return true;
+        ESAC(HashJoin)
+
         CASE(Choice)
             // get the targeted relation
             auto& rel = *node->getRelation();
@@ -1004,6 +1160,56 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return execute(node->getChild(1), ctxt);
         ESAC(UnpackRecord)
 
+        CASE_NO_CAST(LeapfrogJoin)
+            executeLeapfrogJoin(node, ctxt, MIN_RAM_DOMAIN, MAX_RAM_DOMAIN);
+            return true;
+        ESAC(LeapfrogJoin)
+
+        CASE(ParallelLeapfrogJoin)
+            auto preamble = node->getPreamble();
+            auto& rel = *node->getRelation();
+
+            // split the values of the join at the starts of the partitions of the first operand,
+            // ordered by its bound columns followed by the joined column
+            size_t arity = rel.getArity();
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            for (size_t i = 0; i < arity; i++) {
+                if (node->getChild(i) != nullptr) {
+                    low[i] = execute(node->getChild(i), ctxt);
+                    hig[i] = low[i];
+                } else {
+                    low[i] = MIN_RAM_DOMAIN;
+                    hig[i] = MAX_RAM_DOMAIN;
+                }
+            }
+            size_t column = cur.getColumn(0);
+            auto pStream = rel.partitionRange(node->getData(cur.getNumOperands()), TupleRef(low, arity),
+                    TupleRef(hig, arity), numOfThreads * 4);
+            std::vector<RamDomain> points;
+            for (auto& stream : pStream) {
+                for (const TupleRef& val : stream) {
+                    points.push_back(val[column]);
+                    break;
+                }
+            }
+            auto partitions = splitLeapfrogRange(std::move(points));
+
+            // each thread joins the values of the partitions it claims
+            std::atomic<size_t> claims(0);
+            PARALLEL_START
+                ;
+                InterpreterContext newCtxt(ctxt);
+                for (const auto& info : preamble->getViewInfoForNested()) {
+                    newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                }
+                for (size_t part = claims++; part < partitions.size(); part = claims++) {
+                    executeLeapfrogJoin(node, newCtxt, partitions[part].first, partitions[part].second);
+                }
+            PARALLEL_END;
+            return true;
+        ESAC(ParallelLeapfrogJoin)
+
         CASE(Aggregate)
             // get the targeted relation
             const InterpreterRelation& rel = *node->getRelation();
@@ -1207,13 +1413,33 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return true;
         ESAC(Project)
 
+        CASE_NO_CAST(BufferedProject)
+            const auto& cur = *static_cast<const RamProject*>(node->getShadow());
+            size_t arity = cur.getRelation().getArity();
+            RamDomain tuple[arity];
+            for (size_t i = 0; i < arity; i++) {
+                tuple[i] = execute(node->getChild(i), ctxt);
+            }
+
+            // insert in the buffer of the thread, merged into the target relation by the query or
+            // flushed into it by the thread once full
+            InterpreterRelation& rel = *node->getRelation();
+            node->getPreamble()->getInsertBuffer(node->getData(0)).insert(tuple, [&](const RamDomain* t) {
+                rel.insert(t);
+            });
+            return true;
+        ESAC(BufferedProject)
+
         CASE(SubroutineReturnValue)
-            for (size_t i = 0; i < cur.getValues().size(); ++i) {
-                if (node->getChild(i) == nullptr) {
-                    ctxt.addReturnValue(0);
-                } else {
-                    ctxt.addReturnValue(execute(node->getChild(i), ctxt));
-                }
+            // evaluate the values first, and append them at once as parallel loops return concurrently
+            size_t size = cur.getValues().size();
+            RamDomain values[size];
+            for (size_t i = 0; i < size; ++i) {
+                values[i] = node->getChild(i) == nullptr ? 0 : execute(node->getChild(i), ctxt);
+            }
+            std::lock_guard<std::mutex> guard(subroutineLock);
+            for (size_t i = 0; i < size; ++i) {
+                ctxt.addReturnValue(values[i]);
             }
             return true;
         ESAC(SubroutineReturnValue)
@@ -1228,6 +1454,20 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Sequence)
 
         CASE_NO_CAST(Parallel)
+            // loads of relations are executed concurrently on the IO pool
+            if (node->getData(0) != 0) {
+                for (const auto& child : node->getChildren()) {
+                    const InterpreterNode* load = child.get();
+                    ioPool.submit(load->getRelation(), [this, load]() {
+                        InterpreterContext ioCtxt;
+                        execute(load, ioCtxt);
+                    });
+                }
+                for (const auto& child : node->getChildren()) {
+                    ioPool.wait(child->getRelation());
+                }
+                return true;
+            }
             for (const auto& child : node->getChildren()) {
                 if (!execute(child.get(), ctxt)) {
                     return false;
@@ -1250,6 +1490,18 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Exit)
 
         CASE(LogRelationTimer)
+            // a store is timed where it is performed, i.e., on the IO pool
+            if (node->getChild(0)->getType() == I_Store) {
+                const auto& store = *static_cast<const RamStore*>(node->getChild(0)->getShadow());
+                InterpreterRelation* rel = node->getChild(0)->getRelation();
+                size_t iteration = getIterationNumber();
+                ioPool.submit(rel, [this, &cur, &store, rel, iteration]() {
+                    Logger logger(
+                            cur.getMessage().c_str(), iteration, std::bind(&InterpreterRelation::size, rel));
+                    storeRelation(store, *rel);
+                });
+                return true;
+            }
             Logger logger(cur.getMessage().c_str(), getIterationNumber(),
                     std::bind(&InterpreterRelation::size, node->getRelation()));
             return execute(node->getChild(0), ctxt);
@@ -1266,10 +1518,29 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(DebugInfo)
 
         CASE_NO_CAST(Clear)
+            // wait for pending writes of the relation
+            ioPool.wait(node->getRelation());
             node->getRelation()->purge();
             return true;
         ESAC(Clear)
 
+        CASE_NO_CAST(Purge)
+            // wait for pending writes of the relation
+            ioPool.wait(node->getRelation());
+            node->getRelation()->purge();
+            return true;
+        ESAC(Purge)
+
+        CASE(Facts)
+            InterpreterRelation& rel = *node->getRelation();
+            size_t arity = rel.getArity();
+            const RamDomain* values = cur.getValues().data();
+            for (size_t i = 0; i < cur.getNumFacts(); i++) {
+                rel.insert(TupleRef(values + i * arity, arity));
+            }
+            return true;
+        ESAC(Facts)
+
         CASE(LogSize)
             const InterpreterRelation& rel = *node->getRelation();
             ProfileEventSingleton::instance().makeQuantityEvent(
@@ -1297,27 +1568,20 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Load)
 
         CASE(Store)
-            for (IODirectives ioDirectives : cur.getIODirectives()) {
-                try {
-                    std::vector<RamTypeAttribute> symbolMask;
-                    for (auto& cur : cur.getRelation().getAttributeTypes()) {
-                        symbolMask.push_back(RamPrimitiveFromChar(cur[0]));
-                    }
-                    IOSystem::getInstance()
-                            .getWriter(symbolMask, getSymbolTable(), ioDirectives,
-                                    cur.getRelation().getAuxiliaryArity())
-                            ->writeAll(*node->getRelation());
-                } catch (std::exception& e) {
-                    std::cerr << e.what();
-                    exit(1);
-                }
-            }
+            // the relation is not modified until it is cleared, which waits for the write
+            InterpreterRelation* rel = node->getRelation();
+            ioPool.submit(rel, [this, &cur, rel]() { storeRelation(cur, *rel); });
             return true;
         ESAC(Store)
 
         CASE_NO_CAST(Query)
             InterpreterPreamble* preamble = node->getPreamble();
 
+            // Adapt the filters of the relations checked by the query to their current size
+            for (size_t relId : preamble->getFilteredRelations()) {
+                getRelationHandle(relId)->updateFilter();
+            }
+
             // Execute view-free operations in outer filter if any.
             auto& viewFreeOps = preamble->getOuterFilterViewFreeOps();
             for (auto& op : viewFreeOps) {
@@ -1349,7 +1613,35 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     ctxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
             }
+            // Build the hash tables of hash joins
+            auto& hashJoinInfo = preamble->getHashJoinInfo();
+            for (size_t i = 0; i < hashJoinInfo.size(); i++) {
+                InterpreterRelation& rel = *getRelationHandle(hashJoinInfo[i].first);
+                auto table = std::make_unique<HashJoinTable>(rel.getArity(), hashJoinInfo[i].second);
+                auto pStream = rel.partitionScan(numOfThreads);
+                PARALLEL_START
+                    ;
+                    pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
+                        for (const TupleRef& val : *it) {
+                            table->insert(val.getBase());
+                        }
+                    }
+                PARALLEL_END;
+                preamble->setHashTable(i, std::move(table));
+            }
             execute(node->getChild(0), ctxt);
+            preamble->clearHashTables();
+
+            // Merge the insertion buffers into their relations; insertions into lattices read the
+            // lattice, hence they are not merged in parallel
+            auto& insertBufferInfo = preamble->getInsertBufferInfo();
+            for (size_t i = 0; i < insertBufferInfo.size(); i++) {
+                InterpreterRelation& rel = *getRelationHandle(insertBufferInfo[i]);
+                bool parallel = dynamic_cast<InterpreterLatticeRelation*>(&rel) == nullptr;
+                preamble->getInsertBuffer(i).merge(
+                        [&]() { return [&](const RamDomain* tuple) { rel.insert(tuple); }; }, parallel);
+            }
+            enforceMemoryBudget();
             return true;
         ESAC(Query)
 
@@ -1371,4 +1663,133 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
     }
 }
 
+void InterpreterEngine::executeLeapfrogJoin(
+        const InterpreterNode* node, InterpreterContext& ctxt, RamDomain lowValue, RamDomain highValue) {
+    const auto& cur = *static_cast<const RamLeapfrogJoin*>(node->getShadow());
+    // create lower bounds for the seeks of all operands
+    size_t numOperands = cur.getNumOperands();
+    size_t totalArity = 0;
+    size_t maxArity = 0;
+    for (size_t i = 0; i < numOperands; i++) {
+        totalArity += cur.getRelation(i).getArity();
+        maxArity = std::max<size_t>(maxArity, cur.getRelation(i).getArity());
+    }
+    RamDomain low[totalArity];
+    RamDomain res[maxArity];
+    size_t offset[numOperands];
+    size_t prefixLength[numOperands];
+    for (size_t i = 0, pos = 0; i < numOperands; i++) {
+        offset[i] = pos;
+        prefixLength[i] = 0;
+        for (size_t j = 0; j < cur.getRelation(i).getArity(); j++, pos++) {
+            if (node->getChild(pos) != nullptr) {
+                low[pos] = execute(node->getChild(pos), ctxt);
+                prefixLength[i]++;
+            } else {
+                low[pos] = MIN_RAM_DOMAIN;
+            }
+        }
+    }
+
+    // seek through the views of the operands, whose index orders
+    // start with the bound columns followed by the joined column
+    RamDomain* bounds = low;
+    RamDomain* found = res;
+    size_t* offsets = offset;
+    size_t* prefixLengths = prefixLength;
+    auto seek = [&](size_t i, RamDomain value, RamDomain& result) -> bool {
+        size_t column = cur.getColumn(i);
+        RamDomain* bound = bounds + offsets[i];
+        bound[column] = value;
+        auto& view = ctxt.getView(node->getData(i));
+        if (!view->seek(TupleRef(bound, cur.getRelation(i).getArity()), prefixLengths[i], found)) {
+            return false;
+        }
+        result = found[column];
+        return true;
+    };
+
+    // bind the values common to all operands
+    RamDomain value;
+    ctxt[cur.getTupleId()] = &value;
+    LeapfrogIntersection<decltype(seek)> intersection(numOperands, seek, lowValue, highValue);
+    while (intersection.next(value)) {
+        if (!execute(node->getChild(totalArity), ctxt)) {
+            break;
+        }
+    }
+}
+
+void InterpreterEngine::executeSplitNested(const InterpreterNode* node, const InterpreterNode* outerOp,
+        PartitionedStream& outer, size_t dataPos, InterpreterContext& ctxt) {
+    const auto& parallel = *static_cast<const RamRelationOperation*>(node->getShadow());
+    const InterpreterNode* nested = outerOp->getChild(0);
+    const auto& scan = *static_cast<const RamRelationOperation*>(nested->getShadow());
+    auto& nestedRel = *getRelationHandle(node->getData(dataPos) - 1);
+    size_t indexPos = node->getData(dataPos + 1);
+    size_t outerArity = parallel.getRelation().getArity();
+    size_t arity = nestedRel.getArity();
+
+    // copy the tuples of the outer loop, which every thread enumerates
+    std::vector<RamDomain> tuples;
+    for (auto& stream : outer) {
+        for (const TupleRef& val : stream) {
+            tuples.insert(tuples.end(), val.getBase(), val.getBase() + outerArity);
+        }
+    }
+    size_t numTuples = tuples.size() / outerArity;
+
+    std::unique_ptr<PartitionedStream> pStream;
+    PARALLEL_START
+        ;
+        InterpreterContext newCtxt(ctxt);
+        for (const auto& info : node->getPreamble()->getViewInfoForNested()) {
+            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+        }
+        for (size_t i = 0; i < numTuples; i++) {
+            newCtxt[parallel.getTupleId()] = &tuples[i * outerArity];
+#pragma omp single
+            {
+                if (nested->getType() == I_Scan) {
+                    pStream = std::make_unique<PartitionedStream>(nestedRel.partitionScan(numOfThreads));
+                } else {
+                    RamDomain low[arity];
+                    RamDomain hig[arity];
+                    for (size_t j = 0; j < arity; j++) {
+                        if (nested->getChild(j) != nullptr) {
+                            low[j] = execute(nested->getChild(j), newCtxt);
+                            hig[j] = low[j];
+                        } else {
+                            low[j] = MIN_RAM_DOMAIN;
+                            hig[j] = MAX_RAM_DOMAIN;
+                        }
+                    }
+                    pStream = std::make_unique<PartitionedStream>(nestedRel.partitionRange(
+                            indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads));
+                }
+            }
+            const InterpreterNode* body = nested->getChild(nested->getType() == I_Scan ? 0 : arity);
+            pfor(auto it = pStream->begin(); it < pStream->end(); it++) {
+                for (const TupleRef& val : *it) {
+                    newCtxt[scan.getTupleId()] = val.getBase();
+                    if (!execute(body, newCtxt)) {
+                        break;
+                    }
+                }
+            }
+        }
+    PARALLEL_END;
+
+    // account for the skipped executions of the outer tuple operation
+    const auto& tupleOp = *static_cast<const RamTupleOperation*>(outerOp->getShadow());
+    const std::string& profileText = tupleOp.getProfileText();
+    if (profileEnabled && !profileText.empty()) {
+        auto& currentFrequencies = frequencies[profileText];
+        while (currentFrequencies.size() <= getIterationNumber()) {
+            currentFrequencies.emplace_back(0);
+        }
+        currentFrequencies[getIterationNumber()] += numTuples;
+    }
+}
+
 }  // namespace souffle
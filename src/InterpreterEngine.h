@@ -16,17 +16,21 @@
 
 #pragma once
 
+#include "IOPool.h"
 #include "InterpreterContext.h"
 #include "InterpreterGenerator.h"
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
 #include "InterpreterRelation.h"
+#include "LsmSet.h"
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
 #include "RecordTable.h"
+#include <atomic>
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <dlfcn.h>
@@ -47,22 +51,50 @@ public:
     InterpreterEngine(RamTranslationUnit& tUnit)
             : profileEnabled(Global::config().has("profile")),
               numOfThreads(std::stoi(Global::config().get("jobs"))), tUnit(tUnit),
-              isa(tUnit.getAnalysis<RamIndexAnalysis>()), generator(isa) {
+              isa(tUnit.getAnalysis<RamIndexAnalysis>()),
+              generator(isa, tUnit.getAnalysis<RamInsertBufferAnalysis>()), ioPool(getNumIOWorkers()) {
 #ifdef _OPENMP
         if (numOfThreads > 0) {
             omp_set_num_threads(numOfThreads);
         }
 #endif
+        if (Global::config().has("memory-budget")) {
+            memoryBudget = std::stoull(Global::config().get("memory-budget")) << 20;
+        }
+        if (Global::config().has("spill-dir")) {
+            LsmConfig::directory() = Global::config().get("spill-dir");
+        }
     }
     /** @brief Execute the main program */
     void executeMain();
     /** @brief Execute the subroutine program */
     void executeSubroutine(
             const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret);
+    /** @brief Execute the subroutine program once for each of the given arguments */
+    void executeSubroutine(const std::string& name, const std::vector<std::vector<RamDomain>>& args,
+            std::vector<std::vector<RamDomain>>& rets);
 
 private:
+    /** @brief Return the tree of a subroutine, generating it on first use */
+    const InterpreterNode* getSubroutine(const std::string& name);
     /** @brief Remove a relation from the environment */
     void dropRelation(const size_t relId);
+    /** @brief Return the number of threads performing IO in the background */
+    size_t getNumIOWorkers() const {
+#ifdef IS_PARALLEL
+        if (numOfThreads == 0) {
+            return std::thread::hardware_concurrency();
+        }
+        return numOfThreads == 1 ? 0 : numOfThreads;
+#else
+        // locks are no-ops in sequential builds, so IO is performed synchronously
+        return 0;
+#endif
+    }
+    /** @brief Write a relation as directed by a store statement */
+    void storeRelation(const RamStore& store, const InterpreterRelation& rel);
+    /** @brief Move the largest relation to disk if the memory budget is exceeded */
+    void enforceMemoryBudget();
     /** @brief Swap the content of two relations */
     void swapRelation(const size_t ramRel1, const size_t ramRel2);
     /** @brief Return a reference to the relation on the given index */
@@ -75,6 +107,12 @@ private:
     RamTranslationUnit& getTranslationUnit();
     /** @brief Execute the program */
     RamDomain execute(const InterpreterNode*, InterpreterContext&);
+    /** @brief Execute a leapfrog join for the values in [low, high] */
+    void executeLeapfrogJoin(
+            const InterpreterNode* node, InterpreterContext& ctxt, RamDomain low, RamDomain high);
+    /** @brief Execute the outer loop of a parallel operation in every thread, splitting its nested scan */
+    void executeSplitNested(const InterpreterNode* node, const InterpreterNode* outerOp,
+            PartitionedStream& outer, size_t dataPos, InterpreterContext& ctxt);
     /** @brief Return method handler */
     void* getMethodHandle(const std::string& method);
     /** @brief Load DLL */
@@ -112,6 +150,16 @@ private:
     NodeGenerator generator;
     /** Record Table*/
     RecordTable recordTable;
+    /** Pool performing loads and stores in the background */
+    IOPool ioPool;
+    /** Lock guarding the return values of subroutines */
+    std::mutex subroutineLock;
+    /** Trees of the subroutines executed so far */
+    std::map<std::string, std::unique_ptr<InterpreterNode>> subroutines;
+    /** Memory in bytes the relations may occupy before they are moved to disk, 0 for no limit */
+    size_t memoryBudget = 0;
+    /** Memory usage at which relations are moved to disk */
+    size_t spillThreshold = 0;
 };
 
 }  // namespace souffle
@@ -21,8 +21,11 @@
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
 #include "RamIndexAnalysis.h"
+#include "RamInsertBufferAnalysis.h"
+#include "RamTransforms.h"
 #include "RamVisitor.h"
 #include <cassert>
+#include <map>
 #include <memory>
 #include <queue>
 
@@ -39,7 +42,8 @@ class NodeGenerator : public RamVisitor<std::unique_ptr<InterpreterNode>> {
     using RelationHandle = std::unique_ptr<InterpreterRelation>;
 
 public:
-    NodeGenerator(RamIndexAnalysis* isa) : isa(isa), isProvenance(Global::config().has("provenance")) {}
+    NodeGenerator(RamIndexAnalysis* isa, RamInsertBufferAnalysis* iba)
+            : isa(isa), iba(iba), isProvenance(Global::config().has("provenance")) {}
 
     /**
      * @brief Generate the tree based on given entry.
@@ -60,10 +64,17 @@ public:
             } else if (const auto* provExists = dynamic_cast<const RamProvenanceExistenceCheck*>(&node)) {
                 encodeIndexPos(*provExists);
                 encodeView(provExists);
+            } else if (const auto* join = dynamic_cast<const RamLeapfrogJoin*>(&node)) {
+                for (size_t i = 0; i < join->getNumOperands(); ++i) {
+                    encodeIndexPos(*join, i);
+                    encodeView(&join->getRelationReference(i));
+                }
             }
         });
         // Parse program
-        return visit(root);
+        NodePtr res = visit(root);
+        linkLattices();
+        return res;
     }
 
     NodePtr visitConstant(const RamConstant& num) override {
@@ -141,8 +152,18 @@ public:
         }
         std::vector<size_t> data;
         data.push_back(encodeView(&exists));
+        // guard total checks with a filter of the relation, whose use is decided at the start of the query
+        const RamRelation& relation = exists.getRelation();
+        RelationHandle* rel = nullptr;
+        if (isa->isTotalSignature(&exists) && !isProvenance && parentQueryPreamble != nullptr &&
+                relation.getRepresentation() != RelationRepresentation::EQREL) {
+            size_t relId = encodeRelation(relation);
+            rel = relations[relId].get();
+            parentQueryPreamble->addFilteredRelation(relId);
+        }
+        data.push_back(rel != nullptr ? 1 : 0);
         return std::make_unique<InterpreterNode>(
-                I_ExistenceCheck, &exists, std::move(children), nullptr, std::move(data));
+                I_ExistenceCheck, &exists, std::move(children), rel, std::move(data));
     }
 
     NodePtr visitProvenanceExistenceCheck(const RamProvenanceExistenceCheck& provExists) override {
@@ -187,7 +208,10 @@ public:
         auto rel = relations[relId].get();
         NodePtrVec children;
         children.push_back(visitTupleOperation(pScan));
-        auto res = std::make_unique<InterpreterNode>(I_ParallelScan, &pScan, std::move(children), rel);
+        std::vector<size_t> data;
+        encodeNestedScan(pScan, data);
+        auto res = std::make_unique<InterpreterNode>(
+                I_ParallelScan, &pScan, std::move(children), rel, std::move(data));
         res->setPreamble(parentQueryPreamble);
         return res;
     }
@@ -204,6 +228,21 @@ public:
                 I_IndexScan, &scan, std::move(children), nullptr, std::move(data));
     }
 
+    NodePtr visitHashJoin(const RamHashJoin& join) override {
+        NodePtrVec children;
+        for (const auto& value : join.getRangePattern()) {
+            children.push_back(visit(value));
+        }
+        children.push_back(visitTupleOperation(join));
+        std::vector<size_t> data;
+        data.push_back(
+                parentQueryPreamble->addHashJoin(encodeRelation(join.getRelation()), join.getKeyColumns()));
+        auto res = std::make_unique<InterpreterNode>(
+                I_HashJoin, &join, std::move(children), nullptr, std::move(data));
+        res->setPreamble(parentQueryPreamble);
+        return res;
+    }
+
     NodePtr visitParallelIndexScan(const RamParallelIndexScan& piscan) override {
         size_t relId = encodeRelation(piscan.getRelation());
         auto rel = relations[relId].get();
@@ -214,6 +253,7 @@ public:
         children.push_back(visitTupleOperation(piscan));
         std::vector<size_t> data;
         data.push_back((encodeIndexPos(piscan)));
+        encodeNestedScan(piscan, data);
         auto res = std::make_unique<InterpreterNode>(
                 I_ParallelIndexScan, &piscan, std::move(children), rel, std::move(data));
         res->setPreamble(parentQueryPreamble);
@@ -277,6 +317,39 @@ public:
         return std::make_unique<InterpreterNode>(I_UnpackRecord, &lookup, std::move(children));
     }
 
+    NodePtr visitLeapfrogJoin(const RamLeapfrogJoin& join) override {
+        NodePtrVec children;
+        std::vector<size_t> data;
+        for (size_t i = 0; i < join.getNumOperands(); ++i) {
+            for (const auto& value : join.getRangePattern(i)) {
+                children.push_back(visit(value));
+            }
+            data.push_back(encodeView(&join.getRelationReference(i)));
+        }
+        children.push_back(visitTupleOperation(join));
+        return std::make_unique<InterpreterNode>(
+                I_LeapfrogJoin, &join, std::move(children), nullptr, std::move(data));
+    }
+
+    NodePtr visitParallelLeapfrogJoin(const RamParallelLeapfrogJoin& join) override {
+        NodePtrVec children;
+        std::vector<size_t> data;
+        for (size_t i = 0; i < join.getNumOperands(); ++i) {
+            for (const auto& value : join.getRangePattern(i)) {
+                children.push_back(visit(value));
+            }
+            data.push_back(encodeView(&join.getRelationReference(i)));
+        }
+        children.push_back(visitTupleOperation(join));
+        // the values are partitioned by the index of the first operand
+        auto rel = relations[encodeRelation(join.getRelation(0))].get();
+        data.push_back(encodeIndexPos(join, 0));
+        auto res = std::make_unique<InterpreterNode>(
+                I_ParallelLeapfrogJoin, &join, std::move(children), rel, std::move(data));
+        res->setPreamble(parentQueryPreamble);
+        return res;
+    }
+
     NodePtr visitAggregate(const RamAggregate& aggregate) override {
         size_t relId = encodeRelation(aggregate.getRelation());
         auto rel = relations[relId].get();
@@ -324,6 +397,14 @@ public:
         for (const auto& value : project.getValues()) {
             children.push_back(visit(value));
         }
+        if (iba->isBuffered(project)) {
+            std::vector<size_t> data;
+            data.push_back(parentQueryPreamble->addInsertBuffer(relId, project.getRelation().getArity()));
+            auto res = std::make_unique<InterpreterNode>(
+                    I_BufferedProject, &project, std::move(children), rel, std::move(data));
+            res->setPreamble(parentQueryPreamble);
+            return res;
+        }
         return std::make_unique<InterpreterNode>(I_Project, &project, std::move(children), rel);
     }
 
@@ -345,12 +426,21 @@ public:
     }
 
     NodePtr visitParallel(const RamParallel& parallel) override {
-        // Parallel statements are executed in sequence for now.
+        // Parallel statements are executed in sequence for now, unless all of them are loads.
         NodePtrVec children;
+        bool onlyLoads = true;
         for (const auto& value : parallel.getStatements()) {
+            const RamStatement* stmt = value;
+            if (const auto* timer = dynamic_cast<const RamLogRelationTimer*>(stmt)) {
+                stmt = &timer->getStatement();
+            }
+            onlyLoads = onlyLoads && dynamic_cast<const RamLoad*>(stmt) != nullptr;
             children.push_back(visit(value));
         }
-        return std::make_unique<InterpreterNode>(I_Parallel, &parallel, std::move(children));
+        std::vector<size_t> data;
+        data.push_back(onlyLoads ? 1 : 0);
+        return std::make_unique<InterpreterNode>(
+                I_Parallel, &parallel, std::move(children), nullptr, std::move(data));
     }
 
     NodePtr visitLoop(const RamLoop& loop) override {
@@ -391,6 +481,18 @@ public:
         return std::make_unique<InterpreterNode>(I_Clear, &clear, NodePtrVec{}, rel);
     }
 
+    NodePtr visitPurge(const RamPurge& purge) override {
+        size_t relId = encodeRelation(purge.getRelation());
+        auto rel = relations[relId].get();
+        return std::make_unique<InterpreterNode>(I_Purge, &purge, NodePtrVec{}, rel);
+    }
+
+    NodePtr visitFacts(const RamFacts& facts) override {
+        size_t relId = encodeRelation(facts.getRelation());
+        auto rel = relations[relId].get();
+        return std::make_unique<InterpreterNode>(I_Facts, &facts, NodePtrVec{}, rel);
+    }
+
     NodePtr visitLogSize(const RamLogSize& size) override {
         size_t relId = encodeRelation(size.getRelation());
         auto rel = relations[relId].get();
@@ -448,6 +550,15 @@ public:
             };
         });
 
+        // each operand of a leapfrog join seeks through its own view
+        visitDepthFirst(*next, [&](const RamLeapfrogJoin& join) {
+            for (size_t i = 0; i < join.getNumOperands(); ++i) {
+                const RamNode* operand = &join.getRelationReference(i);
+                preamble->addViewInfoForNested(
+                        encodeRelation(join.getRelation(i)), indexTable[operand], encodeView(operand));
+            }
+        });
+
         visitDepthFirst(*next, [&](const RamAbstractParallel& node) { preamble->isParallel = true; });
 
         NodePtrVec children;
@@ -498,6 +609,8 @@ private:
     std::unordered_map<const RamNode*, size_t> indexTable;
     /** Used by index encoding */
     RamIndexAnalysis* isa;
+    /** Used to detect buffered projections */
+    RamInsertBufferAnalysis* iba;
     /** Points to the current preamble during the generation.  It is used to passing preamble between parent
      * query and its nested parallel operation. */
     std::shared_ptr<InterpreterPreamble> parentQueryPreamble = nullptr;
@@ -514,6 +627,31 @@ private:
     /** If generating a provenance program */
     const bool isProvenance;
 
+    /** @brief Let the tuples of lattices dominate the tuples inserted into their delta and new relations */
+    void linkLattices() {
+        std::map<std::string, size_t> ids;
+        for (const auto& cur : relTable) {
+            ids[cur.first->getName()] = cur.second;
+        }
+        for (const auto& cur : relTable) {
+            const std::string& name = cur.first->getName();
+            if (!isLattice(cur.first->getRepresentation())) {
+                continue;
+            }
+            for (const std::string prefix : {"@delta_", "@new_"}) {
+                if (name.compare(0, prefix.size(), prefix) != 0) {
+                    continue;
+                }
+                auto base = ids.find(name.substr(prefix.size()));
+                if (base != ids.end()) {
+                    auto& rel = static_cast<InterpreterLatticeRelation&>(**relations[cur.second]);
+                    rel.setDominator(static_cast<const InterpreterLatticeRelation*>(
+                            relations[base->second]->get()));
+                }
+            }
+        }
+    }
+
     /** @brief Reset view allocation system, since view's life time is within each query. */
     void newQueryBlock() {
         viewTable.clear();
@@ -544,6 +682,32 @@ private:
         return i;
     };
 
+    /**
+     * @brief Encode the scan nested directly in a parallel operation, whose range the threads split if the
+     * parallel operation has too few tuples. Appends the id of its relation plus one, or zero if the nested
+     * operation can not be split, and the index position of the range.
+     */
+    void encodeNestedScan(const RamTupleOperation& op, std::vector<size_t>& data) {
+        const RamRelationOperation* scan = ParallelTransformer::getSplittableScan(op);
+        if (scan == nullptr) {
+            data.push_back(0);
+            data.push_back(0);
+            return;
+        }
+        const auto* indexScan = dynamic_cast<const RamIndexScan*>(scan);
+        data.push_back(encodeRelation(scan->getRelation()) + 1);
+        data.push_back(indexScan != nullptr ? encodeIndexPos(*indexScan) : 0);
+    }
+
+    /** @brief Return index id of an operand of a leapfrog join from the result of indexAnalysis */
+    size_t encodeIndexPos(const RamLeapfrogJoin& join, size_t operand) {
+        const MinIndexSelection& orderSet = isa->getIndexes(join.getRelation(operand));
+        auto i = orderSet.getPrefixOrderNum(
+                isa->getSearchSignature(&join, operand), join.getColumn(operand));
+        indexTable[&join.getRelationReference(operand)] = i;
+        return i;
+    }
+
     /** @brief Encode and return the View id of an operation. */
     size_t encodeView(const RamNode* node) {
         auto pos = viewTable.find(node);
@@ -643,6 +807,13 @@ private:
             if (isProvenance) {
                 res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
                         id.getName(), std::vector<std::string>(), orderSet, createBTreeProvenanceIndex);
+            } else if (isLattice(id.getRepresentation())) {
+                res = std::make_unique<InterpreterLatticeRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet,
+                        id.getRepresentation() == RelationRepresentation::MAX_LATTICE);
+            } else if (id.getRepresentation() == RelationRepresentation::DISK) {
+                res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
+                        id.getName(), std::vector<std::string>(), orderSet, createDiskIndex);
             } else {
                 res = std::make_unique<InterpreterRelation>(id.getArity(), id.getAuxiliaryArity(),
                         id.getName(), std::vector<std::string>(), orderSet);
@@ -16,6 +16,7 @@
 
 #include "InterpreterIndex.h"
 #include "CompiledIndexUtils.h"
+#include "LsmSet.h"
 #include "Util.h"
 #include <atomic>
 
@@ -134,6 +135,10 @@ class NullaryIndex : public InterpreterIndex {
             return index.range(low, high);
         }
 
+        bool seek(const TupleRef&, std::size_t, RamDomain*) const override {
+            return index.present;
+        }
+
         size_t getArity() const override {
             return 0;
         }
@@ -309,6 +314,25 @@ protected:
             return std::make_unique<Source>(index.order, range.begin(), range.end());
         }
 
+        bool seek(const TupleRef& low, std::size_t prefixLength, RamDomain* res) const override {
+            Entry key = index.order.encode(low.asTuple<Arity>());
+            auto pos = index.data.lower_bound(key, hints);
+            if (pos == index.data.end()) {
+                return false;
+            }
+            const Entry& cur = *pos;
+            for (std::size_t i = 0; i < prefixLength; ++i) {
+                if (cur[i] != key[i]) {
+                    return false;
+                }
+            }
+            Entry entry = index.order.decode(cur);
+            for (std::size_t i = 0; i < Arity; ++i) {
+                res[i] = entry[i];
+            }
+            return true;
+        }
+
         size_t getArity() const override {
             return Arity;
         }
@@ -491,6 +515,23 @@ public:
                     index.set.lower_bound(low, hints), index.set.upper_bound(high, hints));
         }
 
+        bool seek(const TupleRef& low, std::size_t prefixLength, RamDomain* res) const override {
+            auto pos = index.set.lower_bound(low, hints);
+            if (pos == index.set.end()) {
+                return false;
+            }
+            const TupleRef& cur = *pos;
+            for (std::size_t i = 0; i < prefixLength; ++i) {
+                if (cur[index.theOrder[i]] != low[index.theOrder[i]]) {
+                    return false;
+                }
+            }
+            for (std::size_t i = 0; i < cur.size(); ++i) {
+                res[i] = cur[i];
+            }
+            return true;
+        }
+
         size_t getArity() const override {
             return index.getArity();
         }
@@ -614,6 +655,15 @@ public:
             InterpreterProvenanceUpdater<Arity>>>::GenericIndex;
 };
 
+/**
+ * A index adapter for disk-backed sets, using the generic index adapter.
+ */
+template <std::size_t Arity>
+class DiskIndex : public GenericIndex<LsmSet<t_tuple<Arity>, comparator<Arity>>> {
+public:
+    using GenericIndex<LsmSet<t_tuple<Arity>, comparator<Arity>>>::GenericIndex;
+};
+
 /**
  * A index adapter for Bries, using the generic index adapter.
  */
@@ -745,6 +795,39 @@ std::unique_ptr<InterpreterIndex> createBrieIndex(const Order& order) {
     return {};
 }
 
+std::unique_ptr<InterpreterIndex> createDiskIndex(const Order& order) {
+    switch (order.size()) {
+        case 0:
+            return std::make_unique<NullaryIndex>();
+        case 1:
+            return std::make_unique<DiskIndex<1>>(order);
+        case 2:
+            return std::make_unique<DiskIndex<2>>(order);
+        case 3:
+            return std::make_unique<DiskIndex<3>>(order);
+        case 4:
+            return std::make_unique<DiskIndex<4>>(order);
+        case 5:
+            return std::make_unique<DiskIndex<5>>(order);
+        case 6:
+            return std::make_unique<DiskIndex<6>>(order);
+        case 7:
+            return std::make_unique<DiskIndex<7>>(order);
+        case 8:
+            return std::make_unique<DiskIndex<8>>(order);
+        case 9:
+            return std::make_unique<DiskIndex<9>>(order);
+        case 10:
+            return std::make_unique<DiskIndex<10>>(order);
+        case 11:
+            return std::make_unique<DiskIndex<11>>(order);
+        case 12:
+            return std::make_unique<DiskIndex<12>>(order);
+    }
+    assert(false && "Requested arity not yet supported. Feel free to add it.");
+    return {};
+}
+
 std::unique_ptr<InterpreterIndex> createIndirectIndex(const Order& order) {
     assert(order.size() != 0 && "IndirectIndex does not work with nullary relation\n");
     return std::make_unique<IndirectIndex>(order.getOrder());
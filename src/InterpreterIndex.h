@@ -20,7 +20,9 @@
 #include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "Util.h"
+#include "WorkStealing.h"
 
+#include <algorithm>
 #include <array>
 #include <deque>
 #include <map>
@@ -262,7 +264,9 @@ public:
         if (source == nullptr) {
             return std::make_unique<Stream>();
         }
-        auto newStream = std::make_unique<Stream>(source->clone());
+        // take over the source without loading the next chunk of elements
+        auto newStream = std::make_unique<Stream>();
+        newStream->source = source->clone();
         newStream->source->reload(&newStream->buffer[0], limit);
         newStream->cur = cur;
         newStream->limit = limit;
@@ -351,6 +355,75 @@ public:
     iterator end() {
         return streams.end();
     }
+
+    std::size_t size() const {
+        return streams.size();
+    }
+};
+
+/**
+ * A partitioned stream enumerated by the threads of a parallel region in
+ * batches, where idle threads split the remaining range of busy streams
+ * (see StealingScheduler). The tuples of a batch are copied out of the
+ * streams, since sources decode tuples into buffers that are overwritten
+ * by their next load.
+ */
+class StealingStream {
+public:
+    StealingStream(PartitionedStream& streams, std::size_t arity, bool timed)
+            : streams(streams), arity(arity), scheduler(streams.size(), timed), batches(MAX_THREADS) {}
+
+    /**
+     * Takes the next batch of tuples for the calling thread.
+     *
+     * @return the batch, which stays valid until the next call, or nullptr if there are no more tuples
+     */
+    const std::vector<TupleRef>* next() {
+        std::size_t chunk = 0;
+        std::size_t count = 0;
+        Batch& batch = batches[THREAD_ID];
+        while (scheduler.next(chunk, count)) {
+            Stream& stream = *(streams.begin() + chunk);
+            batch.data.resize(count * arity);
+            batch.tuples.clear();
+            scheduler.getLock(chunk).lock();
+            for (auto it = stream.begin(); batch.tuples.size() < count && it != stream.end(); ++it) {
+                RamDomain* tuple = &batch.data[batch.tuples.size() * arity];
+                std::copy_n((*it).getBase(), arity, tuple);
+                batch.tuples.emplace_back(tuple, arity);
+            }
+            scheduler.getLock(chunk).unlock();
+            if (batch.tuples.empty()) {
+                scheduler.exhausted(chunk);
+                continue;
+            }
+            return &batch.tuples;
+        }
+        return nullptr;
+    }
+
+    std::vector<uint64_t> getThreadTimes() const {
+        return scheduler.getThreadTimes();
+    }
+
+    std::vector<uint64_t> getChunkTimes() const {
+        return scheduler.getChunkTimes();
+    }
+
+private:
+    /** the current batch of a thread */
+    struct alignas(64) Batch {
+        std::vector<RamDomain> data;
+        std::vector<TupleRef> tuples;
+    };
+
+    PartitionedStream& streams;
+
+    const std::size_t arity;
+
+    StealingScheduler scheduler;
+
+    std::vector<Batch> batches;
 };
 
 /**
@@ -375,6 +448,16 @@ public:
      */
     virtual Stream range(const TupleRef& low, const TupleRef& high) const = 0;
 
+    /**
+     * Obtains the smallest element of this index not less than the given lower
+     * bound that agrees with the lower bound on the first prefixLength components
+     * of the index order. The element is stored in res, which has to provide
+     * space for a tuple of this index.
+     *
+     * @return false if there is no such element
+     */
+    virtual bool seek(const TupleRef& low, std::size_t prefixLength, RamDomain* res) const = 0;
+
     /**
      * Return arity size of the index
      */
@@ -483,6 +566,9 @@ std::unique_ptr<InterpreterIndex> createBTreeProvenanceIndex(const Order&);
 // A factory for Brie based index.
 std::unique_ptr<InterpreterIndex> createBrieIndex(const Order&);
 
+// A factory for disk-backed index.
+std::unique_ptr<InterpreterIndex> createDiskIndex(const Order&);
+
 // A factory for indirect index.
 std::unique_ptr<InterpreterIndex> createIndirectIndex(const Order&);
 
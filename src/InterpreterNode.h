@@ -50,16 +50,20 @@ enum InterpreterNodeType {
     I_ParallelScan,
     I_IndexScan,
     I_ParallelIndexScan,
+    I_HashJoin,
     I_Choice,
     I_ParallelChoice,
     I_IndexChoice,
     I_ParallelIndexChoice,
     I_UnpackRecord,
+    I_LeapfrogJoin,
+    I_ParallelLeapfrogJoin,
     I_Aggregate,
     I_IndexAggregate,
     I_Break,
     I_Filter,
     I_Project,
+    I_BufferedProject,
     I_SubroutineReturnValue,
     I_Sequence,
     I_Parallel,
@@ -69,6 +73,8 @@ enum InterpreterNodeType {
     I_LogTimer,
     I_DebugInfo,
     I_Clear,
+    I_Purge,
+    I_Facts,
     I_LogSize,
     I_Load,
     I_Store,
@@ -17,8 +17,12 @@
 
 #pragma once
 
+#include "HashJoin.h"
+#include "InsertBuffer.h"
+#include <algorithm>
 #include <array>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace souffle {
@@ -81,6 +85,64 @@ public:
         viewInfoForNested.push_back({relId, indexPos, viewPos});
     }
 
+    /** @brief Add a hash join, whose hash table is built before the nested operation. */
+    size_t addHashJoin(size_t relId, std::vector<size_t> keyColumns) {
+        hashJoinInfo.push_back({relId, std::move(keyColumns)});
+        hashTables.resize(hashJoinInfo.size());
+        return hashJoinInfo.size() - 1;
+    }
+
+    /** @brief Return relation and key columns of the hash joins */
+    const std::vector<std::pair<size_t, std::vector<size_t>>>& getHashJoinInfo() {
+        return hashJoinInfo;
+    }
+
+    /** @brief Set the hash table of a hash join */
+    void setHashTable(size_t hashJoinPos, std::unique_ptr<HashJoinTable> table) {
+        hashTables[hashJoinPos] = std::move(table);
+    }
+
+    /** @brief Return the hash table of a hash join */
+    const HashJoinTable& getHashTable(size_t hashJoinPos) const {
+        return *hashTables[hashJoinPos];
+    }
+
+    /** @brief Release the hash tables once the nested operation has been executed */
+    void clearHashTables() {
+        for (auto& table : hashTables) {
+            table.reset();
+        }
+    }
+
+    /** @brief Add an insertion buffer, which is merged into its relation after the nested operation. */
+    size_t addInsertBuffer(size_t relId, size_t arity) {
+        insertBufferInfo.push_back(relId);
+        insertBuffers.push_back(std::make_unique<InsertBuffer>(arity));
+        return insertBuffers.size() - 1;
+    }
+
+    /** @brief Return the relations of the insertion buffers */
+    const std::vector<size_t>& getInsertBufferInfo() const {
+        return insertBufferInfo;
+    }
+
+    /** @brief Return an insertion buffer */
+    InsertBuffer& getInsertBuffer(size_t insertBufferPos) const {
+        return *insertBuffers[insertBufferPos];
+    }
+
+    /** @brief Add a relation whose existence checks are guarded by a filter, updated before the query. */
+    void addFilteredRelation(size_t relId) {
+        if (std::find(filteredRelations.begin(), filteredRelations.end(), relId) == filteredRelations.end()) {
+            filteredRelations.push_back(relId);
+        }
+    }
+
+    /** @brief Return the relations whose existence checks are guarded by a filter */
+    const std::vector<size_t>& getFilteredRelations() const {
+        return filteredRelations;
+    }
+
     /** If this preamble contains parallel operation.  */
     bool isParallel = false;
 
@@ -95,6 +157,16 @@ private:
     std::vector<std::array<size_t, 3>> viewInfoForFilter;
     /** Vector of View information in nested operations */
     std::vector<std::array<size_t, 3>> viewInfoForNested;
+    /** Vector of relations and key columns of hash joins */
+    std::vector<std::pair<size_t, std::vector<size_t>>> hashJoinInfo;
+    /** Vector of hash tables of hash joins, built for the duration of the query */
+    std::vector<std::unique_ptr<HashJoinTable>> hashTables;
+    /** Vector of relations of insertion buffers */
+    std::vector<size_t> insertBufferInfo;
+    /** Vector of insertion buffers of buffered projections */
+    std::vector<std::unique_ptr<InsertBuffer>> insertBuffers;
+    /** Vector of relations with filtered existence checks */
+    std::vector<size_t> filteredRelations;
 };
 
 }  // namespace souffle
@@ -41,6 +41,26 @@ public:
         relation.insert(t.data);
     }
 
+    /** Insert tuples given row by row */
+    void insertMany(const RamDomain* rows, std::size_t n) override {
+        size_t arity = getArity();
+        for (size_t row = 0; row < n; row++) {
+            relation.insert(rows + row * arity);
+        }
+    }
+
+    /** Export tuples column by column */
+    void exportColumns(RamDomain* const* columns) const override {
+        size_t arity = getArity();
+        size_t row = 0;
+        for (const RamDomain* t : relation) {
+            for (size_t i = 0; i < arity; i++) {
+                columns[i][row] = t[i];
+            }
+            row++;
+        }
+    }
+
     /** Check whether tuple exists */
     bool contains(const tuple& t) const override {
         return relation.contains(TupleRef(&t.data[0], t.size()));
@@ -58,6 +78,30 @@ public:
                 new InterpreterRelInterface::iterator_base(id, this, relation.end()));
     }
 
+    /** Range of tuples matching a pattern */
+    std::pair<iterator, iterator> equalRange(const tuple& pattern, SearchSignature mask) const override {
+        int indexPos = relation.getIndexPos(mask);
+        if (indexPos < 0) {
+            return Relation::equalRange(pattern, mask);
+        }
+
+        // pad the columns not selected by the mask
+        size_t arity = getArity();
+        std::vector<RamDomain> low(pattern.data, pattern.data + arity);
+        std::vector<RamDomain> high(low);
+        for (size_t i = 0; i < arity; i++) {
+            if (((mask >> i) & 1) == 0) {
+                low[i] = MIN_RAM_DOMAIN;
+                high[i] = MAX_RAM_DOMAIN;
+            }
+        }
+        InterpreterRelation::Iterator first(
+                relation.range(indexPos, TupleRef(low.data(), arity), TupleRef(high.data(), arity)));
+        return std::make_pair(InterpreterRelInterface::iterator(
+                                      new InterpreterRelInterface::iterator_base(id, this, std::move(first))),
+                end());
+    }
+
     /** Get name */
     std::string getName() const override {
         return name;
@@ -253,6 +297,12 @@ public:
         exec.executeSubroutine(name, args, ret);
     }
 
+    /** Run subroutine for a batch of arguments */
+    void executeSubroutineBatch(std::string name, const std::vector<std::vector<RamDomain>>& args,
+            std::vector<std::vector<RamDomain>>& rets) override {
+        exec.executeSubroutine(name, args, rets);
+    }
+
     /** Get symbol table */
     SymbolTable& getSymbolTable() override {
         return symTable;
@@ -27,7 +27,7 @@ namespace souffle {
 InterpreterRelation::InterpreterRelation(std::size_t arity, std::size_t auxiliaryArity, std::string name,
         std::vector<std::string> attributeTypes, const MinIndexSelection& orderSet, IndexFactory factory)
         : relName(std::move(name)), arity(arity), auxiliaryArity(auxiliaryArity),
-          attributeTypes(std::move(attributeTypes)) {
+          attributeTypes(std::move(attributeTypes)), factory(factory) {
     for (auto order : orderSet.getAllOrders()) {
         // Expand the order to a total order
         std::set<int> set;
@@ -40,6 +40,7 @@ InterpreterRelation::InterpreterRelation(std::size_t arity, std::size_t auxiliar
             }
         }
         indexes.push_back(factory(Order(order)));
+        orders.push_back(Order(order));
     }
 
     // Use the first index as default main index
@@ -58,6 +59,7 @@ IndexViewPtr InterpreterRelation::getView(const size_t& indexPos) const {
 }
 
 bool InterpreterRelation::insert(const TupleRef& tuple) {
+    insertIntoFilter(tuple);
     if (!main->insert(tuple)) {
         return false;
     }
@@ -98,6 +100,24 @@ Stream InterpreterRelation::range(const size_t& indexPos, const TupleRef& low, c
     return pos->range(low, high);
 }
 
+int InterpreterRelation::getIndexPos(SearchSignature search) const {
+    for (size_t pos = 0; pos < indexes.size(); pos++) {
+        if (indexes[pos] == nullptr) {
+            continue;
+        }
+        // extend the prefix of the order until it covers the search
+        const auto& order = orders[pos].getOrder();
+        SearchSignature prefix = 0;
+        for (size_t i = 0; prefix != search && i < order.size(); i++) {
+            prefix |= SearchSignature(1) << order[i];
+        }
+        if (prefix == search) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
 PartitionedStream InterpreterRelation::partitionRange(
         const size_t& indexPos, const TupleRef& low, const TupleRef& high, size_t partitionCount) const {
     auto& pos = indexes[indexPos];
@@ -106,6 +126,9 @@ PartitionedStream InterpreterRelation::partitionRange(
 
 void InterpreterRelation::swap(InterpreterRelation& other) {
     indexes.swap(other.indexes);
+    orders.swap(other.orders);
+    std::swap(factory, other.factory);
+    filter.swap(other.filter);
 }
 
 size_t InterpreterRelation::getLevel() const {
@@ -136,6 +159,9 @@ void InterpreterRelation::purge() {
     for (auto& index : indexes) {
         index->clear();
     }
+    if (filter != nullptr) {
+        filter->clear();
+    }
 }
 
 bool InterpreterRelation::exists(const TupleRef& tuple) const {
@@ -144,6 +170,36 @@ bool InterpreterRelation::exists(const TupleRef& tuple) const {
 
 void InterpreterRelation::extend(const InterpreterRelation& rel) {}
 
+bool InterpreterRelation::spill() {
+    if (!canSpill()) {
+        return false;
+    }
+    factory = &createDiskIndex;
+    for (size_t pos = 0; pos < indexes.size(); pos++) {
+        if (indexes[pos] == nullptr) {
+            continue;
+        }
+        auto index = factory(orders[pos]);
+        index->insert(*indexes[pos]);
+        if (main == indexes[pos].get()) {
+            main = index.get();
+        }
+        indexes[pos] = std::move(index);
+    }
+    return true;
+}
+
+void InterpreterRelation::updateFilter() {
+    if (filter == nullptr) {
+        filter = std::make_unique<TupleFilter>(arity);
+    }
+    filter->update(size(), [&](const auto& add) {
+        for (const auto& cur : scan()) {
+            add(cur.getBase());
+        }
+    });
+}
+
 InterpreterEqRelation::InterpreterEqRelation(size_t arity, size_t auxiliaryArity, const std::string& name,
         const std::vector<std::string>& attributeTypes, const MinIndexSelection& orderSet)
         : InterpreterRelation(arity, auxiliaryArity, name, attributeTypes, orderSet, createEqrelIndex) {
@@ -166,6 +222,7 @@ bool InterpreterIndirectRelation::insert(const TupleRef& tuple) {
     if (main->contains(tuple)) {
         return false;
     }
+    insertIntoFilter(tuple);
 
     int blockIndex = numTuples / (BLOCK_SIZE / arity);
     int tupleIndex = (numTuples % (BLOCK_SIZE / arity)) * arity;
@@ -199,7 +256,63 @@ void InterpreterIndirectRelation::purge() {
     for (auto& cur : indexes) {
         cur->clear();
     }
+    if (filter != nullptr) {
+        filter->clear();
+    }
     numTuples = 0;
 }
 
+InterpreterLatticeRelation::InterpreterLatticeRelation(size_t arity, size_t auxiliaryArity,
+        const std::string& name, const std::vector<std::string>& attributeTypes,
+        const MinIndexSelection& orderSet, bool isMax)
+        : InterpreterRelation(arity, auxiliaryArity, name, attributeTypes, orderSet), isMax(isMax) {
+    assert(arity > 0 && "lattice without value column");
+
+    // any full index ending with the value column groups the tuples of a key by their values
+    latticePos = indexes.size();
+    for (size_t pos = 0; pos < orders.size(); pos++) {
+        if (orders[pos].getOrder().back() == static_cast<int>(arity - 1)) {
+            latticePos = pos;
+            break;
+        }
+    }
+    if (latticePos == indexes.size()) {
+        indexes.push_back(factory(Order::create(arity)));
+        orders.push_back(Order::create(arity));
+    }
+}
+
+bool InterpreterLatticeRelation::insert(const TupleRef& tuple) {
+    // concurrent writers, e.g., rules of a parallel statement, must not search the index while
+    // it is modified, hence checking and inserting are serialised
+    auto lease = insertLock.acquire();
+
+    // drop tuples not improving the value of their key
+    if (dominated(tuple) || (dominator != nullptr && dominator->dominated(tuple))) {
+        return false;
+    }
+    return InterpreterRelation::insert(tuple);
+}
+
+bool InterpreterLatticeRelation::insert(const RamDomain* tuple) {
+    return this->insert(TupleRef(tuple, arity));
+}
+
+bool InterpreterLatticeRelation::dominated(const TupleRef& tuple) const {
+    // seek the least stored value of the key, or the least one not below the given value
+    RamDomain low[arity];
+    RamDomain res[arity];
+    for (size_t i = 0; i < arity; i++) {
+        low[i] = tuple[i];
+    }
+    if (!isMax) {
+        low[arity - 1] = MIN_RAM_DOMAIN;
+    }
+    auto view = indexes[latticePos]->createView();
+    if (!view->seek(TupleRef(low, arity), arity - 1, res)) {
+        return false;
+    }
+    return isMax || res[arity - 1] <= tuple[arity - 1];
+}
+
 }  // namespace souffle
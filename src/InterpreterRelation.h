@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include "BloomFilter.h"
 #include "InterpreterIndex.h"
+#include "ParallelUtils.h"
 #include "RamIndexAnalysis.h"
 
 namespace souffle {
@@ -47,6 +49,8 @@ public:
 
         Iterator(const InterpreterRelation& rel) : stream(std::make_unique<Stream>(rel.scan())) {}
 
+        Iterator(Stream&& stream) : stream(std::make_unique<Stream>(std::move(stream))) {}
+
         Iterator(const Iterator& iter) : stream(iter.stream->clone()) {}
 
         Iterator(Iterator&& iter) : stream(std::move(iter.stream)) {}
@@ -130,6 +134,12 @@ public:
      */
     Stream range(const size_t& indexPos, const TupleRef& low, const TupleRef& high) const;
 
+    /**
+     * Obtains the position of an index whose order starts with the columns of the given search,
+     * or -1 if there is no such index.
+     */
+    int getIndexPos(SearchSignature search) const;
+
     /**
      * Obtains a partitioned stream list for parallel computation
      */
@@ -201,7 +211,45 @@ public:
      */
     virtual void extend(const InterpreterRelation& rel);
 
+    /**
+     * Moves the tuples of this relation to disk-backed indexes, unless the
+     * relation is disk-backed already or uses specialised indexes. Must not
+     * run concurrently with any other operation on the relation.
+     *
+     * @return whether the relation has been moved
+     */
+    bool spill();
+
+    /**
+     * Check whether the relation can be moved to disk-backed indexes
+     */
+    bool canSpill() const {
+        return factory == &createBTreeIndex;
+    }
+
+    /**
+     * Creates or adapts the filter guarding existence checks of this relation.
+     * Must not run concurrently with insertions.
+     */
+    void updateFilter();
+
+    /**
+     * Return the filter guarding existence checks, or null if there is none
+     */
+    TupleFilter* getFilter() const {
+        return filter.get();
+    }
+
 protected:
+    /**
+     * Record a tuple in the filter, before it is inserted into the indexes
+     */
+    void insertIntoFilter(const TupleRef& tuple) {
+        if (filter != nullptr) {
+            filter->insert(tuple.getBase());
+        }
+    }
+
     // Relation name
     std::string relName;
 
@@ -217,11 +265,20 @@ protected:
     // a map of managed indexes
     std::vector<std::unique_ptr<InterpreterIndex>> indexes;
 
+    // the orders of the managed indexes
+    std::vector<Order> orders;
+
     // a pointer to the main index within the managed index
     InterpreterIndex* main;
 
     // relation level
     size_t level = 0;
+
+    // the factory of the indexes
+    IndexFactory factory;
+
+    // the filter of existence checks, created once the relation is checked by a query
+    std::unique_ptr<TupleFilter> filter;
 };  // namespace souffle
 
 /**
@@ -259,4 +316,46 @@ private:
 
     size_t numTuples = 0;
 };
+
+/**
+ * Interpreter Lattice Relation
+ *
+ * Keeps the best value of the last column for each key, i.e., each combination of
+ * the other columns. A tuple is dominated if a tuple with the same key and an at
+ * least as good value is stored, and dominated tuples are not inserted. Membership
+ * tests remain exact. Superseded tuples stay in the relation until it is compacted
+ * by the program.
+ */
+class InterpreterLatticeRelation : public InterpreterRelation {
+public:
+    InterpreterLatticeRelation(size_t arity, size_t auxiliaryArity, const std::string& relName,
+            const std::vector<std::string>& attributeTypes, const MinIndexSelection& orderSet,
+            bool isMax);
+
+    /** Insert tuple, unless it is dominated by a tuple of this relation or of the dominator */
+    bool insert(const TupleRef& tuple) override;
+
+    bool insert(const RamDomain* tuple) override;
+
+    /** Tests whether a stored tuple has the key of the given tuple and an at least as good value */
+    bool dominated(const TupleRef& tuple) const;
+
+    /** Set a relation whose tuples dominate the inserted tuples as well, e.g., for new knowledge */
+    void setDominator(const InterpreterLatticeRelation* rel) {
+        dominator = rel;
+    }
+
+private:
+    /** Whether greater values are better */
+    const bool isMax;
+
+    /** Position of an index ordered by the key columns followed by the value column */
+    size_t latticePos;
+
+    /** Relation whose tuples dominate the inserted tuples as well */
+    const InterpreterLatticeRelation* dominator = nullptr;
+
+    /** Serialises the insertions of concurrent writers */
+    Lock insertLock;
+};
 }  // end of namespace souffle
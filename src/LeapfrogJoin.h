@@ -0,0 +1,127 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file LeapfrogJoin.h
+ *
+ * The intersection kernel of leapfrog triejoins, shared by the interpreter
+ * and the synthesised code.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Enumerates the values common to several sorted sets in ascending order,
+ * following the leapfrog join of T. Veldhuizen, "Leapfrog Triejoin: A Simple,
+ * Worst-Case Optimal Join Algorithm" (ICDT 2014).
+ *
+ * The sets are accessed through a seek function with the signature
+ *
+ *     bool seek(std::size_t i, RamDomain value, RamDomain& res)
+ *
+ * that stores the smallest element of the i-th set not less than the given
+ * value in res, and returns false if there is no such element. The sets are
+ * visited round-robin, each seek leaping to the largest value seen so far,
+ * until all sets agree on a value. Hence, the number of seeks is bounded by
+ * the size of the smallest set times the number of sets.
+ *
+ * The enumeration may be restricted to the values in [low, high], such that
+ * the threads of a parallel join enumerate disjoint partitions of the values.
+ */
+template <typename Seek>
+class LeapfrogIntersection {
+public:
+    LeapfrogIntersection(std::size_t numSets, Seek seek, RamDomain low = MIN_RAM_DOMAIN,
+            RamDomain high = MAX_RAM_DOMAIN)
+            : numSets(numSets), seek(std::move(seek)), key(low), high(high) {}
+
+    /**
+     * Obtains the next value of the intersection.
+     *
+     * @return false if the intersection has been exhausted
+     */
+    bool next(RamDomain& value) {
+        if (exhausted) {
+            return false;
+        }
+        RamDomain found;
+        std::size_t agree = 0;
+        while (agree < numSets) {
+            if (!seek(cur, key, found) || found > high) {
+                exhausted = true;
+                return false;
+            }
+            if (found == key) {
+                agree++;
+            } else {
+                key = found;
+                agree = 1;
+            }
+            cur = (cur + 1) % numSets;
+        }
+        value = key;
+        if (key == high) {
+            exhausted = true;
+        } else {
+            key++;
+        }
+        return true;
+    }
+
+private:
+    /** Number of intersected sets */
+    const std::size_t numSets;
+
+    /** Seek function of the sets */
+    Seek seek;
+
+    /** The set to be visited next */
+    std::size_t cur = 0;
+
+    /** The smallest candidate value of the intersection */
+    RamDomain key;
+
+    /** The largest value to be enumerated */
+    const RamDomain high;
+
+    /** Whether the intersection has been exhausted */
+    bool exhausted = false;
+};
+
+/**
+ * Splits the values of a leapfrog join into consecutive ranges [low, high]
+ * covering all values, starting a new range at each of the given points.
+ * The points are typically the values of the first operand at the starts of
+ * the chunks of its index, such that the ranges hold similar numbers of tuples.
+ */
+inline std::vector<std::pair<RamDomain, RamDomain>> splitLeapfrogRange(std::vector<RamDomain> points) {
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    std::vector<std::pair<RamDomain, RamDomain>> res;
+    RamDomain low = MIN_RAM_DOMAIN;
+    for (RamDomain point : points) {
+        if (point != MIN_RAM_DOMAIN) {
+            res.emplace_back(low, point - 1);
+            low = point;
+        }
+    }
+    res.emplace_back(low, MAX_RAM_DOMAIN);
+    return res;
+}
+
+}  // end of namespace souffle
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "ParallelUtils.h"
+#include "PerfCounters.h"
 #include "ProfileEvent.h"
 
 #include <chrono>
@@ -33,7 +34,8 @@ namespace souffle {
  * the corresponding measurements.
  *
  * To far, only execution times are logged. More events, e.g. the number of
- * processed tuples may be added in the future.
+ * processed tuples may be added in the future. If enabled, the hardware
+ * performance counters of all threads during the execution are logged too.
  */
 class Logger {
 public:
@@ -44,16 +46,25 @@ public:
         struct rusage ru {};
         getrusage(RUSAGE_SELF, &ru);
         startMaxRSS = ru.ru_maxrss;
+        startCounts = PerfCounters::instance().read();
         // Assume that if we are logging the progress of an event then we care about usage during that time.
         ProfileEventSingleton::instance().resetTimerInterval();
     }
 
     ~Logger() {
+        PerfCounters::Counts endCounts = PerfCounters::instance().read();
         struct rusage ru {};
         getrusage(RUSAGE_SELF, &ru);
         size_t endMaxRSS = ru.ru_maxrss;
         ProfileEventSingleton::instance().makeTimingEvent(
                 label, start, now(), startMaxRSS, endMaxRSS, size() - preSize, iteration);
+        if (PerfCounters::instance().isEnabled()) {
+            for (size_t event = 0; event < PerfCounters::NUM_EVENTS; event++) {
+                size_t count = endCounts[event] - startCounts[event];
+                ProfileEventSingleton::instance().makeCounterEvent(
+                        label, PerfCounters::getName(event), count, iteration);
+            }
+        }
     }
 
 private:
@@ -63,5 +74,6 @@ private:
     size_t iteration;
     std::function<size_t()> size;
     size_t preSize;
+    PerfCounters::Counts startCounts;
 };
 }  // end of namespace souffle
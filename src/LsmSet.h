@@ -0,0 +1,457 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file LsmSet.h
+ *
+ * A set of tuples spilling to memory-mapped files, organised as a
+ * log-structured merge tree, for relations that do not fit into memory.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BTree.h"
+#include "BloomFilter.h"
+#include "Util.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * The settings shared by all disk-backed sets of a program.
+ */
+struct LsmConfig {
+    /** Returns the directory storing the files of the runs */
+    static std::string& directory() {
+        static std::string dir = std::getenv("TMPDIR") != nullptr ? std::getenv("TMPDIR") : "/tmp";
+        return dir;
+    }
+
+    /** Returns the number of tuples buffered in memory before they are written to a run */
+    static std::size_t& bufferSize() {
+        static std::size_t size = 1 << 20;
+        return size;
+    }
+};
+
+/**
+ * A sorted, immutable sequence of tuples stored in a memory-mapped file.
+ *
+ * The file is removed from the directory as soon as it has been created,
+ * hence its space is reclaimed once the run is released, even if the
+ * program is killed. Pages of a run are evicted by the operating system
+ * under memory pressure without being written back. Each run keeps a
+ * Bloom filter in memory to avoid searching it for absent tuples.
+ */
+template <typename Key, typename Comparator>
+class MappedRun {
+    /** Number of tuples written at once */
+    static constexpr std::size_t BLOCK_SIZE = 4096;
+
+public:
+    /**
+     * Creates a run of the tuples produced by next, which stores the next
+     * tuple in its argument and returns false once there are none left.
+     * The tuples have to be produced in ascending order.
+     */
+    template <typename Next>
+    MappedRun(std::size_t capacity, Next next) : filter(Key::arity, capacity) {
+        std::string path = LsmConfig::directory() + "/souffle-run-XXXXXX";
+        int fd = mkstemp(&path[0]);
+        if (fd < 0) {
+            fail("Cannot create run in " + LsmConfig::directory());
+        }
+        unlink(path.c_str());
+
+        std::vector<Key> block(BLOCK_SIZE);
+        std::size_t filled = 0;
+        while (next(block[filled])) {
+            filter.insert(&block[filled][0]);
+            if (++filled == BLOCK_SIZE) {
+                write(fd, block.data(), filled);
+                filled = 0;
+            }
+        }
+        write(fd, block.data(), filled);
+
+        if (count > 0) {
+            void* map = mmap(nullptr, count * sizeof(Key), PROT_READ, MAP_SHARED, fd, 0);
+            if (map == MAP_FAILED) {
+                close(fd);
+                fail("Cannot map run");
+            }
+            entries = static_cast<const Key*>(map);
+        }
+        close(fd);
+    }
+
+    MappedRun(const MappedRun&) = delete;
+    MappedRun& operator=(const MappedRun&) = delete;
+
+    ~MappedRun() {
+        if (entries != nullptr) {
+            munmap(const_cast<Key*>(entries), count * sizeof(Key));
+        }
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    const Key* begin() const {
+        return entries;
+    }
+
+    const Key* end() const {
+        return entries + count;
+    }
+
+    /** Returns the first tuple not less than the given key */
+    const Key* lower_bound(const Key& key) const {
+        return std::lower_bound(begin(), end(), key,
+                [](const Key& a, const Key& b) { return Comparator().less(a, b); });
+    }
+
+    bool contains(const Key& key) const {
+        if (!filter.mayContain(&key[0])) {
+            return false;
+        }
+        const Key* pos = lower_bound(key);
+        return pos != end() && Comparator().equal(*pos, key);
+    }
+
+private:
+    void write(int fd, const Key* data, std::size_t num) {
+        const char* bytes = reinterpret_cast<const char*>(data);
+        std::size_t remaining = num * sizeof(Key);
+        while (remaining > 0) {
+            ssize_t written = ::write(fd, bytes, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                close(fd);
+                fail("Cannot write run");
+            }
+            bytes += written;
+            remaining -= written;
+        }
+        count += num;
+    }
+
+    [[noreturn]] static void fail(const std::string& message) {
+        throw std::runtime_error(message + ": " + std::strerror(errno));
+    }
+
+    /** Number of tuples of the run */
+    std::size_t count = 0;
+
+    /** The mapped tuples */
+    const Key* entries = nullptr;
+
+    /** Filter of the tuples of the run */
+    BloomFilter filter;
+};
+
+/**
+ * A set of tuples buffering insertions in a B-tree, which is written to a
+ * new run on disk once it is full. Runs are merged such that each run is
+ * at least twice as large as the next younger one, hence a set of n tuples
+ * consists of O(log n) runs. Since a tuple is only inserted if it is
+ * contained in none of the runs, the runs and the buffer are disjoint and
+ * the tuples of the set are enumerated by merging them.
+ *
+ * The set offers the interface of the B-tree sets used by the interpreter.
+ * Insertions are thread-safe; lookups may not run concurrently with them.
+ */
+template <typename Key, typename Comparator>
+class LsmSet {
+    using Buffer = btree_set<Key, Comparator>;
+    using Run = MappedRun<Key, Comparator>;
+
+public:
+    using element_type = Key;
+
+    /** Hints accelerating operations on the buffer */
+    struct operation_hints {
+        typename Buffer::operation_hints buffer;
+    };
+
+    /**
+     * An iterator merging the buffer and the runs.
+     */
+    class iterator : public std::iterator<std::forward_iterator_tag, Key> {
+        typename Buffer::iterator bufferCur;
+        typename Buffer::iterator bufferEnd;
+
+        // the remaining tuples of each run
+        std::vector<std::pair<const Key*, const Key*>> runs;
+
+        // the current tuple, the least of the buffer and the runs, or null at the end
+        const Key* current = nullptr;
+
+        // the run of the current tuple, or -1 for the buffer
+        int source = -1;
+
+    public:
+        iterator() = default;
+
+        iterator(typename Buffer::iterator bufferCur, typename Buffer::iterator bufferEnd,
+                std::vector<std::pair<const Key*, const Key*>> runs)
+                : bufferCur(bufferCur), bufferEnd(bufferEnd), runs(std::move(runs)) {
+            select();
+        }
+
+        // all iterators at the same tuple agree on the position in every run, as those
+        // point to the first tuple not less than the current one
+        bool operator==(const iterator& other) const {
+            return current == other.current;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return current != other.current;
+        }
+
+        const Key& operator*() const {
+            return *current;
+        }
+
+        iterator& operator++() {
+            if (source < 0) {
+                ++bufferCur;
+            } else {
+                ++runs[source].first;
+            }
+            select();
+            return *this;
+        }
+
+    private:
+        void select() {
+            Comparator comp;
+            current = nullptr;
+            if (bufferCur != bufferEnd) {
+                current = &*bufferCur;
+                source = -1;
+            }
+            for (std::size_t i = 0; i < runs.size(); i++) {
+                const Key* head = runs[i].first;
+                if (head != runs[i].second && (current == nullptr || comp.less(*head, *current))) {
+                    current = head;
+                    source = i;
+                }
+            }
+        }
+    };
+
+    LsmSet() = default;
+
+    LsmSet(const LsmSet&) = delete;
+    LsmSet& operator=(const LsmSet&) = delete;
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    /** Returns the number of runs on disk */
+    std::size_t getNumRuns() const {
+        return runs.size();
+    }
+
+    bool insert(const Key& key) {
+        operation_hints hints;
+        return insert(key, hints);
+    }
+
+    bool insert(const Key& key, operation_hints& hints) {
+        {
+            std::shared_lock<std::shared_mutex> guard(lock);
+            for (const auto& run : runs) {
+                if (run->contains(key)) {
+                    return false;
+                }
+            }
+            if (!buffer.insert(key, hints.buffer)) {
+                return false;
+            }
+            count++;
+            if (++buffered < LsmConfig::bufferSize()) {
+                return true;
+            }
+        }
+        flush();
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        operation_hints hints;
+        return contains(key, hints);
+    }
+
+    bool contains(const Key& key, operation_hints& hints) const {
+        if (buffer.contains(key, hints.buffer)) {
+            return true;
+        }
+        for (const auto& run : runs) {
+            if (run->contains(key)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    iterator begin() const {
+        std::vector<std::pair<const Key*, const Key*>> cursors;
+        for (const auto& run : runs) {
+            cursors.emplace_back(run->begin(), run->end());
+        }
+        return iterator(buffer.begin(), buffer.end(), std::move(cursors));
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    iterator lower_bound(const Key& key) const {
+        operation_hints hints;
+        return lower_bound(key, hints);
+    }
+
+    iterator lower_bound(const Key& key, operation_hints& hints) const {
+        std::vector<std::pair<const Key*, const Key*>> cursors;
+        for (const auto& run : runs) {
+            cursors.emplace_back(run->lower_bound(key), run->end());
+        }
+        return iterator(buffer.lower_bound(key, hints.buffer), buffer.end(), std::move(cursors));
+    }
+
+    /**
+     * Splits the set into ranges of similar sizes, divided at tuples of the
+     * largest run, or of the buffer if there are no runs.
+     */
+    std::vector<souffle::range<iterator>> partition(int num) const {
+        std::vector<Key> splits;
+        const Run* largest = nullptr;
+        for (const auto& run : runs) {
+            if (largest == nullptr || run->size() > largest->size()) {
+                largest = run.get();
+            }
+        }
+        if (largest != nullptr) {
+            for (int i = 1; i < num; i++) {
+                splits.push_back(largest->begin()[largest->size() * i / num]);
+            }
+        } else {
+            auto chunks = buffer.partition(num);
+            for (std::size_t i = 1; i < chunks.size(); i++) {
+                splits.push_back(*chunks[i].begin());
+            }
+        }
+
+        std::vector<souffle::range<iterator>> res;
+        iterator from = begin();
+        for (const Key& split : splits) {
+            iterator to = lower_bound(split);
+            if (from != to) {
+                res.push_back({from, to});
+            }
+            from = to;
+        }
+        if (from != end()) {
+            res.push_back({from, end()});
+        }
+        return res;
+    }
+
+    void clear() {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        buffer.clear();
+        runs.clear();
+        buffered = 0;
+        count = 0;
+    }
+
+private:
+    /** Writes the buffer to a new run and merges runs of similar sizes */
+    void flush() {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        // the buffer may have been written by another thread meanwhile
+        if (buffered < LsmConfig::bufferSize()) {
+            return;
+        }
+        auto cur = buffer.begin();
+        auto end = buffer.end();
+        runs.push_back(std::make_unique<Run>(buffered.load(), [&](Key& next) {
+            if (cur == end) {
+                return false;
+            }
+            next = *cur;
+            ++cur;
+            return true;
+        }));
+        buffer.clear();
+        buffered = 0;
+
+        while (runs.size() > 1 && runs[runs.size() - 2]->size() <= 2 * runs.back()->size()) {
+            const Run& older = *runs[runs.size() - 2];
+            const Run& younger = *runs.back();
+            const Key* a = older.begin();
+            const Key* b = younger.begin();
+            Comparator comp;
+            auto merged = std::make_unique<Run>(older.size() + younger.size(), [&](Key& next) {
+                if (a == older.end() && b == younger.end()) {
+                    return false;
+                }
+                if (b == younger.end() || (a != older.end() && comp.less(*a, *b))) {
+                    next = *a++;
+                } else {
+                    next = *b++;
+                }
+                return true;
+            });
+            runs.pop_back();
+            runs.back() = std::move(merged);
+        }
+    }
+
+    /** The tuples inserted since the last run was written */
+    Buffer buffer;
+
+    /** Number of tuples of the buffer */
+    std::atomic<std::size_t> buffered{0};
+
+    /** The runs, from the oldest and largest to the youngest */
+    std::vector<std::unique_ptr<Run>> runs;
+
+    /** Number of tuples of the set */
+    std::atomic<std::size_t> count{0};
+
+    /** Excludes concurrent insertions while the buffer is written */
+    std::shared_mutex lock;
+};
+
+}  // end of namespace souffle
@@ -223,6 +223,9 @@ void updateQualifier(AstRelation* originalRelation, AstRelation* newRelation) {
         currentQualifier |= EQREL_RELATION;
     }
 
+    // adorned lattices keep the best value of each key as well
+    currentQualifier |= originalRelation->getQualifier() & (MIN_LATTICE_RELATION | MAX_LATTICE_RELATION);
+
     newRelation->setQualifier(currentQualifier);
 }
 
@@ -26,307 +26,248 @@
 #include "AstTranslationUnit.h"
 #include "AstUtils.h"
 #include "AstVisitor.h"
+#include "Util.h"
+#include <algorithm>
+#include <functional>
 #include <map>
 #include <memory>
-#include <stack>
+#include <set>
 #include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace souffle {
 
 /**
- * Extract valid permutations from a given permutation matrix of valid moves.
+ * A clause prepared for equivalence checks. The atoms of the clause, with the
+ * head as atom 0, refer to their variables by index, and atoms and variables
+ * are coloured by colour refinement over the graph connecting each atom to its
+ * arguments.
+ *
+ * The colours and the hash of the clause are invariant under the renaming of
+ * variables and the reordering of body atoms, so that equivalent clauses have
+ * equal hashes. Clauses with equal hashes are confirmed to be equivalent by an
+ * exact search for an isomorphism, which only pairs up atoms and variables of
+ * the same colour.
  */
-std::vector<std::vector<unsigned int>> extractPermutations(
-        const std::vector<std::vector<unsigned int>>& permutationMatrix) {
-    size_t clauseSize = permutationMatrix.size();
-    // keep track of the possible end-positions of each atom in the first clause
-    std::vector<std::vector<unsigned int>> validMoves;
-    for (size_t i = 0; i < clauseSize; i++) {
-        std::vector<unsigned int> currentRow;
-        for (size_t j = 0; j < clauseSize; j++) {
-            if (permutationMatrix[i][j] == 1) {
-                currentRow.push_back(j);
+class CanonicalClause {
+public:
+    /**
+     * Prepares the given clause, where the name of its head relation is only
+     * taken into account if requested.
+     */
+    CanonicalClause(const AstClause& clause, bool withHeadName) {
+        // only check equivalence for a subset of the possible clauses
+        // i.e. avoid clauses with constraints or negations
+        // TODO (azreika): extend to constraints and negations
+        for (AstLiteral* lit : clause.getBodyLiterals()) {
+            if (dynamic_cast<AstAtom*>(lit) == nullptr) {
+                return;
             }
         }
-        validMoves.push_back(currentRow);
-    }
-
-    // extract the possible permutations, DFS style
-    std::vector<std::vector<unsigned int>> permutations;
-    std::vector<unsigned int> seen(clauseSize);
-    std::vector<unsigned int> currentPermutation;
-    std::stack<std::vector<unsigned int>> todoStack;
 
-    todoStack.push(validMoves[0]);
-
-    size_t currentIdx = 0;
-    while (!todoStack.empty()) {
-        if (currentIdx == clauseSize) {
-            // permutation is complete
-            permutations.push_back(currentPermutation);
+        std::vector<const AstAtom*> clauseAtoms = {clause.getHead()};
+        for (const AstAtom* atom : clause.getAtoms()) {
+            clauseAtoms.push_back(atom);
+        }
 
-            if (currentIdx == 0) {
-                // already at starting position, so no more permutations possible
-                break;
+        // translate the atoms, only allowing constants and variables as arguments
+        std::map<std::string, size_t> variables;
+        for (const AstAtom* atom : clauseAtoms) {
+            bool isHead = atoms.empty();
+            std::string name = (!isHead || withHeadName) ? toString(atom->getName()) : "";
+            atoms.push_back({combine(combine(std::hash<std::string>()(name), atom->getArity()), isHead), {}});
+            for (const AstArgument* arg : atom->getArguments()) {
+                if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                    auto pos = variables.insert(std::make_pair(var->getName(), variables.size())).first;
+                    atoms.back().arguments.push_back({static_cast<int>(pos->second), 0});
+                } else if (const auto* cst = dynamic_cast<const AstConstant*>(arg)) {
+                    size_t label = combine(typeid(*cst).hash_code(), cst->getRamRepresentation());
+                    atoms.back().arguments.push_back({-1, label});
+                } else {
+                    atoms.clear();
+                    return;
+                }
             }
-
-            // undo the last number added to the permutation
-            currentIdx--;
-            seen[currentPermutation[currentIdx]] = 0;
-            currentPermutation.pop_back();
-
-            // see if we can pick up other permutations
-            continue;
         }
-
-        // pull out the possibilities for the current point of the permutation
-        std::vector<unsigned int> possibilities = todoStack.top();
-        todoStack.pop();
-        if (possibilities.empty()) {
-            // no more possibilities at this point, so undo our last move
-
-            if (currentIdx == 0) {
-                // already at starting position, so no more permutations possible
-                break;
+        valid = true;
+
+        // collect the occurrences of each variable
+        std::vector<std::vector<std::pair<size_t, size_t>>> occurrences(variables.size());
+        for (size_t i = 0; i < atoms.size(); i++) {
+            for (size_t j = 0; j < atoms[i].arguments.size(); j++) {
+                if (atoms[i].arguments[j].variable >= 0) {
+                    occurrences[atoms[i].arguments[j].variable].push_back(std::make_pair(i, j));
+                }
             }
-
-            currentIdx--;
-            seen[currentPermutation[currentIdx]] = 0;
-            currentPermutation.pop_back();
-
-            // continue looking for permutations
-            continue;
         }
 
-        // try the next possibility
-        unsigned int nextNum = possibilities[0];
-
-        // update the possibility vector for the current position
-        possibilities.erase(possibilities.begin());
-        todoStack.push(possibilities);
+        // refine the colours until the partition into colour classes is stable; as each new colour
+        // includes the old one, this is the case once the number of colours stops increasing
+        variableColours.assign(variables.size(), 0);
+        size_t numColours = countColours();
+        for (size_t round = 0; round <= atoms.size() + variables.size(); round++) {
+            std::vector<size_t> newVariableColours(variableColours.size());
+            for (size_t v = 0; v < variableColours.size(); v++) {
+                std::vector<size_t> neighbours;
+                for (const auto& occurrence : occurrences[v]) {
+                    neighbours.push_back(combine(atoms[occurrence.first].colour, occurrence.second));
+                }
+                std::sort(neighbours.begin(), neighbours.end());
+                newVariableColours[v] = variableColours[v];
+                for (size_t neighbour : neighbours) {
+                    newVariableColours[v] = combine(newVariableColours[v], neighbour);
+                }
+            }
+            for (Atom& atom : atoms) {
+                for (const Argument& arg : atom.arguments) {
+                    atom.colour = combine(atom.colour,
+                            arg.variable >= 0 ? combine(1, variableColours[arg.variable])
+                                              : combine(2, arg.constant));
+                }
+            }
+            variableColours = std::move(newVariableColours);
 
-        if (seen[nextNum] != 0u) {
-            // number already seen in this permutation
-            continue;
-        } else {
-            // number can be used
-            seen[nextNum] = 1;
-            currentPermutation.push_back(nextNum);
-            currentIdx++;
-
-            // if we havent reached the end of the permutation,
-            // push up the valid moves for the next position
-            if (currentIdx < clauseSize) {
-                todoStack.push(validMoves[currentIdx]);
+            size_t newNumColours = countColours();
+            if (newNumColours == numColours) {
+                break;
             }
+            numColours = newNumColours;
         }
-    }
 
-    // found all permutations
-    return permutations;
-}
-
-/**
- * Check if the atom at leftIdx in the left clause can potentially be matched up
- * with the atom at rightIdx in the right clause.
- * NOTE: index 0 refers to the head atom, index 1 to the first body atom, and so on.
- */
-bool isValidMove(const AstClause* left, size_t leftIdx, const AstClause* right, size_t rightIdx) {
-    // invalid indices
-    if (leftIdx < 0 || rightIdx < 0) {
-        return false;
+        // hash the multiset of atom colours
+        std::vector<size_t> colours;
+        for (const Atom& atom : atoms) {
+            colours.push_back(atom.colour);
+        }
+        std::sort(colours.begin(), colours.end());
+        for (size_t colour : colours) {
+            hash = combine(hash, colour);
+        }
     }
 
-    // handle the case where one of the indices refers to the head
-    if (leftIdx == 0 && rightIdx == 0) {
-        const AstAtom* leftHead = left->getHead()->getAtom();
-        const AstAtom* rightHead = right->getHead()->getAtom();
-        return leftHead->getName() == rightHead->getName();
-    } else if (leftIdx == 0 || rightIdx == 0) {
-        return false;
+    /** Whether the clause is supported by the equivalence check */
+    bool isValid() const {
+        return valid;
     }
 
-    // both must hence be body atoms
-    int leftBodyAtomIdx = leftIdx - 1;
-    const AstAtom* leftAtom = dynamic_cast<AstAtomLiteral*>(left->getBodyLiteral(leftBodyAtomIdx))->getAtom();
-
-    int rightBodyAtomIdx = rightIdx - 1;
-    const AstAtom* rightAtom =
-            dynamic_cast<AstAtomLiteral*>(right->getBodyLiteral(rightBodyAtomIdx))->getAtom();
-
-    return leftAtom->getName() == rightAtom->getName();
-}
-
-/**
- * Check whether a valid variable mapping exists for the given permutation.
- */
-bool isValidPermutation(
-        const AstClause* left, const AstClause* right, const std::vector<unsigned int>& permutation) {
-    // --- perform the permutation ---
-
-    auto reorderedLeft = std::unique_ptr<AstClause>(left->clone());
-
-    // deduce the body atom permutation from the full clause permutation
-    std::vector<unsigned int> bodyPermutation(permutation.begin() + 1, permutation.end());
-    for (unsigned int& i : bodyPermutation) {
-        i -= 1;
+    /** Hash of the clause, which is equal for equivalent clauses */
+    size_t getHash() const {
+        return hash;
     }
 
-    // currently, <permutation[i] == j> indicates that atom i should map to position j
-    // internally, for the clause class' reordering function, <permutation[i] == j> indicates
-    // that position i should contain atom j
-    // rearrange the permutation to match the internals
-    // TODO (azreika): perhaps change the internal reordering strategy because this came up in MST too
-    std::vector<unsigned int> reorderedPermutation(bodyPermutation.size());
-    for (size_t i = 0; i < bodyPermutation.size(); i++) {
-        reorderedPermutation[bodyPermutation[i]] = i;
+    /**
+     * Checks whether the two clauses are bijectively equivalent, i.e., whether
+     * there is a bijection between their variables and body atoms under which
+     * the clauses are equal.
+     */
+    bool isEquivalent(const CanonicalClause& other) const {
+        if (!valid || !other.valid || hash != other.hash || atoms.size() != other.atoms.size() ||
+                variableColours.size() != other.variableColours.size()) {
+            return false;
+        }
+        std::vector<int> forward(variableColours.size(), -1);
+        std::vector<int> backward(variableColours.size(), -1);
+        std::vector<bool> used(atoms.size(), false);
+        return matchAtoms(other, 0, forward, backward, used);
     }
 
-    // perform the permutation
-    reorderedLeft->reorderAtoms(reorderedPermutation);
-
-    // --- check if a valid variable exists corresponding to this permutation ---
-
-    std::map<std::string, std::string> variableMap;
-    visitDepthFirst(*reorderedLeft, [&](const AstVariable& var) { variableMap[var.getName()] = ""; });
-
-    // need to match the variables in the body
-    std::vector<AstLiteral*> leftAtoms = reorderedLeft->getBodyLiterals();
-    std::vector<AstLiteral*> rightAtoms = right->getBodyLiterals();
-
-    // need to match the variables in the head
-    leftAtoms.push_back(reorderedLeft->getHead());
-    rightAtoms.push_back(right->getHead());
-
-    // check if a valid variable mapping exists
-    auto isVariable = [&](const AstArgument* arg) {
-        return dynamic_cast<const AstVariable*>(arg) != nullptr;
+private:
+    /** An argument of an atom, either a variable index or a constant */
+    struct Argument {
+        int variable;
+        size_t constant;
     };
 
-    auto isConstant = [&](const AstArgument* arg) {
-        return dynamic_cast<const AstConstant*>(arg) != nullptr;
+    /** An atom and its colour */
+    struct Atom {
+        size_t colour;
+        std::vector<Argument> arguments;
     };
 
-    bool validMapping = true;
-    for (size_t i = 0; i < leftAtoms.size() && validMapping; i++) {
-        // match arguments
-        std::vector<AstArgument*> leftArgs =
-                dynamic_cast<AstAtomLiteral*>(leftAtoms[i])->getAtom()->getArguments();
-        std::vector<AstArgument*> rightArgs =
-                dynamic_cast<AstAtomLiteral*>(rightAtoms[i])->getAtom()->getArguments();
-
-        for (size_t j = 0; j < leftArgs.size(); j++) {
-            AstArgument* leftArg = leftArgs[j];
-            AstArgument* rightArg = rightArgs[j];
-            if (isVariable(leftArg) && isVariable(rightArg)) {
-                // both variables, their names should match to each other through the clause
-                std::string leftVarName = dynamic_cast<AstVariable*>(leftArg)->getName();
-                std::string rightVarName = dynamic_cast<AstVariable*>(rightArg)->getName();
-
-                std::string currentMap = variableMap[leftVarName];
-                if (currentMap.empty()) {
-                    // unassigned yet, so assign it appropriately
-                    variableMap[leftVarName] = rightVarName;
-                } else if (currentMap != rightVarName) {
-                    // mapping is inconsistent!
-                    // clauses cannot be equivalent under this permutation
-                    validMapping = false;
-                    break;
-                }
-            } else if (isConstant(leftArg) && isConstant(rightArg)) {
-                // check if its the same constant
-                auto leftCst = dynamic_cast<AstConstant*>(leftArg)->getRamRepresentation();
-                auto rightCst = dynamic_cast<AstConstant*>(rightArg)->getRamRepresentation();
-
-                if (leftCst != rightCst) {
-                    // constants don't match, failed!
-                    validMapping = false;
-                    break;
-                }
-            } else {
-                // not the same type, failed!
-                validMapping = false;
-                break;
-            }
-        }
+    /** Combines a value into a hash */
+    static size_t combine(size_t seed, size_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
     }
 
-    // return whether a valid variable mapping exists for this permutation
-    return validMapping;
-}
+    /** Counts the number of distinct atom and variable colours */
+    size_t countColours() const {
+        std::set<size_t> atomColours;
+        for (const Atom& atom : atoms) {
+            atomColours.insert(atom.colour);
+        }
+        return atomColours.size() + std::set<size_t>(variableColours.begin(), variableColours.end()).size();
+    }
 
-/**
- * Check whether two clauses are bijectively equivalent.
- */
-bool areBijectivelyEquivalent(const AstClause* left, const AstClause* right) {
-    // only check bijective equivalence for a subset of the possible clauses
-    auto isValidClause = [&](const AstClause* clause) {
-        // check that all body literals are atoms
-        // i.e. avoid clauses with constraints or negations
-        // TODO (azreika): extend to constraints and negations
-        for (AstLiteral* lit : clause->getBodyLiterals()) {
-            if (dynamic_cast<AstAtom*>(lit) == nullptr) {
-                return false;
-            }
+    /**
+     * Extends the variable mapping given by forward and backward, such that
+     * the atoms up to idx are mapped to unused atoms of the other clause.
+     */
+    bool matchAtoms(const CanonicalClause& other, size_t idx, std::vector<int>& forward,
+            std::vector<int>& backward, std::vector<bool>& used) const {
+        if (idx == atoms.size()) {
+            return true;
         }
 
-        // check that all arguments are either constants or variables
-        // i.e. only allow primitive arguments
-        bool valid = true;
-        visitDepthFirst(*clause, [&](const AstArgument& arg) {
-            if (dynamic_cast<const AstVariable*>(&arg) == nullptr &&
-                    dynamic_cast<const AstConstant*>(&arg) == nullptr) {
-                valid = false;
+        // the head can only be mapped to the head
+        size_t first = (idx == 0) ? 0 : 1;
+        size_t last = (idx == 0) ? 1 : atoms.size();
+        for (size_t j = first; j < last; j++) {
+            if (used[j] || atoms[idx].colour != other.atoms[j].colour) {
+                continue;
             }
-        });
-        return valid;
-    };
 
-    if (!isValidClause(left) || !isValidClause(right)) {
-        return false;
-    }
+            // map the arguments, remembering the newly mapped variables
+            std::vector<int> mapped;
+            bool ok = true;
+            for (size_t k = 0; k < atoms[idx].arguments.size() && ok; k++) {
+                const Argument& left = atoms[idx].arguments[k];
+                const Argument& right = other.atoms[j].arguments[k];
+                if (left.variable < 0 || right.variable < 0) {
+                    ok = left.variable == right.variable && left.constant == right.constant;
+                } else if (forward[left.variable] < 0 && backward[right.variable] < 0) {
+                    ok = variableColours[left.variable] == other.variableColours[right.variable];
+                    if (ok) {
+                        forward[left.variable] = right.variable;
+                        backward[right.variable] = left.variable;
+                        mapped.push_back(left.variable);
+                    }
+                } else {
+                    ok = forward[left.variable] == right.variable;
+                }
+            }
 
-    // rules must be the same length to be equal
-    if (left->getBodyLiterals().size() != right->getBodyLiterals().size()) {
-        return false;
-    }
+            if (ok) {
+                used[j] = true;
+                if (matchAtoms(other, idx + 1, forward, backward, used)) {
+                    return true;
+                }
+                used[j] = false;
+            }
 
-    // head atoms must have the same arity
-    if (left->getHead()->getArity() != right->getHead()->getArity()) {
+            // undo the mapping of this atom
+            for (int var : mapped) {
+                backward[forward[var]] = -1;
+                forward[var] = -1;
+            }
+        }
         return false;
     }
 
-    // set up the n x n permutation matrix, where n is the number of
-    // atoms in the clause, including the head atom
-    size_t size = left->getBodyLiterals().size() + 1;
-    auto permutationMatrix = std::vector<std::vector<unsigned int>>(size);
-    for (auto& i : permutationMatrix) {
-        i = std::vector<unsigned int>(size);
-    }
+    /** Whether the clause is supported */
+    bool valid = false;
 
-    // create permutation matrix
-    permutationMatrix[0][0] = 1;
-    for (size_t i = 1; i < size; i++) {
-        for (size_t j = 1; j < size; j++) {
-            if (isValidMove(left, i, right, j)) {
-                permutationMatrix[i][j] = 1;
-            }
-        }
-    }
+    /** Head atom followed by the body atoms */
+    std::vector<Atom> atoms;
 
-    // check if any of these permutations have valid variable mappings associated with them
-    std::vector<std::vector<unsigned int>> permutations = extractPermutations(permutationMatrix);
-    for (auto permutation : permutations) {
-        if (isValidPermutation(left, right, permutation)) {
-            // valid permutation with valid corresponding variable mapping exists
-            // therefore, the two clauses are equivalent!
-            return true;
-        }
-    }
+    /** Colour of each variable */
+    std::vector<size_t> variableColours;
 
-    return false;
-}
+    /** Hash of the clause */
+    size_t hash = 0;
+};
 
 /**
  * Reduces locally-redundant clauses.
@@ -339,30 +280,26 @@ bool reduceLocallyEquivalentClauses(AstTranslationUnit& translationUnit) {
 
     std::vector<AstClause*> clausesToDelete;
 
-    // split up each relation's rules into equivalence classes
+    // split up each relation's rules into equivalence classes, only comparing clauses with equal hashes
     // TODO (azreika): consider turning this into an ast analysis instead
     for (AstRelation* rel : program.getRelations()) {
-        std::vector<std::vector<AstClause*>> equivalenceClasses;
+        std::unordered_map<size_t, std::vector<CanonicalClause>> representatives;
 
         for (AstClause* clause : rel->getClauses()) {
-            bool added = false;
-
-            for (std::vector<AstClause*>& eqClass : equivalenceClasses) {
-                AstClause* rep = eqClass[0];
-
-                if (areBijectivelyEquivalent(rep, clause)) {
-                    // clause belongs to an existing equivalence class, so delete it
-                    eqClass.push_back(clause);
-                    clausesToDelete.push_back(clause);
-                    added = true;
-                    break;
-                }
+            CanonicalClause canonical(*clause, true);
+            if (!canonical.isValid()) {
+                // clause is not supported, so keep it
+                continue;
             }
 
-            if (!added) {
+            std::vector<CanonicalClause>& candidates = representatives[canonical.getHash()];
+            if (std::any_of(candidates.begin(), candidates.end(),
+                        [&](const CanonicalClause& rep) { return rep.isEquivalent(canonical); })) {
+                // clause belongs to an existing equivalence class, so delete it
+                clausesToDelete.push_back(clause);
+            } else {
                 // clause does not belong to any existing equivalence class, so keep it
-                std::vector<AstClause*> clauseToAdd = {clause};
-                equivalenceClasses.push_back(clauseToAdd);
+                candidates.push_back(std::move(canonical));
             }
         }
     }
@@ -403,24 +340,24 @@ bool reduceSingletonRelations(AstTranslationUnit& translationUnit) {
     // Keep track of canonical relation name for each redundant clause
     std::map<AstRelationIdentifier, AstRelationIdentifier> canonicalName;
 
-    // Check pairwise equivalence of each singleton relation
-    for (size_t i = 0; i < singletonRelationClauses.size(); i++) {
-        AstClause* first = singletonRelationClauses[i];
-        if (redundantClauses.find(first) != redundantClauses.end()) {
-            // Already found to be redundant, no need to check
+    // Split the singleton relations into equivalence classes, only comparing clauses with equal hashes
+    // Note: Bijective-equivalence check does not care about the head relation name
+    using Representative = std::pair<CanonicalClause, AstRelationIdentifier>;
+    std::unordered_map<size_t, std::vector<Representative>> representatives;
+    for (AstClause* clause : singletonRelationClauses) {
+        CanonicalClause canonical(*clause, false);
+        if (!canonical.isValid()) {
             continue;
         }
 
-        for (size_t j = i + 1; j < singletonRelationClauses.size(); j++) {
-            AstClause* second = singletonRelationClauses[j];
-
-            // Note: Bijective-equivalence check does not care about the head relation name
-            if (areBijectivelyEquivalent(first, second)) {
-                AstRelationIdentifier firstName = first->getHead()->getName();
-                AstRelationIdentifier secondName = second->getHead()->getName();
-                redundantClauses.insert(second);
-                canonicalName.insert(std::pair(secondName, firstName));
-            }
+        auto& candidates = representatives[canonical.getHash()];
+        auto rep = std::find_if(candidates.begin(), candidates.end(),
+                [&](const Representative& candidate) { return candidate.first.isEquivalent(canonical); });
+        if (rep != candidates.end()) {
+            redundantClauses.insert(clause);
+            canonicalName.insert(std::pair(clause->getHead()->getName(), rep->second));
+        } else {
+            candidates.emplace_back(std::move(canonical), clause->getHead()->getName());
         }
     }
 
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "SignalHandler.h"
 #include <atomic>
 
 #ifdef _OPENMP
@@ -31,9 +32,17 @@
 #define pthread_yield pthread_yield_np
 #endif
 
-// support for a parallel region
-#define PARALLEL_START _Pragma("omp parallel") {
-#define PARALLEL_END }
+// support for a parallel region, whose threads take over the rule of the thread starting it
+#define PARALLEL_START                                                 \
+    {                                                                  \
+        const char* parallelMsg = souffle::SignalHandler::threadMsg(); \
+        _Pragma("omp parallel") {                                      \
+            souffle::SignalHandler::threadMsg() = parallelMsg;
+#define PARALLEL_END                                   \
+    souffle::SignalHandler::threadMsg() = nullptr;     \
+    }                                                  \
+    souffle::SignalHandler::threadMsg() = parallelMsg; \
+    }
 
 // support for parallel loops
 #define pfor _Pragma("omp for schedule(dynamic)") for
@@ -94,8 +103,10 @@
 
 #ifdef IS_PARALLEL
 #define MAX_THREADS (omp_get_max_threads())
+#define THREAD_ID (omp_get_thread_num())
 #else
 #define MAX_THREADS (1)
+#define THREAD_ID (0)
 #endif
 
 #ifdef IS_PARALLEL
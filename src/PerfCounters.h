@@ -0,0 +1,202 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file PerfCounters.h
+ *
+ * Hardware performance counters of all threads of the process, read by
+ * the logger of the profiler.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdlib>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace souffle {
+
+/**
+ * Class PerfCounters counts CPU cycles, instructions, last-level cache
+ * misses and data TLB misses of the user code of each thread, using
+ * perf_event_open. Counters are opened for each thread when it is first
+ * seen, and read summed over all threads, such that the difference of
+ * two reads gives the events of all threads in between.
+ *
+ * The counters are optional: they have to be enabled, and stay disabled
+ * if the system does not provide them (e.g. not on Linux, in virtual
+ * machines, or if perf_event_paranoid forbids them). Events that are not
+ * supported by the CPU are counted as zero.
+ * The counters are implemented as a singleton.
+ */
+class PerfCounters {
+public:
+    static constexpr size_t NUM_EVENTS = 4;
+
+    using Counts = std::array<uint64_t, NUM_EVENTS>;
+
+    // get singleton
+    static PerfCounters& instance() {
+        static PerfCounters singleton;
+        return singleton;
+    }
+
+    /** get the name of an event as stored in the profile */
+    static const char* getName(size_t event) {
+        static const char* names[NUM_EVENTS] = {"cycles", "instructions", "llc-misses", "dtlb-misses"};
+        return names[event];
+    }
+
+    /***
+     * enable the counters, if the system provides them
+     */
+    void enable() {
+#ifdef __linux__
+        std::lock_guard<std::mutex> guard(mutex);
+        if (enabled) {
+            return;
+        }
+        int fd = openCounter(0, 0);
+        if (fd < 0) {
+            std::cerr << "Warning: hardware performance counters are not available (" << strerror(errno)
+                      << ")\n";
+            return;
+        }
+        close(fd);
+        enabled = true;
+#else
+        std::cerr << "Warning: hardware performance counters are only available on Linux\n";
+#endif
+    }
+
+    /** return whether the counters are read */
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    /***
+     * read the counts of all threads, which are zero if the counters are disabled
+     */
+    Counts read() {
+        Counts counts{};
+#ifdef __linux__
+        if (!enabled) {
+            return counts;
+        }
+        std::lock_guard<std::mutex> guard(mutex);
+        openNewThreads();
+        for (const auto& thread : threads) {
+            for (size_t event = 0; event < NUM_EVENTS; event++) {
+                counts[event] += readCounter(thread.second[event]);
+            }
+        }
+#endif
+        return counts;
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (const auto& thread : threads) {
+            for (int fd : thread.second) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+        }
+#endif
+    }
+
+private:
+    bool enabled = false;
+
+    std::mutex mutex;
+
+    /** file descriptors of the counters of each thread, -1 if an event is not supported */
+    std::map<long, std::array<int, NUM_EVENTS>> threads;
+
+    PerfCounters() = default;
+
+#ifdef __linux__
+    /** open the counter of an event for a thread, where 0 is the calling thread */
+    static int openCounter(long tid, size_t event) {
+        struct perf_event_attr attr {};
+        attr.size = sizeof(attr);
+        switch (event) {
+            case 0:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case 1:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case 2:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            default:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+        }
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // scale the counts if the events are multiplexed on fewer hardware counters
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+    }
+
+    /** read the count of a counter, scaled to the time it was enabled */
+    static uint64_t readCounter(int fd) {
+        // the count, and the times the counter was enabled and running
+        uint64_t values[3] = {0, 0, 0};
+        auto size = static_cast<ssize_t>(sizeof(values));
+        if (fd < 0 || ::read(fd, values, sizeof(values)) != size || values[2] == 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+    }
+
+    /** open the counters of threads started since the last read */
+    void openNewThreads() {
+        DIR* dir = opendir("/proc/self/task");
+        if (dir == nullptr) {
+            return;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            long tid = std::strtol(entry->d_name, nullptr, 10);
+            if (tid <= 0 || threads.find(tid) != threads.end()) {
+                continue;
+            }
+            std::array<int, NUM_EVENTS>& fds = threads[tid];
+            for (size_t event = 0; event < NUM_EVENTS; event++) {
+                fds[event] = openCounter(tid, event);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+};
+
+}  // namespace souffle
@@ -18,7 +18,9 @@
 
 #include "EventProcessor.h"
 #include "ProfileDatabase.h"
+#include "SampleProfiler.h"
 #include "Util.h"
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
@@ -85,6 +87,36 @@ public:
         profile::EventProcessorSingleton::instance().process(database, txt.c_str(), number, iteration);
     }
 
+    /** create hardware counter event of a timing event */
+    void makeCounterEvent(
+            const std::string& txt, const std::string& counter, size_t number, size_t iteration) {
+        profile::EventProcessorSingleton::instance().process(
+                database, ("@hw;" + counter + ";" + txt).c_str(), number, iteration);
+    }
+
+    /**
+     * create load balance event of a parallel loop, from the busy times of the threads and the chunks
+     * in nanoseconds; the rule is the message of the signal handler
+     */
+    void makeBalanceEvent(const char* rule, const std::vector<uint64_t>& threadTimes,
+            const std::vector<uint64_t>& chunkTimes) {
+        uint64_t busyTotal = 0;
+        for (uint64_t time : threadTimes) {
+            busyTotal += time;
+        }
+        if (rule == nullptr || busyTotal == 0 || chunkTimes.empty()) {
+            return;
+        }
+        std::string clause(rule);
+        clause = clause.substr(0, clause.find('\n'));
+        size_t busyMax = *std::max_element(threadTimes.begin(), threadTimes.end());
+        size_t chunkMax = *std::max_element(chunkTimes.begin(), chunkTimes.end());
+        profile::EventProcessorSingleton::instance().process(database,
+                ("@parallel-balance;" + SampleProfiler::getRelationName(clause) + ";" + stringify(clause))
+                        .c_str(),
+                threadTimes.size(), busyMax, static_cast<size_t>(busyTotal), chunkTimes.size(), chunkMax);
+    }
+
     /** create utilisation event */
     void makeUtilisationEvent(const std::string& txt) {
         /* current time */
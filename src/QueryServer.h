@@ -0,0 +1,765 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file QueryServer.h
+ *
+ * A server answering read-only pattern queries on the relations of an
+ * evaluated program over a Unix-domain socket, and the matching client.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include "SouffleInterface.h"
+#include "SymbolTable.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * The messages of the query protocol.
+ *
+ * Every request starts with its kind, followed by its arguments; every
+ * response starts with a status. Integers are sent in the byte order of
+ * the host, strings as their length followed by their characters.
+ *
+ *  Query:    relation name, mask (uint64), arity (uint32), pattern
+ *            -> number of tuples (uint64), tuples row by row
+ *  Lookup:   number of symbols (uint32), symbols
+ *            -> indices of the symbols, -1 for unknown symbols
+ *  Resolve:  number of indices (uint32), indices
+ *            -> symbols
+ *  Stats:    -> latency histograms as text
+ *  Shutdown: -> stops the server
+ */
+enum class QueryRequest : uint32_t { Query = 1, Lookup = 2, Resolve = 3, Stats = 4, Shutdown = 5 };
+
+enum class QueryStatus : uint32_t { Ok = 0, UnknownRelation = 1, BadRequest = 2 };
+
+/**
+ * Buffered reading and writing of protocol messages on a socket
+ */
+class QueryChannel {
+public:
+    explicit QueryChannel(int fd) : fd(fd) {}
+
+    /** Reads a value, returns false if the peer closed the connection */
+    template <typename T>
+    bool read(T& value) {
+        return readBytes(&value, sizeof(T));
+    }
+
+    /** Reads a string, returns false if the peer closed the connection or the string is too long */
+    bool read(std::string& str) {
+        uint32_t length;
+        if (!read(length) || !checkLength(length, 1)) {
+            return false;
+        }
+        str.resize(length);
+        return readBytes(&str[0], length);
+    }
+
+    template <typename T>
+    void write(const T& value) {
+        writeBytes(&value, sizeof(T));
+    }
+
+    void write(const std::string& str) {
+        write(static_cast<uint32_t>(str.size()));
+        writeBytes(str.data(), str.size());
+    }
+
+    void writeBytes(const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    /** Sends the buffered output, returns false if the peer closed the connection */
+    bool flush() {
+        size_t pos = 0;
+        while (pos < out.size()) {
+            ssize_t n = ::send(fd, out.data() + pos, out.size() - pos, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            pos += n;
+        }
+        out.clear();
+        return true;
+    }
+
+    /**
+     * Checks the number of elements of a received array before it is allocated. Marks the
+     * message as malformed and returns false if the array exceeds MAX_MESSAGE_SIZE bytes.
+     */
+    bool checkLength(size_t count, size_t elementSize) {
+        if (count > MAX_MESSAGE_SIZE / elementSize) {
+            malformed = true;
+            return false;
+        }
+        return true;
+    }
+
+    /** Whether a received message exceeded the size limits */
+    bool isMalformed() const {
+        return malformed;
+    }
+
+    /** Maximum size in bytes of a string or an array of a message */
+    static constexpr size_t MAX_MESSAGE_SIZE = 1 << 24;
+
+    /** Whether received bytes have not been read yet */
+    bool hasBufferedInput() const {
+        return inPos < in.size();
+    }
+
+private:
+    bool readBytes(void* data, size_t size) {
+        char* bytes = static_cast<char*>(data);
+        while (size > 0) {
+            if (inPos == in.size()) {
+                in.resize(BUFFER_SIZE);
+                ssize_t n = ::recv(fd, in.data(), in.size(), 0);
+                if (n < 0 && errno == EINTR) {
+                    in.clear();
+                    continue;
+                }
+                if (n <= 0) {
+                    in.clear();
+                    return false;
+                }
+                in.resize(n);
+                inPos = 0;
+            }
+            size_t chunk = std::min(size, in.size() - inPos);
+            std::memcpy(bytes, in.data() + inPos, chunk);
+            inPos += chunk;
+            bytes += chunk;
+            size -= chunk;
+        }
+        return true;
+    }
+
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    /** The socket */
+    int fd;
+
+    /** Received bytes and the position of the first unread one */
+    std::vector<char> in;
+    size_t inPos = 0;
+
+    /** Bytes to be sent */
+    std::vector<char> out;
+
+    /** Set when a received message exceeded the size limits */
+    bool malformed = false;
+};
+
+/**
+ * A histogram of latencies with logarithmic buckets, which can be
+ * updated concurrently. Bucket 0 counts latencies below 1us, bucket i
+ * latencies in [2^(i-1), 2^i) us.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t NUM_BUCKETS = 40;
+
+    void record(std::chrono::nanoseconds latency) {
+        auto us = static_cast<uint64_t>(latency.count() / 1000);
+        size_t bucket = 0;
+        while (us > 0 && bucket + 1 < NUM_BUCKETS) {
+            us >>= 1;
+            bucket++;
+        }
+        buckets[bucket]++;
+    }
+
+    uint64_t size() const {
+        uint64_t res = 0;
+        for (const auto& bucket : buckets) {
+            res += bucket;
+        }
+        return res;
+    }
+
+    /** Upper bound of the given percentile in us */
+    uint64_t percentile(double p) const {
+        uint64_t total = size();
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen > 0 && seen >= p / 100 * total) {
+                return uint64_t(1) << i;
+            }
+        }
+        return 0;
+    }
+
+    void print(std::ostream& os) const {
+        os << "count: " << size() << ", p50 < " << percentile(50) << "us, p90 < " << percentile(90)
+           << "us, p99 < " << percentile(99) << "us\n";
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            if (buckets[i] > 0) {
+                os << "  < " << (uint64_t(1) << i) << "us: " << buckets[i] << "\n";
+            }
+        }
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+};
+
+/**
+ * Answers read-only queries on the relations of an evaluated program.
+ *
+ * Requests are served by a fixed pool of threads. The serving thread polls
+ * the idle connections and hands a connection to a worker once a request
+ * arrives; the worker answers that request and returns the connection, so
+ * that idle clients never hold a worker. The relations must not be
+ * modified while the server is running, so that the threads read the
+ * indexes without taking locks.
+ */
+class QueryServer {
+public:
+    QueryServer(SouffleProgram& program, size_t numThreads)
+            : program(program), numThreads(numThreads) {
+        // use one thread per core if the number of threads is not given
+        if (this->numThreads == 0) {
+            this->numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+    }
+
+    /**
+     * Serves queries on a Unix-domain socket created at the given path,
+     * until a shutdown request is received or stop() is called.
+     */
+    void serve(const std::string& socketPath) {
+        sockaddr_un addr{};
+        if (socketPath.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("socket path too long: " + socketPath);
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+        int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0) {
+            throw std::runtime_error("cannot create socket: " + std::string(std::strerror(errno)));
+        }
+        ::unlink(socketPath.c_str());
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+                ::listen(listener, SOMAXCONN) < 0) {
+            std::string error = std::strerror(errno);
+            ::close(listener);
+            throw std::runtime_error("cannot listen on " + socketPath + ": " + error);
+        }
+        int wakeup[2];
+        if (::pipe(wakeup) < 0) {
+            std::string error = std::strerror(errno);
+            ::close(listener);
+            throw std::runtime_error("cannot create pipe: " + error);
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            wakeupFd = wakeup[1];
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < numThreads; i++) {
+            workers.emplace_back([this]() { work(); });
+        }
+
+        // connections waiting for a request, owned by this thread
+        std::vector<std::unique_ptr<Connection>> idle;
+        std::vector<pollfd> fds;
+        while (!stopping) {
+            fds.clear();
+            fds.push_back({listener, POLLIN, 0});
+            fds.push_back({wakeup[0], POLLIN, 0});
+            for (const auto& connection : idle) {
+                fds.push_back({connection->fd, POLLIN, 0});
+            }
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (stopping) {
+                break;
+            }
+
+            // hand the connections with a pending request (or a closed peer) to the workers
+            std::vector<std::unique_ptr<Connection>> waiting;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                for (size_t i = 0; i < idle.size(); i++) {
+                    if (fds[i + 2].revents != 0) {
+                        ready.push_back(std::move(idle[i]));
+                    } else {
+                        waiting.push_back(std::move(idle[i]));
+                    }
+                }
+            }
+            available.notify_all();
+            idle.swap(waiting);
+
+            // take back the connections whose request was answered
+            if (fds[1].revents != 0) {
+                char buffer[64];
+                if (::read(wakeup[0], buffer, sizeof(buffer)) < 0 && errno != EINTR) {
+                    break;
+                }
+                std::lock_guard<std::mutex> guard(mutex);
+                for (auto& connection : answered) {
+                    idle.push_back(std::move(connection));
+                }
+                answered.clear();
+            }
+
+            if (fds[0].revents != 0) {
+                int fd = ::accept(listener, nullptr, nullptr);
+                if (fd >= 0) {
+                    idle.push_back(std::make_unique<Connection>(fd));
+                } else if (errno != EINTR && errno != ECONNABORTED) {
+                    break;
+                }
+            }
+        }
+
+        stopping = true;
+        available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            wakeupFd = -1;
+            ready.clear();
+            answered.clear();
+        }
+        idle.clear();
+        ::close(wakeup[0]);
+        ::close(wakeup[1]);
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+    }
+
+    /**
+     * Stops serving; may be called from any thread
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+            wakeUp();
+        }
+        available.notify_all();
+    }
+
+    /** Prints the latency histograms of the served requests */
+    void printStats(std::ostream& os) const {
+        os << "queries: ";
+        queryLatency.print(os);
+        os << "symbol requests: ";
+        symbolLatency.print(os);
+    }
+
+private:
+    /** An accepted connection and its buffers, closed on destruction */
+    struct Connection {
+        explicit Connection(int fd) : fd(fd), channel(fd) {}
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+        ~Connection() {
+            ::close(fd);
+        }
+
+        int fd;
+        QueryChannel channel;
+    };
+
+    /** Interrupts the poll of the serving thread; the mutex must be held */
+    void wakeUp() {
+        if (wakeupFd >= 0) {
+            char signal = 0;
+            while (::write(wakeupFd, &signal, 1) < 0 && errno == EINTR) {
+            }
+        }
+    }
+
+    /** Main loop of a worker thread */
+    void work() {
+        while (true) {
+            std::unique_ptr<Connection> connection;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [&]() { return stopping || !ready.empty(); });
+                if (stopping) {
+                    return;
+                }
+                connection = std::move(ready.front());
+                ready.pop_front();
+            }
+
+            // answer the request, and those already received with it
+            bool open;
+            try {
+                open = serveRequest(connection->channel);
+                while (open && !stopping && connection->channel.hasBufferedInput()) {
+                    open = serveRequest(connection->channel);
+                }
+            } catch (const std::exception&) {
+                // e.g. a response exceeding the memory, which drops the connection but not the server
+                open = false;
+            }
+            if (!open) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> guard(mutex);
+            answered.push_back(std::move(connection));
+            wakeUp();
+        }
+    }
+
+    /** Answers a request, returns false if the connection is to be closed */
+    bool serveRequest(QueryChannel& channel) {
+        uint32_t kind;
+        if (!channel.read(kind)) {
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        bool ok = true;
+        switch (static_cast<QueryRequest>(kind)) {
+            case QueryRequest::Query:
+                ok = query(channel);
+                queryLatency.record(std::chrono::steady_clock::now() - start);
+                break;
+            case QueryRequest::Lookup:
+                ok = lookup(channel);
+                symbolLatency.record(std::chrono::steady_clock::now() - start);
+                break;
+            case QueryRequest::Resolve:
+                ok = resolve(channel);
+                symbolLatency.record(std::chrono::steady_clock::now() - start);
+                break;
+            case QueryRequest::Stats: {
+                std::stringstream stats;
+                printStats(stats);
+                channel.write(QueryStatus::Ok);
+                channel.write(stats.str());
+                break;
+            }
+            case QueryRequest::Shutdown:
+                channel.write(QueryStatus::Ok);
+                channel.flush();
+                stop();
+                return false;
+            default:
+                // the request cannot be skipped, hence the connection is dropped
+                channel.write(QueryStatus::BadRequest);
+                channel.flush();
+                return false;
+        }
+        if (!ok && channel.isMalformed()) {
+            // the rest of the request cannot be skipped either
+            channel.write(QueryStatus::BadRequest);
+            channel.flush();
+        }
+        return ok && channel.flush();
+    }
+
+    /** Answers a pattern query, returns false if the request was incomplete or malformed */
+    bool query(QueryChannel& channel) {
+        std::string name;
+        uint64_t mask;
+        uint32_t arity;
+        if (!channel.read(name) || !channel.read(mask) || !channel.read(arity) ||
+                !channel.checkLength(arity, sizeof(RamDomain))) {
+            return false;
+        }
+
+        // the pattern is only kept if its arity is the one of the relation
+        const Relation* relation = program.getRelation(name);
+        bool matches = relation != nullptr && relation->getArity() == arity;
+        std::vector<RamDomain> values(matches ? arity : 0);
+        for (size_t i = 0; i < arity; i++) {
+            RamDomain value;
+            if (!channel.read(value)) {
+                return false;
+            }
+            if (matches) {
+                values[i] = value;
+            }
+        }
+
+        if (relation == nullptr) {
+            channel.write(QueryStatus::UnknownRelation);
+            return true;
+        }
+        if (relation->getArity() != arity) {
+            channel.write(QueryStatus::BadRequest);
+            return true;
+        }
+
+        tuple pattern(relation);
+        for (size_t i = 0; i < arity; i++) {
+            pattern[i] = values[i];
+        }
+        std::vector<RamDomain> rows;
+        uint64_t count = 0;
+        auto range = relation->equalRange(pattern, mask);
+        for (auto it = range.first; it != range.second; ++it) {
+            for (size_t i = 0; i < arity; i++) {
+                rows.push_back((*it)[i]);
+            }
+            count++;
+        }
+        channel.write(QueryStatus::Ok);
+        channel.write(count);
+        channel.writeBytes(rows.data(), rows.size() * sizeof(RamDomain));
+        return true;
+    }
+
+    /** Finds the indices of symbols without inserting new ones */
+    bool lookup(QueryChannel& channel) {
+        uint32_t n;
+        if (!channel.read(n) || !channel.checkLength(n, sizeof(RamDomain))) {
+            return false;
+        }
+        std::vector<RamDomain> indices(n);
+        SymbolTable& symbolTable = program.getSymbolTable();
+        for (auto& index : indices) {
+            std::string symbol;
+            if (!channel.read(symbol)) {
+                return false;
+            }
+            index = symbolTable.contains(symbol) ? symbolTable.lookup(symbol) : -1;
+        }
+        channel.write(QueryStatus::Ok);
+        channel.writeBytes(indices.data(), indices.size() * sizeof(RamDomain));
+        return true;
+    }
+
+    /** Finds the symbols of indices */
+    bool resolve(QueryChannel& channel) {
+        uint32_t n;
+        if (!channel.read(n) || !channel.checkLength(n, sizeof(RamDomain))) {
+            return false;
+        }
+        std::vector<RamDomain> indices(n);
+        for (auto& index : indices) {
+            if (!channel.read(index)) {
+                return false;
+            }
+        }
+        SymbolTable& symbolTable = program.getSymbolTable();
+        for (RamDomain index : indices) {
+            if (!symbolTable.contains(index)) {
+                channel.write(QueryStatus::BadRequest);
+                return true;
+            }
+        }
+        channel.write(QueryStatus::Ok);
+        for (RamDomain index : indices) {
+            channel.write(symbolTable.resolve(index));
+        }
+        return true;
+    }
+
+    /** The program whose relations are queried */
+    SouffleProgram& program;
+
+    /** Number of worker threads */
+    size_t numThreads;
+
+    /** Set when the server is shut down */
+    std::atomic<bool> stopping{false};
+
+    /** Guards the queues of connections and the wake-up pipe */
+    std::mutex mutex;
+
+    /** Signalled when a request arrived or the server stops */
+    std::condition_variable available;
+
+    /** Connections with a pending request, waiting for a worker */
+    std::deque<std::unique_ptr<Connection>> ready;
+
+    /** Connections whose request was answered, to be polled again */
+    std::vector<std::unique_ptr<Connection>> answered;
+
+    /** Writing end of the pipe interrupting the poll of the serving thread */
+    int wakeupFd = -1;
+
+    /** Latencies of pattern queries */
+    LatencyHistogram queryLatency;
+
+    /** Latencies of symbol lookups and resolutions */
+    LatencyHistogram symbolLatency;
+};
+
+/**
+ * A connection to a query server
+ */
+class QueryClient {
+public:
+    explicit QueryClient(const std::string& socketPath) : fd(connectTo(socketPath)), channel(fd) {}
+
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    ~QueryClient() {
+        ::close(fd);
+    }
+
+    /**
+     * Retrieves the tuples of a relation agreeing with the pattern on the
+     * columns selected by the mask, row by row.
+     *
+     * @return false if the relation does not exist or the arity does not match
+     */
+    bool query(const std::string& relation, SearchSignature mask, const std::vector<RamDomain>& pattern,
+            std::vector<RamDomain>& rows) {
+        channel.write(QueryRequest::Query);
+        channel.write(relation);
+        channel.write(static_cast<uint64_t>(mask));
+        channel.write(static_cast<uint32_t>(pattern.size()));
+        channel.writeBytes(pattern.data(), pattern.size() * sizeof(RamDomain));
+        if (receiveStatus() != QueryStatus::Ok) {
+            return false;
+        }
+        uint64_t count;
+        receive(count);
+        rows.resize(count * pattern.size());
+        for (auto& value : rows) {
+            receive(value);
+        }
+        return true;
+    }
+
+    /** Finds the indices of symbols, -1 for symbols unknown to the program */
+    std::vector<RamDomain> lookup(const std::vector<std::string>& symbols) {
+        channel.write(QueryRequest::Lookup);
+        channel.write(static_cast<uint32_t>(symbols.size()));
+        for (const auto& symbol : symbols) {
+            channel.write(symbol);
+        }
+        expectOk();
+        std::vector<RamDomain> indices(symbols.size());
+        for (auto& index : indices) {
+            receive(index);
+        }
+        return indices;
+    }
+
+    /** Finds the symbols of indices */
+    std::vector<std::string> resolve(const std::vector<RamDomain>& indices) {
+        channel.write(QueryRequest::Resolve);
+        channel.write(static_cast<uint32_t>(indices.size()));
+        channel.writeBytes(indices.data(), indices.size() * sizeof(RamDomain));
+        expectOk();
+        std::vector<std::string> symbols(indices.size());
+        for (auto& symbol : symbols) {
+            receive(symbol);
+        }
+        return symbols;
+    }
+
+    /** Retrieves the latency histograms of the server */
+    std::string stats() {
+        channel.write(QueryRequest::Stats);
+        expectOk();
+        std::string res;
+        receive(res);
+        return res;
+    }
+
+    /** Stops the server */
+    void shutdown() {
+        channel.write(QueryRequest::Shutdown);
+        expectOk();
+    }
+
+private:
+    static int connectTo(const std::string& socketPath) {
+        sockaddr_un addr{};
+        if (socketPath.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("socket path too long: " + socketPath);
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::string error = std::strerror(errno);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw std::runtime_error("cannot connect to " + socketPath + ": " + error);
+        }
+        return fd;
+    }
+
+    template <typename T>
+    void receive(T& value) {
+        if (!channel.read(value)) {
+            throw std::runtime_error("connection to query server lost");
+        }
+    }
+
+    /** Sends the request and receives the status of the response */
+    QueryStatus receiveStatus() {
+        if (!channel.flush()) {
+            throw std::runtime_error("connection to query server lost");
+        }
+        QueryStatus status;
+        receive(status);
+        return status;
+    }
+
+    void expectOk() {
+        if (receiveStatus() != QueryStatus::Ok) {
+            throw std::runtime_error("query server rejected the request");
+        }
+    }
+
+    int fd;
+    QueryChannel channel;
+};
+
+}  // end of namespace souffle
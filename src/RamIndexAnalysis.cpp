@@ -167,6 +167,23 @@ void MinIndexSelection::solve() {
         }
         assert(k == search && "incorrect lexicographical order");
     }
+
+    // Leapfrog joins seek through an index in the order of the prefix followed by
+    // the joined column; add an index for each seek not covered by the chains
+    for (const auto& prefixSearch : prefixSearches) {
+        SearchSignature prefix = prefixSearch.first;
+        int col = prefixSearch.second;
+        if (findPrefixOrder(prefix, col) >= 0) {
+            continue;
+        }
+        LexOrder ids;
+        insertIndex(ids, prefix);
+        ids.push_back(col);
+        Chain chain;
+        chain.insert(prefix | (SearchSignature(1) << col));
+        chainToOrder.push_back(chain);
+        orders.push_back(ids);
+    }
 }
 
 MinIndexSelection::Chain MinIndexSelection::getChain(
@@ -248,6 +265,11 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
         } else if (const auto* provExists = dynamic_cast<const RamProvenanceExistenceCheck*>(&node)) {
             MinIndexSelection& indexes = getIndexes(provExists->getRelation());
             indexes.addSearch(getSearchSignature(provExists));
+        } else if (const auto* join = dynamic_cast<const RamLeapfrogJoin*>(&node)) {
+            for (size_t i = 0; i < join->getNumOperands(); ++i) {
+                MinIndexSelection& indexes = getIndexes(join->getRelation(i));
+                indexes.addPrefixSearch(getSearchSignature(join, i), join->getColumn(i));
+            }
         } else if (const auto* ramRel = dynamic_cast<const RamRelation*>(&node)) {
             MinIndexSelection& indexes = getIndexes(*ramRel);
             indexes.addSearch(getSearchSignature(ramRel));
@@ -276,6 +298,14 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
         for (const auto& signature : indexesB.getSearches()) {
             indexesA.addSearch(signature);
         }
+
+        // Exchange the seeks of leapfrog joins
+        for (const auto& seek : indexesA.getPrefixSearches()) {
+            indexesB.addPrefixSearch(seek.first, seek.second);
+        }
+        for (const auto& seek : indexesB.getPrefixSearches()) {
+            indexesA.addPrefixSearch(seek.first, seek.second);
+        }
     });
 
     // find optimal indexes for relations
@@ -350,6 +380,17 @@ SearchSignature RamIndexAnalysis::getSearchSignature(const RamIndexOperation* se
     return keys;
 }
 
+SearchSignature RamIndexAnalysis::getSearchSignature(const RamLeapfrogJoin* join, size_t i) const {
+    SearchSignature keys = 0;
+    std::vector<RamExpression*> rangePattern = join->getRangePattern(i);
+    for (int j = 0; j < (int)rangePattern.size(); j++) {
+        if (!isRamUndefValue(rangePattern[j])) {
+            keys |= (1 << j);
+        }
+    }
+    return keys;
+}
+
 SearchSignature RamIndexAnalysis::getSearchSignature(
         const RamProvenanceExistenceCheck* provExistCheck) const {
     const auto values = provExistCheck->getValues();
@@ -156,6 +156,8 @@ public:
     using Chain = std::set<SearchSignature>;
     using ChainOrderMap = std::vector<Chain>;
     using SearchSet = std::set<SearchSignature>;
+    using PrefixSearch = std::pair<SearchSignature, int>;
+    using PrefixSearchSet = std::set<PrefixSearch>;
 
     MinIndexSelection() = default;
     ~MinIndexSelection() = default;
@@ -172,6 +174,30 @@ public:
         return searches;
     }
 
+    /**
+     * @Brief Add a seek of a leapfrog join
+     *
+     * A seek requires an index whose lexicographical order starts with the
+     * columns of the prefix (in any order) followed by the given column.
+     */
+    void addPrefixSearch(SearchSignature prefix, int col) {
+        prefixSearches.insert(std::make_pair(prefix, col));
+        addSearch(prefix);
+        addSearch(prefix | (SearchSignature(1) << col));
+    }
+
+    /** @Brief Get seeks of leapfrog joins */
+    const PrefixSearchSet& getPrefixSearches() const {
+        return prefixSearches;
+    }
+
+    /** @Brief Get index for a seek of a leapfrog join */
+    int getPrefixOrderNum(SearchSignature prefix, int col) const {
+        int idx = findPrefixOrder(prefix, col);
+        assert(idx >= 0 && "no index for seek");
+        return idx;
+    }
+
     /** @Brief Get index for a search */
     const LexOrder getLexOrder(SearchSignature cols) const {
         int idx = map(cols);
@@ -233,10 +259,11 @@ public:
     }
 
 protected:
-    SearchSet searches;          // set of search patterns on table
-    OrderCollection orders;      // collection of lexicographical orders
-    ChainOrderMap chainToOrder;  // maps order index to set of searches covered by chain
-    MaxMatching matching;        // matching problem for finding minimal number of orders
+    SearchSet searches;              // set of search patterns on table
+    PrefixSearchSet prefixSearches;  // set of seeks of leapfrog joins on table
+    OrderCollection orders;          // collection of lexicographical orders
+    ChainOrderMap chainToOrder;      // maps order index to set of searches covered by chain
+    MaxMatching matching;            // matching problem for finding minimal number of orders
 
     /** @Brief count the number of bits in key */
     static size_t card(SearchSignature cols) {
@@ -264,6 +291,25 @@ protected:
         abort();
     }
 
+    /** @Brief find an order starting with the prefix columns followed by col, -1 if there is none */
+    int findPrefixOrder(SearchSignature prefix, int col) const {
+        size_t len = card(prefix);
+        for (size_t i = 0; i < orders.size(); ++i) {
+            const LexOrder& order = orders[i];
+            if (order.size() <= len || order[len] != col) {
+                continue;
+            }
+            SearchSignature k = 0;
+            for (size_t j = 0; j < len; ++j) {
+                k |= SearchSignature(1) << order[j];
+            }
+            if (k == prefix) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
     /** @Brief determine if key a is a strict subset of key b*/
     static bool isStrictSubset(SearchSignature a, SearchSignature b) {
         auto tt = static_cast<SearchSignature>(std::numeric_limits<SearchSignature>::max());
@@ -347,6 +393,14 @@ public:
      */
     SearchSignature getSearchSignature(const RamIndexOperation* search) const;
 
+    /**
+     * @Brief Get the index signature of the bound columns of a leapfrog join operand
+     * @param join leapfrog join
+     * @param i operand of the join
+     * @result Index signature of the operand
+     */
+    SearchSignature getSearchSignature(const RamLeapfrogJoin* join, size_t i) const;
+
     /**
      * @Brief Get the index signature for an existence check
      * @param Existence check
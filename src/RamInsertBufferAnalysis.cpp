@@ -0,0 +1,68 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamInsertBufferAnalysis.cpp
+ *
+ * Implementation of the RAM Insert Buffer Analysis
+ *
+ ***********************************************************************/
+
+#include "RamInsertBufferAnalysis.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamStatement.h"
+#include "RamTranslationUnit.h"
+#include "RamVisitor.h"
+#include <map>
+#include <vector>
+
+namespace souffle {
+
+void RamInsertBufferAnalysis::run(const RamTranslationUnit& translationUnit) {
+    buffered.clear();
+
+    // Note: with provenance, a buffer may hold the same tuple with several annotations; merging
+    // them by regular insertions keeps the smallest one, as inserting them directly would
+    visitDepthFirst(translationUnit.getProgram(), [&](const RamQuery& query) {
+        // only threads of parallel queries compete for the target relations
+        bool isParallel = false;
+        visitDepthFirst(query, [&](const RamAbstractParallel&) { isParallel = true; });
+        if (!isParallel) {
+            return;
+        }
+
+        // count the references of each relation and collect the projections into it
+        std::map<const RamRelation*, size_t> references;
+        visitDepthFirst(query, [&](const RamRelationReference& ref) { references[ref.get()]++; });
+        std::map<const RamRelation*, std::vector<const RamProject*>> projections;
+        visitDepthFirst(query, [&](const RamProject& project) {
+            projections[&project.getRelation()].push_back(&project);
+        });
+
+        // a relation only referenced by projections is not read by the query
+        for (const auto& cur : projections) {
+            const RamRelation* rel = cur.first;
+            if (references[rel] != cur.second.size() || rel->getArity() == 0 ||
+                    rel->getRepresentation() == RelationRepresentation::EQREL) {
+                continue;
+            }
+            buffered.insert(cur.second.begin(), cur.second.end());
+        }
+    });
+}
+
+void RamInsertBufferAnalysis::print(std::ostream& os) const {
+    os << "Buffered projections:\n";
+    for (const RamProject* project : buffered) {
+        os << "INTO " << project->getRelation().getName() << "\n";
+    }
+}
+
+}  // end of namespace souffle
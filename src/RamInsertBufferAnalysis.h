@@ -0,0 +1,60 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamInsertBufferAnalysis.h
+ *
+ * Determines the projections of parallel queries whose tuples are collected
+ * in thread-local insertion buffers and merged into the target relation
+ * once the query has been evaluated.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamAnalysis.h"
+#include <set>
+
+namespace souffle {
+
+class RamProject;
+
+/**
+ * @class RamInsertBufferAnalysis
+ * @brief A Ram Analysis for determining the projections which are buffered
+ *
+ * A projection is buffered if it is located in a parallel query that does
+ * not read the target relation of the projection, e.g., a projection into
+ * a @new_ relation of a recursive stratum. Since the tuples are only read
+ * after the query, the threads may insert them into private buffers instead
+ * of competing for the locks of the relation.
+ */
+class RamInsertBufferAnalysis : public RamAnalysis {
+public:
+    RamInsertBufferAnalysis(const char* id) : RamAnalysis(id) {}
+
+    static constexpr const char* name = "insert-buffer-analysis";
+
+    void run(const RamTranslationUnit& translationUnit) override;
+
+    void print(std::ostream& os) const override;
+
+    /**
+     * @brief Check whether the tuples of a projection are buffered
+     */
+    bool isBuffered(const RamProject& project) const {
+        return buffered.find(&project) != buffered.end();
+    }
+
+private:
+    /** buffered projections */
+    std::set<const RamProject*> buffered;
+};
+
+}  // end of namespace souffle
@@ -0,0 +1,121 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamLayoutAnalysis.cpp
+ *
+ * Implementation of the RAM Layout Analysis
+ *
+ ***********************************************************************/
+
+#include "RamLayoutAnalysis.h"
+#include "Global.h"
+#include "RamIndexAnalysis.h"
+#include "RamProgram.h"
+#include "RamRelation.h"
+#include "RamTranslationUnit.h"
+#include "RamTypes.h"
+#include "RelationRepresentation.h"
+#include "profile/ProgramRun.h"
+#include "profile/Reader.h"
+#include "profile/Relation.h"
+#include <algorithm>
+#include <memory>
+#include <sstream>
+
+namespace souffle {
+
+size_t RamLayoutAnalysis::getDirectBytes(size_t arity, size_t indexes) {
+    return NODE_OVERHEAD * indexes * arity * sizeof(RamDomain);
+}
+
+size_t RamLayoutAnalysis::getIndirectBytes(size_t arity, size_t indexes) {
+    // the tuples are stored densely in a table, and the entries of the indexes are padded to the
+    // alignment of their tuple pointers
+    size_t key = std::min(arity, KEY_COLUMNS);
+    size_t entry = key * sizeof(RamDomain) + sizeof(void*);
+    entry = (entry + alignof(void*) - 1) / alignof(void*) * alignof(void*);
+    return arity * sizeof(RamDomain) + NODE_OVERHEAD * indexes * entry;
+}
+
+void RamLayoutAnalysis::run(const RamTranslationUnit& translationUnit) {
+    indirect.clear();
+    reasons.clear();
+
+    // provenance relations carry their annotations in the tuples of direct indexes
+    if (Global::config().has("provenance")) {
+        return;
+    }
+
+    auto* idxAnalysis = translationUnit.getAnalysis<RamIndexAnalysis>();
+    auto programRun = std::make_shared<profile::ProgramRun>(profile::ProgramRun());
+    if (Global::config().has("profile-use")) {
+        profile::Reader(Global::config().get("profile-use"), programRun).processFile();
+    }
+
+    // Note: relations swapped with each other have the same qualifier, arity, indexes and
+    // profile entry, hence they are given the same layout
+    for (const RamRelation* rel : translationUnit.getProgram().getRelations()) {
+        // disk-backed relations are b-trees in synthesised programs
+        auto representation = rel->getRepresentation();
+        bool isBTree = representation == RelationRepresentation::DEFAULT ||
+                       representation == RelationRepresentation::DISK ||
+                       representation == RelationRepresentation::BTREE ||
+                       representation == RelationRepresentation::INDIRECT;
+        if (rel->isNullary() || !isBTree) {
+            continue;
+        }
+        if (representation == RelationRepresentation::BTREE) {
+            reasons[rel->getName()] = "direct (btree qualifier)";
+            continue;
+        }
+        if (representation == RelationRepresentation::INDIRECT) {
+            reasons[rel->getName()] = "indirect (indirect qualifier)";
+            indirect.insert(rel);
+            continue;
+        }
+
+        size_t arity = rel->getArity();
+        size_t indexes = std::max<size_t>(1, idxAnalysis->getIndexes(*rel).getAllOrders().size());
+        size_t directBytes = getDirectBytes(arity, indexes);
+        size_t indirectBytes = getIndirectBytes(arity, indexes);
+        std::stringstream reason;
+        reason << directBytes << " vs " << indirectBytes << " bytes per tuple";
+
+        // the temporary relations of a recursive relation are profiled under its name
+        std::string name = rel->getName();
+        for (const std::string prefix : {"@delta_", "@new_"}) {
+            if (name.compare(0, prefix.size(), prefix) == 0) {
+                name = name.substr(prefix.size());
+            }
+        }
+        if (const auto* profRel = programRun->getRelation(name)) {
+            if (profRel->size() < SMALL_RELATION) {
+                reasons[rel->getName()] = "direct (small relation)";
+                continue;
+            }
+        }
+
+        if (directBytes >= MEMORY_RATIO * indirectBytes) {
+            indirect.insert(rel);
+            reasons[rel->getName()] = "indirect (" + reason.str() + ")";
+        } else {
+            reasons[rel->getName()] = "direct (" + reason.str() + ")";
+        }
+    }
+}
+
+void RamLayoutAnalysis::print(std::ostream& os) const {
+    os << "Relation layouts:\n";
+    for (const auto& cur : reasons) {
+        os << cur.first << ": " << cur.second << "\n";
+    }
+}
+
+}  // end of namespace souffle
@@ -0,0 +1,92 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamLayoutAnalysis.h
+ *
+ * Chooses between the direct and the indirect layout of the b-tree
+ * relations of synthesised programs.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamAnalysis.h"
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+
+namespace souffle {
+
+class RamRelation;
+
+/**
+ * @class RamLayoutAnalysis
+ * @brief A Ram Analysis choosing the layout of b-tree relations
+ *
+ * A direct relation stores a copy of each tuple in each of its indexes. An
+ * indirect relation stores each tuple once, and its indexes hold pointers to
+ * the tuples together with a copy of the first KEY_COLUMNS columns of the
+ * order of the index, such that most comparisons do not dereference the
+ * pointers.
+ *
+ * Relations qualified as btree are direct and relations qualified as indirect
+ * are indirect. For the remaining b-tree relations, the indirect layout is
+ * chosen if the estimated memory of the direct layout exceeds the one of the
+ * indirect layout by MEMORY_RATIO. With a profile (--profile-use), small
+ * relations stay direct. The constants follow souffle-layout-bench: from a
+ * memory ratio of about 1.2 on (arity 6 with three indexes), keyed indirect
+ * relations are smaller than direct ones and no slower to insert into, scan
+ * or look up.
+ */
+class RamLayoutAnalysis : public RamAnalysis {
+public:
+    RamLayoutAnalysis(const char* id) : RamAnalysis(id) {}
+
+    static constexpr const char* name = "layout-analysis";
+
+    /** Number of leading columns of the order of an index stored inline in indirect indexes */
+    static constexpr size_t KEY_COLUMNS = 2;
+
+    /** Factor of the memory of b-tree entries due to partially filled nodes */
+    static constexpr size_t NODE_OVERHEAD = 2;
+
+    /** Factor by which the direct layout must be larger to choose the indirect layout */
+    static constexpr double MEMORY_RATIO = 1.15;
+
+    /** Number of tuples below which profiled relations stay direct, as the saving is negligible */
+    static constexpr size_t SMALL_RELATION = 10000;
+
+    void run(const RamTranslationUnit& translationUnit) override;
+
+    void print(std::ostream& os) const override;
+
+    /**
+     * @brief Check whether the b-tree indexes of a relation are indirect
+     */
+    bool isIndirect(const RamRelation& rel) const {
+        return indirect.find(&rel) != indirect.end();
+    }
+
+    /** Estimated bytes per tuple of a direct relation */
+    static size_t getDirectBytes(size_t arity, size_t indexes);
+
+    /** Estimated bytes per tuple of an indirect relation */
+    static size_t getIndirectBytes(size_t arity, size_t indexes);
+
+private:
+    /** relations with indirect indexes */
+    std::set<const RamRelation*> indirect;
+
+    /** layouts of the b-tree relations and their reasons, by relation name */
+    std::map<std::string, std::string> reasons;
+};
+
+}  // end of namespace souffle
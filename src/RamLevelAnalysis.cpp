@@ -58,6 +58,15 @@ int RamLevelAnalysis::getLevel(const RamNode* node) const {
             return level;
         }
 
+        // hash join
+        int visitHashJoin(const RamHashJoin& hashJoin) override {
+            int level = -1;
+            for (auto& index : hashJoin.getRangePattern()) {
+                level = std::max(level, visit(index));
+            }
+            return level;
+        }
+
         // choice
         int visitChoice(const RamChoice& choice) override {
             return std::max(-1, visit(choice.getCondition()));
@@ -92,6 +101,17 @@ int RamLevelAnalysis::getLevel(const RamNode* node) const {
             return visit(unpack.getExpression());
         }
 
+        // leapfrog join
+        int visitLeapfrogJoin(const RamLeapfrogJoin& join) override {
+            int level = -1;
+            for (size_t i = 0; i < join.getNumOperands(); ++i) {
+                for (auto& index : join.getRangePattern(i)) {
+                    level = std::max(level, visit(index));
+                }
+            }
+            return level;
+        }
+
         // filter
         int visitFilter(const RamFilter& filter) override {
             return visit(filter.getCondition());
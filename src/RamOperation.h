@@ -404,6 +404,105 @@ public:
     }
 };
 
+/**
+ * @class RamHashJoin
+ * @brief Search for tuples of a relation matching a criteria through a hash table
+ *
+ * The hash table is built from the relation when the enclosing query is
+ * entered and released when it is left. Hence, unlike an index scan, the
+ * search does not require the relation to maintain an index.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   ...
+ *	 FOR t1 IN X ON HASH t1.c = t0.0
+ *	 ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamHashJoin : public RamRelationOperation {
+public:
+    RamHashJoin(std::unique_ptr<RamRelationReference> r, int ident,
+            std::vector<std::unique_ptr<RamExpression>> queryPattern, std::unique_ptr<RamOperation> nested,
+            std::string profileText = "")
+            : RamRelationOperation(std::move(r), ident, std::move(nested), std::move(profileText)),
+              queryPattern(std::move(queryPattern)) {
+        assert(getRangePattern().size() == getRelation().getArity());
+        for (const auto& pattern : this->queryPattern) {
+            assert(pattern != nullptr && "pattern is a null-pointer");
+        }
+    }
+
+    /**
+     * @brief Get range pattern
+     * @return A std::vector of pointers to RamExpression objects
+     */
+    std::vector<RamExpression*> getRangePattern() const {
+        return toPtrVector(queryPattern);
+    }
+
+    /** @brief Get the columns forming the key of the hash table */
+    std::vector<size_t> getKeyColumns() const {
+        std::vector<size_t> res;
+        for (size_t i = 0; i < queryPattern.size(); ++i) {
+            if (!isRamUndefValue(queryPattern[i].get())) {
+                res.push_back(i);
+            }
+        }
+        return res;
+    }
+
+    std::vector<const RamNode*> getChildNodes() const override {
+        auto res = RamRelationOperation::getChildNodes();
+        for (auto& pattern : queryPattern) {
+            res.push_back(pattern.get());
+        }
+        return res;
+    }
+
+    void apply(const RamNodeMapper& map) override {
+        RamRelationOperation::apply(map);
+        for (auto& pattern : queryPattern) {
+            pattern = map(std::move(pattern));
+        }
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        const auto& attrib = getRelation().getAttributeNames();
+        os << times(" ", tabpos);
+        os << "FOR t" << getTupleId() << " IN " << getRelation().getName();
+        bool first = true;
+        for (unsigned int i = 0; i < queryPattern.size(); ++i) {
+            if (!isRamUndefValue(queryPattern[i].get())) {
+                os << (first ? " ON HASH " : " AND ");
+                os << "t" << getTupleId() << "." << attrib[i] << " = " << *queryPattern[i];
+                first = false;
+            }
+        }
+        os << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+
+    RamHashJoin* clone() const override {
+        std::vector<std::unique_ptr<RamExpression>> resQueryPattern(queryPattern.size());
+        for (unsigned int i = 0; i < queryPattern.size(); ++i) {
+            resQueryPattern[i] = std::unique_ptr<RamExpression>(queryPattern[i]->clone());
+        }
+        return new RamHashJoin(std::unique_ptr<RamRelationReference>(relationRef->clone()), getTupleId(),
+                std::move(resQueryPattern), std::unique_ptr<RamOperation>(getOperation().clone()),
+                getProfileText());
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamHashJoin&>(node);
+        return RamRelationOperation::equal(other) && equal_targets(queryPattern, other.queryPattern);
+    }
+
+    /** Values of the key per column of table */
+    std::vector<std::unique_ptr<RamExpression>> queryPattern;
+};
+
 /**
  * @class RamAbstractChoice
  * @brief Abstract class for a choice operation
@@ -900,6 +999,206 @@ protected:
     const size_t arity;
 };
 
+/**
+ * @class RamLeapfrogJoin
+ * @brief Bind a single variable to the values shared by several relations
+ *
+ * A leapfrog join is one level of a worst-case optimal multi-way join. Each
+ * operand of the join is a relation, a range pattern over the already bound
+ * columns, and the column supplying the values of the variable. The join
+ * enumerates the values occurring in all operands in ascending order by
+ * seeking through indexes whose order starts with the bound columns followed
+ * by the enumerated column. The value is bound to element 0 of the tuple.
+ *
+ * For example, the triangle query t(x,y,z) :- e(x,y), e(y,z), e(x,z)
+ * is evaluated as:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   LEAPFROG t0 ON e.0 AND e.0
+ *    LEAPFROG t1 ON e.1 WHERE e.0 = t0.0 AND e.0
+ *     LEAPFROG t2 ON e.1 WHERE e.0 = t1.0 AND e.1 WHERE e.0 = t0.0
+ *      PROJECT (t0.0, t1.0, t2.0) INTO t
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamLeapfrogJoin : public RamTupleOperation {
+public:
+    RamLeapfrogJoin(std::vector<std::unique_ptr<RamRelationReference>> relRefs,
+            std::vector<std::vector<std::unique_ptr<RamExpression>>> queryPatterns,
+            std::vector<size_t> columns, int ident, std::unique_ptr<RamOperation> nested,
+            std::string profileText = "")
+            : RamTupleOperation(ident, std::move(nested), std::move(profileText)),
+              relationRefs(std::move(relRefs)), queryPatterns(std::move(queryPatterns)),
+              columns(std::move(columns)) {
+        assert(!relationRefs.empty() && "leapfrog join without operands");
+        assert(relationRefs.size() == this->queryPatterns.size() && "operands are not well formed");
+        assert(relationRefs.size() == this->columns.size() && "operands are not well formed");
+        for (size_t i = 0; i < relationRefs.size(); ++i) {
+            assert(relationRefs[i] != nullptr && "relation reference is a null-pointer");
+            assert(this->queryPatterns[i].size() == getRelation(i).getArity());
+            assert(this->columns[i] < getRelation(i).getArity());
+            for (const auto& pattern : this->queryPatterns[i]) {
+                assert(pattern != nullptr && "pattern is a null-pointer");
+            }
+        }
+    }
+
+    /** @brief Get number of operands */
+    size_t getNumOperands() const {
+        return relationRefs.size();
+    }
+
+    /** @brief Get relation of an operand */
+    const RamRelation& getRelation(size_t i) const {
+        return *relationRefs[i]->get();
+    }
+
+    /** @brief Get relation reference of an operand */
+    const RamRelationReference& getRelationReference(size_t i) const {
+        return *relationRefs[i];
+    }
+
+    /** @brief Get range pattern of an operand */
+    std::vector<RamExpression*> getRangePattern(size_t i) const {
+        return toPtrVector(queryPatterns[i]);
+    }
+
+    /** @brief Get column of an operand that supplies the values of the join */
+    size_t getColumn(size_t i) const {
+        return columns[i];
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "LEAPFROG t" << getTupleId() << " ON ";
+        printOperands(os);
+        os << std::endl;
+        RamTupleOperation::print(os, tabpos + 1);
+    }
+
+    /** @brief Print the operands of the join */
+    void printOperands(std::ostream& os) const {
+        for (size_t i = 0; i < getNumOperands(); ++i) {
+            const RamRelation& rel = getRelation(i);
+            const auto& attrib = rel.getAttributeNames();
+            if (i > 0) {
+                os << " AND ";
+            }
+            os << rel.getName() << "." << attrib[columns[i]];
+            bool first = true;
+            for (size_t j = 0; j < queryPatterns[i].size(); ++j) {
+                if (!isRamUndefValue(queryPatterns[i][j].get())) {
+                    os << (first ? " WHERE " : ", ");
+                    os << rel.getName() << "." << attrib[j] << " = " << *queryPatterns[i][j];
+                    first = false;
+                }
+            }
+        }
+    }
+
+    std::vector<const RamNode*> getChildNodes() const override {
+        auto res = RamTupleOperation::getChildNodes();
+        for (size_t i = 0; i < getNumOperands(); ++i) {
+            res.push_back(relationRefs[i].get());
+            for (const auto& pattern : queryPatterns[i]) {
+                res.push_back(pattern.get());
+            }
+        }
+        return res;
+    }
+
+    RamLeapfrogJoin* clone() const override {
+        std::vector<std::unique_ptr<RamRelationReference>> resRelationRefs;
+        std::vector<std::vector<std::unique_ptr<RamExpression>>> resQueryPatterns(queryPatterns.size());
+        for (size_t i = 0; i < getNumOperands(); ++i) {
+            resRelationRefs.emplace_back(relationRefs[i]->clone());
+            for (const auto& pattern : queryPatterns[i]) {
+                resQueryPatterns[i].emplace_back(pattern->clone());
+            }
+        }
+        return new RamLeapfrogJoin(std::move(resRelationRefs), std::move(resQueryPatterns), columns,
+                getTupleId(), std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+
+    void apply(const RamNodeMapper& map) override {
+        RamTupleOperation::apply(map);
+        for (size_t i = 0; i < getNumOperands(); ++i) {
+            relationRefs[i] = map(std::move(relationRefs[i]));
+            for (auto& pattern : queryPatterns[i]) {
+                pattern = map(std::move(pattern));
+            }
+        }
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamLeapfrogJoin&>(node);
+        if (!RamTupleOperation::equal(other) || getNumOperands() != other.getNumOperands() ||
+                columns != other.columns) {
+            return false;
+        }
+        for (size_t i = 0; i < getNumOperands(); ++i) {
+            if (getRelation(i) != other.getRelation(i) ||
+                    !equal_targets(queryPatterns[i], other.queryPatterns[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Relations of the operands */
+    std::vector<std::unique_ptr<RamRelationReference>> relationRefs;
+
+    /** Range patterns of the operands over the already bound columns */
+    std::vector<std::vector<std::unique_ptr<RamExpression>>> queryPatterns;
+
+    /** Columns of the operands supplying the values of the join */
+    std::vector<size_t> columns;
+};
+
+/**
+ * @class RamParallelLeapfrogJoin
+ * @brief Bind a single variable to the values shared by several relations in parallel
+ *
+ * The values are split into ranges by the index of the first operand, and
+ * the threads enumerate the values of the ranges they claim, such that the
+ * ranges are distributed among the threads dynamically.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   PARALLEL LEAPFROG t0 ON e.0 AND e.0
+ *    ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamParallelLeapfrogJoin : public RamLeapfrogJoin, public RamAbstractParallel {
+public:
+    RamParallelLeapfrogJoin(std::vector<std::unique_ptr<RamRelationReference>> relRefs,
+            std::vector<std::vector<std::unique_ptr<RamExpression>>> queryPatterns,
+            std::vector<size_t> columns, int ident, std::unique_ptr<RamOperation> nested,
+            std::string profileText = "")
+            : RamLeapfrogJoin(std::move(relRefs), std::move(queryPatterns), std::move(columns), ident,
+                      std::move(nested), std::move(profileText)) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "PARALLEL LEAPFROG t" << getTupleId() << " ON ";
+        printOperands(os);
+        os << std::endl;
+        RamTupleOperation::print(os, tabpos + 1);
+    }
+
+    RamParallelLeapfrogJoin* clone() const override {
+        std::vector<std::unique_ptr<RamRelationReference>> resRelationRefs;
+        std::vector<std::vector<std::unique_ptr<RamExpression>>> resQueryPatterns(queryPatterns.size());
+        for (size_t i = 0; i < getNumOperands(); ++i) {
+            resRelationRefs.emplace_back(relationRefs[i]->clone());
+            for (const auto& pattern : queryPatterns[i]) {
+                resQueryPatterns[i].emplace_back(pattern->clone());
+            }
+        }
+        return new RamParallelLeapfrogJoin(std::move(resRelationRefs), std::move(resQueryPatterns), columns,
+                getTupleId(), std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+};
+
 /**
  * @class RamAbstractConditional
  * @brief Abstract conditional statement
@@ -213,6 +213,95 @@ public:
     }
 };
 
+/**
+ * @class RamPurge
+ * @brief Delete tuples of a relation in any case
+ *
+ * Unlike a clear, which keeps the tuples of non-temporary relations for the
+ * interface of a program that does not perform IO, a purge always deletes the
+ * tuples, e.g., to replace the content of a relation during the evaluation.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * PURGE A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamPurge : public RamRelationStatement {
+public:
+    RamPurge(std::unique_ptr<RamRelationReference> relRef) : RamRelationStatement(std::move(relRef)) {}
+
+    void print(std::ostream& os, int tabpos) const override {
+        const RamRelation& rel = getRelation();
+        os << times(" ", tabpos);
+        os << "PURGE ";
+        os << rel.getName();
+        os << std::endl;
+    }
+
+    RamPurge* clone() const override {
+        return new RamPurge(std::unique_ptr<RamRelationReference>(relationRef->clone()));
+    }
+};
+
+/**
+ * @class RamFacts
+ * @brief Insert a table of constant tuples into a relation
+ *
+ * The facts of a relation stated in the program are inserted at once
+ * instead of projecting each of them in a query of its own. The values
+ * of the tuples are stored consecutively.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * PROJECT FACTS {(1,2), (3,4)} INTO A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamFacts : public RamRelationStatement {
+public:
+    RamFacts(std::unique_ptr<RamRelationReference> relRef, std::vector<RamDomain> values)
+            : RamRelationStatement(std::move(relRef)), values(std::move(values)) {
+        assert(getRelation().getArity() > 0 && "nullary facts are projected");
+        assert(this->values.size() % getRelation().getArity() == 0 && "incomplete tuple");
+    }
+
+    /** @brief Get values of the tuples */
+    const std::vector<RamDomain>& getValues() const {
+        return values;
+    }
+
+    /** @brief Get number of tuples */
+    size_t getNumFacts() const {
+        return values.size() / getRelation().getArity();
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        const RamRelation& rel = getRelation();
+        size_t arity = rel.getArity();
+        os << times(" ", tabpos);
+        os << "PROJECT FACTS {";
+        for (size_t i = 0; i < values.size(); i += arity) {
+            os << (i == 0 ? "(" : ", (");
+            os << join(values.begin() + i, values.begin() + i + arity, ",");
+            os << ")";
+        }
+        os << "} INTO " << rel.getName();
+        os << std::endl;
+    }
+
+    RamFacts* clone() const override {
+        return new RamFacts(std::unique_ptr<RamRelationReference>(relationRef->clone()), values);
+    }
+
+protected:
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamFacts&>(node);
+        return RamRelationStatement::equal(other) && values == other.values;
+    }
+
+    /** Values of the tuples */
+    const std::vector<RamDomain> values;
+};
+
 /**
  * @class RamBinRelationStatement
  * @brief Abstract class for a binary relation
@@ -28,7 +28,11 @@
 #include "RamUtils.h"
 #include "RamVisitor.h"
 #include <algorithm>
+#include <functional>
 #include <list>
+#include <map>
+#include <set>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -608,6 +612,83 @@ bool ChoiceConversionTransformer::convertScans(RamProgram& program) {
     return changed;
 }
 
+bool HashJoinTransformer::convertIndexScans(RamProgram& program) {
+    // count the searches of each relation
+    std::map<const RamRelation*, std::map<SearchSignature, size_t>> searches;
+    visitDepthFirst(program, [&](const RamNode& node) {
+        if (const auto* indexSearch = dynamic_cast<const RamIndexOperation*>(&node)) {
+            searches[&indexSearch->getRelation()][idxAnalysis->getSearchSignature(indexSearch)]++;
+        } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
+            searches[&exists->getRelation()][idxAnalysis->getSearchSignature(exists)]++;
+        } else if (const auto* provExists = dynamic_cast<const RamProvenanceExistenceCheck*>(&node)) {
+            searches[&provExists->getRelation()][idxAnalysis->getSearchSignature(provExists)]++;
+        }
+    });
+
+    // index scans executed repeatedly, and relations sharing their indexes through swaps
+    std::set<const RamIndexScan*> repeated;
+    for (const auto& sub : program.getSubroutines()) {
+        visitDepthFirst(*sub.second, [&](const RamIndexScan& scan) { repeated.insert(&scan); });
+    }
+    visitDepthFirst(program, [&](const RamLoop& loop) {
+        visitDepthFirst(loop, [&](const RamIndexScan& scan) { repeated.insert(&scan); });
+    });
+    std::set<const RamRelation*> swapped;
+    visitDepthFirst(program, [&](const RamSwap& swap) {
+        swapped.insert(&swap.getFirstRelation());
+        swapped.insert(&swap.getSecondRelation());
+    });
+
+    // number of orders required for the remaining searches of a relation
+    auto countOrders = [&](const RamRelation& rel, SearchSignature without) {
+        MinIndexSelection indexes;
+        indexes.addSearch(idxAnalysis->getSearchSignature(&rel));
+        for (const auto& cur : searches[&rel]) {
+            if (cur.second > 0 && cur.first != without) {
+                indexes.addSearch(cur.first);
+            }
+        }
+        for (const auto& seek : idxAnalysis->getIndexes(rel).getPrefixSearches()) {
+            indexes.addPrefixSearch(seek.first, seek.second);
+        }
+        indexes.solve();
+        return indexes.getAllOrders().size();
+    };
+
+    bool changed = false;
+    visitDepthFirst(program, [&](const RamQuery& query) {
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> scanRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const RamIndexScan* scan = dynamic_cast<RamIndexScan*>(node.get())) {
+                const RamRelation& rel = scan->getRelation();
+                SearchSignature signature = idxAnalysis->getSearchSignature(scan);
+                if (typeid(*scan) == typeid(RamIndexScan) && scan->getTupleId() > 0 &&
+                        repeated.count(scan) == 0 && swapped.count(&rel) == 0 &&
+                        (rel.getRepresentation() == RelationRepresentation::DEFAULT ||
+                                rel.getRepresentation() == RelationRepresentation::BTREE ||
+                                rel.getRepresentation() == RelationRepresentation::INDIRECT) &&
+                        searches[&rel][signature] == 1 &&
+                        countOrders(rel, signature) < countOrders(rel, 0)) {
+                    changed = true;
+                    searches[&rel][signature] = 0;
+                    std::vector<std::unique_ptr<RamExpression>> queryPattern;
+                    for (const RamExpression* pattern : scan->getRangePattern()) {
+                        queryPattern.emplace_back(pattern->clone());
+                    }
+                    node = std::make_unique<RamHashJoin>(
+                            std::make_unique<RamRelationReference>(&rel), scan->getTupleId(),
+                            std::move(queryPattern), std::unique_ptr<RamOperation>(scan->getOperation().clone()),
+                            scan->getProfileText());
+                }
+            }
+            node->apply(makeLambdaRamMapper(scanRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(scanRewriter));
+    });
+    return changed;
+}
+
 bool TupleIdTransformer::reorderOperations(RamProgram& program) {
     bool changed = false;
     visitDepthFirst(program, [&](const RamQuery& query) {
@@ -725,6 +806,24 @@ bool HoistAggregateTransformer::hoistAggregate(RamProgram& program) {
     return changed;
 }  // namespace souffle
 
+const RamRelationOperation* ParallelTransformer::getSplittableScan(const RamTupleOperation& op) {
+    const auto* scan = dynamic_cast<const RamRelationOperation*>(&op.getOperation());
+    const auto* indexScan = dynamic_cast<const RamIndexScan*>(scan);
+    if ((dynamic_cast<const RamScan*>(scan) == nullptr && indexScan == nullptr) ||
+            scan->getRelation().getArity() == 0 ||
+            scan->getRelation().getRepresentation() == RelationRepresentation::EQREL) {
+        return nullptr;
+    }
+    // every thread evaluates the range, hence it has to be deterministic
+    bool deterministic = true;
+    if (indexScan != nullptr) {
+        for (const RamExpression* value : indexScan->getRangePattern()) {
+            visitDepthFirst(*value, [&](const RamAutoIncrement&) { deterministic = false; });
+        }
+    }
+    return deterministic ? scan : nullptr;
+}
+
 bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
     bool changed = false;
 
@@ -734,15 +833,13 @@ bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
         std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> parallelRewriter =
                 [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
             if (const RamScan* scan = dynamic_cast<RamScan*>(node.get())) {
+                // copies are parallelized too, as the threads buffer their insertions
                 if (scan->getTupleId() == 0 && scan->getRelation().getArity() > 0) {
-                    if (nullptr == dynamic_cast<RamProject*>(&scan->getOperation())) {
-                        changed = true;
-                        return std::make_unique<RamParallelScan>(
-                                std::make_unique<RamRelationReference>(&scan->getRelation()),
-                                scan->getTupleId(),
-                                std::unique_ptr<RamOperation>(scan->getOperation().clone()),
-                                scan->getProfileText());
-                    }
+                    changed = true;
+                    return std::make_unique<RamParallelScan>(
+                            std::make_unique<RamRelationReference>(&scan->getRelation()), scan->getTupleId(),
+                            std::unique_ptr<RamOperation>(scan->getOperation().clone()),
+                            scan->getProfileText());
                 }
             } else if (const RamChoice* choice = dynamic_cast<RamChoice*>(node.get())) {
                 if (choice->getTupleId() == 0) {
@@ -772,6 +869,25 @@ bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
                             std::unique_ptr<RamOperation>(indexScan->getOperation().clone()),
                             indexScan->getProfileText());
                 }
+            } else if (const auto* join = dynamic_cast<RamLeapfrogJoin*>(node.get())) {
+                if (join->getTupleId() == 0) {
+                    changed = true;
+                    std::vector<std::unique_ptr<RamRelationReference>> relRefs;
+                    std::vector<std::vector<std::unique_ptr<RamExpression>>> queryPatterns;
+                    std::vector<size_t> columns;
+                    for (size_t i = 0; i < join->getNumOperands(); ++i) {
+                        relRefs.push_back(std::make_unique<RamRelationReference>(&join->getRelation(i)));
+                        queryPatterns.emplace_back();
+                        for (const RamExpression* cur : join->getRangePattern(i)) {
+                            queryPatterns.back().push_back(std::unique_ptr<RamExpression>(cur->clone()));
+                        }
+                        columns.push_back(join->getColumn(i));
+                    }
+                    return std::make_unique<RamParallelLeapfrogJoin>(std::move(relRefs),
+                            std::move(queryPatterns), std::move(columns), join->getTupleId(),
+                            std::unique_ptr<RamOperation>(join->getOperation().clone()),
+                            join->getProfileText());
+                }
             } else if (const RamIndexChoice* indexChoice = dynamic_cast<RamIndexChoice*>(node.get())) {
                 if (indexChoice->getTupleId() == 0) {
                     changed = true;
@@ -549,6 +549,60 @@ protected:
     }
 };
 
+/**
+ * @class HashJoinTransformer
+ * @brief Convert IndexScan operations of non-recursive rules to hash joins
+ *
+ * An IndexScan operation requires its relation to maintain an index for
+ * the lifetime of the relation, which costs memory and slows down every
+ * insertion. If the search of an IndexScan is issued only once, outside
+ * of fixpoint loops, and requires an index that no other search shares,
+ * the IndexScan is rewritten to a hash join whose hash table is built when
+ * the query is entered and dropped when it is left.
+ *
+ * For example,
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON INDEX t1.y = t0.x
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN A
+ *    FOR t1 IN B ON HASH t1.y = t0.x
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ */
+class HashJoinTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "HashJoinTransformer";
+    }
+
+    /**
+     * @brief Apply hash-join conversion to the whole program
+     * @param RAM program
+     * @result A flag indicating whether the RAM program has been changed.
+     *
+     * Collects the searches of all relations and rewrites the IndexScan
+     * operations whose index would be dropped without them.
+     */
+    bool convertIndexScans(RamProgram& program);
+
+protected:
+    RamIndexAnalysis* idxAnalysis{nullptr};
+    bool transform(RamTranslationUnit& translationUnit) override {
+        idxAnalysis = translationUnit.getAnalysis<RamIndexAnalysis>();
+        return convertIndexScans(translationUnit.getProgram());
+    }
+};
+
 /**
  * @class TupleIdTransformer
  * @brief Ordering tupleIds in RamTupleOperation operations correctly
@@ -625,7 +679,7 @@ protected:
 
 /**
  * @class ParallelTransformer
- * @brief Transforms Choice/IndexChoice/IndexScan/Scan into parallel versions.
+ * @brief Transforms Choice/IndexChoice/IndexScan/Scan/LeapfrogJoin into parallel versions.
  *
  * For example ..
  *
@@ -643,6 +697,9 @@ protected:
  *     ...
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
  *
+ * If the outer loop has too few tuples at runtime to occupy all threads,
+ * the threads instead enumerate the outer loop together and split the
+ * range of a scan nested directly in it.
  */
 class ParallelTransformer : public RamTransformer {
 public:
@@ -650,6 +707,13 @@ public:
         return "ParallelTransformer";
     }
 
+    /**
+     * @brief Return the scan nested directly in a parallel operation, whose range the threads may split
+     * @param op Parallel operation
+     * @return Scan or index scan, or null if the nested operation can not be split
+     */
+    static const RamRelationOperation* getSplittableScan(const RamTupleOperation& op);
+
     /**
      * @brief Parallelize operations
      * @param program Program that is transformed
@@ -109,10 +109,13 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Project);
         FORWARD(SubroutineReturnValue);
         FORWARD(UnpackRecord);
+        FORWARD(ParallelLeapfrogJoin);
+        FORWARD(LeapfrogJoin);
         FORWARD(ParallelScan);
         FORWARD(Scan);
         FORWARD(ParallelIndexScan);
         FORWARD(IndexScan);
+        FORWARD(HashJoin);
         FORWARD(ParallelChoice);
         FORWARD(Choice);
         FORWARD(ParallelIndexChoice);
@@ -125,6 +128,8 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Store);
         FORWARD(Query);
         FORWARD(Clear);
+        FORWARD(Purge);
+        FORWARD(Facts);
         FORWARD(LogSize);
 
         FORWARD(Swap);
@@ -165,6 +170,8 @@ protected:
     LINK(AbstractLoadStore, RelationStatement);
     LINK(Query, Statement);
     LINK(Clear, RelationStatement);
+    LINK(Purge, RelationStatement);
+    LINK(Facts, RelationStatement);
     LINK(LogSize, RelationStatement);
 
     LINK(RelationStatement, Statement);
@@ -188,10 +195,13 @@ protected:
     LINK(Project, Operation);
     LINK(SubroutineReturnValue, Operation);
     LINK(UnpackRecord, TupleOperation);
+    LINK(LeapfrogJoin, TupleOperation);
+    LINK(ParallelLeapfrogJoin, LeapfrogJoin);
     LINK(Scan, RelationOperation);
     LINK(ParallelScan, Scan);
     LINK(IndexScan, IndexOperation);
     LINK(ParallelIndexScan, IndexScan);
+    LINK(HashJoin, RelationOperation);
     LINK(Choice, RelationOperation);
     LINK(ParallelChoice, Choice);
     LINK(IndexChoice, IndexOperation);
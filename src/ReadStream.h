@@ -15,11 +15,14 @@
 #pragma once
 
 #include "IODirectives.h"
+#include "IOPool.h"
 #include "RamTypes.h"
 #include "SymbolTable.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace souffle {
@@ -33,22 +36,72 @@ public:
               auxiliaryArity(auxiliaryArity) {}
     template <typename T>
     void readAll(T& relation) {
-        auto lease = symbolTable.acquireLock();
-        (void)lease;
-        while (const auto next = readNextTuple()) {
-            const RamDomain* ramDomain = next.get();
-            relation.insert(ramDomain);
+        if (std::find(symbolMask.begin(), symbolMask.begin() + arity, RamTypeAttribute::Symbol) ==
+                symbolMask.begin() + arity) {
+            while (const auto next = readNextTuple()) {
+                const RamDomain* ramDomain = next.get();
+                relation.insert(ramDomain);
+            }
+            return;
+        }
+        // relations are read concurrently, hence the symbols of a chunk of tuples are collected first and
+        // added to the symbol table in the order of the loads, such that the indices of symbols are
+        // deterministic; a load holds a single chunk at a time
+        const size_t size = symbolMask.size();
+        std::vector<RamDomain> tuples;
+        bool done = false;
+        while (!done) {
+            tuples.clear();
+            symbols.clear();
+            symbolIndices.clear();
+            while (tuples.size() < CHUNK_SIZE * size) {
+                const auto next = readNextTuple();
+                if (!next) {
+                    done = true;
+                    break;
+                }
+                tuples.insert(tuples.end(), next.get(), next.get() + size);
+            }
+            std::vector<RamDomain> indices(symbols.size());
+            IOPool::ordered(
+                    [&]() { symbolTable.lookup(symbols.data(), symbols.size(), indices.data()); }, done);
+            for (size_t i = 0; i < tuples.size(); i += size) {
+                RamDomain* tuple = &tuples[i];
+                for (size_t column = 0; column < arity; column++) {
+                    if (symbolMask[column] == RamTypeAttribute::Symbol) {
+                        tuple[column] = indices[tuple[column]];
+                    }
+                }
+                relation.insert(static_cast<const RamDomain*>(tuple));
+            }
         }
     }
 
     virtual ~ReadStream() = default;
 
 protected:
+    /** Number of tuples read before their symbols are added to the symbol table */
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+
     virtual std::unique_ptr<RamDomain[]> readNextTuple() = 0;
+
+    /** Returns the index of a symbol among the symbols of the current chunk, which readAll replaces */
+    RamDomain lookupSymbol(const std::string& symbol) {
+        auto res = symbolIndices.emplace(symbol, static_cast<RamDomain>(symbols.size()));
+        if (res.second) {
+            symbols.push_back(symbol);
+        }
+        return res.first->second;
+    }
+
     const std::vector<RamTypeAttribute>& symbolMask;
     SymbolTable& symbolTable;
     const uint8_t arity;
     const size_t auxiliaryArity;
+
+    /** The symbols of the current chunk, in the order of their first occurrence, and their indices */
+    std::vector<std::string> symbols;
+    std::unordered_map<std::string, RamDomain> symbolIndices;
 };
 
 class ReadStreamFactory {
@@ -94,7 +94,7 @@ protected:
             try {
                 switch (symbolMask.at(inputMap[column])) {
                     case RamTypeAttribute::Symbol:
-                        tuple[inputMap[column]] = symbolTable.unsafeLookup(element);
+                        tuple[inputMap[column]] = lookupSymbol(element);
                         break;
                     case RamTypeAttribute::Record:  // What should be done here?
                     case RamTypeAttribute::Signed:
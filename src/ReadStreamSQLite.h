@@ -70,7 +70,7 @@ protected:
             try {
                 switch (symbolMask.at(column)) {
                     case RamTypeAttribute::Symbol:
-                        tuple[column] = symbolTable.unsafeLookup(element);
+                        tuple[column] = lookupSymbol(element);
                         break;
                     case RamTypeAttribute::Signed:
                     case RamTypeAttribute::Unsigned:
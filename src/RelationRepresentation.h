@@ -30,6 +30,14 @@ enum class RelationRepresentation {
     BRIE,
     // equivalence relation
     EQREL,
+    // disk-backed data-structure
+    DISK,
+    // btree data-structure with indirect indexes
+    INDIRECT,
+    // btree data-structure keeping the least value of the last column per key
+    MIN_LATTICE,
+    // btree data-structure keeping the greatest value of the last column per key
+    MAX_LATTICE,
     // info relation
     INFO
 };
@@ -45,6 +53,18 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation structu
         case RelationRepresentation::EQREL:
             os << "eqrel";
             break;
+        case RelationRepresentation::DISK:
+            os << "disk";
+            break;
+        case RelationRepresentation::INDIRECT:
+            os << "indirect";
+            break;
+        case RelationRepresentation::MIN_LATTICE:
+            os << "min";
+            break;
+        case RelationRepresentation::MAX_LATTICE:
+            os << "max";
+            break;
         case RelationRepresentation::INFO:
             os << "info";
             break;
@@ -56,4 +76,13 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation structu
     return os;
 }
 
+/**
+ * Determines whether relations of the given representation are lattices, i.e., store
+ * only the best value of their last column for each combination of the other columns.
+ */
+inline bool isLattice(RelationRepresentation structure) {
+    return structure == RelationRepresentation::MIN_LATTICE ||
+           structure == RelationRepresentation::MAX_LATTICE;
+}
+
 }  // end of namespace souffle
@@ -0,0 +1,230 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file SampleProfiler.h
+ *
+ * A sampling profiler for Souffle's interpreter and compiler, attributing
+ * CPU time to the rule that is currently evaluated.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "SignalHandler.h"
+#include <atomic>
+#include <cctype>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <sys/time.h>
+
+namespace souffle {
+
+/**
+ * Class SampleProfiler periodically interrupts the program with SIGPROF
+ * signals, and counts how often each rule is under evaluation. The kernel
+ * delivers the signal to a thread consuming CPU time, and the sample is
+ * attributed to the rule of that thread: the rule recorded by the signal
+ * handler at the last debug-info statement of the thread, or of the thread
+ * starting its parallel region. Hence, rules evaluated concurrently and
+ * background I/O do not take the samples of each other; threads outside of
+ * rules, e.g., I/O threads and idle workers, count as "no rule".
+ *
+ * Samples are recorded by the signal handler into a fixed table without
+ * locks or allocations, keyed by the address of the rule text. When the
+ * profiler is stopped, the samples are written as folded stacks
+ * (relation;rule count) for flame graphs, and returned per relation for
+ * the profile events.
+ * The profiler is implemented as a singleton.
+ */
+class SampleProfiler {
+public:
+    /** sampling interval in microseconds of CPU time */
+    static constexpr long INTERVAL = 1000;
+
+    // get singleton
+    static SampleProfiler& instance() {
+        static SampleProfiler singleton;
+        return singleton;
+    }
+
+    /** set the file of the folded stacks, enabling the profiler */
+    void setOutputFile(const std::string& file) {
+        outputFile = file;
+    }
+
+    /** return whether samples are taken */
+    bool isEnabled() const {
+        return !outputFile.empty();
+    }
+
+    /***
+     * start sampling, if enabled
+     */
+    void start() {
+        if (!isEnabled() || running) {
+            return;
+        }
+        // the handler stays installed, as a signal may still be pending after stopping the timer
+        struct sigaction action {};
+        action.sa_handler = handler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            perror("Failed to set SIGPROF signal handler.");
+            return;
+        }
+        struct itimerval timer {};
+        timer.it_interval.tv_usec = INTERVAL;
+        timer.it_value.tv_usec = INTERVAL;
+        if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+            perror("Failed to set profiling timer.");
+            return;
+        }
+        running = true;
+    }
+
+    /***
+     * stop sampling, output the samples taken so far, and return the samples
+     * of each relation taken since the last stop
+     */
+    std::map<std::string, uint64_t> stop() {
+        if (running) {
+            struct itimerval timer {};
+            setitimer(ITIMER_PROF, &timer, nullptr);
+            running = false;
+        }
+        std::map<std::string, uint64_t> relationSamples = collect();
+        if (isEnabled()) {
+            std::ofstream os(outputFile);
+            if (!os.is_open()) {
+                std::cerr << "Cannot open sample profile file <" + outputFile + ">\n";
+            }
+            for (const auto& cur : stacks) {
+                os << cur.first << " " << cur.second << "\n";
+            }
+        }
+        return relationSamples;
+    }
+
+    /***
+     * record a sample of the given rule; safe to call from a signal handler
+     */
+    void record(const char* rule) {
+        if (rule == nullptr) {
+            unattributed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto hash = reinterpret_cast<uintptr_t>(rule) * 0x9e3779b97f4a7c15ULL;
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            Slot& slot = table[(hash + i) % TABLE_SIZE];
+            const char* key = slot.rule.load(std::memory_order_acquire);
+            if (key == nullptr && slot.rule.compare_exchange_strong(key, rule)) {
+                key = rule;
+            }
+            if (key == rule) {
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** get the folded stacks of the samples collected so far */
+    const std::map<std::string, uint64_t>& getStacks() const {
+        return stacks;
+    }
+
+    /** get the relation of the head of a rule text */
+    static std::string getRelationName(const std::string& rule) {
+        size_t end = 0;
+        while (end < rule.size() && (isalnum(rule[end]) != 0 || strchr("_?.@", rule[end]) != nullptr)) {
+            end++;
+        }
+        return rule.substr(0, end);
+    }
+
+private:
+    /** number of distinct rules that can be sampled */
+    static constexpr size_t TABLE_SIZE = 4096;
+
+    /** sample counter of a rule */
+    struct Slot {
+        std::atomic<const char*> rule{nullptr};
+        std::atomic<uint64_t> count{0};
+    };
+
+    Slot table[TABLE_SIZE];
+
+    /** samples taken outside of rules */
+    std::atomic<uint64_t> unattributed{0};
+
+    /** samples of rules not fitting into the table */
+    std::atomic<uint64_t> overflow{0};
+
+    /** folded stacks of the samples collected from the table */
+    std::map<std::string, uint64_t> stacks;
+
+    std::string outputFile;
+
+    bool running = false;
+
+    SampleProfiler() = default;
+
+    /**
+     * Signal handler of the profiling timer.
+     */
+    static void handler(int) {
+        instance().record(SignalHandler::threadMsg());
+    }
+
+    /** turn a rule text into a frame of a folded stack */
+    static std::string getFrame(const std::string& rule) {
+        std::string frame;
+        for (char c : rule) {
+            if (c == ';') {
+                c = ',';
+            } else if (isspace(c)) {
+                c = ' ';
+            }
+            if (c != ' ' || (!frame.empty() && frame.back() != ' ')) {
+                frame += c;
+            }
+        }
+        return frame;
+    }
+
+    /** move the samples from the table into the folded stacks, and return them per relation */
+    std::map<std::string, uint64_t> collect() {
+        std::map<std::string, uint64_t> relationSamples;
+        for (Slot& slot : table) {
+            const char* rule = slot.rule.exchange(nullptr);
+            uint64_t count = slot.count.exchange(0);
+            if (rule != nullptr && count > 0) {
+                std::string relation = getRelationName(rule);
+                stacks[relation + ";" + getFrame(rule)] += count;
+                relationSamples[relation] += count;
+            }
+        }
+        if (uint64_t count = unattributed.exchange(0)) {
+            stacks["souffle;no rule"] += count;
+        }
+        if (uint64_t count = overflow.exchange(0)) {
+            stacks["souffle;other rules"] += count;
+        }
+        return relationSamples;
+    }
+};
+
+}  // namespace souffle
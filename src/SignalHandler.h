@@ -67,6 +67,18 @@ public:
             }
         }
         msg = m;
+        threadMsg() = m;
+    }
+
+    // get signal message, i.e., the rule under evaluation
+    const char* getMsg() const {
+        return msg;
+    }
+
+    // get the rule under evaluation by the calling thread, or by the thread starting its parallel region
+    static const char*& threadMsg() {
+        static thread_local const char* m = nullptr;
+        return m;
     }
 
     /***
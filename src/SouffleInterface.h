@@ -132,6 +132,13 @@ protected:
         virtual bool equal(const iterator_base& o) const = 0;
     };
 
+    /**
+     * Iterator of the default equalRange implementation.
+     *
+     * Wraps an iterator over the whole relation and skips the tuples not matching the pattern.
+     */
+    class filter_iterator;
+
 public:
     /**
      * Destructor.
@@ -267,6 +274,26 @@ public:
      */
     virtual void insert(const tuple& t) = 0;
 
+    /**
+     * Insert multiple tuples into the relation.
+     * The tuples are given row by row, i.e., the first getArity() elements of rows form the first tuple.
+     * Symbols have to be given by their index in the symbol table of the relation.
+     *
+     * @param rows Pointer to n * getArity() elements (const RamDomain*)
+     * @param n The number of tuples (std::size_t)
+     */
+    virtual void insertMany(const RamDomain* rows, std::size_t n);
+
+    /**
+     * Export the tuples of the relation column by column.
+     * Element j of columns[i] is set to column i of the j-th tuple of the relation, so that each of the
+     * getArity() buffers has to provide space for size() elements.
+     * Symbols are exported by their index in the symbol table of the relation.
+     *
+     * @param columns Pointer to getArity() buffers (RamDomain* const*)
+     */
+    virtual void exportColumns(RamDomain* const* columns) const;
+
     /**
      * Check whether a tuple exists in a relation.
      * The definition of contains has to be defined by the child class of relation class.
@@ -284,6 +311,19 @@ public:
      */
     virtual iterator begin() const = 0;
 
+    /**
+     * Return the range of tuples that agree with the pattern on the columns selected by the mask.
+     * Bit i of the mask selects column i; the remaining columns of the pattern are ignored.
+     *
+     * Relations answer the query with an index whose order starts with the selected columns. If no index
+     * matches, the default implementation scans the relation and skips the tuples not matching the pattern.
+     *
+     * @param pattern Reference to a tuple object of this relation
+     * @param mask Columns to be matched (SearchSignature)
+     * @return Pair of iterators pointing to the first matching tuple and next to the last matching tuple
+     */
+    virtual std::pair<iterator, iterator> equalRange(const tuple& pattern, SearchSignature mask) const;
+
     /**
      * Return an iterator pointing to next to the last tuple of the relation.
      *
@@ -591,6 +631,94 @@ public:
     }
 };
 
+class Relation::filter_iterator : public Relation::iterator_base {
+    /** Current position in the wrapped relation */
+    iterator cur;
+
+    /** End of the wrapped relation */
+    iterator fin;
+
+    /** Values of the pattern */
+    std::vector<RamDomain> pattern;
+
+    /** Columns to be matched */
+    SearchSignature mask;
+
+    /** Move forward to the next matching tuple or the end */
+    void skip() {
+        while (cur != fin && !matches(*cur)) {
+            ++cur;
+        }
+    }
+
+    bool matches(const tuple& t) const {
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (((mask >> i) & 1) != 0 && t[i] != pattern[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    /** Identifies filter iterators, which cannot clash with the ids of the relations */
+    static constexpr uint32_t ID = static_cast<uint32_t>(-1);
+
+    filter_iterator(iterator cur, iterator fin, std::vector<RamDomain> pattern, SearchSignature mask)
+            : iterator_base(ID), cur(std::move(cur)), fin(std::move(fin)), pattern(std::move(pattern)),
+              mask(mask) {
+        skip();
+    }
+
+    void operator++() override {
+        ++cur;
+        skip();
+    }
+
+    tuple& operator*() override {
+        return *cur;
+    }
+
+    iterator_base* clone() const override {
+        return new filter_iterator(*this);
+    }
+
+protected:
+    bool equal(const iterator_base& o) const override {
+        const auto& casted = static_cast<const filter_iterator&>(o);
+        return cur == casted.cur;
+    }
+};
+
+inline void Relation::insertMany(const RamDomain* rows, std::size_t n) {
+    size_t arity = getArity();
+    for (size_t row = 0; row < n; row++) {
+        tuple t(this);
+        for (size_t i = 0; i < arity; i++) {
+            t[i] = rows[row * arity + i];
+        }
+        insert(t);
+    }
+}
+
+inline void Relation::exportColumns(RamDomain* const* columns) const {
+    size_t arity = getArity();
+    size_t row = 0;
+    for (const auto& t : *this) {
+        for (size_t i = 0; i < arity; i++) {
+            columns[i][row] = t[i];
+        }
+        row++;
+    }
+}
+
+inline std::pair<Relation::iterator, Relation::iterator> Relation::equalRange(
+        const tuple& pattern, SearchSignature mask) const {
+    std::vector<RamDomain> values(pattern.data, pattern.data + pattern.size());
+    return std::make_pair(iterator(new filter_iterator(begin(), end(), values, mask)),
+            iterator(new filter_iterator(end(), end(), values, mask)));
+}
+
 /**
  * Abstract base class for generated Datalog programs.
  */
@@ -791,6 +919,41 @@ public:
         return allRelations;
     }
 
+    /**
+     * Insert multiple tuples, given row by row, into the target relation.
+     *
+     * @param name The name of the target relation (const std::string)
+     * @param rows Pointer to n * arity elements (const RamDomain*)
+     * @param n The number of tuples (std::size_t)
+     * @return False if the relation was not found, otherwise true (bool)
+     * @see Relation::insertMany()
+     */
+    bool insertMany(const std::string& name, const RamDomain* rows, std::size_t n) {
+        Relation* relation = getRelation(name);
+        if (relation == nullptr) {
+            return false;
+        }
+        relation->insertMany(rows, n);
+        return true;
+    }
+
+    /**
+     * Export the tuples of the target relation column by column into the given buffers.
+     *
+     * @param name The name of the target relation (const std::string)
+     * @param columns Pointer to arity buffers of size elements each (RamDomain* const*)
+     * @return False if the relation was not found, otherwise true (bool)
+     * @see Relation::exportColumns()
+     */
+    bool exportColumns(const std::string& name, RamDomain* const* columns) const {
+        Relation* relation = getRelation(name);
+        if (relation == nullptr) {
+            return false;
+        }
+        relation->exportColumns(columns);
+        return true;
+    }
+
     /**
      * Execute a subroutine
      * @param name  Name of a subroutine (std:string)
@@ -800,6 +963,20 @@ public:
     virtual void executeSubroutine(
             std::string name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) {}
 
+    /**
+     * Execute a subroutine once for each of the given arguments
+     * @param name  Name of a subroutine (std:string)
+     * @param args Arguments of each invocation (std::vector<std::vector<RamDomain>>&)
+     * @param rets Return values of each invocation (std::vector<std::vector<RamDomain>>&)
+     */
+    virtual void executeSubroutineBatch(std::string name, const std::vector<std::vector<RamDomain>>& args,
+            std::vector<std::vector<RamDomain>>& rets) {
+        rets.resize(args.size());
+        for (size_t i = 0; i < args.size(); i++) {
+            executeSubroutine(name, args[i], rets[i]);
+        }
+    }
+
     /**
      * Get the symbol table of the program.
      */
@@ -119,6 +119,17 @@ public:
         }
     }
 
+    /** Find the indices of n symbols, inserting the symbols that do not exist there already, while
+     * acquiring the lock only once. */
+    void lookup(const std::string* symbols, size_t n, RamDomain* indices) {
+        auto lease = access.acquire();
+        (void)lease;  // avoid warning;
+        strToNum.reserve(size() + n);
+        for (size_t i = 0; i < n; i++) {
+            indices[i] = static_cast<RamDomain>(newSymbolOfIndex(symbols[i]));
+        }
+    }
+
     /** Finds the index of a symbol in the table, giving an error if it's not found */
     RamDomain lookupExisting(const std::string& symbol) const {
         {
@@ -156,6 +167,21 @@ public:
         }
     }
 
+    /** Find the symbols of n indices while acquiring the lock only once, note that this gives an error if
+     * an index is out of bounds. */
+    void resolve(const RamDomain* indices, size_t n, const std::string** symbols) const {
+        auto lease = access.acquire();
+        (void)lease;  // avoid warning;
+        for (size_t i = 0; i < n; i++) {
+            auto pos = static_cast<size_t>(indices[i]);
+            if (pos >= size()) {
+                std::cerr << "Error index out of bounds in call to SymbolTable::resolve.\n";
+                exit(1);
+            }
+            symbols[i] = &numToStr[pos];
+        }
+    }
+
     const std::string& unsafeResolve(const RamDomain index) const {
         return numToStr[static_cast<size_t>(index)];
     }
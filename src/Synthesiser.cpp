@@ -22,10 +22,13 @@
 #include "RamCondition.h"
 #include "RamExpression.h"
 #include "RamIndexAnalysis.h"
+#include "RamInsertBufferAnalysis.h"
+#include "RamLayoutAnalysis.h"
 #include "RamNode.h"
 #include "RamOperation.h"
 #include "RamProgram.h"
 #include "RamRelation.h"
+#include "RamTransforms.h"
 #include "RamTranslationUnit.h"
 #include "RamTypes.h"
 #include "RamUtils.h"
@@ -71,6 +74,10 @@ size_t Synthesiser::lookupReadIdx(const std::string& txt) {
     }
 }
 
+bool Synthesiser::isFiltered(const RamRelation& rel) const {
+    return filteredRelations.find(rel.getName()) != filteredRelations.end();
+}
+
 /** Convert RAM identifier */
 const std::string Synthesiser::convertRamIdent(const std::string& name) {
     auto it = identifiers.find(name);
@@ -161,6 +168,10 @@ std::set<const RamRelation*> Synthesiser::getReferencedRelations(const RamOperat
             res.insert(&provExists->getRelation());
         } else if (auto project = dynamic_cast<const RamProject*>(&node)) {
             res.insert(&project->getRelation());
+        } else if (auto join = dynamic_cast<const RamLeapfrogJoin*>(&node)) {
+            for (size_t i = 0; i < join->getNumOperands(); i++) {
+                res.insert(&join->getRelation(i));
+            }
         }
     });
     return res;
@@ -171,6 +182,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
     private:
         Synthesiser& synthesiser;
         RamIndexAnalysis* isa;
+        RamInsertBufferAnalysis* iba;
 
 // macros to add comments to generated code for debugging
 #ifndef PRINT_BEGIN_COMMENT
@@ -188,10 +200,15 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         std::function<void(std::ostream&, const RamNode*)> rec;
         std::ostringstream preamble;
         bool preambleIssued = false;
+        // whether the parallel loop of the current query steals work
+        bool stealingIssued = false;
+        // insertion buffers of the buffered projections of the current query
+        std::map<const RamProject*, size_t> insertBuffers;
 
     public:
         CodeEmitter(Synthesiser& syn)
-                : synthesiser(syn), isa(syn.getTranslationUnit().getAnalysis<RamIndexAnalysis>()) {
+                : synthesiser(syn), isa(syn.getTranslationUnit().getAnalysis<RamIndexAnalysis>()),
+                  iba(syn.getTranslationUnit().getAnalysis<RamInsertBufferAnalysis>()) {
             rec = [&](std::ostream& out, const RamNode* node) { this->visit(*node, out); };
         }
 
@@ -230,6 +247,15 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitStore(const RamStore& store, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
+            // the relation is not modified until it is cleared, which waits for the write
+            out << "ioPool.submit(" << synthesiser.getRelationName(store.getRelation()) << ".get(),[&]() {\n";
+            emitWrite(store, out);
+            out << "});\n";
+            PRINT_END_COMMENT(out);
+        }
+
+        /** emit the write of a store, whose errors are rethrown by the pool on the evaluating thread */
+        void emitWrite(const RamStore& store, std::ostream& out) {
             out << "if (performIO) {\n";
 
             std::vector<RamTypeAttribute> symbolMask;
@@ -237,7 +263,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 symbolMask.push_back(RamPrimitiveFromChar(cur[0]));
             }
             for (IODirectives ioDirectives : store.getIODirectives()) {
-                out << "try {";
+                out << "{";
                 out << "std::map<std::string, std::string> directiveMap(" << ioDirectives << ");\n";
                 out << R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
                 out << "directiveMap[\"filename\"].front() != '/') {";
@@ -249,15 +275,24 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << ", symTable, ioDirectives";
                 out << ", " << store.getRelation().getAuxiliaryArity();
                 out << ")->writeAll(*" << synthesiser.getRelationName(store.getRelation()) << ");\n";
-                out << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+                out << "}\n";
             }
             out << "}\n";
-            PRINT_END_COMMENT(out);
         }
 
         void visitQuery(const RamQuery& query, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
 
+            // adapt the filters of the relations checked by the query to their current size
+            std::set<std::string> filtered;
+            visitDepthFirst(query, [&](const RamExistenceCheck& exists) {
+                const auto& rel = exists.getRelation();
+                if (isa->isTotalSignature(&exists) && synthesiser.isFiltered(rel) &&
+                        filtered.insert(rel.getName()).second) {
+                    out << synthesiser.getRelationName(rel) << "->updateFilter();\n";
+                }
+            });
+
             // split terms of conditions of outer filter operation
             // into terms that require a context and terms that
             // do not require a context
@@ -291,6 +326,34 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             // enclose operation in its own scope
             out << "{\n";
 
+            // build the hash tables of hash joins before entering the loop nest
+            visitDepthFirst(*next, [&](const RamHashJoin& join) {
+                const auto& rel = join.getRelation();
+                out << "HashJoinTable hashTable" << join.getTupleId() << "(" << rel.getArity() << ",{"
+                    << souffle::join(join.getKeyColumns()) << "});\n";
+                out << "{\n";
+                out << "auto part = " << synthesiser.getRelationName(rel) << "->partition();\n";
+                out << "PARALLEL_START;\n";
+                out << "pfor(auto it = part.begin(); it<part.end(); ++it) {\n";
+                out << "for(const auto& tuple : *it) {\n";
+                out << "hashTable" << join.getTupleId() << ".insert(&tuple[0]);\n";
+                out << "}\n";
+                out << "}\n";
+                out << "PARALLEL_END;\n";
+                out << "}\n";
+            });
+
+            // create the insertion buffers of buffered projections
+            insertBuffers.clear();
+            visitDepthFirst(*next, [&](const RamProject& project) {
+                if (iba->isBuffered(project)) {
+                    size_t id = insertBuffers.size();
+                    insertBuffers[&project] = id;
+                    out << "InsertBuffer insertBuffer" << id << "(" << project.getRelation().getArity()
+                        << ");\n";
+                }
+            });
+
             // check whether loop nest can be parallelized
             bool isParallel = false;
             visitDepthFirst(*next, [&](const RamAbstractParallel&) { isParallel = true; });
@@ -299,6 +362,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             preamble.str("");
             preamble.clear();
             preambleIssued = false;
+            stealingIssued = false;
 
             // create operation contexts for this operation
             for (const RamRelation* rel : synthesiser.getReferencedRelations(query.getOperation())) {
@@ -335,6 +399,31 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << "PARALLEL_END;\n";  // end parallel
             }
 
+            if (stealingIssued && Global::config().has("profile")) {
+                out << "ProfileEventSingleton::instance().makeBalanceEvent("
+                       "SignalHandler::instance()->getMsg(), stealing.getThreadTimes(), "
+                       "stealing.getChunkTimes());\n";
+            }
+
+            // merge the insertion buffers into their relations
+            visitDepthFirst(*next, [&](const RamProject& project) {
+                auto buffer = insertBuffers.find(&project);
+                if (buffer == insertBuffers.end()) {
+                    return;
+                }
+                const auto& rel = project.getRelation();
+                auto relName = synthesiser.getRelationName(rel);
+                // each merge task inserts with its own hints; insertions into lattices read the
+                // lattice, hence they are not merged in parallel
+                out << "insertBuffer" << buffer->second << ".merge([&]() {\n";
+                out << "return [&, mergeCtxt = " << relName
+                    << "->createContext()](const RamDomain* tuple) mutable {\n";
+                out << relName << "->insert(reinterpret_cast<const Tuple<RamDomain," << rel.getArity()
+                    << ">&>(*tuple), mergeCtxt);\n";
+                out << "};\n";
+                out << "}, " << (isLattice(rel.getRepresentation()) ? "false" : "true") << ");\n";
+            });
+
             out << "}\n";
             out << "();";  // call lambda
 
@@ -348,6 +437,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         void visitClear(const RamClear& clear, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
 
+            // wait for pending writes of the relation
+            out << "ioPool.wait(" << synthesiser.getRelationName(clear.getRelation()) << ".get());\n";
             out << "if (!isHintsProfilingEnabled()"
                 << (clear.getRelation().isTemp() ? ") " : "&& performIO) ");
             out << synthesiser.getRelationName(clear.getRelation()) << "->"
@@ -356,6 +447,40 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitPurge(const RamPurge& purge, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+
+            // wait for pending writes of the relation
+            out << "ioPool.wait(" << synthesiser.getRelationName(purge.getRelation()) << ".get());\n";
+            out << synthesiser.getRelationName(purge.getRelation()) << "->"
+                << "purge();\n";
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitFacts(const RamFacts& facts, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto& rel = facts.getRelation();
+            auto arity = rel.getArity();
+            auto relName = synthesiser.getRelationName(rel);
+            const auto& values = facts.getValues();
+
+            // emit the facts as a constant table, which is inserted in a single loop
+            out << "{\n";
+            out << "static const Tuple<RamDomain," << arity << "> facts[] = {\n";
+            for (size_t i = 0; i < values.size(); i += arity) {
+                out << "{{" << join(values.begin() + i, values.begin() + i + arity, ",") << "}},\n";
+            }
+            out << "};\n";
+            out << "auto factsCtxt = " << relName << "->createContext();\n";
+            out << "for (const auto& fact : facts) {\n";
+            out << relName << "->insert(fact, factsCtxt);\n";
+            out << "}\n";
+            out << "}\n";
+
+            PRINT_END_COMMENT(out);
+        }
+
         void visitLogSize(const RamLogSize& size, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << "ProfileEventSingleton::instance().makeQuantityEvent( R\"(";
@@ -391,6 +516,30 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 return;
             }
 
+            // only loads => run them concurrently on the IO pool
+            bool onlyLoads = all_of(stmts, [](const RamStatement* stmt) {
+                if (const auto* timer = dynamic_cast<const RamLogRelationTimer*>(stmt)) {
+                    stmt = &timer->getStatement();
+                }
+                return dynamic_cast<const RamLoad*>(stmt) != nullptr;
+            });
+            if (onlyLoads) {
+                std::vector<std::string> relNames;
+                visitDepthFirst(parallel, [&](const RamLoad& load) {
+                    relNames.push_back(synthesiser.getRelationName(load.getRelation()));
+                });
+                for (size_t i = 0; i < stmts.size(); i++) {
+                    out << "ioPool.submit(" << relNames[i] << ".get(),[&]() {\n";
+                    visit(stmts[i], out);
+                    out << "});\n";
+                }
+                for (const auto& relName : relNames) {
+                    out << "ioPool.wait(" << relName << ".get());\n";
+                }
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             // more than one => parallel sections
 
             // start parallel section
@@ -454,6 +603,18 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             const auto& rel = timer.getRelation();
             auto relName = synthesiser.getRelationName(rel);
 
+            // a store is timed where it is performed, i.e., on the IO pool
+            if (const auto* store = dynamic_cast<const RamStore*>(&timer.getStatement())) {
+                out << "ioPool.submit(" << relName << ".get(),[&, iteration = iter.load()]() {\n";
+                out << "\tLogger logger(R\"_(" << timer.getMessage() << ")_\",iteration, [&](){return "
+                    << relName << "->size();});\n";
+                emitWrite(*store, out);
+                out << "});\n";
+                out << "}\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             out << "\tLogger logger(R\"_(" << timer.getMessage() << ")_\",iter, [&](){return " << relName
                 << "->size();});\n";
             // insert statement to be measured
@@ -521,21 +682,93 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
+            emitStealingPartition(out);
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            const RamRelationOperation* nested = ParallelTransformer::getSplittableScan(pscan);
+            if (nested != nullptr) {
+                emitSplitNested(pscan, *nested, out);
+            }
+            out << "while(auto* batch = stealing.next()){\n";
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
+            out << "for(const auto& env0 : *batch) {\n";
 
             visitTupleOperation(pscan, out);
 
             out << "}\n";
             out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
+            if (nested != nullptr) {
+                out << "}\n";
+            }
 
             PRINT_END_COMMENT(out);
         }
 
+        /**
+         * Emits the work-stealing partition over the chunks in part, whose balance is reported after
+         * the parallel region of the query if profiling.
+         */
+        void emitStealingPartition(std::ostream& out) {
+            stealingIssued = true;
+            out << "auto stealing = makeStealingPartition(part, "
+                << (Global::config().has("profile") ? "true" : "false") << ");\n";
+        }
+
+        /**
+         * Emits the loop of a parallel operation with too few tuples to occupy all threads, which
+         * every thread enumerates while splitting the range of the nested scan. The loop is followed
+         * by the else branch for the common case, which the caller has to close.
+         */
+        void emitSplitNested(
+                const RamTupleOperation& op, const RamRelationOperation& nested, std::ostream& out) {
+            const auto& rel = nested.getRelation();
+            auto relName = synthesiser.getRelationName(rel);
+
+            out << "if(part.size() < static_cast<std::size_t>(MAX_THREADS)) {\n";
+            out << "for(auto it = part.begin(); it<part.end();++it){\n";
+            out << "for(const auto& env0 : *it) {\n";
+            if (const auto* iscan = dynamic_cast<const RamIndexScan*>(&nested)) {
+                auto arity = rel.getArity();
+                const auto& rangePattern = iscan->getRangePattern();
+                out << "const Tuple<RamDomain," << arity << "> key{{";
+                for (size_t i = 0; i < arity; i++) {
+                    if (!isRamUndefValue(rangePattern[i])) {
+                        visit(rangePattern[i], out);
+                    } else {
+                        out << "0";
+                    }
+                    if (i + 1 < arity) {
+                        out << ",";
+                    }
+                }
+                out << "}};\n";
+                out << "auto range = " << relName << "->"
+                    << "equalRange_" << isa->getSearchSignature(iscan) << "(key,"
+                    << "READ_OP_CONTEXT(" << synthesiser.getOpContextName(rel) << "));\n";
+                out << "auto nestedPart = range.partition();\n";
+            } else {
+                out << "auto nestedPart = " << relName << "->partition();\n";
+            }
+            out << "pfor(auto nestedIt = nestedPart.begin(); nestedIt<nestedPart.end(); ++nestedIt) {\n";
+            out << "try{\n";
+            out << "for(const auto& env" << nested.getTupleId() << " : *nestedIt) {\n";
+
+            visitTupleOperation(nested, out);
+
+            out << "}\n";
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
+            // every thread enumerates the tuples, but only one counts them
+            if (Global::config().has("profile") && !op.getProfileText().empty()) {
+                out << "#pragma omp master\n";
+                out << "freqs[" << synthesiser.lookupFreqIdx(op.getProfileText()) << "]++;\n";
+            }
+            out << "}\n";
+            out << "}\n";
+            out << "} else {\n";
+        }
+
         void visitScan(const RamScan& scan, std::ostream& out) override {
             const auto& rel = scan.getRelation();
             auto relName = synthesiser.getRelationName(rel);
@@ -654,6 +887,35 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitHashJoin(const RamHashJoin& join, std::ostream& out) override {
+            const auto& rel = join.getRelation();
+            auto identifier = join.getTupleId();
+            auto arity = rel.getArity();
+            const auto& rangePattern = join.getRangePattern();
+
+            PRINT_BEGIN_COMMENT(out);
+
+            out << "const Tuple<RamDomain," << arity << "> key" << identifier << "{{";
+            for (size_t i = 0; i < arity; i++) {
+                if (!isRamUndefValue(rangePattern[i])) {
+                    visit(rangePattern[i], out);
+                } else {
+                    out << "0";
+                }
+                if (i + 1 < arity) {
+                    out << ",";
+                }
+            }
+            out << "}};\n";
+            out << "for(const RamDomain* env" << identifier << " : hashTable" << identifier << ".probe(&key"
+                << identifier << "[0])) {\n";
+
+            visitTupleOperation(join, out);
+
+            out << "}\n";
+            PRINT_END_COMMENT(out);
+        }
+
         void visitParallelIndexScan(const RamParallelIndexScan& piscan, std::ostream& out) override {
             const auto& rel = piscan.getRelation();
             auto relName = synthesiser.getRelationName(rel);
@@ -687,17 +949,25 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 // TODO (b-scholz): context may be missing here?
                 << "equalRange_" << keys << "(key);\n";
             out << "auto part = range.partition();\n";
+            emitStealingPartition(out);
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            const RamRelationOperation* nested = ParallelTransformer::getSplittableScan(piscan);
+            if (nested != nullptr) {
+                emitSplitNested(piscan, *nested, out);
+            }
+            out << "while(auto* batch = stealing.next()){\n";
             out << "try{\n";
-            out << "for(const auto& env0 : *it) {\n";
+            out << "for(const auto& env0 : *batch) {\n";
 
             visitTupleOperation(piscan, out);
 
             out << "}\n";
             out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
+            if (nested != nullptr) {
+                out << "}\n";
+            }
 
             PRINT_END_COMMENT(out);
         }
@@ -834,6 +1104,102 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitLeapfrogJoin(const RamLeapfrogJoin& join, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            emitLeapfrogJoin(join, false, out);
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitParallelLeapfrogJoin(const RamParallelLeapfrogJoin& join, std::ostream& out) override {
+            assert(join.getTupleId() == 0 && "not outer-most loop");
+
+            assert(!preambleIssued && "only first loop can be made parallel");
+            preambleIssued = true;
+
+            PRINT_BEGIN_COMMENT(out);
+
+            // split the values of the join at the starts of the chunks of the index of the first operand,
+            // and let the threads join the values of a partition each at a time
+            out << "auto partitions = splitLeapfrogRange(" << synthesiser.getRelationName(join.getRelation(0))
+                << "->split_" << isa->getSearchSignature(&join, 0) << "_" << join.getColumn(0) << "());\n";
+            out << "PARALLEL_START;\n";
+            out << preamble.str();
+            out << "pfor(auto it = partitions.begin(); it < partitions.end(); ++it) {\n";
+            out << "try{\n";
+            emitLeapfrogJoin(join, true, out);
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
+
+            PRINT_END_COMMENT(out);
+        }
+
+        /**
+         * Emits the enumeration of the values of a leapfrog join. If partitioned, only the values
+         * of the partition *it are enumerated.
+         */
+        void emitLeapfrogJoin(const RamLeapfrogJoin& join, bool partitioned, std::ostream& out) {
+            auto identifier = join.getTupleId();
+
+            // seek function over the operands of the join
+            out << "auto seek" << identifier << " = [&](std::size_t i, RamDomain value, RamDomain& res) {\n";
+            out << "switch (i) {\n";
+            for (size_t i = 0; i < join.getNumOperands(); i++) {
+                const auto& rel = join.getRelation(i);
+                auto relName = synthesiser.getRelationName(rel);
+                auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
+                auto keys = isa->getSearchSignature(&join, i);
+                auto column = join.getColumn(i);
+                auto arity = rel.getArity();
+                const auto& rangePattern = join.getRangePattern(i);
+
+                out << "case " << i << ": {\n";
+                out << "const Tuple<RamDomain," << arity << "> low{{";
+                for (size_t j = 0; j < arity; j++) {
+                    if (j == column) {
+                        out << "value";
+                    } else if (!isRamUndefValue(rangePattern[j])) {
+                        visit(rangePattern[j], out);
+                    } else {
+                        out << "MIN_RAM_DOMAIN";
+                    }
+                    if (j + 1 < arity) {
+                        out << ",";
+                    }
+                }
+                out << "}};\n";
+                out << "const auto* tuple = " << relName << "->seek_" << keys << "_" << column << "(low,"
+                    << ctxName << ");\n";
+                out << "if (tuple == nullptr";
+                for (size_t j = 0; j < arity; j++) {
+                    if (j != column && !isRamUndefValue(rangePattern[j])) {
+                        out << " || (*tuple)[" << j << "] != low[" << j << "]";
+                    }
+                }
+                out << ") return false;\n";
+                out << "res = (*tuple)[" << column << "];\n";
+                out << "return true;\n";
+                out << "}\n";
+            }
+            out << "}\n";
+            out << "return false;\n";
+            out << "};\n";
+
+            // enumerate the values of the intersection
+            out << "LeapfrogIntersection<decltype(seek" << identifier << ")> join" << identifier << "("
+                << join.getNumOperands() << ", seek" << identifier;
+            if (partitioned) {
+                out << ", it->first, it->second";
+            }
+            out << ");\n";
+            out << "for (RamDomain value" << identifier << "; join" << identifier << ".next(value"
+                << identifier << ");) {\n";
+            out << "const Tuple<RamDomain,1> env" << identifier << "{{value" << identifier << "}};\n";
+
+            visitTupleOperation(join, out);
+
+            out << "}\n";
+        }
+
         void visitIndexAggregate(const RamIndexAggregate& aggregate, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             // get some properties
@@ -1091,9 +1457,18 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                     << join(project.getValues(), "),static_cast<RamDomain>(", rec) << ")}};\n";
             }
 
-            // insert tuple
-            out << relName << "->"
-                << "insert(tuple," << ctxName << ");\n";
+            // insert tuple, or buffer it if the query does not read the relation
+            auto buffer = insertBuffers.find(&project);
+            if (buffer != insertBuffers.end()) {
+                // a full buffer is flushed into the relation by the thread
+                out << "insertBuffer" << buffer->second << ".insert(&tuple[0], [&](const RamDomain* t) {\n";
+                out << relName << "->insert(reinterpret_cast<const Tuple<RamDomain," << arity << ">&>(*t),"
+                    << ctxName << ");\n";
+                out << "});\n";
+            } else {
+                out << relName << "->"
+                    << "insert(tuple," << ctxName << ");\n";
+            }
 
             PRINT_END_COMMENT(out);
         }
@@ -1685,12 +2060,53 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 }
 
 void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary) {
+    generateProgram(os, os, nullptr, id, withSharedLibrary);
+}
+
+void Synthesiser::generateCode(std::ostream& header, const std::string& headerName, std::ostream& main,
+        std::vector<std::string>& units, const std::string& id, bool& withSharedLibrary) {
+    // the precompiled header of the runtime can only be used if it is included first
+    const std::string prologue = "#include \"souffle/CompiledSouffle.h\"\n#include \"" + headerName +
+                                 "\"\n\nnamespace souffle {\nusing namespace ram;\n";
+
+    std::vector<std::string> bodies;
+    main << prologue;
+    generateProgram(header, main, &bodies, id, withSharedLibrary);
+    for (const auto& body : bodies) {
+        units.push_back(prologue + body + "}  // end of namespace souffle\n");
+    }
+}
+
+void Synthesiser::generateProgram(std::ostream& os, std::ostream& defs, std::vector<std::string>* units,
+        const std::string& id, bool& withSharedLibrary) {
     // ---------------------------------------------------------------
     //                      Auto-Index Generation
     // ---------------------------------------------------------------
     const SymbolTable& symTable = translationUnit.getSymbolTable();
     const RamProgram& prog = translationUnit.getProgram();
     auto* idxAnalysis = translationUnit.getAnalysis<RamIndexAnalysis>();
+    auto* layoutAnalysis = translationUnit.getAnalysis<RamLayoutAnalysis>();
+
+    // relations probed by total existence checks are guarded by filters; the relations
+    // they are swapped with need the same type
+    filteredRelations.clear();
+    if (!Global::config().has("provenance")) {
+        visitDepthFirst(prog.getMain(), [&](const RamExistenceCheck& exists) {
+            const auto& rel = exists.getRelation();
+            if (idxAnalysis->isTotalSignature(&exists) &&
+                    rel.getRepresentation() != RelationRepresentation::EQREL) {
+                filteredRelations.insert(rel.getName());
+            }
+        });
+        visitDepthFirst(prog.getMain(), [&](const RamSwap& swap) {
+            const auto& first = swap.getFirstRelation();
+            const auto& second = swap.getSecondRelation();
+            if (isFiltered(first) || isFiltered(second)) {
+                filteredRelations.insert(first.getName());
+                filteredRelations.insert(second.getName());
+            }
+        });
+    }
 
     // ---------------------------------------------------------------
     //                      Code Generation
@@ -1700,8 +2116,15 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     std::string classname = "Sf_" + id;
 
-    // generate C++ program
-    os << "\n#include \"souffle/CompiledSouffle.h\"\n";
+    // the code is split into a header and units
+    bool split = units != nullptr;
+
+    // generate C++ program; the units include the runtime before the header
+    if (split) {
+        os << "#pragma once\n";
+    } else {
+        os << "\n#include \"souffle/CompiledSouffle.h\"\n";
+    }
     if (Global::config().has("provenance")) {
         os << "#include <mutex>\n";
         os << "#include \"souffle/Explain.h\"\n";
@@ -1750,8 +2173,8 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     // synthesise data-structures for relations
     for (auto rel : prog.getRelations()) {
         bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                *rel, idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(*rel, idxAnalysis->getIndexes(*rel),
+                Global::config().has("provenance") && !isProvInfo, layoutAnalysis->isIndirect(*rel));
 
         generateRelationTypeStruct(os, std::move(relationType));
     }
@@ -1801,15 +2224,27 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     // declare symbol table
     os << "// -- initialize symbol table --\n";
 
-    os << "SymbolTable symTable\n";
-    if (symTable.size() > 0) {
-        os << "{\n";
+    std::ostream& symbols = split ? defs : os;
+    if (split) {
+        // the symbols are defined in the main unit such that the header does not change with them
+        os << "static SymbolTable makeSymbolTable();\n";
+        os << "SymbolTable symTable = makeSymbolTable();\n";
+        defs << "SymbolTable " << classname << "::makeSymbolTable() {\n";
+        defs << "return SymbolTable";
+    } else {
+        os << "SymbolTable symTable\n";
+    }
+    if (symTable.size() > 0 || split) {
+        symbols << "{\n";
         for (size_t i = 0; i < symTable.size(); i++) {
-            os << "\tR\"_(" << symTable.resolve(i) << ")_\",\n";
+            symbols << "\tR\"_(" << symTable.resolve(i) << ")_\",\n";
         }
-        os << "}";
+        symbols << "}";
+    }
+    symbols << ";";
+    if (split) {
+        defs << "\n}\n";
     }
-    os << ";";
 
     // declare record table
     os << "// -- initialize record table --\n";
@@ -1834,6 +2269,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     // print relation definitions
     std::string initCons;     // initialization of constructor
     std::string registerRel;  // registration of relations
+    std::string linkRel;      // dominators of the delta and new relations of lattices
     int relCtr = 0;
     std::set<std::string> storeRelations;
     std::set<std::string> loadRelations;
@@ -1849,12 +2285,28 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         const std::string& datalogName = rel->getName();
         const std::string& cppName = getRelationName(*rel);
 
+        // the tuples of a lattice dominate the tuples inserted into its delta and new relations
+        if (rel->isTemp() && isLattice(rel->getRepresentation())) {
+            for (const std::string prefix : {"@delta_", "@new_"}) {
+                if (datalogName.compare(0, prefix.size(), prefix) == 0) {
+                    for (auto base : prog.getRelations()) {
+                        if (base->getName() == datalogName.substr(prefix.size())) {
+                            linkRel += cppName + "->dominator = " + getRelationName(*base) + ".get();\n";
+                        }
+                    }
+                }
+            }
+        }
+
         // TODO(b-scholz): we need a qualifier for info relations used by the provenance system
         // this would permit a more efficient storage of relations (no indexes!!)
         bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                *rel, idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
-        const std::string& type = relationType->getTypeName();
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(*rel, idxAnalysis->getIndexes(*rel),
+                Global::config().has("provenance") && !isProvInfo, layoutAnalysis->isIndirect(*rel));
+        std::string type = relationType->getTypeName();
+        if (isFiltered(*rel)) {
+            type = "souffle::FilteredRelation<" + type + "," + std::to_string(arity) + ">";
+        }
 
         // defining table
         os << "// -- Table: " << datalogName << "\n";
@@ -1922,12 +2374,23 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         os << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
     }
     os << registerRel;
+    os << linkRel;
     os << "}\n";
     // -- destructor --
 
     os << "~" << classname << "() {\n";
     os << "}\n";
 
+    // -- evaluation of the units --
+    // the state of the run function is passed by reference, since it is captured by IO tasks
+    const std::string unitParameters =
+            "(const std::string& inputDirectory, const std::string& outputDirectory, const bool& performIO, "
+            "IOPool& ioPool, std::atomic<size_t>& iter, std::atomic<RamDomain>& ctr)";
+    if (split) {
+        os << "private:\ntemplate <size_t unit>\nvoid evaluateUnit" << unitParameters << ";\n";
+        os << "void evaluate" << unitParameters << ";\n";
+    }
+
     // -- run function --
     os << "private:\nvoid runFunction(std::string inputDirectory = \".\", "
           "std::string outputDirectory = \".\", bool performIO = false) "
@@ -1937,10 +2400,11 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     if (Global::config().has("verbose")) {
         os << "SignalHandler::instance()->enableLogging();\n";
     }
+    os << "SampleProfiler::instance().start();\n";
     bool hasIncrement = false;
     visitDepthFirst(prog.getMain(), [&](const RamAutoIncrement& inc) { hasIncrement = true; });
     // initialize counter
-    if (hasIncrement) {
+    if (hasIncrement || split) {
         os << "// -- initialize counter --\n";
         os << "std::atomic<RamDomain> ctr(0);\n\n";
     }
@@ -1952,9 +2416,19 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "if (getNumThreads() > 0) {omp_set_num_threads(getNumThreads());}\n";
     os << "#endif\n\n";
 
+    // create the pool performing loads and stores in the background
+    os << "#if defined(_OPENMP)\n";
+    os << "IOPool ioPool(omp_get_max_threads() > 1 ? omp_get_max_threads() : 0);\n";
+    os << "#else\n";
+    os << "IOPool ioPool(0);\n";
+    os << "#endif\n\n";
+
     // add actual program body
     os << "// -- query evaluation --\n";
     if (Global::config().has("profile")) {
+        if (Global::config().has("profile-counters")) {
+            os << "PerfCounters::instance().enable();\n";
+        }
         os << "ProfileEventSingleton::instance().startTimer();\n";
         os << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
         os << "{\n"
@@ -1972,7 +2446,55 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     }
 
     // emit code
-    emitCode(os, prog.getMain());
+    if (split) {
+        os << "evaluate(inputDirectory, outputDirectory, performIO, ioPool, iter, ctr);\n";
+
+        std::vector<const RamStatement*> strata;
+        std::function<void(const RamStatement&)> collectStrata = [&](const RamStatement& stmt) {
+            if (const auto* seq = dynamic_cast<const RamSequence*>(&stmt)) {
+                for (const RamStatement* cur : seq->getStatements()) {
+                    collectStrata(*cur);
+                }
+            } else {
+                strata.push_back(&stmt);
+            }
+        };
+        collectStrata(prog.getMain());
+
+        // a unit ends after a stratum whose code hashes to a boundary, such that
+        // editing a stratum does not move the boundaries of the other units
+        const size_t strataPerUnit = 8;
+        const size_t maxUnitSize = 1 << 18;
+        std::stringstream unit;
+        for (size_t i = 0; i < strata.size(); i++) {
+            std::stringstream stratum;
+            emitCode(stratum, *strata[i]);
+            unit << stratum.str();
+            if (i + 1 == strata.size() || unit.tellp() >= std::streamoff(maxUnitSize) ||
+                    std::hash<std::string>()(stratum.str()) % strataPerUnit == 0) {
+                units->push_back("template <>\nvoid " + classname + "::evaluateUnit<" +
+                                 std::to_string(units->size()) + ">" + unitParameters + " {\n" + unit.str() +
+                                 "}\n");
+                unit.str("");
+            }
+        }
+
+        for (size_t i = 0; i < units->size(); i++) {
+            defs << "template <>\nvoid " << classname << "::evaluateUnit<" << i << ">" << unitParameters
+                 << ";\n";
+        }
+        defs << "void " << classname << "::evaluate" << unitParameters << " {\n";
+        for (size_t i = 0; i < units->size(); i++) {
+            defs << "evaluateUnit<" << i
+                 << ">(inputDirectory, outputDirectory, performIO, ioPool, iter, ctr);\n";
+        }
+        defs << "}\n";
+    } else {
+        emitCode(os, prog.getMain());
+    }
+
+    // wait for pending loads and stores
+    os << "ioPool.join();\n";
 
     if (Global::config().has("profile")) {
         os << "}\n";
@@ -1992,6 +2514,14 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     }
     os << "}\n";
 
+    if (Global::config().has("profile")) {
+        os << "for (const auto& cur : SampleProfiler::instance().stop()) {\n";
+        os << "ProfileEventSingleton::instance().makeQuantityEvent(\"@relation-samples;\" + cur.first, "
+              "cur.second, 0);\n";
+        os << "}\n";
+    } else {
+        os << "SampleProfiler::instance().stop();\n";
+    }
     os << "SignalHandler::instance()->reset();\n";
 
     os << "}\n";  // end of runFunction() method
@@ -2050,6 +2580,12 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;" << cur.first
                << ")_\", reads[" << cur.second << "],0);\n";
         }
+        for (auto rel : prog.getRelations()) {
+            if (isFiltered(*rel) && !rel->isTemp()) {
+                os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-filter-saved;"
+                   << rel->getName() << ")_\", " << getRelationName(*rel) << "->getFilter().getSaved(),0);\n";
+            }
+        }
         os << "}\n";  // end of dumpFreqs() method
     }
     // issue loadAll method
@@ -2133,7 +2669,8 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
                 bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
                 auto relationType = SynthesiserRelation::getSynthesiserRelation(*rel,
-                        idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
+                        idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo,
+                        layoutAnalysis->isIndirect(*rel));
 
                 if (!relationType->getProvenenceIndexNumbers().empty()) {
                     os << cppName << "->copyIndex();\n";
@@ -2178,82 +2715,91 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         }
     }
     os << "};\n";  // end of class declaration
+    if (split) {
+        os << "}  // end of namespace souffle\n";
+    }
 
     // hidden hooks
-    os << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
-    os << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
-       << "*>(p)->symTable;}\n";
-
-    os << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
-    os << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
-    os << "SouffleProgram *newInstance() {\n";
-    os << "return new " << classname << "();\n";
-    os << "};\n";
-    os << "public:\n";
-    os << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
-    os << "};\n";
-    os << "static factory_" << classname << " __factory_" << classname << "_instance;\n";
-    os << "}\n";
-    os << "#else\n";
-    os << "}\n";
-    os << "int main(int argc, char** argv)\n{\n";
-    os << "try{\n";
+    defs << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
+    defs << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
+         << "*>(p)->symTable;}\n";
+
+    defs << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
+    defs << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
+    defs << "SouffleProgram *newInstance() {\n";
+    defs << "return new " << classname << "();\n";
+    defs << "};\n";
+    defs << "public:\n";
+    defs << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
+    defs << "};\n";
+    defs << "static factory_" << classname << " __factory_" << classname << "_instance;\n";
+    defs << "}\n";
+    defs << "#else\n";
+    defs << "}\n";
+    defs << "int main(int argc, char** argv)\n{\n";
+    defs << "try{\n";
 
     // parse arguments
-    os << "souffle::CmdOptions opt(";
-    os << "R\"(" << Global::config().get("") << ")\",\n";
-    os << "R\"(.)\",\n";
-    os << "R\"(.)\",\n";
+    defs << "souffle::CmdOptions opt(";
+    defs << "R\"(" << Global::config().get("") << ")\",\n";
+    defs << "R\"(.)\",\n";
+    defs << "R\"(.)\",\n";
     if (Global::config().has("profile")) {
-        os << "true,\n";
-        os << "R\"(" << Global::config().get("profile") << ")\",\n";
+        defs << "true,\n";
+        defs << "R\"(" << Global::config().get("profile") << ")\",\n";
     } else {
-        os << "false,\n";
-        os << "R\"()\",\n";
+        defs << "false,\n";
+        defs << "R\"()\",\n";
     }
-    os << std::stoi(Global::config().get("jobs")) << ",\n";
-    os << "-1";
-    os << ");\n";
+    defs << std::stoi(Global::config().get("jobs")) << ",\n";
+    defs << "-1,\n";
+    defs << "R\"(" << Global::config().get("sample-profile") << ")\"";
+    defs << ");\n";
 
-    os << "if (!opt.parse(argc,argv)) return 1;\n";
+    defs << "if (!opt.parse(argc,argv)) return 1;\n";
+    defs << "souffle::SampleProfiler::instance().setOutputFile(opt.getSampleProfileName());\n";
 
-    os << "souffle::";
+    defs << "souffle::";
     if (Global::config().has("profile")) {
-        os << classname + " obj(opt.getProfileName());\n";
+        defs << classname + " obj(opt.getProfileName());\n";
     } else {
-        os << classname + " obj;\n";
+        defs << classname + " obj;\n";
     }
 
-    os << "#if defined(_OPENMP) \n";
-    os << "obj.setNumThreads(opt.getNumJobs());\n";
-    os << "\n#endif\n";
+    defs << "#if defined(_OPENMP) \n";
+    defs << "obj.setNumThreads(opt.getNumJobs());\n";
+    defs << "\n#endif\n";
 
     if (Global::config().has("profile")) {
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
-           << Global::config().get("version") << R"_(");)_" << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
+             << Global::config().get("version") << R"_(");)_" << '\n';
     }
-    os << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
+    defs << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
 
     if (Global::config().get("provenance") == "explain") {
-        os << "explain(obj, false, false);\n";
+        defs << "explain(obj, false, false);\n";
     } else if (Global::config().get("provenance") == "subtreeHeights") {
-        os << "obj.copyIndex();\n";
-        os << "explain(obj, false, true);\n";
+        defs << "obj.copyIndex();\n";
+        defs << "explain(obj, false, true);\n";
     } else if (Global::config().get("provenance") == "explore") {
-        os << "explain(obj, true, false);\n";
+        defs << "explain(obj, true, false);\n";
     }
-    os << "return 0;\n";
-    os << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
-    os << "}\n";
-    os << "\n#endif\n";
+    defs << "if (opt.isServing()) {\n";
+    defs << "souffle::QueryServer server(obj, opt.getNumJobs());\n";
+    defs << "server.serve(opt.getServerSocket());\n";
+    defs << "}\n";
+    defs << "return 0;\n";
+    defs << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
+    defs << "}\n";
+    defs << "\n#endif\n";
 }
 
 }  // end of namespace souffle
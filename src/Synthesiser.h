@@ -24,6 +24,7 @@
 #include <ostream>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -55,6 +56,9 @@ private:
     /** Cache for generated types for relations */
     std::set<std::string> typeCache;
 
+    /** Relations whose existence checks are guarded by a filter */
+    std::set<std::string> filteredRelations;
+
 protected:
     /** Get record table */
     const RecordTable& getRecordTable();
@@ -68,6 +72,9 @@ protected:
     /** Get context name */
     const std::string getOpContextName(const RamRelation& rel);
 
+    /** Check whether the existence checks of a relation are guarded by a filter */
+    bool isFiltered(const RamRelation& rel) const;
+
     /** Get relation struct definition */
     void generateRelationTypeStruct(std::ostream& out, std::unique_ptr<SynthesiserRelation> relationType);
 
@@ -86,6 +93,14 @@ protected:
     /** Lookup read counter */
     size_t lookupReadIdx(const std::string& txt);
 
+    /**
+     * Generate the code of the program, writing the declarations to os and the
+     * definitions outside of the program class to defs. If units is not null,
+     * the evaluation is split into groups of strata whose code is added to units.
+     */
+    void generateProgram(std::ostream& os, std::ostream& defs, std::vector<std::string>* units,
+            const std::string& id, bool& withSharedLibrary);
+
 public:
     explicit Synthesiser(RamTranslationUnit& tUnit) : translationUnit(tUnit) {}
     virtual ~Synthesiser() = default;
@@ -97,5 +112,14 @@ public:
 
     /** Generate code */
     void generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary);
+
+    /**
+     * Generate code split into translation units, which can be compiled in
+     * parallel and recompiled separately. The header declares the relations
+     * and the program class, the main unit defines the entry points of the
+     * program, and each further unit the evaluation of a group of strata.
+     */
+    void generateCode(std::ostream& header, const std::string& headerName, std::ostream& main,
+            std::vector<std::string>& units, const std::string& id, bool& withSharedLibrary);
 };
 }  // end of namespace souffle
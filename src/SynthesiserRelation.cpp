@@ -8,6 +8,7 @@
 
 #include "SynthesiserRelation.h"
 #include "Global.h"
+#include "RamLayoutAnalysis.h"
 #include "RelationRepresentation.h"
 #include "Util.h"
 #include <algorithm>
@@ -18,8 +19,8 @@
 
 namespace souffle {
 
-std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(
-        const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance) {
+std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(const RamRelation& ramRel,
+        const MinIndexSelection& indexSet, bool isProvenance, bool isIndirect) {
     SynthesiserRelation* rel;
 
     // Handle the qualifier in souffle code
@@ -27,7 +28,8 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.isNullary()) {
         rel = new SynthesiserNullaryRelation(ramRel, indexSet, isProvenance);
-    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE) {
+    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE ||
+               isLattice(ramRel.getRepresentation())) {
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BRIE) {
         rel = new SynthesiserBrieRelation(ramRel, indexSet, isProvenance);
@@ -36,8 +38,9 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
     } else if (ramRel.getRepresentation() == RelationRepresentation::INFO) {
         rel = new SynthesiserInfoRelation(ramRel, indexSet, isProvenance);
     } else {
-        // Handle the data structure command line flag
-        if (ramRel.getArity() > 6) {
+        // The layout of the remaining b-trees is chosen by the RamLayoutAnalysis; disk-backed
+        // relations are only supported by the interpreter and kept in memory by synthesised programs
+        if (isIndirect) {
             rel = new SynthesiserIndirectRelation(ramRel, indexSet, isProvenance);
         } else {
             rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
@@ -52,6 +55,24 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
     return std::unique_ptr<SynthesiserRelation>(rel);
 }
 
+std::map<SearchSignature, std::pair<size_t, size_t>> SynthesiserRelation::getIndexPrefixes() const {
+    std::map<SearchSignature, std::pair<size_t, size_t>> prefixes;
+    for (size_t i = 0; i < computedIndices.size(); i++) {
+        // indices of the top-down phase of provenance are only filled on demand
+        if (provenanceIndexNumbers.find(i) != provenanceIndexNumbers.end()) {
+            continue;
+        }
+        // the first index covering a search answers it
+        const auto& ind = computedIndices[i];
+        SearchSignature search = 0;
+        for (size_t length = 1; length <= ind.size(); length++) {
+            search |= SearchSignature(1) << ind[length - 1];
+            prefixes.insert(std::make_pair(search, std::make_pair(i, length)));
+        }
+    }
+    return prefixes;
+}
+
 // -------- Info Relation --------
 
 /** Generate index set for a info relation, which should be empty */
@@ -192,6 +213,18 @@ void SynthesiserDirectRelation::computeIndices() {
         masterIndex = 0;
     }
 
+    // lattices look up the values of a key in a full index ending with the value column
+    if (isLattice(relation.getRepresentation())) {
+        int valueColumn = getArity() - 1;
+        auto pos = std::find_if(inds.begin(), inds.end(),
+                [&](const MinIndexSelection::LexOrder& ind) { return ind.back() == valueColumn; });
+        if (pos == inds.end()) {
+            MinIndexSelection::LexOrder fullInd(getArity());
+            std::iota(fullInd.begin(), fullInd.end(), 0);
+            inds.push_back(fullInd);
+        }
+    }
+
     assert(masterIndex >= 0 && masterIndex < inds.size());
 
     computedIndices = inds;
@@ -200,7 +233,13 @@ void SynthesiserDirectRelation::computeIndices() {
 /** Generate type name of a direct indexed relation */
 std::string SynthesiserDirectRelation::getTypeName() {
     std::stringstream res;
-    res << "t_btree_" << getArity();
+    if (relation.getRepresentation() == RelationRepresentation::MIN_LATTICE) {
+        res << "t_lattice_min_" << getArity();
+    } else if (relation.getRepresentation() == RelationRepresentation::MAX_LATTICE) {
+        res << "t_lattice_max_" << getArity();
+    } else {
+        res << "t_btree_" << getArity();
+    }
 
     for (auto& ind : getIndices()) {
         res << "__" << join(ind, "_");
@@ -210,6 +249,10 @@ std::string SynthesiserDirectRelation::getTypeName() {
         res << "__" << search;
     }
 
+    for (auto& seek : getMinIndexSelection().getPrefixSearches()) {
+        res << "__seek_" << seek.first << "_" << seek.second;
+    }
+
     return res.str();
 }
 
@@ -294,7 +337,47 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(t, h);\n";
     out << "}\n";  // end of insert(t_tuple&)
 
+    // lattices only store tuples improving the value of their key, also with respect to the
+    // tuples of a dominator, e.g., of the full relation for new knowledge; the lower bound of the key
+    // is its least value in min lattices, and the least value not below the given one otherwise
+    bool lattice = isLattice(relation.getRepresentation());
+    if (lattice) {
+        size_t valueColumn = arity - 1;
+        size_t latticeIndex = 0;
+        while (inds[latticeIndex].back() != static_cast<int>(valueColumn)) {
+            latticeIndex++;
+        }
+        out << "const " << getTypeName() << "* dominator = nullptr;\n";
+        out << "Lock insert_lock;\n";
+        out << "bool dominated(const t_tuple& t, context& h) const {\n";
+        out << "t_tuple low(t);\n";
+        if (relation.getRepresentation() == RelationRepresentation::MIN_LATTICE) {
+            out << "low[" << valueColumn << "] = MIN_RAM_DOMAIN;\n";
+        }
+        out << "auto pos = ind_" << latticeIndex << ".lower_bound(low, h.hints_" << latticeIndex << ");\n";
+        out << "if (pos == ind_" << latticeIndex << ".end()) return false;\n";
+        for (size_t column = 0; column < valueColumn; column++) {
+            out << "if ((*pos)[" << column << "] != t[" << column << "]) return false;\n";
+        }
+        if (relation.getRepresentation() == RelationRepresentation::MIN_LATTICE) {
+            out << "return (*pos)[" << valueColumn << "] <= t[" << valueColumn << "];\n";
+        } else {
+            out << "return true;\n";
+        }
+        out << "}\n";  // end of dominated(t_tuple&, context&)
+        out << "bool dominated(const t_tuple& t) const {\n";
+        out << "context h;\n";
+        out << "return dominated(t, h);\n";
+        out << "}\n";  // end of dominated(t_tuple&)
+    }
+
     out << "bool insert(const t_tuple& t, context& h) {\n";
+    if (lattice) {
+        // writers running concurrently, e.g., rules of a parallel statement, must not search the
+        // b-tree while it is modified, and the dominance check is atomic with the insertion
+        out << "auto lease = insert_lock.acquire();\n";
+        out << "if (dominated(t, h) || (dominator != nullptr && dominator->dominated(t))) return false;\n";
+    }
     out << "if (ind_" << masterIndex << ".insert(t, h.hints_" << masterIndex << ")) {\n";
     for (size_t i = 0; i < numIndexes; i++) {
         if (i != masterIndex && provenanceIndexNumbers.find(i) == provenanceIndexNumbers.end()) {
@@ -402,6 +485,57 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // equalRange method for searches only known at run time, e.g. from the interface
+    std::map<size_t, std::vector<SearchSignature>> searchesOfIndex;
+    for (const auto& prefix : getIndexPrefixes()) {
+        searchesOfIndex[prefix.second.first].push_back(prefix.first);
+    }
+    out << "template <typename Visitor>\n";
+    out << "bool equalRange(SearchSignature search, const t_tuple& t, Visitor visitor) const {\n";
+    out << "if (search == 0) {\n";
+    out << "visitor(equalRange_0(t));\n";
+    out << "return true;\n";
+    out << "}\n";
+    out << "context h;\n";
+    out << "t_tuple low(t); t_tuple high(t);\n";
+    out << "for (size_t column = 0; column < " << arity << "; column++) {\n";
+    out << "if (((search >> column) & 1) == 0) {\n";
+    out << "low[column] = MIN_RAM_DOMAIN;\n";
+    out << "high[column] = MAX_RAM_DOMAIN;\n";
+    out << "}\n";
+    out << "}\n";
+    out << "switch (search) {\n";
+    for (const auto& cur : searchesOfIndex) {
+        size_t indNum = cur.first;
+        for (SearchSignature search : cur.second) {
+            out << "case " << search << ":\n";
+        }
+        out << "visitor(make_range(ind_" << indNum << ".lower_bound(low, h.hints_" << indNum << "), ind_"
+            << indNum << ".upper_bound(high, h.hints_" << indNum << ")));\n";
+        out << "return true;\n";
+    }
+    out << "}\n";
+    out << "return false;\n";
+    out << "}\n";
+
+    // seek methods for the leapfrog joins on this relation, and split points of their values for
+    // parallel joins
+    for (const auto& seek : getMinIndexSelection().getPrefixSearches()) {
+        int indNum = getMinIndexSelection().getPrefixOrderNum(seek.first, seek.second);
+        out << "const t_tuple* seek_" << seek.first << "_" << seek.second;
+        out << "(const t_tuple& low, context& h) const {\n";
+        out << "auto pos = ind_" << indNum << ".lower_bound(low, h.hints_" << indNum << ");\n";
+        out << "return (pos == ind_" << indNum << ".end()) ? nullptr : &*pos;\n";
+        out << "}\n";
+        out << "std::vector<RamDomain> split_" << seek.first << "_" << seek.second << "() const {\n";
+        out << "std::vector<RamDomain> res;\n";
+        out << "for (const auto& cur : ind_" << indNum << ".getChunks(400)) {\n";
+        out << "if (!cur.empty()) res.push_back((*cur.begin())[" << seek.second << "]);\n";
+        out << "}\n";
+        out << "return res;\n";
+        out << "}\n";
+    }
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -514,7 +648,7 @@ void SynthesiserIndirectRelation::computeIndices() {
 /** Generate type name of a indirect indexed relation */
 std::string SynthesiserIndirectRelation::getTypeName() {
     std::stringstream res;
-    res << "t_btree_" << getArity();
+    res << "t_ibtree_" << getArity();
 
     for (auto& ind : getIndices()) {
         res << "__" << join(ind, "_");
@@ -524,6 +658,10 @@ std::string SynthesiserIndirectRelation::getTypeName() {
         res << "__" << search;
     }
 
+    for (auto& seek : getMinIndexSelection().getPrefixSearches()) {
+        res << "__seek_" << seek.first << "_" << seek.second;
+    }
+
     return res.str();
 }
 
@@ -552,24 +690,24 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
             indexToNumMap[getMinIndexSelection().getAllOrders()[i]] = i;
         }
 
-        if (ind.size() == arity) {
-            out << "using t_ind_" << i
-                << " = btree_set<const t_tuple*, index_utils::deref_compare<typename "
-                   "index_utils::comparator<"
-                << join(ind) << ">>>;\n";
-        } else {
-            out << "using t_ind_" << i
-                << " = btree_multiset<const t_tuple*, index_utils::deref_compare<typename "
-                   "index_utils::comparator<"
-                << join(ind) << ">>>;\n";
-        }
+        // the leading columns of the order are stored next to the tuple pointers
+        size_t keySize = std::min(ind.size(), RamLayoutAnalysis::KEY_COLUMNS);
+        MinIndexSelection::LexOrder keyColumns(ind.begin(), ind.begin() + keySize);
+        MinIndexSelection::LexOrder keyPositions(keySize);
+        std::iota(keyPositions.begin(), keyPositions.end(), 0);
+        MinIndexSelection::LexOrder restColumns(ind.begin() + keySize, ind.end());
+        out << "using t_ref_" << i << " = index_utils::keyed_ref<t_tuple, " << join(keyColumns) << ">;\n";
+        out << "using t_ind_" << i << " = " << (ind.size() == arity ? "btree_set" : "btree_multiset")
+            << "<t_ref_" << i << ", index_utils::keyed_compare<index_utils::comparator<" << join(keyPositions)
+            << ">, index_utils::comparator<" << join(restColumns) << ">>>;\n";
 
         out << "t_ind_" << i << " ind_" << i << ";\n";
     }
 
     // typedef deref iterators
     for (size_t i = 0; i < numIndexes; i++) {
-        out << "using iterator_" << i << " = IterDerefWrapper<typename t_ind_" << i << "::iterator>;\n";
+        out << "using iterator_" << i << " = IterDerefWrapper<typename t_ind_" << i
+            << "::iterator, t_tuple>;\n";
     }
     out << "using iterator = iterator_" << masterIndex << ";\n";
 
@@ -697,6 +835,57 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // equalRange method for searches only known at run time, e.g. from the interface
+    std::map<size_t, std::vector<SearchSignature>> searchesOfIndex;
+    for (const auto& prefix : getIndexPrefixes()) {
+        searchesOfIndex[prefix.second.first].push_back(prefix.first);
+    }
+    out << "template <typename Visitor>\n";
+    out << "bool equalRange(SearchSignature search, const t_tuple& t, Visitor visitor) const {\n";
+    out << "if (search == 0) {\n";
+    out << "visitor(equalRange_0(t));\n";
+    out << "return true;\n";
+    out << "}\n";
+    out << "context h;\n";
+    out << "t_tuple low(t); t_tuple high(t);\n";
+    out << "for (size_t column = 0; column < " << arity << "; column++) {\n";
+    out << "if (((search >> column) & 1) == 0) {\n";
+    out << "low[column] = MIN_RAM_DOMAIN;\n";
+    out << "high[column] = MAX_RAM_DOMAIN;\n";
+    out << "}\n";
+    out << "}\n";
+    out << "switch (search) {\n";
+    for (const auto& cur : searchesOfIndex) {
+        size_t indNum = cur.first;
+        for (SearchSignature search : cur.second) {
+            out << "case " << search << ":\n";
+        }
+        out << "visitor(range<iterator_" << indNum << ">(ind_" << indNum << ".lower_bound(&low, h.hints_"
+            << indNum << "), ind_" << indNum << ".upper_bound(&high, h.hints_" << indNum << ")));\n";
+        out << "return true;\n";
+    }
+    out << "}\n";
+    out << "return false;\n";
+    out << "}\n";
+
+    // seek methods for the leapfrog joins on this relation, and split points of their values for
+    // parallel joins
+    for (const auto& seek : getMinIndexSelection().getPrefixSearches()) {
+        int indNum = getMinIndexSelection().getPrefixOrderNum(seek.first, seek.second);
+        out << "const t_tuple* seek_" << seek.first << "_" << seek.second;
+        out << "(const t_tuple& low, context& h) const {\n";
+        out << "auto pos = ind_" << indNum << ".lower_bound(&low, h.hints_" << indNum << ");\n";
+        out << "return (pos == ind_" << indNum << ".end()) ? nullptr : (*pos).ptr;\n";
+        out << "}\n";
+        out << "std::vector<RamDomain> split_" << seek.first << "_" << seek.second << "() const {\n";
+        out << "std::vector<RamDomain> res;\n";
+        out << "for (const auto& cur : ind_" << indNum << ".getChunks(400)) {\n";
+        out << "if (!cur.empty()) res.push_back((*(*cur.begin()).ptr)[" << seek.second << "]);\n";
+        out << "}\n";
+        out << "return res;\n";
+        out << "}\n";
+    }
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -706,7 +895,7 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "std::vector<range<iterator>> partition() const {\n";
     out << "std::vector<range<iterator>> res;\n";
     out << "for (const auto& cur : ind_" << masterIndex << ".getChunks(400)) {\n";
-    out << "    res.push_back(make_range(derefIter(cur.begin()), derefIter(cur.end())));\n";
+    out << "    res.push_back(make_range(iterator(cur.begin()), iterator(cur.end())));\n";
     out << "}\n";
     out << "return res;\n";
     out << "}\n";
@@ -732,7 +921,7 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
         out << "const auto& stats_" << i << " = ind_" << i << ".getHintStatistics();\n";
-        out << "o << prefix << \"arity " << arity << " indirect b-tree index " << inds[i]
+        out << "o << prefix << \"arity " << arity << " keyed indirect b-tree index " << inds[i]
             << ": (hits/misses/total)\\n\";\n";
         out << "o << prefix << \"Insert: \" << stats_" << i << ".inserts.getHits() << \"/\" << stats_" << i
             << ".inserts.getMisses() << \"/\" << stats_" << i << ".inserts.getAccesses() << \"\\n\";\n";
@@ -977,6 +1166,28 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // equalRange method for searches only known at run time, e.g. from the interface
+    out << "template <typename Visitor>\n";
+    out << "bool equalRange(SearchSignature search, const t_tuple& t, Visitor visitor) const {\n";
+    out << "context h;\n";
+    out << "switch (search) {\n";
+    out << "case 0:\n";
+    out << "visitor(equalRange_0(t, h));\n";
+    out << "return true;\n";
+    for (const auto& prefix : getIndexPrefixes()) {
+        size_t indNum = prefix.second.first;
+        out << "case " << prefix.first << ": {\n";
+        out << "auto r = ind_" << indNum << ".template getBoundaries<" << prefix.second.second << ">(orderIn_"
+            << indNum << "(t), h.hints_" << indNum << ");\n";
+        out << "visitor(make_range(iterator_" << indNum << "(r.begin()), iterator_" << indNum
+            << "(r.end())));\n";
+        out << "return true;\n";
+        out << "}\n";
+    }
+    out << "}\n";
+    out << "return false;\n";
+    out << "}\n";
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -1196,6 +1407,24 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // equalRange method for searches only known at run time, e.g. from the interface
+    out << "template <typename Visitor>\n";
+    out << "bool equalRange(SearchSignature search, const t_tuple& t, Visitor visitor) const {\n";
+    out << "context h;\n";
+    out << "switch (search) {\n";
+    out << "case 0:\n";
+    out << "visitor(range<iterator>(begin(), end()));\n";
+    out << "return true;\n";
+    // equalRange_2 bounds the first column of the index, hence that pattern is left to the caller
+    for (int i : {1, 3}) {
+        out << "case " << i << ":\n";
+        out << "visitor(equalRange_" << i << "(t, h));\n";
+        out << "return true;\n";
+    }
+    out << "}\n";
+    out << "return false;\n";
+    out << "}\n";
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".size() == 0;\n";
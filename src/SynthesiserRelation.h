@@ -11,9 +11,11 @@
 #include "RamIndexAnalysis.h"
 #include "RamRelation.h"
 
+#include <map>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 
 namespace souffle {
 
@@ -65,11 +67,14 @@ public:
     /** Generate relation type struct */
     virtual void generateTypeStruct(std::ostream& out) = 0;
 
-    /** Factory method to generate a SynthesiserRelation */
-    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(
-            const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance);
+    /** Factory method to generate a SynthesiserRelation, with indirect b-tree indexes if isIndirect */
+    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(const RamRelation& ramRel,
+            const MinIndexSelection& indexSet, bool isProvenance, bool isIndirect);
 
 protected:
+    /** Map each search answered by a prefix of an index to the index number and the prefix length */
+    std::map<SearchSignature, std::pair<size_t, size_t>> getIndexPrefixes() const;
+
     /** Ram relation referred to by this */
     const RamRelation& relation;
 
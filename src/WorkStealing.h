@@ -0,0 +1,264 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WorkStealing.h
+ *
+ * Work stealing over the chunks of a parallel loop, such that idle
+ * threads split the remaining range of chunks that are still busy.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Class StealingScheduler hands out the chunks of a parallel loop to the
+ * threads of a parallel region. Each thread first claims chunks of its own;
+ * once no chunk is left, it joins the busy chunk with the fewest workers,
+ * and all workers of a chunk take their elements from the remaining range
+ * of the chunk in batches. The batch size of a chunk grows while a single
+ * thread works on it and drops back to one element whenever a thread joins,
+ * such that a skewed chunk is split up finely among the threads.
+ *
+ * If timed, the busy time of each thread and of each chunk is recorded to
+ * reveal the imbalance of the loop.
+ */
+class StealingScheduler {
+public:
+    /** maximal number of elements taken from a chunk at once */
+    static constexpr size_t MAX_BATCH = 128;
+
+    StealingScheduler(size_t numChunks, bool timed)
+            : numChunks(numChunks), chunks(new Chunk[numChunks]), threads(MAX_THREADS), timed(timed) {}
+
+    /**
+     * Selects the chunk the calling thread continues with, and the number of
+     * elements to be taken from it.
+     *
+     * @return false if all chunks are exhausted
+     */
+    bool next(size_t& chunk, size_t& count) {
+        ThreadState& thread = getThread();
+        account(thread);
+        if (thread.chunk == NONE || chunks[thread.chunk].exhausted.load(std::memory_order_acquire)) {
+            if (thread.chunk != NONE) {
+                chunks[thread.chunk].workers--;
+                thread.chunk = NONE;
+            }
+            size_t claimed = nextChunk++;
+            if (claimed < numChunks) {
+                thread.chunk = claimed;
+            } else {
+                thread.chunk = findVictim();
+                if (thread.chunk == NONE) {
+                    return false;
+                }
+                // split the remaining range of the chunk finely from now on
+                chunks[thread.chunk].batch.store(1, std::memory_order_relaxed);
+            }
+            chunks[thread.chunk].workers++;
+        }
+        chunk = thread.chunk;
+        Chunk& cur = chunks[chunk];
+        count = cur.batch.load(std::memory_order_relaxed);
+        if (count < MAX_BATCH) {
+            cur.batch.store(count * 2, std::memory_order_relaxed);
+        }
+        if (timed) {
+            thread.start = now();
+        }
+        return true;
+    }
+
+    /** marks a chunk as exhausted, such that no thread takes elements from it anymore */
+    void exhausted(size_t chunk) {
+        chunks[chunk].exhausted.store(true, std::memory_order_release);
+    }
+
+    /** the lock protecting the remaining range of a chunk */
+    SpinLock& getLock(size_t chunk) {
+        return chunks[chunk].lock;
+    }
+
+    size_t size() const {
+        return numChunks;
+    }
+
+    /** busy time of each thread in nanoseconds */
+    std::vector<uint64_t> getThreadTimes() const {
+        std::vector<uint64_t> times;
+        for (const ThreadState& thread : threads) {
+            times.push_back(thread.busy);
+        }
+        return times;
+    }
+
+    /** busy time of each chunk in nanoseconds, summed over all its workers */
+    std::vector<uint64_t> getChunkTimes() const {
+        std::vector<uint64_t> times;
+        for (size_t i = 0; i < numChunks; i++) {
+            times.push_back(chunks[i].busy.load(std::memory_order_relaxed));
+        }
+        return times;
+    }
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    using time_point = std::chrono::steady_clock::time_point;
+
+    struct Chunk {
+        SpinLock lock;
+        std::atomic<bool> exhausted{false};
+        std::atomic<size_t> workers{0};
+        std::atomic<size_t> batch{1};
+        std::atomic<uint64_t> busy{0};
+    };
+
+    /** state of a thread, aligned to avoid false sharing among threads */
+    struct alignas(64) ThreadState {
+        size_t chunk = NONE;
+        time_point start{};
+        uint64_t busy = 0;
+    };
+
+    const size_t numChunks;
+
+    std::unique_ptr<Chunk[]> chunks;
+
+    std::atomic<size_t> nextChunk{0};
+
+    std::vector<ThreadState> threads;
+
+    const bool timed;
+
+    static time_point now() {
+        return std::chrono::steady_clock::now();
+    }
+
+    ThreadState& getThread() {
+        size_t id = THREAD_ID;
+        assert(id < threads.size() && "parallel region larger than announced");
+        return threads[id];
+    }
+
+    /** charges the time of the last batch of a thread to the thread and its chunk */
+    void account(ThreadState& thread) {
+        if (!timed || thread.chunk == NONE) {
+            return;
+        }
+        auto elapsed = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now() - thread.start).count());
+        thread.busy += elapsed;
+        chunks[thread.chunk].busy += elapsed;
+    }
+
+    /** the busy chunk with the fewest workers, or NONE if all chunks are exhausted */
+    size_t findVictim() const {
+        size_t victim = NONE;
+        size_t fewest = 0;
+        for (size_t i = 0; i < numChunks; i++) {
+            const Chunk& cur = chunks[i];
+            if (cur.exhausted.load(std::memory_order_acquire)) {
+                continue;
+            }
+            size_t workers = cur.workers.load(std::memory_order_relaxed);
+            if (victim == NONE || workers < fewest) {
+                victim = i;
+                fewest = workers;
+            }
+        }
+        return victim;
+    }
+};
+
+/**
+ * A partition of a range into chunks, e.g. of a btree or a Trie, whose
+ * elements are enumerated by the threads of a parallel region in batches:
+ *
+ *      while (auto* batch = stealing.next()) {
+ *          for (const auto& tuple : *batch) { ... }
+ *      }
+ *
+ * The chunks are consumed by advancing their begin iterators, hence the
+ * partition may be enumerated only once.
+ */
+template <typename Range>
+class StealingPartition {
+public:
+    StealingPartition(std::vector<Range>& chunks, bool timed)
+            : chunks(chunks), scheduler(chunks.size(), timed) {
+        if (!chunks.empty()) {
+            batches.resize(MAX_THREADS, chunks.front());
+        }
+    }
+
+    /**
+     * Takes the next batch of elements for the calling thread.
+     *
+     * @return the batch, which stays valid until the next call, or nullptr if there are no more elements
+     */
+    Range* next() {
+        size_t chunk = 0;
+        size_t count = 0;
+        while (scheduler.next(chunk, count)) {
+            Range& remaining = chunks[chunk];
+            Range& batch = batches[THREAD_ID];
+            scheduler.getLock(chunk).lock();
+            if (remaining.empty()) {
+                scheduler.getLock(chunk).unlock();
+                scheduler.exhausted(chunk);
+                continue;
+            }
+            batch.begin() = remaining.begin();
+            for (size_t i = 0; i < count && !remaining.empty(); i++) {
+                ++remaining.begin();
+            }
+            batch.end() = remaining.begin();
+            scheduler.getLock(chunk).unlock();
+            return &batch;
+        }
+        return nullptr;
+    }
+
+    std::vector<uint64_t> getThreadTimes() const {
+        return scheduler.getThreadTimes();
+    }
+
+    std::vector<uint64_t> getChunkTimes() const {
+        return scheduler.getChunkTimes();
+    }
+
+private:
+    std::vector<Range>& chunks;
+
+    StealingScheduler scheduler;
+
+    /** the current batch of each thread */
+    std::vector<Range> batches;
+};
+
+/** creates a stealing partition over the chunks of a partitioned range */
+template <typename Range>
+StealingPartition<Range> makeStealingPartition(std::vector<Range>& chunks, bool timed = false) {
+    return StealingPartition<Range>(chunks, timed);
+}
+
+}  // namespace souffle
@@ -15,10 +15,13 @@
 #pragma once
 
 #include "IODirectives.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "SymbolTable.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -35,16 +38,32 @@ public:
         if (summary) {
             return writeSize(relation.size());
         }
-        auto lease = symbolTable.acquireLock();
-        (void)lease;
+        // symbols are resolved one at a time, such that relations can be written
+        // while the evaluation continues to add symbols
         if (arity == 0) {
             if (relation.begin() != relation.end()) {
                 writeNullary();
             }
             return;
         }
+        if (!isBatched()) {
+            for (const auto& current : relation) {
+                writeNext(current);
+            }
+            return;
+        }
+        // hand the tuples over in batches, which can be formatted in parallel
+        std::vector<RamDomain> batch;
+        batch.reserve(BATCH_SIZE * arity);
         for (const auto& current : relation) {
-            writeNext(current);
+            appendNext(batch, current);
+            if (batch.size() == BATCH_SIZE * arity) {
+                writeBatch(batch);
+                batch.clear();
+            }
+        }
+        if (!batch.empty()) {
+            writeBatch(batch);
         }
     }
     template <typename T>
@@ -55,6 +74,12 @@ public:
     virtual ~WriteStream() = default;
 
 protected:
+    /** Number of tuples of a batch */
+    static constexpr size_t BATCH_SIZE = 1 << 16;
+
+    /** Number of tuples formatted by a thread at a time */
+    static constexpr size_t CHUNK_SIZE = 1 << 12;
+
     const std::vector<RamTypeAttribute>& symbolMask;
     const SymbolTable& symbolTable;
     const bool summary;
@@ -65,14 +90,122 @@ protected:
     virtual void writeSize(std::size_t) {
         assert(false && "attempting to print size of a write operation");
     }
+
+    /** Whether tuples are written in batches by writeBatch rather than one by one */
+    virtual bool isBatched() const {
+        return false;
+    }
+
+    /** Writes a batch of tuples, stored consecutively, each with arity values */
+    virtual void writeBatch(const std::vector<RamDomain>& batch) {
+        for (size_t i = 0; i < batch.size(); i += arity) {
+            writeNextTuple(&batch[i]);
+        }
+    }
+
     template <typename Tuple>
     void writeNext(const Tuple tuple) {
         writeNextTuple(tuple.data);
     }
+    template <typename Tuple>
+    void appendNext(std::vector<RamDomain>& batch, const Tuple tuple) {
+        batch.insert(batch.end(), &tuple.data[0], &tuple.data[0] + arity);
+    }
+
+    /**
+     * Formats a batch of tuples as lines of values separated by the given
+     * delimiter. The batch is split into chunks, which are formatted in
+     * parallel; the concatenation of the chunks is the formatted batch.
+     * On the threads of an IOPool, parallel regions have a single thread.
+     */
+    std::vector<std::string> formatBatch(const std::vector<RamDomain>& batch, const std::string& delimiter) {
+        size_t numTuples = batch.size() / arity;
+        std::vector<std::string> chunks((numTuples + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+        PARALLEL_START
+            ;
+            pfor(size_t chunk = 0; chunk < chunks.size(); chunk++) {
+                std::string& out = chunks[chunk];
+                size_t begin = chunk * CHUNK_SIZE;
+                size_t end = std::min(numTuples, (chunk + 1) * CHUNK_SIZE);
+
+                // the symbols of a chunk are resolved taking the lock of the symbol table once; symbols
+                // are never moved by the table, so they are formatted after the lock is released
+                std::vector<RamDomain> indices;
+                for (size_t i = begin; i < end; i++) {
+                    for (size_t col = 0; col < arity; ++col) {
+                        if (symbolMask[col] == RamTypeAttribute::Symbol) {
+                            indices.push_back(batch[i * arity + col]);
+                        }
+                    }
+                }
+                std::vector<const std::string*> symbols(indices.size());
+                if (!indices.empty()) {
+                    symbolTable.resolve(indices.data(), indices.size(), symbols.data());
+                }
+
+                auto symbol = symbols.begin();
+                for (size_t i = begin; i < end; i++) {
+                    const RamDomain* tuple = &batch[i * arity];
+                    for (size_t col = 0; col < arity; ++col) {
+                        if (col > 0) {
+                            out += delimiter;
+                        }
+                        if (symbolMask[col] == RamTypeAttribute::Symbol) {
+                            out += **symbol++;
+                        } else {
+                            appendTupleElement(out, symbolMask[col], tuple[col]);
+                        }
+                    }
+                    out += '\n';
+                }
+            }
+        PARALLEL_END;
+        return chunks;
+    }
+
+    /** Appends the text of a value other than a symbol to a string */
+    static void appendTupleElement(std::string& destination, RamTypeAttribute type, RamDomain value) {
+        switch (type) {
+            case RamTypeAttribute::Signed:
+                if (value < 0) {
+                    destination += '-';
+                    appendDecimal(destination, RamUnsigned(0) - ramBitCast<RamUnsigned>(value));
+                } else {
+                    appendDecimal(destination, ramBitCast<RamUnsigned>(value));
+                }
+                break;
+            case RamTypeAttribute::Unsigned:
+                appendDecimal(destination, ramBitCast<RamUnsigned>(value));
+                break;
+            case RamTypeAttribute::Float: {
+                // same format as writing the value to a stream
+                char buffer[32];
+                int length = snprintf(buffer, sizeof(buffer), "%g", ramBitCast<RamFloat>(value));
+                destination.append(buffer, length);
+                break;
+            }
+            case RamTypeAttribute::Symbol:
+            case RamTypeAttribute::Record:
+                assert(false && "Symbols and records are not formatted by value");
+        }
+    }
+
+    /** Appends the decimal digits of a value to a string */
+    static void appendDecimal(std::string& destination, RamUnsigned value) {
+        char buffer[24];
+        char* end = buffer + sizeof(buffer);
+        char* pos = end;
+        do {
+            *--pos = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        destination.append(pos, end);
+    }
     void writeNextTupleElement(std::ostream& destination, RamTypeAttribute type, RamDomain value) {
         switch (type) {
             case RamTypeAttribute::Symbol:
-                destination << symbolTable.unsafeResolve(value);
+                destination << symbolTable.resolve(value);
                 break;
             case RamTypeAttribute::Signed:
                 destination << value;
@@ -103,4 +236,9 @@ inline void WriteStream::writeNext(const RamDomain* tuple) {
     writeNextTuple(tuple);
 }
 
+template <>
+inline void WriteStream::appendNext(std::vector<RamDomain>& batch, const RamDomain* tuple) {
+    batch.insert(batch.end(), tuple, tuple + arity);
+}
+
 } /* namespace souffle */
@@ -20,14 +20,18 @@
 #include "SymbolTable.h"
 #include "WriteStream.h"
 #ifdef USE_LIBZ
-#include "gzfstream.h"
+#include <zlib.h>
 #endif
 
 #include <cassert>
 #include <fstream>
+#include <iostream>
 #include <memory>
 #include <ostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -70,38 +74,119 @@ protected:
         }
         file << "\n";
     }
+
+    bool isBatched() const override {
+        return true;
+    }
+
+    void writeBatch(const std::vector<RamDomain>& batch) override {
+        for (const auto& chunk : formatBatch(batch, delimiter)) {
+            file.write(chunk.data(), chunk.size());
+        }
+    }
 };
 
 #ifdef USE_LIBZ
+/**
+ * Writes a gzip compressed file as a sequence of gzip members, which are
+ * compressed independently of each other and thus in parallel. Readers of
+ * gzip files, including zlib's gzread, decompress the concatenation of the
+ * members.
+ */
 class WriteGZipFileCSV : public WriteStreamCSV, public WriteStream {
 public:
     WriteGZipFileCSV(const std::vector<RamTypeAttribute>& symbolMask, const SymbolTable& symbolTable,
             const IODirectives& ioDirectives, const size_t auxiliaryArity = 0)
             : WriteStream(symbolMask, symbolTable, auxiliaryArity), delimiter(getDelimiter(ioDirectives)),
-              file(ioDirectives.getFileName(), std::ios::out | std::ios::binary) {
+              fileName(ioDirectives.getFileName()), file(fileName, std::ios::out | std::ios::binary) {
         if (ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
-            file << ioDirectives.get("attributeNames") << std::endl;
+            pending << ioDirectives.get("attributeNames") << "\n";
         }
     }
 
-    ~WriteGZipFileCSV() override = default;
+    ~WriteGZipFileCSV() override {
+        // destructors must not throw; a failure to compress the remaining text is reported instead
+        try {
+            flush();
+        } catch (const std::exception& e) {
+            std::cerr << "Error writing " << fileName << ": " << e.what() << "\n";
+        }
+    }
 
 protected:
+    /** Size of the uncompressed text buffered by writeNextTuple */
+    static constexpr size_t PENDING_SIZE = 1 << 20;
+
     void writeNullary() override {
-        file << "()\n";
+        pending << "()\n";
     }
 
     void writeNextTuple(const RamDomain* tuple) override {
-        writeNextTupleElement(file, symbolMask.at(0), tuple[0]);
+        writeNextTupleElement(pending, symbolMask.at(0), tuple[0]);
         for (size_t col = 1; col < arity; ++col) {
-            file << delimiter;
-            writeNextTupleElement(file, symbolMask.at(col), tuple[col]);
+            pending << delimiter;
+            writeNextTupleElement(pending, symbolMask.at(col), tuple[col]);
         }
-        file << "\n";
+        pending << "\n";
+        if (pending.tellp() >= static_cast<std::streamoff>(PENDING_SIZE)) {
+            flush();
+        }
+    }
+
+    bool isBatched() const override {
+        return true;
+    }
+
+    void writeBatch(const std::vector<RamDomain>& batch) override {
+        flush();
+        std::vector<std::string> chunks = formatBatch(batch, delimiter);
+        PARALLEL_START
+            ;
+            pfor(size_t i = 0; i < chunks.size(); i++) {
+                chunks[i] = compress(chunks[i]);
+            }
+        PARALLEL_END;
+        for (const auto& chunk : chunks) {
+            file.write(chunk.data(), chunk.size());
+        }
+    }
+
+    /** Compresses and writes the buffered text */
+    void flush() {
+        std::string text = pending.str();
+        if (!text.empty()) {
+            std::string member = compress(text);
+            file.write(member.data(), member.size());
+            pending.str("");
+        }
+    }
+
+    /** Compresses a text into a gzip member */
+    static std::string compress(const std::string& text) {
+        z_stream stream{};
+        // a window of 2^15 bytes with a gzip header (+16)
+        int status = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        if (status != Z_OK) {
+            throw std::runtime_error("Cannot initialise gzip compression");
+        }
+        std::string res(deflateBound(&stream, text.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+        stream.avail_in = text.size();
+        stream.next_out = reinterpret_cast<Bytef*>(&res[0]);
+        stream.avail_out = res.size();
+        status = deflate(&stream, Z_FINISH);
+        res.resize(stream.total_out);
+        deflateEnd(&stream);
+        if (status != Z_STREAM_END) {
+            throw std::runtime_error("Cannot compress gzip member");
+        }
+        return res;
     }
 
     const std::string delimiter;
-    gzfstream::ogzfstream file;
+    const std::string fileName;
+    std::ofstream file;
+    std::stringstream pending;
 };
 #endif
 
@@ -60,7 +60,7 @@ namespace souffle {
 /**
  * Executes a binary file.
  */
-void executeBinary(const std::string& binaryFilename) {
+void executeBinary(const std::string& binaryFilename, const std::vector<std::string>& sourceFilenames) {
     assert(!binaryFilename.empty() && "binary filename cannot be blank");
 
     // check whether the executable exists
@@ -85,7 +85,9 @@ void executeBinary(const std::string& binaryFilename) {
 
     if (Global::config().get("dl-program").empty()) {
         remove(binaryFilename.c_str());
-        remove((binaryFilename + ".cpp").c_str());
+        for (const std::string& sourceFilename : sourceFilenames) {
+            remove(sourceFilename.c_str());
+        }
     }
 
     // exit with same code as executable
@@ -123,10 +125,59 @@ void compileToBinary(std::string compileCmd, const std::string& sourceFilename)
     }
 }
 
+/**
+ * Quotes a string for the shell.
+ */
+std::string shellQuote(const std::string& str) {
+    std::string res = "'";
+    for (char ch : str) {
+        if (ch == '\'') {
+            res += "'\\''";
+        } else {
+            res += ch;
+        }
+    }
+    return res + "'";
+}
+
+/**
+ * Evaluates the program with the interpreter on the given fact directory and
+ * writes the profile of the evaluation to the given file. The options which
+ * affect the translation of the program are passed on, such that the profile
+ * describes the program being compiled.
+ */
+void trainProfile(const std::string& souffleExecutable, const std::string& factDir, const std::string& profile) {
+    std::string cmd = souffleExecutable;
+    for (const char* option : {"include-dir", "library-dir", "libraries"}) {
+        for (const std::string& value : splitString(Global::config().get(option), ' ')) {
+            if (!value.empty()) {
+                cmd += " --" + std::string(option) + "=" + shellQuote(value);
+            }
+        }
+    }
+    for (const char* option : {"macro", "magic-transform", "disable-transformers", "pragma", "jobs"}) {
+        if (Global::config().has(option)) {
+            cmd += " --" + std::string(option) + "=" + shellQuote(Global::config().get(option));
+        }
+    }
+    if (Global::config().has("no-warn")) {
+        cmd += " --no-warn";
+    }
+    cmd += " --fact-dir=" + shellQuote(factDir) + " --output-dir=- --profile=" + shellQuote(profile);
+    cmd += " " + shellQuote(Global::config().get("")) + " >/dev/null";
+
+    if (system(cmd.c_str()) != 0) {
+        throw std::runtime_error("failed to evaluate the program on the training facts <" + factDir + ">");
+    }
+}
+
 int main(int argc, char** argv) {
     /* Time taking for overall runtime */
     auto souffle_start = std::chrono::high_resolution_clock::now();
 
+    /* Profile of the training run of a profile-guided build */
+    std::string trainingProfile;
+
     /* have all to do with command line arguments in its own scope, as these are accessible through the global
      * configuration only */
     try {
@@ -166,6 +217,14 @@ int main(int argc, char** argv) {
                 {"swig", 's', "LANG", "", false,
                         "Generate SWIG interface for given language. The values <LANG> accepts is java and "
                         "python. "},
+                {"split-units", '\6', "", "", false,
+                        "Split the generated C++ code into translation units, which are compiled in "
+                        "parallel and cached."},
+                {"memory-budget", '\10', "MB", "", false,
+                        "Move relations of the interpreter to disk once it uses more than <MB> "
+                        "megabytes."},
+                {"spill-dir", '\11', "DIR", "", false,
+                        "Specify directory for relations stored on disk (default: $TMPDIR or /tmp)."},
                 {"library-dir", 'L', "DIR", "", true, "Specify directory for library files."},
                 {"libraries", 'l', "FILE", "", true, "Specify libraries."},
                 {"no-warn", 'w', "", "", false, "Disable warnings."},
@@ -175,13 +234,21 @@ int main(int argc, char** argv) {
                 {"macro", 'M', "MACROS", "", false, "Set macro definitions for the pre-processor"},
                 {"disable-transformers", 'z', "TRANSFORMERS", "", false,
                         "Disable the given AST transformers."},
+                {"no-leapfrog", '\14', "", "", false,
+                        "Evaluate rules with cyclic bodies by nested loops instead of leapfrog triejoins."},
                 {"dl-program", 'o', "FILE", "", false,
                         "Generate C++ source code, written to <FILE>, and compile this to a "
                         "binary executable (without executing it)."},
                 {"live-profile", '\2', "", "", false, "Enable live profiling."},
                 {"profile", 'p', "FILE", "", false, "Enable profiling, and write profile data to <FILE>."},
+                {"sample-profile", '\12', "FILE", "", false,
+                        "Sample the CPU time of rules, and write folded stacks to <FILE>."},
+                {"profile-counters", '\13', "", "", false,
+                        "Record hardware performance counters of rules when profiling."},
                 {"profile-use", 'u', "FILE", "", false,
                         "Use profile log-file <FILE> for profile-guided optimization."},
+                {"pgo", '\7', "DIR", "", false,
+                        "Compile with profile-guided optimisation, trained on the fact directory <DIR>."},
                 {"debug-report", 'r', "FILE", "", false, "Write HTML debug report to <FILE>."},
                 {"pragma", 'P', "OPTIONS", "", false, "Set pragma options."},
                 {"provenance", 't', "[ none | explain | explore | subtreeHeights ]", "", false,
@@ -220,6 +287,24 @@ int main(int argc, char** argv) {
             throw std::runtime_error("cannot open file " + std::string(Global::config().get("")));
         }
 
+        /* for profile-guided optimisation, profile the program on the training facts unless a profile is
+         * given; the compiled program is trained on the same facts by souffle-compile */
+        if (Global::config().has("pgo")) {
+            if (!existDir(Global::config().get("pgo"))) {
+                throw std::runtime_error(
+                        "training fact directory " + Global::config().get("pgo") + " does not exists");
+            }
+            if (Global::config().has("swig")) {
+                throw std::runtime_error("--pgo cannot be combined with --swig");
+            }
+            if (!Global::config().has("profile-use")) {
+                trainingProfile = tempFile();
+                trainProfile(which(argv[0]), Global::config().get("pgo"), trainingProfile);
+                Global::config().set("profile-use", trainingProfile);
+            }
+            Global::config().set("compile");
+        }
+
         /* for the jobs option, to determine the number of threads used */
 #ifdef _OPENMP
         if (isNumber(Global::config().get("jobs").c_str())) {
@@ -494,6 +579,7 @@ int main(int argc, char** argv) {
                             std::make_unique<HoistConditionsTransformer>(),
                             std::make_unique<MakeIndexTransformer>())),
             std::make_unique<IfConversionTransformer>(), std::make_unique<ChoiceConversionTransformer>(),
+            std::make_unique<HashJoinTransformer>(),
             std::make_unique<CollapseFiltersTransformer>(), std::make_unique<TupleIdTransformer>(),
             std::make_unique<RamLoopTransformer>(std::make_unique<RamTransformerSequence>(
                     std::make_unique<HoistAggregateTransformer>(), std::make_unique<TupleIdTransformer>())),
@@ -539,11 +625,6 @@ int main(int argc, char** argv) {
                 profiler.join();
             }
             if (Global::config().has("provenance")) {
-                // Test for bugged combination of provenance, interpreted souffle, and concurrency
-                if (Global::config().get("jobs") != "1") {
-                    throw std::runtime_error("Provenance is not supported with parallel interpreted mode");
-                }
-
                 // only run explain interface if interpreted
                 InterpreterProgInterface interface(*interpreter);
                 if (Global::config().get("provenance") == "explain" ||
@@ -585,10 +666,30 @@ int main(int argc, char** argv) {
 
             std::string baseIdentifier = identifier(simpleName(baseFilename));
             std::string sourceFilename = baseFilename + ".cpp";
+            std::vector<std::string> generatedFilenames{sourceFilename};
+
+            // the translation units passed to the compiler, the main unit first
+            std::string unitFilenames = sourceFilename;
 
             bool withSharedLibrary;
             std::ofstream os(sourceFilename);
-            synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
+            if (Global::config().has("split-units") && !Global::config().has("swig")) {
+                std::string headerFilename = baseFilename + ".h";
+                std::ofstream header(headerFilename);
+                std::vector<std::string> units;
+                synthesiser->generateCode(
+                        header, baseName(headerFilename), os, units, baseIdentifier, withSharedLibrary);
+                generatedFilenames.push_back(headerFilename);
+                for (size_t i = 0; i < units.size(); i++) {
+                    std::string unitFilename = baseFilename + "_" + std::to_string(i) + ".cpp";
+                    std::ofstream unit(unitFilename);
+                    unit << units[i];
+                    generatedFilenames.push_back(unitFilename);
+                    unitFilenames += " " + unitFilename;
+                }
+            } else {
+                synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
+            }
             os.close();
 
             if (withSharedLibrary) {
@@ -600,12 +701,19 @@ int main(int argc, char** argv) {
                 }
             }
 
+            if (Global::config().has("pgo")) {
+                compileCmd += "-t " + shellQuote(Global::config().get("pgo")) + " ";
+            }
+
             if (Global::config().has("swig")) {
                 compileCmd += "-s " + Global::config().get("swig") + " ";
                 compileToBinary(compileCmd, sourceFilename);
             } else if (Global::config().has("compile")) {
                 auto start = std::chrono::high_resolution_clock::now();
-                compileToBinary(compileCmd, sourceFilename);
+                compileToBinary(compileCmd, unitFilenames);
+                if (!trainingProfile.empty()) {
+                    remove(trainingProfile.c_str());
+                }
                 /* Report overall run-time in verbose mode */
                 if (Global::config().has("verbose")) {
                     auto end = std::chrono::high_resolution_clock::now();
@@ -614,7 +722,7 @@ int main(int argc, char** argv) {
                 }
                 // run compiled C++ program if requested.
                 if (!Global::config().has("dl-program") && !Global::config().has("swig")) {
-                    executeBinary(baseFilename);
+                    executeBinary(baseFilename, generatedFilenames);
                 }
             }
         }
@@ -89,6 +89,8 @@
 %token BRIE_QUALIFIER            "BRIE datastructure qualifier"
 %token BTREE_QUALIFIER           "BTREE datastructure qualifier"
 %token EQREL_QUALIFIER           "equivalence relation qualifier"
+%token DISK_QUALIFIER            "disk-backed datastructure qualifier"
+%token INDIRECT_QUALIFIER        "indirect BTREE datastructure qualifier"
 %token OVERRIDABLE_QUALIFIER     "relation qualifier overidable"
 %token INLINE_QUALIFIER          "relation qualifier inline"
 %token TMATCH                    "match predicate"
@@ -518,20 +520,40 @@ qualifiers
         $$ = $1 | INLINE_RELATION;
     }
   | qualifiers BRIE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|DISK_RELATION|INDIRECT_RELATION))
+            driver.error(@2, "btree/brie/eqrel/disk/indirect qualifier already set");
         $$ = $1 | BRIE_RELATION;
     }
   | qualifiers BTREE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|DISK_RELATION|INDIRECT_RELATION))
+            driver.error(@2, "btree/brie/eqrel/disk/indirect qualifier already set");
         $$ = $1 | BTREE_RELATION;
     }
   | qualifiers EQREL_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|DISK_RELATION|INDIRECT_RELATION))
+            driver.error(@2, "btree/brie/eqrel/disk/indirect qualifier already set");
         $$ = $1 | EQREL_RELATION;
     }
+  | qualifiers DISK_QUALIFIER {
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|DISK_RELATION|INDIRECT_RELATION))
+            driver.error(@2, "btree/brie/eqrel/disk/indirect qualifier already set");
+        $$ = $1 | DISK_RELATION;
+    }
+  | qualifiers INDIRECT_QUALIFIER {
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|DISK_RELATION|INDIRECT_RELATION))
+            driver.error(@2, "btree/brie/eqrel/disk/indirect qualifier already set");
+        $$ = $1 | INDIRECT_RELATION;
+    }
+  | qualifiers MIN {
+        if($1 & (MIN_LATTICE_RELATION|MAX_LATTICE_RELATION))
+            driver.error(@2, "min/max qualifier already set");
+        $$ = $1 | MIN_LATTICE_RELATION;
+    }
+  | qualifiers MAX {
+        if($1 & (MIN_LATTICE_RELATION|MAX_LATTICE_RELATION))
+            driver.error(@2, "min/max qualifier already set");
+        $$ = $1 | MAX_LATTICE_RELATION;
+    }
   | %empty {
         $$ = 0;
     }
@@ -8,9 +8,11 @@
 
 #pragma once
 
+#include "ProfileDiff.h"
 #include "StringUtils.h"
 #include "Tui.h"
 
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <string>
@@ -22,7 +24,7 @@ namespace profile {
 
 /*
  * CLI to parse command line arguments and start up the TUI to either run a single command,
- * generate the GUI file or run the TUI
+ * generate the GUI file, compare the log file with a baseline or run the TUI
  */
 class Cli {
 public:
@@ -32,7 +34,7 @@ public:
         int c;
         option longOptions[1];
         longOptions[0] = {nullptr, 0, nullptr, 0};
-        while ((c = getopt_long(argc, argv, "c:hj::", longOptions, nullptr)) != EOF) {
+        while ((c = getopt_long(argc, argv, "c:d:hj::J::", longOptions, nullptr)) != EOF) {
             // An invalid argument was given
             if (c == '?') {
                 exit(1);
@@ -60,7 +62,9 @@ public:
 
         if (args.count('h') != 0 || args.count('f') == 0) {
             std::cout << "Souffle Profiler" << std::endl
-                      << "Usage: souffle-profile <log-file> [ -h | -c <command> [options] | -j ]" << std::endl
+                      << "Usage: souffle-profile <log-file> [ -h | -c <command> [options] | -j | "
+                         "-d <baseline> [ -j | -J ] ]"
+                      << std::endl
                       << "<log-file>            The log file to profile." << std::endl
                       << "-c <command>          Run the given command on the log file, try with  "
                          "'-c help' for a list"
@@ -69,12 +73,39 @@ public:
                       << "-j[filename]          Generate a GUI (html/js) version of the profiler."
                       << std::endl
                       << "                      Default filename is profiler_html/[num].html" << std::endl
+                      << "-d <baseline>         Compare the log file with the log file of a baseline run, and"
+                      << std::endl
+                      << "                      print the differences sorted by their regression impact."
+                      << std::endl
+                      << "                      With -j, generate a GUI version of the differences instead."
+                      << std::endl
+                      << "-J[filename]          With -d, output the differences as json to the given file."
+                      << std::endl
+                      << "                      Default is the standard output." << std::endl
                       << "-h                    Print this help message." << std::endl;
             exit(0);
         }
         std::string filename = args['f'];
 
-        if (args.count('c') != 0) {
+        if (args.count('d') != 0) {
+            ProfileDiff diff = Tui::loadDiff(args['d'], filename);
+            if (args.count('J') != 0) {
+                if (args['J'] == "J") {
+                    std::cout << diff.genJson();
+                } else {
+                    std::ofstream out(args['J']);
+                    out << diff.genJson();
+                }
+            } else if (args.count('j') != 0) {
+                if (args['j'] == "j") {
+                    Tui::outputDiffHtml(diff);
+                } else {
+                    Tui::outputDiffHtml(diff, args['j']);
+                }
+            } else {
+                diff.print();
+            }
+        } else if (args.count('c') != 0) {
             Tui tui(filename, false, false);
             for (auto& command : Tools::split(args['c'], ";")) {
                 tui.runCommand(Tools::split(command, " "));
@@ -12,6 +12,7 @@
 #include "OutputProcessor.h"
 #include "htmlCssChartist.h"
 #include "htmlCssStyle.h"
+#include "htmlDiff.h"
 #include "htmlJsChartistMin.h"
 #include "htmlJsChartistPlugin.h"
 #include "htmlJsMain.h"
@@ -35,6 +36,15 @@ public:
         return getFirstHalf() + json + getSecondHalf();
     }
 
+    /** the report of the differences between two profiles, given as the json of a ProfileDiff */
+    static std::string getDiffHtml(const std::string& json) {
+        std::stringstream ss;
+        ss << html::htmlHeadTop << wrapCss(html::cssStyle) << html::htmlHeadBottom << html::htmlDiffBody
+           << "<script>data=" << json << ";</script>" << wrapJs(html::jsTableSort) << wrapJs(html::jsUtil)
+           << wrapJs(html::jsDiff) << html::htmlBodyBottom;
+        return ss.str();
+    }
+
 protected:
     static std::string getFirstHalf() {
         std::stringstream ss;
@@ -0,0 +1,386 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+#pragma once
+
+#include "ProgramRun.h"
+#include "StringUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+/*
+ * Compares the profiles of two runs of a program, a baseline and a current run.
+ *
+ * Relations are aligned by name, rules by relation, source location and text, versions of recursive
+ * rules additionally by version, and iterations by relation and number. Rules whose source location
+ * changed between the runs are aligned by their text if it is unique. The differences are sorted by
+ * their regression impact, i.e. the increase of their time.
+ */
+class ProfileDiff {
+public:
+    /** measurements of a relation, rule, rule version or iteration in one run */
+    struct Measure {
+        bool present = false;
+        std::chrono::microseconds time{0};
+        int64_t tuples = 0;
+        int64_t memory = 0;
+    };
+
+    /** difference of an aligned relation, rule, rule version or iteration */
+    struct Delta {
+        /** one of relation, rule, version and iteration */
+        std::string kind;
+        std::string relation;
+        /** the text of a rule */
+        std::string name;
+        std::string locator;
+        /** the version of a rule version or the number of an iteration */
+        int number = 0;
+        Measure base;
+        Measure cur;
+
+        std::chrono::microseconds getImpact() const {
+            return cur.time - base.time;
+        }
+
+        int64_t getTupleDelta() const {
+            return cur.tuples - base.tuples;
+        }
+    };
+
+    /** difference of the frequency of an atom of a rule, summed over all iterations */
+    struct AtomDelta {
+        std::string relation;
+        std::string rule;
+        std::string atom;
+        size_t level = 0;
+        int64_t base = 0;
+        int64_t cur = 0;
+
+        int64_t getDelta() const {
+            return cur - base;
+        }
+    };
+
+    ProfileDiff(const ProgramRun& base, const ProgramRun& cur) {
+        baseRuntime = base.getEndtime() - base.getStarttime();
+        curRuntime = cur.getEndtime() - cur.getStarttime();
+
+        std::map<Key, Entry> baseEntries;
+        std::map<Key, Entry> curEntries;
+        std::map<AtomKey, AtomDelta> atomMap;
+        collect(base, baseEntries, atomMap, true);
+        collect(cur, curEntries, atomMap, false);
+        align(baseEntries, curEntries);
+
+        for (auto& cur : atomMap) {
+            atoms.push_back(cur.second);
+        }
+        std::stable_sort(deltas.begin(), deltas.end(), [](const Delta& left, const Delta& right) {
+            if (left.getImpact() != right.getImpact()) {
+                return left.getImpact() > right.getImpact();
+            }
+            return std::abs(left.getTupleDelta()) > std::abs(right.getTupleDelta());
+        });
+        std::stable_sort(atoms.begin(), atoms.end(), [](const AtomDelta& left, const AtomDelta& right) {
+            return std::abs(left.getDelta()) > std::abs(right.getDelta());
+        });
+    }
+
+    /** differences, sorted by decreasing regression impact */
+    const std::vector<Delta>& getDeltas() const {
+        return deltas;
+    }
+
+    /** differences of atom frequencies, sorted by decreasing absolute difference */
+    const std::vector<AtomDelta>& getAtomDeltas() const {
+        return atoms;
+    }
+
+    std::chrono::microseconds getBaseRuntime() const {
+        return baseRuntime;
+    }
+
+    std::chrono::microseconds getCurRuntime() const {
+        return curRuntime;
+    }
+
+    /** print the differences with the largest impact as tables */
+    void print(size_t limit = 20, int precision = 3) const {
+        std::printf("%11s%11s%11s\n", "BASE_T", "CUR_T", "DELTA_T");
+        std::printf("%11s%11s%11s\n\n", Tools::formatTime(baseRuntime).c_str(),
+                Tools::formatTime(curRuntime).c_str(), formatTimeDelta(curRuntime - baseRuntime).c_str());
+
+        std::printf("%9s%8s%8s%10s%9s%9s%10s %-10s%s\n\n", "DELTA_T", "BASE_T", "CUR_T", "DELTA_TUP",
+                "BASE_TUP", "CUR_TUP", "DELTA_MEM", "KIND", "NAME");
+        size_t shown = 0;
+        for (const auto& delta : deltas) {
+            if (shown == limit) {
+                break;
+            }
+            if (delta.getImpact().count() == 0 && delta.getTupleDelta() == 0 && delta.base.present &&
+                    delta.cur.present) {
+                continue;
+            }
+            std::string memory = "-";
+            if (delta.kind == "relation") {
+                int64_t diff = delta.cur.memory - delta.base.memory;
+                memory = (diff < 0 ? "-" : "+") + Tools::formatMemory(std::abs(diff));
+            }
+            std::printf("%9s%8s%8s%10s%9s%9s%10s %-10s%s\n", formatTimeDelta(delta.getImpact()).c_str(),
+                    formatTime(delta.base).c_str(), formatTime(delta.cur).c_str(),
+                    formatNumDelta(precision, delta.getTupleDelta()).c_str(),
+                    formatNum(precision, delta.base).c_str(), formatNum(precision, delta.cur).c_str(),
+                    memory.c_str(), delta.kind.c_str(), getDescription(delta).c_str());
+            ++shown;
+        }
+
+        std::printf("\n%9s%10s%10s%6s %s\n\n", "DELTA", "BASE", "CUR", "LEVEL", "ATOM");
+        shown = 0;
+        for (const auto& atom : atoms) {
+            if (shown == limit || atom.getDelta() == 0) {
+                break;
+            }
+            std::printf("%9s%10s%10s%6zu %s: %s in %s\n", formatNumDelta(precision, atom.getDelta()).c_str(),
+                    Tools::formatNum(precision, atom.base).c_str(),
+                    Tools::formatNum(precision, atom.cur).c_str(), atom.level, atom.relation.c_str(),
+                    atom.atom.c_str(), atom.rule.c_str());
+            ++shown;
+        }
+    }
+
+    /** all differences as a json object, with times in seconds and memory in kB */
+    std::string genJson() const {
+        std::stringstream ss;
+        ss << R"_({"runtime": {"baseline": )_" << baseRuntime.count() / 1000000.0
+           << R"_(, "current": )_" << curRuntime.count() / 1000000.0 << "},\n";
+
+        ss << R"_("deltas": [)_";
+        bool first = true;
+        for (const auto& delta : deltas) {
+            ss << (first ? "\n" : ",\n");
+            first = false;
+            ss << R"_({"kind": ")_" << delta.kind << R"_(", "relation": ")_"
+               << Tools::cleanJsonOut(delta.relation) << R"_(", "name": ")_"
+               << Tools::cleanJsonOut(delta.name) << R"_(", "locator": ")_"
+               << Tools::cleanJsonOut(delta.locator) << R"_(", "number": )_" << delta.number
+               << R"_(, "baseline": )_";
+            genJsonMeasure(ss, delta.kind, delta.base);
+            ss << R"_(, "current": )_";
+            genJsonMeasure(ss, delta.kind, delta.cur);
+            ss << R"_(, "impact": )_" << delta.getImpact().count() / 1000000.0 << "}";
+        }
+        ss << "],\n";
+
+        ss << R"_("atoms": [)_";
+        first = true;
+        for (const auto& atom : atoms) {
+            ss << (first ? "\n" : ",\n");
+            first = false;
+            ss << R"_({"relation": ")_" << Tools::cleanJsonOut(atom.relation) << R"_(", "rule": ")_"
+               << Tools::cleanJsonOut(atom.rule) << R"_(", "atom": ")_" << Tools::cleanJsonOut(atom.atom)
+               << R"_(", "level": )_" << atom.level << R"_(, "baseline": )_" << atom.base
+               << R"_(, "current": )_" << atom.cur << "}";
+        }
+        ss << "]}\n";
+        return ss.str();
+    }
+
+private:
+    /** kind, relation, rule text, source location and number of a measured entity */
+    using Key = std::tuple<std::string, std::string, std::string, std::string, int>;
+
+    /** relation, rule text, atom text and level of an atom */
+    using AtomKey = std::tuple<std::string, std::string, std::string, size_t>;
+
+    struct Entry {
+        std::string locator;
+        Measure measure;
+    };
+
+    std::chrono::microseconds baseRuntime{0};
+    std::chrono::microseconds curRuntime{0};
+    std::vector<Delta> deltas;
+    std::vector<AtomDelta> atoms;
+
+    static void add(std::map<Key, Entry>& entries, const Key& key, const std::string& locator,
+            std::chrono::microseconds time, int64_t tuples) {
+        Entry& entry = entries[key];
+        entry.locator = locator;
+        entry.measure.present = true;
+        entry.measure.time += time;
+        entry.measure.tuples += tuples;
+    }
+
+    static void addAtoms(std::map<AtomKey, AtomDelta>& atomMap, const std::string& relation,
+            const Rule& rule, bool isBase) {
+        for (const auto& atom : rule.getAtoms()) {
+            AtomDelta& delta = atomMap[AtomKey(relation, atom.rule, atom.identifier, atom.level)];
+            delta.relation = relation;
+            delta.rule = atom.rule;
+            delta.atom = atom.identifier;
+            delta.level = atom.level;
+            (isBase ? delta.base : delta.cur) += atom.frequency;
+        }
+    }
+
+    /** collect the measurements of the relations, rules, rule versions and iterations of a run */
+    static void collect(const ProgramRun& run, std::map<Key, Entry>& entries,
+            std::map<AtomKey, AtomDelta>& atomMap, bool isBase) {
+        for (const auto& cur : run.getRelationMap()) {
+            const Relation& relation = *cur.second;
+            const std::string& name = relation.getName();
+
+            Entry& entry = entries[Key("relation", name, "", "", 0)];
+            entry.locator = relation.getLocator();
+            entry.measure.present = true;
+            entry.measure.time = relation.getNonRecTime() + relation.getRecTime() + relation.getCopyTime();
+            entry.measure.tuples = relation.size();
+            entry.measure.memory = relation.getMaxRSSDiff();
+
+            for (const auto& rul : relation.getRuleMap()) {
+                Rule& rule = *rul.second;
+                add(entries, Key("rule", name, rule.getName(), rule.getLocator(), 0), rule.getLocator(),
+                        rule.getRuntime(), rule.size());
+                addAtoms(atomMap, name, rule, isBase);
+            }
+
+            int number = 0;
+            for (const auto& iteration : relation.getIterations()) {
+                ++number;
+                add(entries, Key("iteration", name, "", "", number), relation.getLocator(),
+                        iteration->getRuntime() + iteration->getCopytime(), iteration->size());
+                for (const auto& rul : iteration->getRules()) {
+                    Rule& rule = *rul.second;
+                    add(entries, Key("rule", name, rule.getName(), rule.getLocator(), 0), rule.getLocator(),
+                            rule.getRuntime(), rule.size());
+                    add(entries, Key("version", name, rule.getName(), rule.getLocator(), rule.getVersion()),
+                            rule.getLocator(), rule.getRuntime(), rule.size());
+                    addAtoms(atomMap, name, rule, isBase);
+                }
+            }
+        }
+    }
+
+    void addDelta(const Key& key, const Entry* base, const Entry* cur) {
+        Delta delta;
+        std::tie(delta.kind, delta.relation, delta.name, std::ignore, delta.number) = key;
+        delta.locator = cur != nullptr ? cur->locator : base->locator;
+        if (base != nullptr) {
+            delta.base = base->measure;
+        }
+        if (cur != nullptr) {
+            delta.cur = cur->measure;
+        }
+        deltas.push_back(delta);
+    }
+
+    /** align the entries of both runs, first by their keys and then by their keys without location */
+    void align(const std::map<Key, Entry>& baseEntries, const std::map<Key, Entry>& curEntries) {
+        std::map<Key, std::vector<const Key*>> baseMoved;
+        std::map<Key, std::vector<const Key*>> curMoved;
+        auto unlocated = [](const Key& key) {
+            Key result = key;
+            std::get<3>(result) = "";
+            return result;
+        };
+
+        for (const auto& cur : baseEntries) {
+            auto match = curEntries.find(cur.first);
+            if (match != curEntries.end()) {
+                addDelta(cur.first, &cur.second, &match->second);
+            } else {
+                baseMoved[unlocated(cur.first)].push_back(&cur.first);
+            }
+        }
+        for (const auto& cur : curEntries) {
+            if (baseEntries.find(cur.first) == baseEntries.end()) {
+                curMoved[unlocated(cur.first)].push_back(&cur.first);
+            }
+        }
+
+        for (const auto& cur : curMoved) {
+            auto match = baseMoved.find(cur.first);
+            if (match != baseMoved.end() && match->second.size() == 1 && cur.second.size() == 1) {
+                addDelta(*cur.second.front(), &baseEntries.at(*match->second.front()),
+                        &curEntries.at(*cur.second.front()));
+                baseMoved.erase(match);
+                continue;
+            }
+            for (const Key* key : cur.second) {
+                addDelta(*key, nullptr, &curEntries.at(*key));
+            }
+        }
+        for (const auto& cur : baseMoved) {
+            for (const Key* key : cur.second) {
+                addDelta(*key, &baseEntries.at(*key), nullptr);
+            }
+        }
+    }
+
+    static std::string getDescription(const Delta& delta) {
+        std::string description = delta.relation;
+        if (delta.kind == "iteration") {
+            description += " #" + std::to_string(delta.number);
+        } else if (delta.kind != "relation") {
+            description += ": " + delta.name;
+            if (delta.kind == "version") {
+                description += " [" + std::to_string(delta.number) + "]";
+            }
+        }
+        if (!delta.base.present) {
+            description += " (new)";
+        } else if (!delta.cur.present) {
+            description += " (removed)";
+        }
+        return description;
+    }
+
+    static void genJsonMeasure(std::stringstream& ss, const std::string& kind, const Measure& measure) {
+        if (!measure.present) {
+            ss << "null";
+            return;
+        }
+        ss << R"_({"time": )_" << measure.time.count() / 1000000.0 << R"_(, "tuples": )_" << measure.tuples;
+        if (kind == "relation") {
+            ss << R"_(, "memory": )_" << measure.memory;
+        }
+        ss << "}";
+    }
+
+    static std::string formatTime(const Measure& measure) {
+        return measure.present ? Tools::formatTime(measure.time) : "-";
+    }
+
+    static std::string formatNum(int precision, const Measure& measure) {
+        return measure.present ? Tools::formatNum(precision, measure.tuples) : "-";
+    }
+
+    static std::string formatTimeDelta(std::chrono::microseconds delta) {
+        return (delta.count() < 0 ? "-" : "+") +
+               Tools::formatTime(std::chrono::microseconds(std::abs(delta.count())));
+    }
+
+    static std::string formatNumDelta(int precision, int64_t delta) {
+        return (delta < 0 ? "-" : "+") + Tools::formatNum(precision, std::abs(delta));
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
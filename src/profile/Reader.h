@@ -60,6 +60,42 @@ protected:
     T& base;
 };
 
+/**
+ * Visit ProfileDB hardware counters.
+ * counters: {counter: num}
+ */
+template <typename T>
+class CountersVisitor : public Visitor {
+public:
+    CountersVisitor(T& base) : base(base) {}
+    void visit(SizeEntry& size) override {
+        base.addCounter(size.getKey(), size.getSize());
+    }
+
+private:
+    T& base;
+};
+
+/**
+ * Visit ProfileDB load balance of the parallel loops of a relation.
+ * parallel: {rule: {executions: num, busy-max: num, ...}}
+ */
+class ParallelBalanceVisitor : public Visitor {
+public:
+    ParallelBalanceVisitor(Relation& relation) : relation(relation) {}
+    void visit(DirectoryEntry& directory) override {
+        for (const auto& key : directory.getKeys()) {
+            auto* size = dynamic_cast<SizeEntry*>(directory.readEntry(key));
+            if (size != nullptr) {
+                relation.addParallelBalance(directory.getKey(), key, size->getSize());
+            }
+        }
+    }
+
+private:
+    Relation& relation;
+};
+
 /**
  * Visit ProfileDB atom frequencies.
  * atomrule : {atom: {num-tuples: num}}
@@ -98,6 +134,11 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            CountersVisitor<Rule> countersVisitor(base);
+            for (auto& key : directory.getKeys()) {
+                directory.readEntry(key)->accept(countersVisitor);
+            }
         }
     }
 };
@@ -143,6 +184,11 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            CountersVisitor<Rule> countersVisitor(base);
+            for (auto& key : directory.getKeys()) {
+                directory.readEntry(key)->accept(countersVisitor);
+            }
         }
     }
 };
@@ -194,6 +240,12 @@ public:
             relation.setPreMaxRSS(preMaxRSS->getSize());
             relation.setPostMaxRSS(postMaxRSS->getSize());
         }
+        if (directory.getKey() == "counters") {
+            CountersVisitor<Relation> countersVisitor(relation);
+            for (const auto& key : directory.getKeys()) {
+                directory.readEntry(key)->accept(countersVisitor);
+            }
+        }
     }
 
 protected:
@@ -253,11 +305,25 @@ public:
             auto* postMaxRSS = dynamic_cast<SizeEntry*>(directory.readEntry("post"));
             base.setPreMaxRSS(preMaxRSS->getSize());
             base.setPostMaxRSS(postMaxRSS->getSize());
+        } else if (directory.getKey() == "counters") {
+            CountersVisitor<Relation> countersVisitor(base);
+            for (const auto& key : directory.getKeys()) {
+                directory.readEntry(key)->accept(countersVisitor);
+            }
+        } else if (directory.getKey() == "parallel") {
+            ParallelBalanceVisitor balanceVisitor(base);
+            for (const auto& key : directory.getKeys()) {
+                directory.readEntry(key)->accept(balanceVisitor);
+            }
         }
     }
     void visit(SizeEntry& size) override {
         if (size.getKey() == "reads") {
             base.addReads(size.getSize());
+        } else if (size.getKey() == "filter-saved") {
+            base.addFilterSaved(size.getSize());
+        } else if (size.getKey() == "samples") {
+            base.addSamples(size.getSize());
         } else {
             DSNVisitor::visit(size);
         }
@@ -11,6 +11,7 @@
 #include "Iteration.h"
 #include "Rule.h"
 #include <chrono>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -39,6 +40,10 @@ private:
     int ruleId = 0;
     int recursiveId = 0;
     size_t tuplesRead = 0;
+    size_t filterSaved = 0;
+    size_t samples = 0;
+    std::map<std::string, size_t> counters;
+    std::map<std::string, std::map<std::string, size_t>> parallelBalance;
 
     std::vector<std::shared_ptr<Iteration>> iterations;
 
@@ -246,6 +251,43 @@ public:
     void addReads(size_t tuplesRead) {
         this->tuplesRead += tuplesRead;
     }
+
+    size_t getFilterSaved() const {
+        return filterSaved;
+    }
+
+    void addFilterSaved(size_t filterSaved) {
+        this->filterSaved += filterSaved;
+    }
+
+    size_t getSamples() const {
+        return samples;
+    }
+
+    void addSamples(size_t samples) {
+        this->samples += samples;
+    }
+
+    /** hardware counters of the relation, summed over all iterations */
+    const std::map<std::string, size_t>& getCounters() const {
+        return counters;
+    }
+
+    void addCounter(const std::string& counter, size_t count) {
+        counters[counter] += count;
+    }
+
+    /**
+     * load balance of the parallel loops of the rules of the relation, with the executions of each
+     * loop and the maximal and mean busy times of its threads and chunks in nanoseconds
+     */
+    const std::map<std::string, std::map<std::string, size_t>>& getParallelBalance() const {
+        return parallelBalance;
+    }
+
+    void addParallelBalance(const std::string& rule, const std::string& key, size_t value) {
+        parallelBalance[rule][key] += value;
+    }
 };
 
 }  // namespace profile
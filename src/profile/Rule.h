@@ -9,6 +9,7 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
@@ -53,6 +54,7 @@ protected:
     std::string identifier;
     std::string locator{};
     std::set<Atom> atoms;
+    std::map<std::string, size_t> counters;
 
 private:
     bool recursive = false;
@@ -103,6 +105,14 @@ public:
     const std::set<Atom>& getAtoms() const {
         return atoms;
     }
+
+    const std::map<std::string, size_t>& getCounters() const {
+        return counters;
+    }
+
+    void addCounter(const std::string& counter, size_t count) {
+        counters[counter] += count;
+    }
     std::string getName() const {
         return name;
     }
@@ -11,6 +11,7 @@
 #include "../ProfileEvent.h"
 #include "HtmlGenerator.h"
 #include "OutputProcessor.h"
+#include "ProfileDiff.h"
 #include "Reader.h"
 #include "Table.h"
 #include "UserInputReader.h"
@@ -18,7 +19,9 @@
 #include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -591,6 +594,53 @@ public:
         return ss;
     }
 
+    std::stringstream& genJsonCounters(std::stringstream& ss) {
+        const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
+
+        auto comma = [&ss](bool& first, const std::string& delimiter = ", ") {
+            if (!first) {
+                ss << delimiter;
+            } else {
+                first = false;
+            }
+        };
+
+        bool firstRow = true;
+        auto genCounters = [&](const std::string& id, const std::map<std::string, size_t>& counters) {
+            if (counters.empty()) {
+                return;
+            }
+            comma(firstRow, ", \n");
+            ss << '"' << id << R"_(": {)_";
+            bool firstCol = true;
+            for (const auto& cur : counters) {
+                comma(firstCol);
+                ss << '"' << cur.first << R"_(": )_" << cur.second;
+            }
+            ss << '}';
+        };
+
+        // counters of relations and rules, keyed by their ids
+        ss << R"_("counters": {)_";
+        std::set<std::string> ruleIds;
+        for (auto& relation : run->getRelationMap()) {
+            genCounters(relation.second->getId(), relation.second->getCounters());
+            for (auto& rule : relation.second->getRuleMap()) {
+                ruleIds.insert(rule.second->getId());
+            }
+            for (auto& iteration : relation.second->getIterations()) {
+                for (auto& rule : iteration->getRules()) {
+                    ruleIds.insert(rule.second->getId());
+                }
+            }
+        }
+        for (const auto& id : ruleIds) {
+            genCounters(id, getRuleCounters(id));
+        }
+        ss << '}';
+        return ss;
+    }
+
     std::string genJson() {
         std::stringstream ss;
 
@@ -609,6 +659,8 @@ public:
         genJsonConfiguration(ss);
         ss << ",\n";
         genJsonAtoms(ss);
+        ss << ",\n";
+        genJsonCounters(ss);
         ss << '\n';
 
         ss << "};\n";
@@ -620,6 +672,41 @@ public:
         std::cout << "SouffleProf\n";
         std::cout << "Generating HTML files...\n";
 
+        std::string newFile = getHtmlFilename(filename);
+        std::ofstream outfile(newFile);
+
+        outfile << HtmlGenerator::getHtml(genJson());
+
+        std::cout << "file output to: " << newFile << std::endl;
+    }
+
+    /** load the profiles of a baseline run and a current run and compare them */
+    static ProfileDiff loadDiff(const std::string& baseFile, const std::string& curFile) {
+        auto base = std::make_shared<ProgramRun>();
+        Reader(baseFile, base).processFile();
+        auto cur = std::make_shared<ProgramRun>();
+        Reader(curFile, cur).processFile();
+        return ProfileDiff(*base, *cur);
+    }
+
+    static void outputDiffHtml(const ProfileDiff& diff, std::string filename = "profiler_html/") {
+        std::cout << "SouffleProf\n";
+        std::cout << "Generating HTML diff...\n";
+
+        std::string newFile = getHtmlFilename(filename);
+        std::ofstream outfile(newFile);
+
+        outfile << HtmlGenerator::getDiffHtml(diff.genJson());
+
+        std::cout << "file output to: " << newFile << std::endl;
+    }
+
+    /**
+     * create the directory of an html file, and number the file if the name does not end with .html
+     *
+     * @return the name of the file
+     */
+    static std::string getHtmlFilename(const std::string& filename) {
         DIR* dir;
         bool exists = false;
 
@@ -651,12 +738,7 @@ public:
                 newFile = filename + std::to_string(i) + ".html";
             } while (Tools::file_exists(newFile));
         }
-
-        std::ofstream outfile(newFile);
-
-        outfile << HtmlGenerator::getHtml(genJson());
-
-        std::cout << "file output to: " << newFile << std::endl;
+        return newFile;
     }
 
     void quit() {
@@ -1154,6 +1236,17 @@ public:
             src = run->getRelation(name)->getLocator();
         }
         std::cout << "\nSrc locator: " << src << "\n\n";
+        if (run->getRelation(name) != nullptr && run->getRelation(name)->getFilterSaved() > 0) {
+            std::cout << "Existence checks answered by filter: " << run->getRelation(name)->getFilterSaved()
+                      << "\n\n";
+        }
+        if (run->getRelation(name) != nullptr && run->getRelation(name)->getSamples() > 0) {
+            std::cout << "CPU samples: " << run->getRelation(name)->getSamples() << "\n\n";
+        }
+        if (run->getRelation(name) != nullptr) {
+            printCounters(run->getRelation(name)->getCounters());
+            printParallelBalance(run->getRelation(name)->getParallelBalance());
+        }
         for (auto& row : formattedRuleTable) {
             if (row[7] == name) {
                 std::printf("%7s%2s%s\n", row[6].c_str(), "", row[5].c_str());
@@ -1200,6 +1293,7 @@ public:
             } else if (formattedRuleTable.size() > 0) {
                 std::cout << "Src locator-: " << formattedRuleTable[0][10] << "\n\n";
             }
+            printCounters(getRuleCounters(str));
         }
 
         // Print out the versions of this rule.
@@ -1230,6 +1324,71 @@ public:
         verAtoms(atom_table, ruleName);
     }
 
+    /** sum the hardware counters of all versions and iterations of a rule */
+    std::map<std::string, size_t> getRuleCounters(const std::string& id) {
+        std::map<std::string, size_t> counters;
+        auto add = [&](const Rule& rule) {
+            if (rule.getId() == id) {
+                for (const auto& cur : rule.getCounters()) {
+                    counters[cur.first] += cur.second;
+                }
+            }
+        };
+        for (auto& relation : out.getProgramRun()->getRelationMap()) {
+            for (auto& rule : relation.second->getRuleMap()) {
+                add(*rule.second);
+            }
+            for (auto& iteration : relation.second->getIterations()) {
+                for (auto& rule : iteration->getRules()) {
+                    add(*rule.second);
+                }
+            }
+        }
+        return counters;
+    }
+
+    /** print hardware counters, if they were collected */
+    static void printCounters(const std::map<std::string, size_t>& counters) {
+        if (counters.empty()) {
+            return;
+        }
+        std::cout << "Hardware counters:";
+        for (const auto& cur : counters) {
+            std::cout << " " << cur.first << " " << cur.second;
+        }
+        auto cycles = counters.find("cycles");
+        auto instructions = counters.find("instructions");
+        if (cycles != counters.end() && instructions != counters.end() && cycles->second > 0) {
+            std::printf(" (IPC %.2f)", static_cast<double>(instructions->second) / cycles->second);
+        }
+        std::cout << "\n\n";
+    }
+
+    /**
+     * print the load balance of parallel loops, as the ratios of the maximal to the mean busy time
+     * of their threads and of their chunks
+     */
+    static void printParallelBalance(const std::map<std::string, std::map<std::string, size_t>>& loops) {
+        if (loops.empty()) {
+            return;
+        }
+        std::cout << "Parallel loops:\n";
+        std::printf("%8s%8s%8s%8s %s\n", "EXEC", "CHUNKS", "THR_IMB", "CHK_IMB", "RULE");
+        for (const auto& loop : loops) {
+            auto get = [&](const std::string& key) {
+                auto value = loop.second.find(key);
+                return value == loop.second.end() ? 0.0 : static_cast<double>(value->second);
+            };
+            auto ratio = [](double max, double mean) { return mean > 0 ? max / mean : 0.0; };
+            double executions = get("executions");
+            std::printf("%8.0f%8.0f%8.2f%8.2f %s\n", executions,
+                    executions > 0 ? get("chunks") / executions : 0.0,
+                    ratio(get("busy-max"), get("busy-mean")), ratio(get("chunk-max"), get("chunk-mean")),
+                    loop.first.c_str());
+        }
+        std::cout << "\n";
+    }
+
     void iterRel(std::string c, std::string col) {
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
         std::vector<std::vector<std::string>> table = Tools::formatTable(relationTable, -1);
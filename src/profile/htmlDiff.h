@@ -0,0 +1,159 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+#include <string>
+
+namespace souffle {
+namespace profile {
+namespace html {
+std::string htmlDiffBody = R"___(
+<body>
+<div id="wrapper" style="width:100%;height:inherit;">
+    <div class="tabcontent" style="display:block;margin-left: auto;margin-right: auto;">
+        <h3>Profile difference</h3>
+        <div id="diff-stats"></div>
+        <button onclick="toggle_precision();">Toggle number precision</button>
+        <h3>Relations, rules, rule versions and iterations by regression impact</h3>
+        <div class="table_wrapper">
+            <table id='diff_table'>
+                <thead>
+                <tr>
+                    <th data-sort-method="time">Delta Time</th>
+                    <th data-sort-method="time">Baseline Time</th>
+                    <th data-sort-method="time">Current Time</th>
+                    <th data-sort-method="number">Delta Tuples</th>
+                    <th data-sort-method="number">Baseline Tuples</th>
+                    <th data-sort-method="number">Current Tuples</th>
+                    <th data-sort-method="number">Delta Memory</th>
+                    <th data-sort-method="text">Kind</th>
+                    <th data-sort-method="text">Name</th>
+                    <th data-sort-method="text">Source</th>
+                </tr>
+                </thead>
+                <tbody id="diff_table_body">
+                </tbody>
+            </table>
+        </div>
+        <h3>Atom frequencies</h3>
+        <div class="table_wrapper">
+            <table id='diff_atom_table'>
+                <thead>
+                <tr>
+                    <th data-sort-method="number">Delta</th>
+                    <th data-sort-method="number">Baseline</th>
+                    <th data-sort-method="number">Current</th>
+                    <th data-sort-method="number">Level</th>
+                    <th data-sort-method="text">Relation</th>
+                    <th data-sort-method="text">Atom</th>
+                    <th data-sort-method="text">Rule</th>
+                </tr>
+                </thead>
+                <tbody id="diff_atom_table_body">
+                </tbody>
+            </table>
+        </div>
+    </div>
+</div>
+)___";
+
+std::string jsDiff = R"___(
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+var precision = false;
+
+function signed(value, format) {
+    return (value < 0 ? "-" : "+") + format(Math.abs(value));
+}
+
+function diff_measure(measure, key, format) {
+    if (measure === null) {
+        return "-";
+    }
+    return format(measure[key]);
+}
+
+function diff_description(delta) {
+    var description = delta.relation;
+    if (delta.kind == "iteration") {
+        description += " #" + delta.number;
+    } else if (delta.kind != "relation") {
+        description += ": " + delta.name;
+        if (delta.kind == "version") {
+            description += " [" + delta.number + "]";
+        }
+    }
+    if (delta.baseline === null) {
+        description += " (new)";
+    } else if (delta.current === null) {
+        description += " (removed)";
+    }
+    return description;
+}
+
+function diff_cells(row, cells) {
+    for (var i = 0; i < cells.length; i++) {
+        var cell = document.createElement("td");
+        cell.textContent = cells[i];
+        row.appendChild(cell);
+    }
+}
+
+function diff_tables() {
+    document.getElementById("diff-stats").textContent = "Runtime: " + humanise_time(data.runtime.baseline) +
+        " -> " + humanise_time(data.runtime.current) + " (" +
+        signed(data.runtime.current - data.runtime.baseline, humanise_time) + ")";
+
+    var body = document.getElementById("diff_table_body");
+    body.innerHTML = "";
+    data.deltas.forEach(function (delta) {
+        var base = delta.baseline === null ? {time: 0, tuples: 0, memory: 0} : delta.baseline;
+        var cur = delta.current === null ? {time: 0, tuples: 0, memory: 0} : delta.current;
+        var memory = "-";
+        if (delta.kind == "relation") {
+            memory = signed((cur.memory - base.memory) * 1024, minify_memory);
+        }
+        var row = document.createElement("tr");
+        diff_cells(row, [signed(delta.impact, humanise_time),
+            diff_measure(delta.baseline, "time", humanise_time),
+            diff_measure(delta.current, "time", humanise_time),
+            signed(cur.tuples - base.tuples, minify_numbers),
+            diff_measure(delta.baseline, "tuples", minify_numbers),
+            diff_measure(delta.current, "tuples", minify_numbers),
+            memory, delta.kind, diff_description(delta), delta.locator]);
+        body.appendChild(row);
+    });
+
+    var atomBody = document.getElementById("diff_atom_table_body");
+    atomBody.innerHTML = "";
+    data.atoms.forEach(function (atom) {
+        var row = document.createElement("tr");
+        diff_cells(row, [signed(atom.current - atom.baseline, minify_numbers),
+            minify_numbers(atom.baseline), minify_numbers(atom.current), atom.level,
+            atom.relation, atom.atom, atom.rule]);
+        atomBody.appendChild(row);
+    });
+}
+
+function toggle_precision() {
+    precision = !precision;
+    diff_tables();
+}
+
+diff_tables();
+Tablesort(document.getElementById('diff_table'), {descending: true});
+Tablesort(document.getElementById('diff_atom_table'), {descending: true});
+)___";
+}  // namespace html
+}  // namespace profile
+}  // namespace souffle
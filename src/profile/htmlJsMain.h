@@ -16,6 +16,7 @@ function changeSelectedRel(id) {
     selected.rel = id;
     highlightRow();
     genRulesOfRelations();
+    genCounters(id, "rel_counters");
 }
 
 function changeSelectedRul(id) {
@@ -23,6 +24,7 @@ function changeSelectedRul(id) {
     highlightRow();
     genRulVer();
     genAtomVer();
+    genCounters(id, "rul_counters");
 }
 
 function highlightRow() {
@@ -474,6 +476,22 @@ function genAtomVer() {
     document.getElementById("atoms").style.display = "block";
 }
 
+function genCounters(id, element_id) {
+    var element = document.getElementById(element_id);
+    element.textContent = "";
+    if (!data.hasOwnProperty("counters") || !data.counters.hasOwnProperty(id)) return;
+    var counters = data.counters[id];
+    var text = "Hardware counters:";
+    for (var name in counters) {
+        if (!counters.hasOwnProperty(name)) continue;
+        text += " " + name + " " + minify_numbers(counters[name]);
+    }
+    if (counters.cycles > 0 && counters.hasOwnProperty("instructions")) {
+        text += " (IPC " + (counters.instructions / counters.cycles).toFixed(2) + ")";
+    }
+    element.textContent = text;
+}
+
 function genConfig() {
     var table = document.createElement("table");
     {
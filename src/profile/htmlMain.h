@@ -154,6 +154,7 @@ std::string htmlBodyTop = R"___(
                 </tbody>
             </table>
         </div>
+        <p id="rel_counters"></p>
     </div>
 </div>
 <div id="Rules" class="tabcontent">
@@ -202,6 +203,7 @@ std::string htmlBodyTop = R"___(
                 </tbody>
             </table>
         </div>
+        <p id="rul_counters"></p>
     </div>
     <div id="atoms" style="display:none;">
         <h3>Atom Frequency Table</h3>
@@ -0,0 +1,112 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file souffle_disk_bench.cpp
+ *
+ * Throughput benchmark of disk-backed sets against in-memory B-trees,
+ * for data sets of a given multiple of the available memory. Each run
+ * measures a single data structure, such that a B-tree exceeding the
+ * memory only terminates its own run.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "LsmSet.h"
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+
+using Tuple = souffle::ram::Tuple<souffle::RamDomain, 2>;
+using Comparator = typename souffle::ram::index_utils::get_full_index<2>::type::comparator;
+
+/** Returns the i-th tuple of a pseudo-random sequence without duplicates */
+Tuple getTuple(uint64_t i) {
+    uint64_t x = i * 0x9e3779b97f4a7c15ULL;
+    return Tuple{{static_cast<souffle::RamDomain>(x >> 32), static_cast<souffle::RamDomain>(i)}};
+}
+
+template <typename Set>
+void run(const std::string& name, uint64_t numTuples) {
+    using clock = std::chrono::steady_clock;
+    auto report = [&](const char* phase, clock::time_point start, uint64_t ops) {
+        std::chrono::duration<double> elapsed = clock::now() - start;
+        std::cout << name << " " << phase << ": " << elapsed.count() << "s, " << ops / elapsed.count()
+                  << " tuples/s\n";
+    };
+
+    Set set;
+    auto start = clock::now();
+    for (uint64_t i = 0; i < numTuples; i++) {
+        set.insert(getTuple(i));
+    }
+    report("insert", start, numTuples);
+
+    start = clock::now();
+    uint64_t found = 0;
+    uint64_t numLookups = std::min<uint64_t>(numTuples, 1000000);
+    for (uint64_t i = 0; i < numLookups; i++) {
+        // alternate between present and absent tuples
+        found += set.contains(getTuple((i * 7919) % numTuples + (i % 2) * numTuples)) ? 1 : 0;
+    }
+    report("lookup", start, numLookups);
+
+    start = clock::now();
+    uint64_t scanned = 0;
+    for (auto it = set.begin(); it != set.end(); ++it) {
+        scanned++;
+    }
+    report("scan", start, scanned);
+
+    if (found != (numLookups + 1) / 2 || scanned != numTuples) {
+        std::cerr << "Inconsistent results: " << found << " found, " << scanned << " scanned\n";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <btree|disk> <memory> <factor> [buffer]\n";
+        std::cerr << "  Inserts, looks up and scans <factor> times <memory> megabytes of binary tuples\n";
+        std::cerr << "  in a B-tree or a disk-backed set buffering [buffer] tuples in memory. Run it\n";
+        std::cerr << "  with the memory limited to <memory> megabytes, e.g. by ulimit -v or a cgroup.\n";
+        return 1;
+    }
+    std::string structure = argv[1];
+    try {
+        uint64_t memory = std::stoull(argv[2]) << 20;
+        double factor = std::stod(argv[3]);
+        if (argc > 4) {
+            souffle::LsmConfig::bufferSize() = std::stoull(argv[4]);
+        }
+        auto numTuples = static_cast<uint64_t>(factor * memory / sizeof(Tuple));
+        std::cout << "tuples: " << numTuples << ", data: " << numTuples * sizeof(Tuple) / (1 << 20)
+                  << "MB\n";
+        if (structure == "btree") {
+            run<souffle::btree_set<Tuple, Comparator>>(structure, numTuples);
+        } else if (structure == "disk") {
+            run<souffle::LsmSet<Tuple, Comparator>>(structure, numTuples);
+        } else {
+            std::cerr << "Unknown data structure " << structure << "\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file souffle_layout_bench.cpp
+ *
+ * Benchmark of the layouts of b-tree relations with three indexes: direct
+ * indexes storing copies of the tuples, indirect indexes storing pointers to
+ * the tuples, and keyed indirect indexes storing pointers together with a
+ * copy of the leading key columns. Prints the memory of each layout and the
+ * time of insertions, full scans and range lookups for several arities, as
+ * a reference for the cost model of RamLayoutAnalysis.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "Table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+
+using souffle::RamDomain;
+using namespace souffle::ram::index_utils;
+
+/** An index storing the two leading columns of its order next to the pointers to the tuples */
+template <typename Tuple, unsigned First, unsigned Second, unsigned... Rest>
+struct KeyedIndex {
+    using type = souffle::btree_set<keyed_ref<Tuple, First, Second>,
+            keyed_compare<comparator<0, 1>, comparator<Rest...>>>;
+};
+
+/** The orders of the three indexes of a relation, which rotate the columns by 0, 1 and 2 */
+template <size_t Arity, size_t Shift, typename Columns = std::make_index_sequence<Arity>>
+struct Rotation;
+
+template <size_t Arity, size_t Shift, size_t... Columns>
+struct Rotation<Arity, Shift, std::index_sequence<Columns...>> {
+    using order = comparator<(Columns + Shift) % Arity...>;
+
+    template <typename Tuple>
+    using keyed = typename KeyedIndex<Tuple, (Columns + Shift) % Arity...>::type;
+};
+
+/** Returns the i-th tuple of a pseudo-random sequence without duplicates */
+template <typename Tuple>
+Tuple getTuple(uint64_t i) {
+    Tuple t;
+    for (size_t c = 0; c + 1 < Tuple::arity; c++) {
+        // splitmix64 of the position of the column
+        uint64_t x = (i * Tuple::arity + c + 1) * 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        t[c] = static_cast<RamDomain>((x ^ (x >> 31)) & 0xff);
+    }
+    t[Tuple::arity - 1] = static_cast<RamDomain>(i);
+    return t;
+}
+
+/** Returns a tuple of the columns 1 and 2 of the given tuple, and value in the other columns */
+template <typename Tuple>
+Tuple getBound(const Tuple& t, RamDomain value) {
+    Tuple bound;
+    for (size_t c = 0; c < Tuple::arity; c++) {
+        bound[c] = value;
+    }
+    bound[1] = t[1];
+    bound[2] = t[2];
+    return bound;
+}
+
+/** A relation storing a copy of each tuple in each index */
+template <size_t Arity>
+struct Direct {
+    using Tuple = souffle::ram::Tuple<RamDomain, Arity>;
+
+    souffle::btree_set<Tuple, typename Rotation<Arity, 0>::order> ind0;
+    souffle::btree_set<Tuple, typename Rotation<Arity, 1>::order> ind1;
+    souffle::btree_set<Tuple, typename Rotation<Arity, 2>::order> ind2;
+
+    void insert(const Tuple& t) {
+        if (ind0.insert(t)) {
+            ind1.insert(t);
+            ind2.insert(t);
+        }
+    }
+
+    uint64_t countRange(const Tuple& low, const Tuple& high) const {
+        uint64_t count = 0;
+        for (auto it = ind1.lower_bound(low), end = ind1.upper_bound(high); it != end; ++it) {
+            count += (*it)[Arity - 1] != 0 ? 1 : 0;
+        }
+        return count;
+    }
+
+    template <typename Body>
+    void forEachIndex(const Body& body) const {
+        body(ind0, [](const Tuple& t) -> const Tuple& { return t; });
+        body(ind1, [](const Tuple& t) -> const Tuple& { return t; });
+        body(ind2, [](const Tuple& t) -> const Tuple& { return t; });
+    }
+
+    size_t getMemoryUsage() const {
+        return ind0.getMemoryUsage() + ind1.getMemoryUsage() + ind2.getMemoryUsage();
+    }
+};
+
+/** A relation storing each tuple once, indexed by the given indexes of references to the tuples */
+template <typename Tuple, typename Index0, typename Index1, typename Index2>
+struct Indirect {
+    souffle::Table<Tuple> data;
+    Index0 ind0;
+    Index1 ind1;
+    Index2 ind2;
+
+    void insert(const Tuple& t) {
+        if (ind0.contains(&t)) {
+            return;
+        }
+        const Tuple* copy = &data.insert(t);
+        ind0.insert(copy);
+        ind1.insert(copy);
+        ind2.insert(copy);
+    }
+
+    uint64_t countRange(const Tuple& low, const Tuple& high) const {
+        uint64_t count = 0;
+        for (auto it = ind1.lower_bound(&low), end = ind1.upper_bound(&high); it != end; ++it) {
+            count += (**it)[Tuple::arity - 1] != 0 ? 1 : 0;
+        }
+        return count;
+    }
+
+    template <typename Body>
+    void forEachIndex(const Body& body) const {
+        body(ind0, [](const auto& ref) -> const Tuple& { return *ref; });
+        body(ind1, [](const auto& ref) -> const Tuple& { return *ref; });
+        body(ind2, [](const auto& ref) -> const Tuple& { return *ref; });
+    }
+
+    size_t getMemoryUsage() const {
+        return data.size() * sizeof(Tuple) + ind0.getMemoryUsage() + ind1.getMemoryUsage() +
+               ind2.getMemoryUsage();
+    }
+};
+
+template <size_t Arity, typename Tuple = souffle::ram::Tuple<RamDomain, Arity>>
+using PointerIndirect =
+        Indirect<Tuple, souffle::btree_set<const Tuple*, deref_compare<typename Rotation<Arity, 0>::order>>,
+                souffle::btree_set<const Tuple*, deref_compare<typename Rotation<Arity, 1>::order>>,
+                souffle::btree_set<const Tuple*, deref_compare<typename Rotation<Arity, 2>::order>>>;
+
+template <size_t Arity, typename Tuple = souffle::ram::Tuple<RamDomain, Arity>>
+using KeyedIndirect = Indirect<Tuple, typename Rotation<Arity, 0>::template keyed<Tuple>,
+        typename Rotation<Arity, 1>::template keyed<Tuple>,
+        typename Rotation<Arity, 2>::template keyed<Tuple>>;
+
+template <size_t Arity, typename Relation>
+void run(const std::string& layout, uint64_t numTuples) {
+    using Tuple = souffle::ram::Tuple<RamDomain, Arity>;
+    std::string name = "arity " + std::to_string(Arity) + " " + layout;
+    using clock = std::chrono::steady_clock;
+    auto report = [&](const char* phase, clock::time_point start, uint64_t ops) {
+        std::chrono::duration<double> elapsed = clock::now() - start;
+        std::cout << name << " " << phase << ": " << elapsed.count() << "s, " << ops / elapsed.count()
+                  << " tuples/s\n";
+    };
+
+    Relation rel;
+    auto start = clock::now();
+    for (uint64_t i = 0; i < numTuples; i++) {
+        rel.insert(getTuple<Tuple>(i));
+    }
+    report("insert", start, numTuples);
+
+    size_t memory = rel.getMemoryUsage();
+    std::cout << name << " memory: " << memory / (1 << 20) << "MB, " << memory / numTuples
+              << " bytes per tuple\n";
+
+    start = clock::now();
+    uint64_t scanned = 0;
+    uint64_t sum = 0;
+    rel.forEachIndex([&](const auto& index, const auto& deref) {
+        for (const auto& cur : index) {
+            sum += deref(cur)[0] + 1;
+            scanned++;
+        }
+    });
+    report("scan", start, scanned);
+
+    start = clock::now();
+    uint64_t found = 0;
+    uint64_t numLookups = std::min<uint64_t>(numTuples, 100000);
+    for (uint64_t i = 0; i < numLookups; i++) {
+        Tuple t = getTuple<Tuple>((i * 7919) % numTuples);
+        found += rel.countRange(getBound(t, MIN_RAM_DOMAIN), getBound(t, MAX_RAM_DOMAIN));
+    }
+    report("lookup", start, found);
+
+    if (scanned != 3 * numTuples || sum == 0) {
+        std::cerr << "Inconsistent results: " << scanned << " scanned\n";
+    }
+}
+
+/** Runs the benchmark for all layouts of the given arity */
+template <size_t Arity>
+void runLayouts(uint64_t numTuples) {
+    run<Arity, Direct<Arity>>("direct", numTuples);
+    run<Arity, PointerIndirect<Arity>>("indirect", numTuples);
+    run<Arity, KeyedIndirect<Arity>>("keyed", numTuples);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [tuples]\n";
+        std::cerr << "  Inserts [tuples] tuples (default 1000000) of arities 3 to 12 into relations with\n";
+        std::cerr << "  three indexes of direct, indirect and keyed indirect layout, and prints the memory\n";
+        std::cerr << "  and the throughput of insertions, scans of all indexes and range lookups.\n";
+        return 1;
+    }
+    try {
+        uint64_t numTuples = argc > 1 ? std::stoull(argv[1]) : 1000000;
+        runLayouts<3>(numTuples);
+        runLayouts<4>(numTuples);
+        runLayouts<6>(numTuples);
+        runLayouts<7>(numTuples);
+        runLayouts<8>(numTuples);
+        runLayouts<12>(numTuples);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
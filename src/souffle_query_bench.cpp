@@ -0,0 +1,109 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file souffle_query_bench.cpp
+ *
+ * Load generator for the query server of a compiled program. It samples
+ * patterns from the tuples of a relation and queries them concurrently.
+ *
+ ***********************************************************************/
+
+#include "QueryServer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " <socket> <relation> <arity> <mask> [threads] [queries]\n";
+        std::cerr << "  Sends queries for patterns sampled from the tuples of <relation>, bounding\n";
+        std::cerr << "  the columns selected by the bit mask <mask>, from [threads] clients issuing\n";
+        std::cerr << "  [queries] queries each.\n";
+        return 1;
+    }
+    std::string socketPath = argv[1];
+    std::string relation = argv[2];
+    size_t arity = std::stoul(argv[3]);
+    souffle::SearchSignature mask = std::stoull(argv[4]);
+    size_t numThreads = (argc > 5) ? std::stoul(argv[5]) : std::thread::hardware_concurrency();
+    size_t numQueries = (argc > 6) ? std::stoul(argv[6]) : 10000;
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+
+    try {
+        // sample the patterns from the tuples of the relation
+        std::vector<souffle::RamDomain> tuples;
+        {
+            souffle::QueryClient client(socketPath);
+            if (!client.query(relation, 0, std::vector<souffle::RamDomain>(arity, 0), tuples)) {
+                std::cerr << "Unknown relation " << relation << " of arity " << arity << "\n";
+                return 1;
+            }
+        }
+        size_t numTuples = tuples.size() / arity;
+        if (numTuples == 0) {
+            std::cerr << "Relation " << relation << " is empty\n";
+            return 1;
+        }
+
+        souffle::LatencyHistogram latency;
+        std::vector<size_t> results(numThreads, 0);
+        std::vector<std::thread> clients;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < numThreads; t++) {
+            clients.emplace_back([&, t]() {
+                souffle::QueryClient client(socketPath);
+                std::mt19937 random(t);
+                std::uniform_int_distribution<size_t> pick(0, numTuples - 1);
+                std::vector<souffle::RamDomain> pattern(arity);
+                std::vector<souffle::RamDomain> rows;
+                for (size_t q = 0; q < numQueries; q++) {
+                    size_t row = pick(random);
+                    for (size_t i = 0; i < arity; i++) {
+                        pattern[i] = ((mask >> i) & 1) != 0 ? tuples[row * arity + i] : 0;
+                    }
+                    auto queryStart = std::chrono::steady_clock::now();
+                    client.query(relation, mask, pattern, rows);
+                    latency.record(std::chrono::steady_clock::now() - queryStart);
+                    results[t] += rows.size() / arity;
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        size_t totalResults = 0;
+        for (size_t result : results) {
+            totalResults += result;
+        }
+        size_t totalQueries = numThreads * numQueries;
+        std::cout << "clients: " << numThreads << ", queries: " << totalQueries
+                  << ", tuples returned: " << totalResults << "\n";
+        std::cout << "time: " << elapsed.count() << "s, throughput: " << totalQueries / elapsed.count()
+                  << " queries/s\n";
+        std::cout << "client latency: ";
+        latency.print(std::cout);
+        std::cout << "server ";
+        std::cout << souffle::QueryClient(socketPath).stats();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
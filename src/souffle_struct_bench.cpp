@@ -0,0 +1,251 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file souffle_struct_bench.cpp
+ *
+ * Microbenchmarks of the relation data structures (B-trees, Tries and
+ * equivalence relations) at a given number of threads. The results are
+ * printed as lines of the benchmark harness, i.e.
+ *
+ *     workload,mode,threads,run,seconds
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "Brie.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "EquivalenceRelation.h"
+#include "InsertBuffer.h"
+#include "ParallelUtils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+
+using Tuple = souffle::ram::Tuple<souffle::RamDomain, 2>;
+using Comparator = typename souffle::ram::index_utils::get_full_index<2>::type::comparator;
+using BTree = souffle::btree_set<Tuple, Comparator>;
+using Trie = souffle::Trie<2>;
+using EqRel = souffle::EquivalenceRelation<Tuple>;
+
+/** Returns the i-th tuple of a pseudo-random sequence without duplicates */
+Tuple getTuple(int64_t i) {
+    uint64_t x = static_cast<uint64_t>(i) * 0x9e3779b97f4a7c15ULL;
+    return Tuple{{static_cast<souffle::RamDomain>((x >> 40) & 0xffff), static_cast<souffle::RamDomain>(i)}};
+}
+
+/** Returns the i-th tuple of a dense sequence, filling blocks of 1024 consecutive values */
+Tuple getDenseTuple(int64_t i) {
+    return Tuple{{static_cast<souffle::RamDomain>(i / 1024), static_cast<souffle::RamDomain>(i % 1024)}};
+}
+
+/** Reports the time of a phase of a benchmark in the format of the harness */
+class Reporter {
+public:
+    Reporter(int threads, int run) : threads(threads), run(run) {}
+
+    template <typename Body>
+    void measure(const std::string& workload, const Body& body) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t check = body();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << workload << ",micro," << threads << "," << run << "," << elapsed.count() << std::endl;
+        // keep the results alive, such that the work is not optimised away
+        if (check == static_cast<uint64_t>(-1)) {
+            std::cerr << "unexpected result of " << workload << "\n";
+        }
+    }
+
+private:
+    int threads;
+    int run;
+};
+
+/** Benchmarks the insertion, lookup and scan of a set of binary tuples */
+template <typename Set, typename Context>
+void benchSet(Reporter& reporter, const std::string& name, int64_t size) {
+    Set set;
+    reporter.measure(name + "-insert", [&]() {
+        PARALLEL_START;
+        Context ctxt;
+        pfor(int64_t i = 0; i < size; i++) {
+            set.insert(getTuple(i), ctxt);
+        }
+        PARALLEL_END;
+        return set.size();
+    });
+
+    reporter.measure(name + "-lookup", [&]() {
+        std::atomic<uint64_t> found(0);
+        PARALLEL_START;
+        Context ctxt;
+        uint64_t local = 0;
+        // alternate between present and absent tuples
+        pfor(int64_t i = 0; i < size; i++) {
+            local += set.contains(getTuple((i * 7919) % size + (i % 2) * size), ctxt) ? 1 : 0;
+        }
+        found += local;
+        PARALLEL_END;
+        return found.load();
+    });
+
+    reporter.measure(name + "-scan", [&]() {
+        std::atomic<uint64_t> sum(0);
+        auto part = set.partition(400);
+        PARALLEL_START;
+        uint64_t local = 0;
+        pfor(auto it = part.begin(); it < part.end(); ++it) {
+            for (const auto& cur : *it) {
+                local += cur[0];
+            }
+        }
+        sum += local;
+        PARALLEL_END;
+        return sum.load();
+    });
+}
+
+/**
+ * Benchmarks the parallel insertion of binary tuples into a B-tree through thread-local
+ * insertion buffers, to be compared with the contended direct insertion of benchSet
+ */
+void benchBuffered(Reporter& reporter, int64_t size) {
+    BTree set;
+    souffle::InsertBuffer buffer(2);
+    reporter.measure("btree-buffered-insert", [&]() {
+        PARALLEL_START;
+        pfor(int64_t i = 0; i < size; i++) {
+            Tuple t = getTuple(i);
+            buffer.insert(&t[0]);
+        }
+        PARALLEL_END;
+        buffer.merge([&]() {
+            return [&, hints = BTree::operation_hints()](const souffle::RamDomain* tuple) mutable {
+                set.insert(reinterpret_cast<const Tuple&>(*tuple), hints);
+            };
+        });
+        return set.size();
+    });
+}
+
+/** Inserts all tuples of a B-tree into another B-tree */
+void insertAll(BTree& trg, const BTree& src) {
+    trg.insert(src.begin(), src.end());
+}
+
+/** Inserts all tuples of a Trie into another Trie */
+void insertAll(Trie& trg, const Trie& src) {
+    trg.insertAll(src);
+}
+
+/** Benchmarks the union of two sets of binary tuples and the size of the result */
+template <typename Set, typename Generator>
+void benchBulk(Reporter& reporter, const std::string& name, int64_t size, const Generator& getTuple) {
+    // two overlapping halves of the tuples
+    Set first;
+    Set second;
+    for (int64_t i = 0; i < size; i++) {
+        if (i % 4 != 0) {
+            first.insert(getTuple(i));
+        }
+        if (i % 4 != 1) {
+            second.insert(getTuple(i));
+        }
+    }
+
+    Set set;
+    reporter.measure(name + "-insertall", [&]() {
+        insertAll(set, first);
+        insertAll(set, second);
+        return static_cast<uint64_t>(set.empty());
+    });
+
+    reporter.measure(name + "-size", [&]() {
+        uint64_t sum = 0;
+        for (int k = 0; k < 10; k++) {
+            sum += set.size();
+        }
+        return sum;
+    });
+}
+
+/** Benchmarks the unions of an equivalence relation and the enumeration of its pairs */
+void benchEqRel(Reporter& reporter, int64_t size) {
+    EqRel eqrel;
+    reporter.measure("eqrel-insert", [&]() {
+        PARALLEL_START;
+        pfor(int64_t i = 0; i < size; i++) {
+            // classes of 50 consecutive elements
+            if ((i + 1) % 50 != 0) {
+                eqrel.insert(static_cast<souffle::RamDomain>(i), static_cast<souffle::RamDomain>(i + 1));
+            }
+        }
+        PARALLEL_END;
+        return static_cast<uint64_t>(eqrel.contains(0, 1));
+    });
+
+    reporter.measure("eqrel-scan", [&]() {
+        std::atomic<uint64_t> pairs(0);
+        auto part = eqrel.partition(400);
+        PARALLEL_START;
+        uint64_t local = 0;
+        pfor(auto it = part.begin(); it < part.end(); ++it) {
+            for (auto cur = it->begin(); cur != it->end(); ++cur) {
+                local++;
+            }
+        }
+        pairs += local;
+        PARALLEL_END;
+        return pairs.load();
+    });
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <threads> <run> [size]\n";
+        std::cerr << "  Inserts, looks up and scans [size] binary tuples (default 2000000) in B-trees,\n";
+        std::cerr << "  Tries and equivalence relations with <threads> threads, inserts them into a\n";
+        std::cerr << "  B-tree through insertion buffers, unites sets of dense and sparse tuples, and\n";
+        std::cerr << "  prints the time of each phase as\n";
+        std::cerr << "  workload,mode,threads,run,seconds.\n";
+        return 1;
+    }
+    try {
+        int threads = std::stoi(argv[1]);
+        int run = std::stoi(argv[2]);
+        int64_t size = argc > 3 ? std::stoll(argv[3]) : 2000000;
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#else
+        threads = 1;
+#endif
+        Reporter reporter(threads, run);
+        benchSet<BTree, BTree::operation_hints>(reporter, "btree", size);
+        benchBuffered(reporter, size);
+        benchSet<Trie, Trie::op_context>(reporter, "brie", size);
+        benchBulk<BTree>(reporter, "btree-dense", size, getDenseTuple);
+        benchBulk<Trie>(reporter, "brie-dense", size, getDenseTuple);
+        benchBulk<BTree>(reporter, "btree-sparse", size, getTuple);
+        benchBulk<Trie>(reporter, "brie-sparse", size, getTuple);
+        benchEqRel(reporter, size / 10);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -17,6 +17,7 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -83,6 +84,74 @@ public:
     void dumpOutputs(std::ostream& out = std::cout) {
         program->dumpOutputs(out);
     }
+
+    /**
+     * Returns the arity of a relation, or 0 if the relation does not exist
+     */
+    size_t getArity(const std::string& relationName) {
+        souffle::Relation* relation = program->getRelation(relationName);
+        return relation == nullptr ? 0 : relation->getArity();
+    }
+
+    /**
+     * Inserts tuples given row by row into a relation, see souffle::Relation::insertMany in
+     * SouffleInterface.h. Returns false if the relation does not exist, and throws std::invalid_argument
+     * if the rows do not consist of whole tuples.
+     */
+    bool insertMany(const std::string& relationName, const std::vector<souffle::RamDomain>& rows) {
+        souffle::Relation* relation = program->getRelation(relationName);
+        if (relation == nullptr) {
+            return false;
+        }
+        size_t arity = relation->getArity();
+        if (arity == 0 || rows.size() % arity != 0) {
+            throw std::invalid_argument("rows do not match the arity of relation " + relationName);
+        }
+        relation->insertMany(rows.data(), rows.size() / arity);
+        return true;
+    }
+
+    /**
+     * Returns the columns of a relation, see souffle::Relation::exportColumns in SouffleInterface.h.
+     * The result is empty if the relation does not exist.
+     */
+    std::vector<std::vector<souffle::RamDomain>> exportColumns(const std::string& relationName) {
+        souffle::Relation* relation = program->getRelation(relationName);
+        if (relation == nullptr) {
+            return {};
+        }
+        std::vector<std::vector<souffle::RamDomain>> columns(
+                relation->getArity(), std::vector<souffle::RamDomain>(relation->size()));
+        std::vector<souffle::RamDomain*> buffers;
+        for (auto& column : columns) {
+            buffers.push_back(column.data());
+        }
+        relation->exportColumns(buffers.data());
+        return columns;
+    }
+
+    /**
+     * Returns the indices of the symbols, inserting the new ones into the symbol table
+     */
+    std::vector<souffle::RamDomain> lookupSymbols(const std::vector<std::string>& symbols) {
+        std::vector<souffle::RamDomain> indices(symbols.size());
+        program->getSymbolTable().lookup(symbols.data(), symbols.size(), indices.data());
+        return indices;
+    }
+
+    /**
+     * Returns the symbols of the indices
+     */
+    std::vector<std::string> resolveSymbols(const std::vector<souffle::RamDomain>& indices) {
+        std::vector<const std::string*> symbols(indices.size());
+        program->getSymbolTable().resolve(indices.data(), indices.size(), symbols.data());
+        std::vector<std::string> res;
+        res.reserve(symbols.size());
+        for (const std::string* symbol : symbols) {
+            res.push_back(*symbol);
+        }
+        return res;
+    }
 };
 
 /**
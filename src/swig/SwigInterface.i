@@ -19,8 +19,19 @@
 %include "std_string.i" 
 %include "std_map.i" 
 %include<std_vector.i>
+%include<stdint.i>
+namespace souffle {
+#if RAM_DOMAIN_SIZE == 64
+    typedef int64_t RamDomain;
+#else
+    typedef int32_t RamDomain;
+#endif
+}
 namespace std {
     %template(map_string_string) map<string, string>;
+    %template(vector_string) vector<string>;
+    %template(vector_ram_domain) vector<souffle::RamDomain>;
+    %template(vector_vector_ram_domain) vector< vector<souffle::RamDomain> >;
 }
 
 %{
@@ -35,6 +46,15 @@ souffle::Relation* rel;
 souffle::Relation* rel_out;
 %}
 
+%include "exception.i"
+%exception {
+    try {
+        $action
+    } catch (const std::invalid_argument& e) {
+        SWIG_exception(SWIG_ValueError, e.what());
+    }
+}
+
 %include "SwigInterface.h" 
 %newobject newInstance;
 SWIGSouffleProgram* newInstance(const std::string& name);
@@ -0,0 +1,168 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file bloom_filter_test.cpp
+ *
+ * Tests the filters guarding existence checks.
+ *
+ ***********************************************************************/
+
+#include "BloomFilter.h"
+#include "ParallelUtils.h"
+#include "test.h"
+#include <atomic>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+TEST(BloomFilter, NoFalseNegatives) {
+    const int N = 10000;
+
+    BloomFilter filter(2, N);
+    PARALLEL_START
+        ;
+        pfor(int i = 0; i < N; i++) {
+            RamDomain tuple[2] = {i, 2 * i};
+            filter.insert(tuple);
+        }
+    PARALLEL_END;
+
+    int falsePositives = 0;
+    for (int i = 0; i < N; i++) {
+        RamDomain present[2] = {i, 2 * i};
+        EXPECT_TRUE(filter.mayContain(present));
+        RamDomain absent[2] = {i, 2 * i + 1};
+        if (filter.mayContain(absent)) {
+            falsePositives++;
+        }
+    }
+    // the expected rate at full capacity is below one percent
+    EXPECT_LT(falsePositives, N / 20);
+}
+
+TEST(TupleFilter, EnableForMisses) {
+    const int N = 2 * TupleFilter::MIN_SIZE;
+    std::vector<std::vector<RamDomain>> tuples;
+    for (int i = 0; i < N; i++) {
+        tuples.push_back({i, i});
+    }
+    auto scan = [&](const auto& add) {
+        for (const auto& tuple : tuples) {
+            add(tuple.data());
+        }
+    };
+    auto lookup = [&](const RamDomain* tuple) { return tuple[0] == tuple[1] && tuple[0] < N; };
+
+    // small relations are not filtered
+    TupleFilter filter(2);
+    filter.update(TupleFilter::MIN_SIZE - 1, scan);
+    EXPECT_FALSE(filter.isActive());
+
+    filter.update(N, scan);
+    EXPECT_TRUE(filter.isActive());
+
+    int lookups = 0;
+    for (int i = 0; i < N; i++) {
+        RamDomain present[2] = {i, i};
+        EXPECT_TRUE(filter.contains(present, [&]() {
+            lookups++;
+            return lookup(present);
+        }));
+        RamDomain absent[2] = {i, i + 1};
+        EXPECT_FALSE(filter.contains(absent, [&]() {
+            lookups++;
+            return lookup(absent);
+        }));
+    }
+    // most absent tuples are ruled out without a lookup
+    EXPECT_LT(lookups, N + N / 10);
+    EXPECT_EQ(2 * N, lookups + filter.getSaved());
+
+    // half of the probes missed, so the filter stays
+    filter.update(N, scan);
+    EXPECT_TRUE(filter.isActive());
+
+    filter.clear();
+    EXPECT_FALSE(filter.isActive());
+}
+
+TEST(TupleFilter, DisableForHits) {
+    const int N = 2 * TupleFilter::MIN_SIZE;
+    std::vector<std::vector<RamDomain>> tuples;
+    for (int i = 0; i < N; i++) {
+        tuples.push_back({i});
+    }
+    auto scan = [&](const auto& add) {
+        for (const auto& tuple : tuples) {
+            add(tuple.data());
+        }
+    };
+
+    TupleFilter filter(1);
+    filter.update(N, scan);
+    EXPECT_TRUE(filter.isActive());
+
+    // the filter is dropped if the probes find their tuples
+    for (int i = 0; i < N; i++) {
+        RamDomain tuple[1] = {i};
+        EXPECT_TRUE(filter.contains(tuple, []() { return true; }));
+    }
+    filter.update(N, scan);
+    EXPECT_FALSE(filter.isActive());
+    EXPECT_EQ(0, filter.getSaved());
+
+    // and only enabled again once enough probes missed
+    filter.update(2 * N, scan);
+    EXPECT_FALSE(filter.isActive());
+    for (int i = 0; i < N; i++) {
+        RamDomain tuple[1] = {N + i};
+        EXPECT_FALSE(filter.contains(tuple, []() { return false; }));
+    }
+    filter.update(2 * N, scan);
+    EXPECT_TRUE(filter.isActive());
+}
+
+TEST(TupleFilter, ParallelChecks) {
+    const int N = 2 * TupleFilter::MIN_SIZE;
+    std::vector<std::vector<RamDomain>> tuples;
+    for (int i = 0; i < N; i++) {
+        tuples.push_back({i});
+    }
+    auto scan = [&](const auto& add) {
+        for (const auto& tuple : tuples) {
+            add(tuple.data());
+        }
+    };
+
+    TupleFilter filter(1);
+    filter.update(N, scan);
+    EXPECT_TRUE(filter.isActive());
+
+    // the counts of all threads are summed when the filter is reconsidered
+    std::atomic<int> lookups(0);
+    PARALLEL_START
+        ;
+        pfor(int i = 0; i < N; i++) {
+            RamDomain tuple[1] = {N + i};
+            filter.contains(tuple, [&]() {
+                lookups++;
+                return false;
+            });
+        }
+    PARALLEL_END;
+    EXPECT_EQ(static_cast<size_t>(N), lookups + filter.getSaved());
+    filter.update(N, scan);
+    EXPECT_TRUE(filter.isActive());
+}
+
+}  // end namespace test
+}  // end namespace souffle
@@ -1181,6 +1181,103 @@ TEST(Trie, Merge_Bug) {
     EXPECT_EQ(5, count);
 }
 
+TEST(Trie, Merge_Large) {
+    using entry_t = typename Trie<2>::entry_type;
+
+    // enough top-level sub-tries and leaves to split the merge among threads
+    const int N = 100000;
+
+    std::set<entry_t> ref;
+    Trie<2> a;
+    Trie<2> b;
+    for (int i = 0; i < N; i++) {
+        RamDomain x = rand() % 5000;
+        RamDomain y = rand() % 100000;
+        if (i % 2 == 0) {
+            a.insert(x, y);
+        } else {
+            b.insert(x, y);
+        }
+        ref.insert(entry_t({{x, y}}));
+    }
+
+    a.insertAll(b);
+
+    std::set<entry_t> is(a.begin(), a.end());
+    EXPECT_EQ(ref, is);
+    EXPECT_EQ(ref.size(), a.size());
+
+    // dense bit-maps
+    Trie<1> c;
+    Trie<1> d;
+    for (int i = 0; i < N; i++) {
+        (i % 3 == 0 ? c : d).insert(i);
+    }
+    c.insertAll(d);
+    EXPECT_EQ(N, c.size());
+
+    // few top-level values, such that the root is a leaf of nested tries
+    std::set<entry_t> refSmall;
+    Trie<2> e;
+    Trie<2> f;
+    for (int i = 0; i < N; i++) {
+        RamDomain x = rand() % 50;
+        RamDomain y = rand() % 100000;
+        (i % 2 == 0 ? e : f).insert(x, y);
+        refSmall.insert(entry_t({{x, y}}));
+    }
+    f.insert(63, 1);
+    refSmall.insert(entry_t({{63, 1}}));
+
+    e.insertAll(f);
+
+    std::set<entry_t> isSmall(e.begin(), e.end());
+    EXPECT_EQ(refSmall, isSmall);
+    EXPECT_EQ(refSmall.size(), e.size());
+}
+
+TEST(Trie, ContainsAll) {
+    Trie<2> a;
+    Trie<2> b;
+    Trie<2> e;
+
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < 100; j++) {
+            a.insert(i, j * 37);
+            if (i % 3 == 0 && j % 2 == 0) {
+                b.insert(i, j * 37);
+            }
+        }
+    }
+
+    EXPECT_TRUE(a.containsAll(a));
+    EXPECT_TRUE(a.containsAll(b));
+    EXPECT_TRUE(a.containsAll(e));
+    EXPECT_TRUE(e.containsAll(e));
+    EXPECT_FALSE(b.containsAll(a));
+    EXPECT_FALSE(e.containsAll(b));
+
+    // a missing element in an existing leaf, and in a missing leaf
+    b.insert(3, 1);
+    EXPECT_FALSE(a.containsAll(b));
+
+    Trie<1> c;
+    Trie<1> d;
+    c.insert(5);
+    c.insert(1000000);
+    d.insert(5);
+    EXPECT_TRUE(c.containsAll(d));
+    d.insert(2000000);
+    EXPECT_FALSE(c.containsAll(d));
+
+    Trie<0> f;
+    Trie<0> g;
+    EXPECT_TRUE(f.containsAll(g));
+    g.insert();
+    EXPECT_FALSE(f.containsAll(g));
+    EXPECT_TRUE(g.containsAll(f));
+}
+
 TEST(Trie, Size) {
     Trie<2> t;
 
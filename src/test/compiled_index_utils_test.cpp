@@ -99,5 +99,44 @@ TEST(IndicesTools, FullIndex) {
     EXPECT_EQ(typeid(index<0, 1, 2, 3>), typeid(index_utils::get_full_index<4>::type));
 }
 
+TEST(IndicesTools, KeyedIndex) {
+    using t_tuple = Tuple<RamDomain, 3>;
+    using t_ref = index_utils::keyed_ref<t_tuple, 2, 0>;
+    using t_comp = index_utils::keyed_compare<index_utils::comparator<0, 1>, index_utils::comparator<1>>;
+
+    // all tuples over {0,1,2}, stored once and indexed by the order 2,0,1
+    std::vector<t_tuple> tuples;
+    for (RamDomain i = 0; i < 27; i++) {
+        tuples.push_back(t_tuple{{i % 3, (i / 3) % 3, i / 9}});
+    }
+    btree_set<t_ref, t_comp> index;
+    for (int i = 26; i >= 0; i--) {
+        index.insert(&tuples[i]);
+    }
+    EXPECT_EQ(27, index.size());
+    EXPECT_FALSE(index.insert(&tuples[5]));
+
+    // the keyed index enumerates the tuples in the order 2,0,1
+    index_utils::comparator<2, 0, 1> order;
+    const t_tuple* last = nullptr;
+    for (const auto& cur : index) {
+        EXPECT_EQ((*cur)[2], cur.key[0]);
+        EXPECT_EQ((*cur)[0], cur.key[1]);
+        if (last != nullptr) {
+            EXPECT_TRUE(order.less(*last, *cur));
+        }
+        last = &*cur;
+    }
+
+    // lookups compare the keys of temporary tuples
+    t_tuple low{{1, 0, 2}};
+    auto pos = index.lower_bound(&low);
+    EXPECT_TRUE(pos != index.end());
+    EXPECT_EQ(low, **pos);
+    EXPECT_TRUE(index.contains(&low));
+    t_tuple absent{{1, 3, 2}};
+    EXPECT_FALSE(index.contains(&absent));
+}
+
 }  // namespace ram
 }  // end namespace souffle
@@ -0,0 +1,163 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file insert_buffer_test.cpp
+ *
+ * Tests the thread-local buffers of parallel insertions.
+ *
+ ***********************************************************************/
+
+#include "InsertBuffer.h"
+#include "test.h"
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+TEST(InsertBuffer, Merge) {
+    const int N = 10000;
+
+    InsertBuffer buffer(2);
+    PARALLEL_START
+        ;
+        pfor(int i = 0; i < N; i++) {
+            // every tuple is inserted twice
+            RamDomain tuple[2] = {i % 100, i / 100};
+            buffer.insert(tuple);
+            buffer.insert(tuple);
+        }
+    PARALLEL_END;
+
+    std::set<std::vector<RamDomain>> merged;
+    size_t calls = 0;
+    buffer.merge([&]() {
+        return [&](const RamDomain* tuple) {
+            merged.insert(std::vector<RamDomain>(tuple, tuple + 2));
+            calls++;
+        };
+    });
+    EXPECT_EQ(N, merged.size());
+    // duplicates within the buffer of a thread are removed before merging
+    EXPECT_LT(calls, 2 * N + 1);
+    EXPECT_LT(N - 1, calls);
+
+    // merging empties the buffers
+    calls = 0;
+    buffer.merge([&]() { return [&](const RamDomain*) { calls++; }; });
+    EXPECT_EQ(0, calls);
+}
+
+TEST(InsertBuffer, Sequential) {
+    InsertBuffer buffer(3);
+    RamDomain a[3] = {3, 2, 1};
+    RamDomain b[3] = {1, 2, 3};
+    buffer.insert(a);
+    buffer.insert(b);
+    buffer.insert(a);
+
+    std::vector<std::vector<RamDomain>> merged;
+    buffer.merge([&]() {
+        return [&](const RamDomain* tuple) { merged.push_back(std::vector<RamDomain>(tuple, tuple + 3)); };
+    });
+    // a single buffer is merged in order and without duplicates
+    EXPECT_EQ(2, merged.size());
+    EXPECT_EQ(std::vector<RamDomain>({1, 2, 3}), merged[0]);
+    EXPECT_EQ(std::vector<RamDomain>({3, 2, 1}), merged[1]);
+}
+
+TEST(InsertBuffer, Flush) {
+    const int N = 3 * InsertBuffer::MAX_LOCAL_SIZE;
+
+    InsertBuffer buffer(2);
+    std::set<std::vector<RamDomain>> merged;
+    std::mutex lock;
+    size_t flushed = 0;
+    auto flush = [&](const RamDomain* tuple) {
+        std::lock_guard<std::mutex> guard(lock);
+        merged.insert(std::vector<RamDomain>(tuple, tuple + 2));
+        flushed++;
+    };
+    PARALLEL_START
+        ;
+        pfor(int i = 0; i < N; i++) {
+            RamDomain tuple[2] = {i % 1000, i};
+            buffer.insert(tuple, flush);
+        }
+    PARALLEL_END;
+
+    // the buffers of the threads are bounded, full buffers are flushed by their threads
+    EXPECT_LT(size_t(N), flushed + MAX_THREADS * InsertBuffer::MAX_LOCAL_SIZE);
+    buffer.merge([&]() { return flush; });
+    EXPECT_EQ(N, merged.size());
+    EXPECT_EQ(N, flushed);
+}
+
+TEST(InsertBuffer, Partitioned) {
+    const int N = 100000;
+
+    InsertBuffer buffer(2);
+    PARALLEL_START
+        ;
+        pfor(int i = 0; i < N; i++) {
+            // every tuple is inserted by two iterations, likely of different threads
+            RamDomain tuple[2] = {(i * 7919) % 1000, (i % (N / 2)) / 1000};
+            buffer.insert(tuple);
+        }
+    PARALLEL_END;
+
+    // each task inserts an ordered range of tuples, and the ranges are disjoint
+    std::list<std::vector<std::vector<RamDomain>>> tasks;
+    std::mutex lock;
+    buffer.merge([&]() {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.emplace_back();
+        auto* task = &tasks.back();
+        return [task](const RamDomain* tuple) { task->push_back(std::vector<RamDomain>(tuple, tuple + 2)); };
+    });
+    EXPECT_LT(1, tasks.size());
+
+    std::set<std::vector<RamDomain>> merged;
+    size_t calls = 0;
+    for (const auto& task : tasks) {
+        EXPECT_TRUE(std::is_sorted(task.begin(), task.end()));
+        EXPECT_TRUE(std::adjacent_find(task.begin(), task.end()) == task.end());
+        merged.insert(task.begin(), task.end());
+        calls += task.size();
+    }
+    EXPECT_EQ(N / 2, merged.size());
+    EXPECT_EQ(N / 2, calls);
+
+    // a sequential merge uses a single task
+    PARALLEL_START
+        ;
+        pfor(int i = 0; i < N; i++) {
+            RamDomain tuple[2] = {i, i};
+            buffer.insert(tuple);
+        }
+    PARALLEL_END;
+    size_t numTasks = 0;
+    calls = 0;
+    buffer.merge(
+            [&]() {
+                numTasks++;
+                return [&](const RamDomain*) { calls++; };
+            },
+            false);
+    EXPECT_EQ(1, numTasks);
+    EXPECT_EQ(N, calls);
+}
+
+}  // end namespace test
+}  // end namespace souffle
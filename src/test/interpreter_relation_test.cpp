@@ -18,6 +18,8 @@
 #include "InterpreterRelation.h"
 #include "SouffleInterface.h"
 #include "test.h"
+#include <string>
+#include <vector>
 
 using namespace souffle;
 
@@ -161,4 +163,127 @@ TEST(IndependentCopying, Iteration) {
     EXPECT_EQ(1, (*it)[0]);
 }
 
+TEST(Basic, EqualRange) {
+    // create a relation with an index on the first column only
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "path", {"i", "i"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "path", {"i", "i"}, {"x", "y"}, 0);
+
+    // the transitive closure of a chain of 100 edges
+    for (RamDomain i = 0; i <= 100; i++) {
+        for (RamDomain j = i + 1; j <= 100; j++) {
+            relInt.insert(tuple(&relInt, {i, j}));
+        }
+    }
+
+    // count the tuples of a range, checking that they match the pattern
+    auto count = [&](const std::pair<Relation::iterator, Relation::iterator>& range, const tuple& pattern,
+                         SearchSignature mask) {
+        size_t res = 0;
+        for (auto it = range.first; it != range.second; ++it) {
+            for (size_t i = 0; i < 2; i++) {
+                if (((mask >> i) & 1) != 0) {
+                    EXPECT_EQ(pattern[i], (*it)[i]);
+                }
+            }
+            res++;
+        }
+        return res;
+    };
+
+    for (RamDomain node : {0, 25, 50, 99, 100, 101}) {
+        tuple pattern(&relInt, {node, node + 1});
+
+        // successors and exact matches use the index, predecessors scan the relation
+        size_t successors = count(relInt.equalRange(pattern, 1), pattern, 1);
+        size_t predecessors = count(relInt.equalRange(pattern, 2), pattern, 2);
+        size_t matches = count(relInt.equalRange(pattern, 3), pattern, 3);
+        EXPECT_EQ(successors, count(relInt.Relation::equalRange(pattern, 1), pattern, 1));
+        EXPECT_EQ(predecessors, count(relInt.Relation::equalRange(pattern, 2), pattern, 2));
+        EXPECT_EQ(matches, count(relInt.Relation::equalRange(pattern, 3), pattern, 3));
+
+        EXPECT_EQ(size_t(node <= 100 ? 100 - node : 0), successors);
+        EXPECT_EQ(size_t(node < 100 ? node + 1 : 0), predecessors);
+        EXPECT_EQ(size_t(node < 100 ? 1 : 0), matches);
+    }
+}
+
+TEST(Bulk, Transfer) {
+    // create a relation of symbols
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "edge", {"s", "s"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "edge", {"s", "s"}, {"x", "y"}, 0);
+
+    // look up the nodes of a chain with a single call
+    std::vector<std::string> names = {"A", "B", "C", "D", "E"};
+    std::vector<RamDomain> nodes(names.size());
+    symbolTable.lookup(names.data(), names.size(), nodes.data());
+    for (size_t i = 0; i < names.size(); i++) {
+        EXPECT_EQ(symbolTable.lookup(names[i]), nodes[i]);
+    }
+    EXPECT_EQ(names.size(), symbolTable.size());
+
+    // insert the edges of the chain row by row, twice to check for duplicates
+    std::vector<RamDomain> rows;
+    for (size_t i = 0; i + 1 < nodes.size(); i++) {
+        rows.push_back(nodes[i]);
+        rows.push_back(nodes[i + 1]);
+    }
+    relInt.insertMany(rows.data(), rows.size() / 2);
+    relInt.insertMany(rows.data(), rows.size() / 2);
+    EXPECT_EQ(4, relInt.size());
+    for (size_t i = 0; i + 1 < nodes.size(); i++) {
+        EXPECT_TRUE(relInt.contains(tuple(&relInt, {nodes[i], nodes[i + 1]})));
+    }
+
+    // export the edges column by column, in the order of the tuples
+    std::vector<RamDomain> sources(relInt.size());
+    std::vector<RamDomain> targets(relInt.size());
+    RamDomain* columns[] = {sources.data(), targets.data()};
+    relInt.exportColumns(columns);
+    size_t row = 0;
+    for (auto& t : relInt) {
+        EXPECT_EQ(t[0], sources[row]);
+        EXPECT_EQ(t[1], targets[row]);
+        row++;
+    }
+
+    // resolve the symbols of a column with a single call
+    std::vector<const std::string*> symbols(sources.size());
+    symbolTable.resolve(sources.data(), sources.size(), symbols.data());
+    for (size_t i = 0; i < sources.size(); i++) {
+        EXPECT_EQ(symbolTable.resolve(sources[i]), *symbols[i]);
+    }
+}
+
+TEST(Lattice, ConcurrentInsert) {
+    // a min lattice keeping the least distance of each node
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterLatticeRelation rel(2, 0, "dist", {"i", "i"}, order, false);
+
+    // concurrent writers, as the rules of a parallel statement, offer decreasing distances
+    const RamDomain nodes = 100;
+#pragma omp parallel for
+    for (RamDomain d = 1000; d > 0; d--) {
+        for (RamDomain node = 0; node < nodes; node++) {
+            RamDomain t[] = {node, node + d};
+            rel.insert(t);
+        }
+    }
+
+    // the least distance of each node is stored, and larger ones are dominated
+    for (RamDomain node = 0; node < nodes; node++) {
+        RamDomain best[] = {node, node + 1};
+        RamDomain better[] = {node, node};
+        EXPECT_TRUE(rel.contains(TupleRef(best, 2)));
+        EXPECT_TRUE(rel.dominated(TupleRef(best, 2)));
+        EXPECT_FALSE(rel.dominated(TupleRef(better, 2)));
+    }
+}
+
 }  // end namespace test
@@ -0,0 +1,212 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file io_pool_test.cpp
+ *
+ * Tests the pool performing loads and stores in the background.
+ *
+ ***********************************************************************/
+
+#include "IOPool.h"
+#include "ReadStreamCSV.h"
+#include "test.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace souffle {
+
+namespace test {
+
+TEST(IOPool, Synchronous) {
+    IOPool pool(0);
+    int a = 0;
+    int b = 0;
+    pool.submit(&a, [&]() { a++; });
+    // without workers, tasks are executed immediately
+    EXPECT_EQ(1, a);
+    pool.submit(&b, [&]() { b++; });
+    EXPECT_EQ(1, b);
+    pool.join();
+}
+
+TEST(IOPool, Wait) {
+    const int N = 1000;
+
+    IOPool pool(4);
+    std::atomic<int> a(0);
+    std::atomic<int> b(0);
+    for (int i = 0; i < N; i++) {
+        pool.submit(&a, [&]() { a++; });
+        pool.submit(&b, [&]() { b++; });
+    }
+    pool.wait(&a);
+    EXPECT_EQ(N, a);
+    pool.join();
+    EXPECT_EQ(N, b);
+}
+
+TEST(IOPool, Destructor) {
+    const int N = 100;
+
+    std::atomic<int> a(0);
+    {
+        IOPool pool(2);
+        for (int i = 0; i < N; i++) {
+            pool.submit(&a, [&]() { a++; });
+        }
+    }
+    // pending tasks are completed when the pool is destroyed
+    EXPECT_EQ(N, a);
+}
+
+TEST(IOPool, Errors) {
+    IOPool pool(2);
+    std::atomic<int> a(0);
+    pool.submit(&a, [&]() { throw std::runtime_error("cannot write"); });
+    pool.submit(&a, [&]() { a++; });
+
+    // the error of a task is raised on the waiting thread, once
+    bool raised = false;
+    try {
+        pool.wait(&a);
+    } catch (const std::runtime_error& e) {
+        raised = std::string(e.what()) == "cannot write";
+    }
+    EXPECT_TRUE(raised);
+    EXPECT_EQ(1, a);
+    pool.join();
+}
+
+TEST(IOPool, Ordered) {
+    const int N = 100;
+
+    std::mutex mutex;
+    std::vector<int> order;
+    {
+        IOPool pool(8);
+        for (int i = 0; i < N; i++) {
+            // later tasks reach their ordered step first, some tasks have none
+            pool.submit(&order, [&, i]() {
+                std::this_thread::sleep_for(std::chrono::microseconds((N - i) * 10));
+                if (i % 3 != 0) {
+                    IOPool::ordered([&]() {
+                        std::lock_guard<std::mutex> guard(mutex);
+                        order.push_back(i);
+                    });
+                }
+            });
+        }
+    }
+    ASSERT_TRUE(order.size() == size_t(N - (N + 2) / 3));
+    for (size_t i = 1; i < order.size(); i++) {
+        EXPECT_LT(order[i - 1], order[i]);
+    }
+
+    // outside of a pool, the step is executed immediately
+    bool executed = false;
+    IOPool::ordered([&]() { executed = true; });
+    EXPECT_TRUE(executed);
+}
+
+#ifdef _OPENMP
+TEST(IOPool, SingleThreadedTasks) {
+    std::atomic<int> threads(0);
+    IOPool pool(2);
+    pool.submit(&threads, [&]() { threads = omp_get_max_threads(); });
+    pool.join();
+    EXPECT_EQ(1, threads);
+}
+#endif
+
+/** Collects the tuples read by a stream */
+struct Tuples {
+    void insert(const RamDomain* tuple) {
+        tuples.push_back({tuple[0], tuple[1]});
+    }
+    std::vector<std::vector<RamDomain>> tuples;
+};
+
+TEST(IOPool, DeterministicSymbols) {
+    const int N = 10000;
+
+    // the first relation takes longer to read, yet its symbols come first
+    std::stringstream large;
+    for (int i = 0; i < N; i++) {
+        large << "a" << i << "\t" << i << "\n";
+    }
+    std::stringstream small("b\t1\na0\t2\n");
+
+    std::vector<RamTypeAttribute> symbolMask = {RamTypeAttribute::Symbol, RamTypeAttribute::Signed};
+    IODirectives directives;
+    SymbolTable symbolTable;
+    Tuples first;
+    Tuples second;
+    {
+        IOPool pool(2);
+        pool.submit(&first,
+                [&]() { ReadStreamCSV(large, symbolMask, symbolTable, directives).readAll(first); });
+        pool.submit(&second,
+                [&]() { ReadStreamCSV(small, symbolMask, symbolTable, directives).readAll(second); });
+    }
+    ASSERT_TRUE(first.tuples.size() == size_t(N));
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(i, first.tuples[i][0]);
+        EXPECT_EQ(i, first.tuples[i][1]);
+    }
+    ASSERT_TRUE(second.tuples.size() == 2);
+    EXPECT_EQ(N, second.tuples[0][0]);
+    EXPECT_EQ("b", symbolTable.resolve(N));
+    EXPECT_EQ(0, second.tuples[1][0]);
+}
+
+TEST(IOPool, ChunkedSymbols) {
+    const int N = 200000;
+
+    // the first relation spans several chunks, the symbols of all of them precede the second relation's
+    std::stringstream large;
+    for (int i = 0; i < N; i++) {
+        large << "a" << i << "\t" << i << "\n";
+    }
+    std::stringstream small("b\t1\na0\t2\na199999\t3\n");
+
+    std::vector<RamTypeAttribute> symbolMask = {RamTypeAttribute::Symbol, RamTypeAttribute::Signed};
+    IODirectives directives;
+    SymbolTable symbolTable;
+    Tuples first;
+    Tuples second;
+    {
+        IOPool pool(2);
+        pool.submit(&first,
+                [&]() { ReadStreamCSV(large, symbolMask, symbolTable, directives).readAll(first); });
+        pool.submit(&second,
+                [&]() { ReadStreamCSV(small, symbolMask, symbolTable, directives).readAll(second); });
+    }
+    ASSERT_TRUE(first.tuples.size() == size_t(N));
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(i, first.tuples[i][0]);
+    }
+    ASSERT_TRUE(second.tuples.size() == 3);
+    EXPECT_EQ(N, second.tuples[0][0]);
+    EXPECT_EQ(0, second.tuples[1][0]);
+    EXPECT_EQ(N - 1, second.tuples[2][0]);
+}
+
+}  // end namespace test
+}  // end namespace souffle
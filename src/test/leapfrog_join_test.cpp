@@ -0,0 +1,101 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file leapfrog_join_test.cpp
+ *
+ * Tests the intersection kernel of leapfrog joins and the partitions of
+ * parallel leapfrog joins.
+ *
+ ***********************************************************************/
+
+#include "LeapfrogJoin.h"
+#include "test.h"
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+/** Enumerates the intersection of the given sets in [low, high] */
+std::vector<RamDomain> intersect(
+        const std::vector<std::set<RamDomain>>& sets, RamDomain low, RamDomain high) {
+    auto seek = [&](std::size_t i, RamDomain value, RamDomain& res) {
+        auto pos = sets[i].lower_bound(value);
+        if (pos == sets[i].end()) {
+            return false;
+        }
+        res = *pos;
+        return true;
+    };
+    LeapfrogIntersection<decltype(seek)> intersection(sets.size(), seek, low, high);
+    std::vector<RamDomain> res;
+    for (RamDomain value; intersection.next(value);) {
+        res.push_back(value);
+    }
+    return res;
+}
+
+TEST(Intersection, Range) {
+    std::vector<std::set<RamDomain>> sets(3);
+    for (RamDomain i = -100; i <= 100; i++) {
+        sets[0].insert(2 * i);
+        sets[1].insert(3 * i);
+        sets[2].insert(i);
+    }
+    sets[2].insert(MAX_RAM_DOMAIN);
+    sets[1].insert(MAX_RAM_DOMAIN);
+    sets[0].insert(MAX_RAM_DOMAIN);
+
+    // the multiples of 6 in [-100, 100], and the largest value
+    auto all = intersect(sets, MIN_RAM_DOMAIN, MAX_RAM_DOMAIN);
+    EXPECT_EQ(size_t(34), all.size());
+    EXPECT_EQ(-96, all.front());
+    EXPECT_EQ(MAX_RAM_DOMAIN, all.back());
+
+    // ranges are inclusive
+    std::vector<RamDomain> part = {-6, 0, 6};
+    EXPECT_TRUE(part == intersect(sets, -6, 6));
+    EXPECT_TRUE(intersect(sets, 1, 5).empty());
+}
+
+TEST(Intersection, Partitions) {
+    std::vector<std::set<RamDomain>> sets(2);
+    for (RamDomain i = 0; i < 1000; i++) {
+        sets[0].insert(i * 7 % 1000);
+        sets[1].insert(i * 3);
+    }
+    auto all = intersect(sets, MIN_RAM_DOMAIN, MAX_RAM_DOMAIN);
+
+    // split points in any order, with duplicates and the least value
+    std::vector<RamDomain> points = {500, 100, MIN_RAM_DOMAIN, 500, 999, 0};
+    auto partitions = splitLeapfrogRange(points);
+    EXPECT_EQ(size_t(5), partitions.size());
+    EXPECT_EQ(MIN_RAM_DOMAIN, partitions.front().first);
+    EXPECT_EQ(MAX_RAM_DOMAIN, partitions.back().second);
+
+    // the partitions enumerate all values of the join exactly once
+    std::vector<RamDomain> joined;
+    for (size_t i = 0; i < partitions.size(); i++) {
+        if (i > 0) {
+            EXPECT_EQ(partitions[i - 1].second + 1, partitions[i].first);
+        }
+        auto values = intersect(sets, partitions[i].first, partitions[i].second);
+        joined.insert(joined.end(), values.begin(), values.end());
+    }
+    EXPECT_TRUE(all == joined);
+
+    // without split points, a single partition covers all values
+    EXPECT_EQ(size_t(1), splitLeapfrogRange({}).size());
+}
+
+}  // namespace test
+}  // end namespace souffle
@@ -0,0 +1,111 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file lsm_set_test.cpp
+ *
+ * Tests the disk-backed sets of tuples.
+ *
+ ***********************************************************************/
+
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "LsmSet.h"
+#include "ParallelUtils.h"
+#include "test.h"
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+using Tuple = ram::Tuple<RamDomain, 2>;
+using Set = LsmSet<Tuple, typename ram::index_utils::get_full_index<2>::type::comparator>;
+
+TEST(LsmSet, Basic) {
+    LsmConfig::bufferSize() = 100;
+
+    Set set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.insert(Tuple{{1, 2}}));
+    EXPECT_FALSE(set.insert(Tuple{{1, 2}}));
+    EXPECT_TRUE(set.contains(Tuple{{1, 2}}));
+    EXPECT_FALSE(set.contains(Tuple{{2, 1}}));
+    EXPECT_EQ(1, set.size());
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(LsmSet, Spill) {
+    const int N = 10000;
+    LsmConfig::bufferSize() = 100;
+
+    // insert in a scrambled order, each tuple twice
+    Set set;
+    std::set<Tuple> reference;
+    for (int i = 0; i < 2 * N; i++) {
+        int j = (i * 7919) % N;
+        Tuple t{{j % 100, j / 100}};
+        EXPECT_EQ(reference.insert(t).second, set.insert(t));
+    }
+    EXPECT_EQ(N, set.size());
+    // runs are merged to a logarithmic number
+    EXPECT_LT(0, set.getNumRuns());
+    EXPECT_LT(set.getNumRuns(), 10);
+
+    // the enumeration is ordered and complete
+    std::vector<Tuple> all(set.begin(), set.end());
+    EXPECT_EQ(std::vector<Tuple>(reference.begin(), reference.end()), all);
+
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(set.contains(Tuple{{i, i}}));
+        EXPECT_FALSE(set.contains(Tuple{{i, 100 + i}}));
+    }
+
+    // ranges are served from all runs
+    auto from = set.lower_bound(Tuple{{50, 0}});
+    auto to = set.lower_bound(Tuple{{51, 0}});
+    int count = 0;
+    for (auto it = from; it != to; ++it) {
+        EXPECT_EQ(50, (*it)[0]);
+        count++;
+    }
+    EXPECT_EQ(100, count);
+
+    // partitions cover the set
+    size_t covered = 0;
+    for (auto& chunk : set.partition(7)) {
+        for (auto it = chunk.begin(); it != chunk.end(); ++it) {
+            covered++;
+        }
+    }
+    EXPECT_EQ(N, covered);
+}
+
+TEST(LsmSet, ParallelInsert) {
+    const int N = 10000;
+    LsmConfig::bufferSize() = 1000;
+
+    Set set;
+    PARALLEL_START
+        ;
+        pfor(int i = 0; i < 2 * N; i++) {
+            set.insert(Tuple{{i % N, 0}});
+        }
+    PARALLEL_END;
+    EXPECT_EQ(N, set.size());
+    std::vector<Tuple> all(set.begin(), set.end());
+    EXPECT_EQ(N, all.size());
+}
+
+}  // end namespace test
+}  // end namespace souffle
@@ -0,0 +1,62 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file perf_counters_test.cpp
+ *
+ * Tests the hardware performance counters, as far as they are available.
+ *
+ ***********************************************************************/
+
+#include "PerfCounters.h"
+#include "test.h"
+#include <cstdint>
+#include <thread>
+
+namespace souffle {
+
+namespace test {
+
+TEST(PerfCounters, Disabled) {
+    PerfCounters::Counts counts = PerfCounters::instance().read();
+    for (size_t event = 0; event < PerfCounters::NUM_EVENTS; event++) {
+        EXPECT_EQ(0, counts[event]);
+    }
+}
+
+TEST(PerfCounters, AllThreads) {
+    PerfCounters& counters = PerfCounters::instance();
+    counters.enable();
+    // without counters, e.g. in a virtual machine, the reads stay zero
+    PerfCounters::Counts start = counters.read();
+
+    auto work = []() {
+        volatile uint64_t sum = 0;
+        for (uint64_t i = 0; i < 1000000; i++) {
+            sum = sum + i;
+        }
+    };
+    std::thread worker([&]() {
+        // the counters of the thread are opened by the read while it is running
+        counters.read();
+        work();
+    });
+    work();
+    worker.join();
+
+    PerfCounters::Counts end = counters.read();
+    if (counters.isEnabled()) {
+        EXPECT_LT(start[1] + 1000000, end[1]);
+    } else {
+        EXPECT_EQ(0, end[1]);
+    }
+}
+
+}  // namespace test
+}  // namespace souffle
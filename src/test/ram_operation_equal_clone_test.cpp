@@ -141,6 +141,42 @@ TEST(RamParallelIndexScan, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamHashJoin, CloneAndEquals) {
+    RamRelation edge("edge", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    RamRelation path("path", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // FOR t1 IN edge ON HASH t1.x = t0.1
+    //  PROJECT (t0.0, t1.1) INTO path
+    std::vector<std::unique_ptr<RamExpression>> a_project_args;
+    a_project_args.emplace_back(new RamTupleElement(0, 0));
+    a_project_args.emplace_back(new RamTupleElement(1, 1));
+    auto a_project = std::make_unique<RamProject>(
+            std::make_unique<RamRelationReference>(&path), std::move(a_project_args));
+    std::vector<std::unique_ptr<RamExpression>> a_criteria;
+    a_criteria.emplace_back(new RamTupleElement(0, 1));
+    a_criteria.emplace_back(new RamUndefValue);
+    RamHashJoin a(std::make_unique<RamRelationReference>(&edge), 1, std::move(a_criteria),
+            std::move(a_project), "RamHashJoin test");
+
+    std::vector<std::unique_ptr<RamExpression>> b_project_args;
+    b_project_args.emplace_back(new RamTupleElement(0, 0));
+    b_project_args.emplace_back(new RamTupleElement(1, 1));
+    auto b_project = std::make_unique<RamProject>(
+            std::make_unique<RamRelationReference>(&path), std::move(b_project_args));
+    std::vector<std::unique_ptr<RamExpression>> b_criteria;
+    b_criteria.emplace_back(new RamTupleElement(0, 1));
+    b_criteria.emplace_back(new RamUndefValue);
+    RamHashJoin b(std::make_unique<RamRelationReference>(&edge), 1, std::move(b_criteria),
+            std::move(b_project), "RamHashJoin test");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+    EXPECT_EQ(a.getKeyColumns(), std::vector<size_t>({0}));
+
+    RamHashJoin* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(RamChoice, CloneAndEquals) {
     RamRelation edge("edge", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
     // choose an edge not adjcent to vertex 5
@@ -395,6 +431,88 @@ TEST(RamUnpackedRecord, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamLeapfrogJoin, CloneAndEquals) {
+    RamRelation edge("edge", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // bind z of the triangle edge(x,y), edge(y,z), edge(x,z)
+    // LEAPFROG t2 ON edge.y WHERE edge.x = t1.0 AND edge.y WHERE edge.x = t0.0
+    //  RETURN (t2.0)
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(2, 0));
+    auto a_return = std::make_unique<RamSubroutineReturnValue>(std::move(a_return_args));
+    std::vector<std::unique_ptr<RamRelationReference>> a_rels;
+    a_rels.emplace_back(new RamRelationReference(&edge));
+    a_rels.emplace_back(new RamRelationReference(&edge));
+    std::vector<std::vector<std::unique_ptr<RamExpression>>> a_patterns(2);
+    a_patterns[0].emplace_back(new RamTupleElement(1, 0));
+    a_patterns[0].emplace_back(new RamUndefValue);
+    a_patterns[1].emplace_back(new RamTupleElement(0, 0));
+    a_patterns[1].emplace_back(new RamUndefValue);
+    RamLeapfrogJoin a(std::move(a_rels), std::move(a_patterns), {1, 1}, 2, std::move(a_return),
+            "RamLeapfrogJoin test");
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(2, 0));
+    auto b_return = std::make_unique<RamSubroutineReturnValue>(std::move(b_return_args));
+    std::vector<std::unique_ptr<RamRelationReference>> b_rels;
+    b_rels.emplace_back(new RamRelationReference(&edge));
+    b_rels.emplace_back(new RamRelationReference(&edge));
+    std::vector<std::vector<std::unique_ptr<RamExpression>>> b_patterns(2);
+    b_patterns[0].emplace_back(new RamTupleElement(1, 0));
+    b_patterns[0].emplace_back(new RamUndefValue);
+    b_patterns[1].emplace_back(new RamTupleElement(0, 0));
+    b_patterns[1].emplace_back(new RamUndefValue);
+    RamLeapfrogJoin b(std::move(b_rels), std::move(b_patterns), {1, 1}, 2, std::move(b_return),
+            "RamLeapfrogJoin test");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamLeapfrogJoin* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(RamParallelLeapfrogJoin, CloneAndEquals) {
+    RamRelation edge("edge", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // bind x of the triangle edge(x,y), edge(y,z), edge(x,z)
+    // PARALLEL LEAPFROG t0 ON edge.x AND edge.x
+    //  RETURN (t0.0)
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto a_return = std::make_unique<RamSubroutineReturnValue>(std::move(a_return_args));
+    std::vector<std::unique_ptr<RamRelationReference>> a_rels;
+    a_rels.emplace_back(new RamRelationReference(&edge));
+    a_rels.emplace_back(new RamRelationReference(&edge));
+    std::vector<std::vector<std::unique_ptr<RamExpression>>> a_patterns(2);
+    a_patterns[0].emplace_back(new RamUndefValue);
+    a_patterns[0].emplace_back(new RamUndefValue);
+    a_patterns[1].emplace_back(new RamUndefValue);
+    a_patterns[1].emplace_back(new RamUndefValue);
+    RamParallelLeapfrogJoin a(std::move(a_rels), std::move(a_patterns), {0, 0}, 0, std::move(a_return),
+            "RamParallelLeapfrogJoin test");
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto b_return = std::make_unique<RamSubroutineReturnValue>(std::move(b_return_args));
+    std::vector<std::unique_ptr<RamRelationReference>> b_rels;
+    b_rels.emplace_back(new RamRelationReference(&edge));
+    b_rels.emplace_back(new RamRelationReference(&edge));
+    std::vector<std::vector<std::unique_ptr<RamExpression>>> b_patterns(2);
+    b_patterns[0].emplace_back(new RamUndefValue);
+    b_patterns[0].emplace_back(new RamUndefValue);
+    b_patterns[1].emplace_back(new RamUndefValue);
+    b_patterns[1].emplace_back(new RamUndefValue);
+    RamParallelLeapfrogJoin b(std::move(b_rels), std::move(b_patterns), {0, 0}, 0, std::move(b_return),
+            "RamParallelLeapfrogJoin test");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamParallelLeapfrogJoin* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(RamFilter, CloneAndEquals) {
     RamRelation A("A", 1, 1, {"a"}, {"i"}, RelationRepresentation::DEFAULT);
     // IF (NOT t0.1 in A)
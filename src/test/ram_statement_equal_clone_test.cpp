@@ -66,6 +66,24 @@ TEST(RamClear, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamPurge, CloneAndEquals) {
+    // PURGE A
+    RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    RamPurge a(std::make_unique<RamRelationReference>(&A));
+    RamPurge b(std::make_unique<RamRelationReference>(&A));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamPurge* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    // a purge is not a clear
+    RamClear d(std::make_unique<RamRelationReference>(&A));
+    EXPECT_NE(a, d);
+}
+
 TEST(RamExtend, CloneAndEquals) {
     // MERGE B WITH A
     RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
@@ -0,0 +1,81 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file sample_profiler_test.cpp
+ *
+ * Tests the attribution of samples to rules and relations.
+ *
+ ***********************************************************************/
+
+#include "SampleProfiler.h"
+#include "test.h"
+#include <chrono>
+#include <map>
+#include <string>
+
+namespace souffle {
+
+namespace test {
+
+TEST(SampleProfiler, RelationName) {
+    EXPECT_EQ("path", SampleProfiler::getRelationName("path(x,y) :- \n   edge(x,y).\nin file a.dl"));
+    EXPECT_EQ("A.edge", SampleProfiler::getRelationName("A.edge: 4 facts\nin file a.dl [1:1-1:10]"));
+    EXPECT_EQ("", SampleProfiler::getRelationName(""));
+}
+
+TEST(SampleProfiler, FoldedStacks) {
+    const char* path = "path(x,z) :- \n   path(x,y),\n   edge(y,z).\nin file a.dl [3:1-3:30]";
+    const char* edge = "edge(1,2).\nin file a.dl [1:1-1:10]";
+
+    SampleProfiler& profiler = SampleProfiler::instance();
+    for (int i = 0; i < 3; i++) {
+        profiler.record(path);
+    }
+    profiler.record(edge);
+    profiler.record(nullptr);
+
+    std::map<std::string, uint64_t> relationSamples = profiler.stop();
+    EXPECT_EQ(2, relationSamples.size());
+    EXPECT_EQ(3, relationSamples["path"]);
+    EXPECT_EQ(1, relationSamples["edge"]);
+
+    const auto& stacks = profiler.getStacks();
+    EXPECT_EQ(3, stacks.at("path;path(x,z) :- path(x,y), edge(y,z). in file a.dl [3:1-3:30]"));
+    EXPECT_EQ(1, stacks.at("edge;edge(1,2). in file a.dl [1:1-1:10]"));
+    EXPECT_EQ(1, stacks.at("souffle;no rule"));
+
+    // samples are accumulated in the stacks, but returned once per relation
+    profiler.record(edge);
+    relationSamples = profiler.stop();
+    EXPECT_EQ(1, relationSamples.size());
+    EXPECT_EQ(2, profiler.getStacks().at("edge;edge(1,2). in file a.dl [1:1-1:10]"));
+}
+
+TEST(SampleProfiler, Timer) {
+    SampleProfiler& profiler = SampleProfiler::instance();
+    profiler.setOutputFile("/dev/null");
+    const char* rule = "busy(x) :- \n   busy(x).\nin file a.dl [1:1-1:20]";
+    SignalHandler::instance()->setMsg(rule);
+    profiler.start();
+
+    // burn CPU time for a multiple of the sampling interval
+    auto start = std::chrono::steady_clock::now();
+    volatile uint64_t sum = 0;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100)) {
+        sum = sum + 1;
+    }
+
+    std::map<std::string, uint64_t> relationSamples = profiler.stop();
+    profiler.setOutputFile("");
+    EXPECT_LT(0, relationSamples["busy"]);
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,153 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file work_stealing_test.cpp
+ *
+ * Tests the work stealing over the chunks of parallel loops.
+ *
+ ***********************************************************************/
+
+#include "BTree.h"
+#include "Brie.h"
+#include "CompiledTuple.h"
+#include "WorkStealing.h"
+#include "test.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+namespace {
+
+/** enumerates a stealing partition in a parallel region, where the elements below skew are expensive */
+template <typename Range, typename Visit>
+void enumerate(StealingPartition<Range>& stealing, int skew, const Visit& visit) {
+    PARALLEL_START;
+    while (auto* batch = stealing.next()) {
+        for (const auto& cur : *batch) {
+            int value = visit(cur);
+            if (value < skew) {
+                volatile uint64_t sum = 0;
+                for (int i = 0; i < 100000; i++) {
+                    sum += i;
+                }
+            }
+        }
+    }
+    PARALLEL_END;
+}
+
+}  // namespace
+
+TEST(StealingPartition, Empty) {
+    btree_set<int> set;
+    auto part = set.partition(8);
+    auto stealing = makeStealingPartition(part);
+    EXPECT_TRUE(stealing.next() == nullptr);
+}
+
+TEST(StealingPartition, BTree) {
+    const int N = 10000;
+    btree_set<int> set;
+    for (int i = 0; i < N; i++) {
+        set.insert(i);
+    }
+
+    std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[N]);
+    for (int i = 0; i < N; i++) {
+        visits[i] = 0;
+    }
+
+    auto part = set.partition(16);
+    auto stealing = makeStealingPartition(part, true);
+    enumerate(stealing, 1000, [&](int value) {
+        visits[value]++;
+        return value;
+    });
+
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(1, visits[i]);
+    }
+
+    // all work was done by some thread and in some chunk
+    uint64_t threadTime = 0;
+    for (uint64_t time : stealing.getThreadTimes()) {
+        threadTime += time;
+    }
+    uint64_t chunkTime = 0;
+    for (uint64_t time : stealing.getChunkTimes()) {
+        chunkTime += time;
+    }
+    EXPECT_LT(0, threadTime);
+    EXPECT_EQ(threadTime, chunkTime);
+    EXPECT_EQ(part.size(), stealing.getChunkTimes().size());
+}
+
+TEST(StealingPartition, Trie) {
+    const int N = 200;
+    using tuple = ram::Tuple<RamDomain, 2>;
+    Trie<2> trie;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            trie.insert(tuple({i, j}));
+        }
+    }
+
+    std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[N * N]);
+    for (int i = 0; i < N * N; i++) {
+        visits[i] = 0;
+    }
+
+    auto part = trie.partition(400);
+    auto stealing = makeStealingPartition(part);
+    enumerate(stealing, 1, [&](const tuple& cur) {
+        visits[cur[0] * N + cur[1]]++;
+        return cur[0];
+    });
+
+    for (int i = 0; i < N * N; i++) {
+        EXPECT_EQ(1, visits[i]);
+    }
+}
+
+TEST(StealingScheduler, SingleChunk) {
+    // a single chunk is split among all threads in batches of growing size
+    StealingScheduler scheduler(1, false);
+    std::atomic<int> remaining(10000);
+    std::atomic<int> taken(0);
+    std::atomic<bool> valid(true);
+    PARALLEL_START;
+    size_t chunk = 0;
+    size_t count = 0;
+    while (scheduler.next(chunk, count)) {
+        if (chunk != 0 || count < 1 || count > StealingScheduler::MAX_BATCH) {
+            valid = false;
+        }
+        scheduler.getLock(chunk).lock();
+        int batch = std::min(remaining.load(), static_cast<int>(count));
+        remaining -= batch;
+        scheduler.getLock(chunk).unlock();
+        if (batch == 0) {
+            scheduler.exhausted(chunk);
+        }
+        taken += batch;
+    }
+    PARALLEL_END;
+    EXPECT_TRUE(valid);
+    EXPECT_EQ(10000, taken);
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,92 @@
+#!/bin/bash
+# Souffle - A Datalog Compiler
+# Copyright (c) 2019, The Souffle Developers. All rights reserved
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+
+# Compares the results of run.sh against the results of a baseline. For each
+# workload, mode and thread count, the median times of the runs are compared,
+# and changes beyond the threshold are reported as faster or slower. The exit
+# status is 1 if some configuration is slower, and 0 otherwise.
+
+set -u
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <baseline.csv> <results.csv> [threshold in percent, default 10]" >&2
+    exit 2
+fi
+
+BASELINE=$1
+RESULTS=$2
+THRESHOLD=${3:-10}
+
+for file in "$BASELINE" "$RESULTS"; do
+    if [ ! -f "$file" ]; then
+        echo "Error: cannot read $file" >&2
+        exit 2
+    fi
+done
+
+# prints the median time of each configuration as workload,mode,threads,seconds
+medians() {
+    tail -n +2 "$1" | sort -t, -k1,1 -k2,2 -k3,3n -k5,5g | awk -F, '
+        function flush() {
+            if (n > 0) {
+                median = (n % 2 == 1) ? times[(n + 1) / 2] : (times[n / 2] + times[n / 2 + 1]) / 2
+                print key "," median
+            }
+            n = 0
+        }
+        {
+            cur = $1 "," $2 "," $3
+            if (cur != key) {
+                flush()
+                key = cur
+            }
+            times[++n] = $5
+        }
+        END { flush() }'
+}
+
+medians "$BASELINE" | awk -F, -v threshold="$THRESHOLD" '
+    # the first input holds the baseline, the second the results
+    FNR == NR { base[$1 "," $2 "," $3] = $4; next }
+    BEGIN {
+        printf "%-20s %-12s %8s %12s %12s %9s\n",
+                "WORKLOAD", "MODE", "THREADS", "BASELINE", "CURRENT", "CHANGE"
+    }
+    {
+        key = $1 "," $2 "," $3
+        if (!(key in base)) {
+            printf "%-20s %-12s %8s %12s %12.3f %9s\n", $1, $2, $3, "-", $4, "new"
+            next
+        }
+        seen[key] = 1
+        if (base[key] > 0) {
+            change = ($4 - base[key]) / base[key] * 100
+        } else {
+            change = 0
+        }
+        verdict = ""
+        if (change > threshold) {
+            verdict = " slower"
+            slower++
+        } else if (change < -threshold) {
+            verdict = " faster"
+        }
+        printf "%-20s %-12s %8s %12.3f %12.3f %+8.1f%%%s\n", $1, $2, $3, base[key], $4, change, verdict
+    }
+    END {
+        for (key in base) {
+            if (!(key in seen)) {
+                split(key, field, ",")
+                printf "%-20s %-12s %8s %12.3f %12s %9s\n", field[1], field[2], field[3], base[key], "-",
+                        "missing"
+            }
+        }
+        if (slower > 0) {
+            printf "\n%d configuration(s) more than %s%% slower than the baseline\n", slower, threshold
+            exit 1
+        }
+    }' - <(medians "$RESULTS")
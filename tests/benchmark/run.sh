@@ -0,0 +1,164 @@
+#!/bin/bash
+# Souffle - A Datalog Compiler
+# Copyright (c) 2019, The Souffle Developers. All rights reserved
+# Licensed under the Universal Permissive License v 1.0 as shown at:
+# - https://opensource.org/licenses/UPL
+# - <souffle root>/licenses/SOUFFLE-UPL.txt
+
+# Runs the benchmark workloads (the Datalog programs in the subdirectories of
+# this directory) interpreted and compiled, and the data structure
+# microbenchmarks, at several thread counts. The wall-clock time of each run is
+# written as a line of a CSV file
+#
+#     workload,mode,threads,run,seconds
+#
+# which compare.sh compares against the results of a baseline.
+
+set -u -o pipefail
+
+usage() {
+    cat <<EOF
+Usage: $0 [options] [workload...]
+  -s <souffle>   souffle executable (default: souffle in PATH)
+  -b <bench>     data structure benchmark (default: souffle-struct-bench next to souffle)
+  -m <modes>     modes to run out of "interpreted compiled micro" (default: all)
+  -t <threads>   thread counts (default: "1 2 4 8")
+  -r <runs>      runs of each configuration (default: 3)
+  -o <file>      result file (default: benchmark-results.csv)
+  -w <dir>       work directory for executables and outputs (default: temporary)
+  -M <macros>    macro definitions passed to souffle, e.g. "NODES=4000"
+EOF
+    exit 1
+}
+
+BENCHDIR=$(cd "$(dirname "$0")" && pwd)
+SOUFFLE=$(command -v souffle)
+STRUCTBENCH=""
+MODES="interpreted compiled micro"
+THREADS="1 2 4 8"
+RUNS=3
+RESULTS=benchmark-results.csv
+WORKDIR=""
+MACROS=""
+
+while getopts "s:b:m:t:r:o:w:M:h" opt; do
+    case $opt in
+        s) SOUFFLE=$OPTARG ;;
+        b) STRUCTBENCH=$OPTARG ;;
+        m) MODES=$OPTARG ;;
+        t) THREADS=$OPTARG ;;
+        r) RUNS=$OPTARG ;;
+        o) RESULTS=$OPTARG ;;
+        w) WORKDIR=$OPTARG ;;
+        M) MACROS=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ -z "$SOUFFLE" ] || [ ! -x "$SOUFFLE" ]; then
+    echo "Error: souffle executable not found" >&2
+    usage
+fi
+if [ -z "$STRUCTBENCH" ]; then
+    STRUCTBENCH=$(dirname "$SOUFFLE")/souffle-struct-bench
+fi
+
+WORKLOADS="$*"
+if [ -z "$WORKLOADS" ]; then
+    for dir in "$BENCHDIR"/*/; do
+        WORKLOADS="$WORKLOADS $(basename "$dir")"
+    done
+fi
+
+if [ -z "$WORKDIR" ]; then
+    WORKDIR=$(mktemp -d)
+    trap 'rm -rf "$WORKDIR"' EXIT
+fi
+mkdir -p "$WORKDIR"
+
+MACROFLAGS=()
+if [ -n "$MACROS" ]; then
+    MACROFLAGS=(-M "$MACROS")
+fi
+
+FAILED=0
+TIMEFORMAT=%R
+
+echo "workload,mode,threads,run,seconds" >"$RESULTS"
+
+# sets $out to a fresh output directory of a run
+setOutput() {
+    out="$WORKDIR/$1-$2-$3-$4"
+    mkdir -p "$out"
+}
+
+# runs a command writing its outputs to $out, and appends its wall-clock time to the results
+measure() {
+    local workload=$1 mode=$2 threads=$3 run=$4
+    shift 4
+    local seconds
+    if ! seconds=$( { time "$@" >"$out.log" 2>&1; } 2>&1 ); then
+        echo "Error: $workload ($mode, $threads threads) failed, see $out.log" >&2
+        FAILED=1
+        return
+    fi
+    echo "$workload,$mode,$threads,$run,$seconds" >>"$RESULTS"
+    echo "$workload $mode $threads threads run $run: ${seconds}s"
+}
+
+for workload in $WORKLOADS; do
+    program="$BENCHDIR/$workload/$workload.dl"
+    if [ ! -f "$program" ]; then
+        echo "Error: unknown workload $workload" >&2
+        FAILED=1
+        continue
+    fi
+    for mode in $MODES; do
+        case $mode in
+            interpreted)
+                for threads in $THREADS; do
+                    for run in $(seq 1 "$RUNS"); do
+                        setOutput "$workload" "$mode" "$threads" "$run"
+                        measure "$workload" "$mode" "$threads" "$run" "$SOUFFLE" \
+                                ${MACROFLAGS[@]+"${MACROFLAGS[@]}"} -j "$threads" -D "$out" "$program"
+                    done
+                done
+                ;;
+            compiled)
+                # the compilation is not part of the measured time
+                executable="$WORKDIR/$workload"
+                if ! "$SOUFFLE" ${MACROFLAGS[@]+"${MACROFLAGS[@]}"} -o "$executable" "$program" \
+                        >"$executable.log" 2>&1; then
+                    echo "Error: compilation of $workload failed, see $executable.log" >&2
+                    FAILED=1
+                    continue
+                fi
+                for threads in $THREADS; do
+                    for run in $(seq 1 "$RUNS"); do
+                        setOutput "$workload" "$mode" "$threads" "$run"
+                        measure "$workload" "$mode" "$threads" "$run" "$executable" -j "$threads" -D "$out"
+                    done
+                done
+                ;;
+        esac
+    done
+done
+
+if [[ " $MODES " == *" micro "* ]]; then
+    if [ -x "$STRUCTBENCH" ]; then
+        for threads in $THREADS; do
+            for run in $(seq 1 "$RUNS"); do
+                if ! "$STRUCTBENCH" "$threads" "$run" | tee -a "$RESULTS"; then
+                    echo "Error: data structure benchmark failed" >&2
+                    FAILED=1
+                fi
+            done
+        done
+    else
+        echo "Error: data structure benchmark $STRUCTBENCH not found" >&2
+        FAILED=1
+    fi
+fi
+
+exit $FAILED
@@ -0,0 +1,106 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program moving tuples and symbols in bulk through the OO-interface,
+ * and checking them against the tuple-by-tuple interface
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // create an instance of program "bulk_transfer"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("bulk_transfer")) {
+        SymbolTable& symbolTable = prog->getSymbolTable();
+
+        // look up the nodes of a chain with a single call
+        std::vector<std::string> names = {"A", "B", "C", "D", "E"};
+        std::vector<RamDomain> nodes(names.size());
+        symbolTable.lookup(names.data(), names.size(), nodes.data());
+        for (size_t i = 0; i < names.size(); i++) {
+            if (symbolTable.lookup(names[i]) != nodes[i]) {
+                error("batched lookup differs from lookup");
+            }
+        }
+
+        // insert the edges of the chain row by row
+        std::vector<RamDomain> rows;
+        for (size_t i = 0; i + 1 < nodes.size(); i++) {
+            rows.push_back(nodes[i]);
+            rows.push_back(nodes[i + 1]);
+        }
+        if (!prog->insertMany("edge", rows.data(), rows.size() / 2)) {
+            error("cannot find relation edge");
+        }
+        if (prog->insertMany("vertex", rows.data(), rows.size() / 2)) {
+            error("found relation vertex");
+        }
+
+        // run program
+        prog->run();
+
+        // get output relation "path"
+        if (Relation* path = prog->getRelation("path")) {
+            // export the paths column by column
+            size_t size = path->size();
+            std::vector<RamDomain> sources(size);
+            std::vector<RamDomain> targets(size);
+            RamDomain* columns[] = {sources.data(), targets.data()};
+            if (!prog->exportColumns("path", columns)) {
+                error("cannot export relation path");
+            }
+            size_t row = 0;
+            for (auto& t : *path) {
+                if (t[0] != sources[row] || t[1] != targets[row]) {
+                    error("exported columns differ from tuples");
+                }
+                row++;
+            }
+
+            // resolve the symbols of both columns with a single call each
+            std::vector<const std::string*> from(size);
+            std::vector<const std::string*> to(size);
+            symbolTable.resolve(sources.data(), size, from.data());
+            symbolTable.resolve(targets.data(), size, to.data());
+            for (size_t i = 0; i < size; i++) {
+                if (*from[i] != symbolTable.resolve(sources[i]) ||
+                        *to[i] != symbolTable.resolve(targets[i])) {
+                    error("batched resolve differs from resolve");
+                }
+                std::cout << *from[i] << "\t" << *to[i] << "\n";
+            }
+        } else {
+            error("cannot find relation path");
+        }
+
+        // free program analysis
+        delete prog;
+
+    } else {
+        error("cannot find program bulk_transfer");
+    }
+}
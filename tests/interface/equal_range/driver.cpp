@@ -0,0 +1,107 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program querying a relation by patterns using the OO-interface,
+ * and comparing the latency of the indexed lookup against a scan
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <chrono>
+#include <string>
+#include <utility>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Count the tuples of a range, checking that they match the pattern
+ */
+size_t count(const std::pair<Relation::iterator, Relation::iterator>& range, const tuple& pattern,
+        SearchSignature mask) {
+    size_t res = 0;
+    for (auto it = range.first; it != range.second; ++it) {
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (((mask >> i) & 1) != 0 && (*it)[i] != pattern[i]) {
+                error("tuple does not match the pattern");
+            }
+        }
+        res++;
+    }
+    return res;
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // create an instance of program "equal_range"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("equal_range")) {
+        // get input relation "edge"
+        if (Relation* edge = prog->getRelation("edge")) {
+            // load a chain of 500 edges into relation "edge"
+            for (RamDomain i = 0; i < 500; i++) {
+                tuple t(edge);
+                t << i << i + 1;
+                edge->insert(t);
+            }
+
+            // run program
+            prog->run();
+
+            // get output relation "path"
+            if (Relation* path = prog->getRelation("path")) {
+                double indexed = 0;
+                double scanned = 0;
+                for (RamDomain node : {0, 100, 250, 499, 500, 501}) {
+                    tuple pattern(path);
+                    pattern << node << node;
+
+                    // successors are found by the index of the relation, predecessors may need a scan
+                    for (SearchSignature mask : {1, 2}) {
+                        auto start = std::chrono::steady_clock::now();
+                        size_t matches = count(path->equalRange(pattern, mask), pattern, mask);
+                        auto middle = std::chrono::steady_clock::now();
+                        size_t expected = count(path->Relation::equalRange(pattern, mask), pattern, mask);
+                        auto end = std::chrono::steady_clock::now();
+                        if (matches != expected) {
+                            error("indexed lookup differs from scan");
+                        }
+                        indexed += std::chrono::duration<double>(middle - start).count();
+                        scanned += std::chrono::duration<double>(end - middle).count();
+
+                        std::cout << (mask == 1 ? "successors" : "predecessors") << " of " << node << ": "
+                                  << matches << "\n";
+                    }
+                }
+                std::cerr << "lookup: " << indexed << "s, scan: " << scanned << "s\n";
+            } else {
+                error("cannot find relation path");
+            }
+
+            // free program analysis
+            delete prog;
+
+        } else {
+            error("cannot find relation edge");
+        }
+    } else {
+        error("cannot find program equal_range");
+    }
+}
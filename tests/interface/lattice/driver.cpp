@@ -0,0 +1,95 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program running a program with a min lattice relation through
+ * the OO-interface, which performs no IO, and checking that superseded
+ * tuples are removed and that membership tests are exact
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <array>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Check whether relation "dist" contains the given tuple
+ */
+bool contains(Relation* dist, RamDomain x, RamDomain y, RamDomain d) {
+    tuple t(dist);
+    t << x << y << d;
+    return dist->contains(t);
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // create an instance of program "lattice"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("lattice")) {
+        // get input relation "edge"
+        if (Relation* edge = prog->getRelation("edge")) {
+            // the direct edges from 1 to 3 and from 1 to 4 are longer than the paths via 2
+            std::vector<std::array<RamDomain, 3>> myData = {
+                    {1, 2, 1}, {2, 3, 1}, {1, 3, 5}, {3, 4, 1}, {1, 4, 9}, {4, 1, 1}};
+            for (auto input : myData) {
+                tuple t(edge);
+                t << input[0] << input[1] << input[2];
+                edge->insert(t);
+            }
+
+            // run program
+            prog->run();
+
+            // get output relation "dist"
+            if (Relation* dist = prog->getRelation("dist")) {
+                // each pair keeps its shortest distance only
+                std::set<std::array<RamDomain, 3>> tuples;
+                for (auto it = dist->begin(); it != dist->end(); ++it) {
+                    RamDomain x, y, d;
+                    (*it) >> x >> y >> d;
+                    tuples.insert({x, y, d});
+                }
+                for (const auto& cur : tuples) {
+                    std::cout << cur[0] << " " << cur[1] << " " << cur[2] << "\n";
+                }
+                std::cout << "size: " << dist->size() << "\n";
+
+                // superseded and dominated tuples are not contained
+                std::cout << "contains (1,3,2): " << contains(dist, 1, 3, 2) << "\n";
+                std::cout << "contains (1,3,5): " << contains(dist, 1, 3, 5) << "\n";
+                std::cout << "contains (1,4,4): " << contains(dist, 1, 4, 4) << "\n";
+            } else {
+                error("cannot find relation dist");
+            }
+
+            // free program analysis
+            delete prog;
+
+        } else {
+            error("cannot find relation edge");
+        }
+    } else {
+        error("cannot find program lattice");
+    }
+}
@@ -0,0 +1,167 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program serving the relations of an evaluated program over a
+ * Unix socket, and querying them with a client
+ *
+ ***********************************************************************/
+
+#include "souffle/QueryServer.h"
+#include "souffle/SouffleInterface.h"
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Print the targets of the paths starting at the given node
+ */
+void printSuccessors(QueryClient& client, const std::string& node) {
+    std::vector<RamDomain> rows;
+    RamDomain source = client.lookup({node})[0];
+    if (!client.query("path", 1, {source, 0}, rows)) {
+        error("cannot query relation path");
+    }
+    std::vector<RamDomain> targets;
+    for (size_t i = 0; i < rows.size(); i += 2) {
+        if (rows[i] != source) {
+            error("tuple does not match the pattern");
+        }
+        targets.push_back(rows[i + 1]);
+    }
+    std::cout << "successors of " << node << ":";
+    for (const auto& target : client.resolve(targets)) {
+        std::cout << " " << target;
+    }
+    std::cout << "\n";
+}
+
+/**
+ * Send a request announcing a string or an array beyond the message size limit on a new
+ * connection, and print the status of the response and whether the connection was closed
+ */
+void sendOversized(const std::string& socketPath, const std::string& title, QueryRequest kind) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        error("cannot connect to query server");
+    }
+    QueryChannel channel(fd);
+    channel.write(kind);
+    // the length of the relation name of a query, or the number of symbols of a lookup
+    channel.write(static_cast<uint32_t>(-1));
+    channel.flush();
+    QueryStatus status;
+    uint32_t next;
+    if (!channel.read(status)) {
+        error("no response to " + title);
+    }
+    bool closed = !channel.read(next);
+    std::cout << title << ": " << static_cast<uint32_t>(status) << (closed ? " closed" : " open") << "\n";
+    ::close(fd);
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    // check number of arguments
+    if (argc != 2) {
+        error("wrong number of arguments!");
+    }
+
+    // create instance of program "query_server"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("query_server")) {
+        // load all input relations and run program
+        prog->loadAll(argv[1]);
+        prog->run();
+
+        // serve the relations on a socket in the current directory
+        const std::string socketPath = "query_server.sock";
+        QueryServer server(*prog, 2);
+        std::thread serving([&]() { server.serve(socketPath); });
+
+        // wait for the socket to be created
+        for (int attempt = 0;; attempt++) {
+            try {
+                QueryClient probe(socketPath);
+                break;
+            } catch (const std::exception&) {
+                if (attempt == 1000) {
+                    error("cannot connect to query server");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+
+        try {
+            QueryClient client(socketPath);
+            for (const std::string node : {"a", "b", "c", "d", "x"}) {
+                printSuccessors(client, node);
+            }
+
+            // symbols unknown to the program are not added by lookups
+            std::cout << "unknown symbol: " << client.lookup({"unknown"})[0] << "\n";
+
+            // queries on unknown relations or with the wrong arity are rejected
+            std::vector<RamDomain> rows;
+            std::cout << "unknown relation: " << client.query("unknown", 0, {0, 0}, rows) << "\n";
+            std::cout << "wrong arity: " << client.query("path", 0, {0}, rows) << "\n";
+
+            // requests beyond the message size limit are rejected without allocating them
+            sendOversized(socketPath, "oversized relation name", QueryRequest::Query);
+            sendOversized(socketPath, "oversized lookup", QueryRequest::Lookup);
+            sendOversized(socketPath, "oversized resolve", QueryRequest::Resolve);
+
+            // all tuples are returned for an empty mask
+            client.query("path", 0, {0, 0}, rows);
+            std::cout << "tuples in path: " << rows.size() / 2 << "\n";
+
+            // idle connections do not hold the workers, so more clients than workers are served
+            std::vector<std::unique_ptr<QueryClient>> clients;
+            for (int i = 0; i < 5; i++) {
+                clients.push_back(std::make_unique<QueryClient>(socketPath));
+            }
+            for (auto it = clients.rbegin(); it != clients.rend(); ++it) {
+                printSuccessors(**it, "c");
+            }
+
+            client.shutdown();
+        } catch (const std::exception& e) {
+            error(e.what());
+        }
+        serving.join();
+
+        // free program
+        delete prog;
+
+    } else {
+        error("cannot find program query_server");
+    }
+}
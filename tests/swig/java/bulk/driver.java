@@ -0,0 +1,59 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+import java.io.PrintWriter;
+
+public class driver {
+  static {
+    try {
+      System.loadLibrary("SwigInterface");
+    } catch (UnsatisfiedLinkError e) {
+      System.load(System.getProperty("java.library.path") + "/" + "libSwigInterface.so");
+    }
+
+  }
+
+  public static void main(String argv[]) throws Exception {
+    SWIGSouffleProgram p = SwigInterface.newInstance("bulk");
+
+    // insert a chain of edges with a single call
+    vector_string symbols = new vector_string();
+    for (String symbol : new String[] {"A", "B", "C", "D"}) {
+      symbols.add(symbol);
+    }
+    vector_ram_domain nodes = p.lookupSymbols(symbols);
+    vector_ram_domain rows = new vector_ram_domain();
+    for (int i = 0; i + 1 < nodes.size(); i++) {
+      rows.add(nodes.get(i));
+      rows.add(nodes.get(i + 1));
+    }
+    p.insertMany("edge", rows);
+
+    // a partial tuple is rejected
+    vector_ram_domain partial = new vector_ram_domain();
+    partial.add(nodes.get(0));
+    try {
+      p.insertMany("edge", partial);
+      System.exit(1);
+    } catch (IllegalArgumentException e) {
+    }
+    p.run();
+    p.printAll(".");
+
+    // export the paths column by column
+    vector_vector_ram_domain columns = p.exportColumns("path");
+    vector_string sources = p.resolveSymbols(columns.get(0));
+    vector_string targets = p.resolveSymbols(columns.get(1));
+    try (PrintWriter out = new PrintWriter("exported.csv")) {
+      for (int i = 0; i < sources.size(); i++) {
+        out.print(sources.get(i) + "\t" + targets.get(i) + "\n");
+      }
+    }
+    p.finalize();
+  }
+}
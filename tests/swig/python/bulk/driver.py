@@ -0,0 +1,37 @@
+"""
+Souffle - A Datalog Compiler
+Copyright (c) 2019, The Souffle Developers. All rights reserved
+Licensed under the Universal Permissive License v 1.0 as shown at:
+- https://opensource.org/licenses/UPL
+- <souffle root>/licenses/SOUFFLE-UPL.txt
+"""
+
+import SwigInterface
+import sys
+p = SwigInterface.newInstance('bulk')
+
+# insert a chain of edges with a single call
+nodes = p.lookupSymbols(['A', 'B', 'C', 'D'])
+rows = []
+for i in range(len(nodes) - 1):
+    rows += [nodes[i], nodes[i + 1]]
+p.insertMany('edge', rows)
+
+# a partial tuple is rejected
+try:
+    p.insertMany('edge', [nodes[0]])
+    sys.exit(1)
+except ValueError:
+    pass
+p.run()
+p.printAll('.')
+
+# export the paths column by column
+columns = p.exportColumns('path')
+sources = p.resolveSymbols(columns[0])
+targets = p.resolveSymbols(columns[1])
+with open('exported.csv', 'w') as out:
+    for i in range(len(sources)):
+        out.write(sources[i] + '\t' + targets[i] + '\n')
+p.thisown = 1
+del p